@@ -0,0 +1,95 @@
+program arith;
+var a, b, c, d, e : integer;
+    x, y : real;
+
+procedure step;
+begin
+   a := a + 3 * b - c;
+   b := (b * 7 + 11) % 1000;
+   c := c + a % 17 - d;
+   d := (d + b * c) % 4096;
+   e := e - (a - b) * 2 + (c + d) / 3;
+   x := x + 0.5 * a - y;
+   y := (y + b) / 2.0;
+   a := a % 100000;
+   e := e % 65536
+end;
+
+procedure fan1;
+begin
+   step();
+   step();
+   step();
+   step();
+   step();
+   step();
+   step();
+   step();
+   step();
+   step()
+end;
+
+procedure fan2;
+begin
+   fan1();
+   fan1();
+   fan1();
+   fan1();
+   fan1();
+   fan1();
+   fan1();
+   fan1();
+   fan1();
+   fan1()
+end;
+
+procedure fan3;
+begin
+   fan2();
+   fan2();
+   fan2();
+   fan2();
+   fan2();
+   fan2();
+   fan2();
+   fan2();
+   fan2();
+   fan2()
+end;
+
+procedure fan4;
+begin
+   fan3();
+   fan3();
+   fan3();
+   fan3();
+   fan3();
+   fan3();
+   fan3();
+   fan3();
+   fan3();
+   fan3()
+end;
+
+procedure fan5;
+begin
+   fan4();
+   fan4();
+   fan4();
+   fan4();
+   fan4();
+   fan4();
+   fan4();
+   fan4();
+   fan4();
+   fan4()
+end;
+
+begin
+   a := 1;
+   b := 2;
+   c := 3;
+   d := 4;
+   e := 5;
+   fan5()
+end.
@@ -0,0 +1,34 @@
+program arrays;
+var i, checksum : integer;
+    data : array [1..1000] of integer;
+
+procedure smooth(n : integer);
+var k : integer;
+begin
+   for k := 2 to n - 1 do
+      data[k] := (data[k - 1] + data[k] * 2 + data[k + 1]) % 65536
+end;
+
+procedure scramble(seed : integer);
+var k, j : integer;
+begin
+   j := seed;
+   for k := 1 to 1000 do
+   begin
+      j := (j * 75 + 74) % 1000 + 1;
+      data[j] := data[j] + k
+   end
+end;
+
+begin
+   for i := 1 to 1000 do
+      data[i] := i * 37 % 101;
+
+   checksum := 0;
+   for i := 1 to 300 do
+   begin
+      smooth(1000);
+      scramble(i);
+      checksum := (checksum * 31 + data[i]) % 1000003
+   end
+end.
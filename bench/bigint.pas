@@ -0,0 +1,43 @@
+program bigint;
+var small, f, a, b, t, p, q : bigint;
+    i, round, digits : integer;
+
+begin
+   { Sums that stay within a long. }
+   small := 0;
+   for round := 1 to 50 do
+      for i := 1 to 2000 do
+         small := small + i * round;
+
+   f := 1;
+   for i := 2 to 3000 do
+      f := f * i;
+
+   a := 0;
+   b := 1;
+   for i := 1 to 5000 do
+   begin
+      t := a + b;
+      a := b;
+      b := t
+   end;
+
+   { Products of numbers of some thousand limbs. }
+   p := 3;
+   for i := 1 to 16 do
+      p := p * p;
+   q := p / f;
+   q := q % 1000000007;
+
+   digits := 0;
+   t := f;
+   while t <> 0 do
+   begin
+      t := t / 1000000000;
+      digits := digits + 9
+   end;
+   f := f % 1000000007;
+   a := a % 1000000007;
+   b := b % 1000000007;
+   p := p % 1000000007
+end.
@@ -0,0 +1,55 @@
+program branches;
+var i, primes, steps, longest, inside : integer;
+
+procedure sieve(n : integer);
+var k, m : integer;
+    isPrime : boolean;
+begin
+   for k := 2 to n do
+   begin
+      isPrime := true;
+      m := 2;
+      while (m * m <= k) and isPrime do
+      begin
+         if k % m = 0 then
+            isPrime := false;
+         m := m + 1
+      end;
+      if isPrime then
+         primes := primes + 1
+   end
+end;
+
+procedure collatz(start : integer);
+var k, count : integer;
+begin
+   k := start;
+   count := 0;
+   while k <> 1 do
+   begin
+      if k % 2 = 0 then
+         k := k / 2
+      else
+         k := 3 * k + 1;
+      count := count + 1
+   end;
+   steps := steps + count;
+   if count > longest then
+      longest := count
+end;
+
+procedure grid(n : integer);
+var x, y : integer;
+begin
+   for x := -n to n do
+      for y := -n to n do
+         if (x * x + y * y <= n * n) and not ((x = 0) or (y = 0)) then
+            inside := inside + 1
+end;
+
+begin
+   sieve(20000);
+   for i := 1 to 3000 do
+      collatz(i);
+   grid(150)
+end.
@@ -0,0 +1,91 @@
+program calls;
+var total, count : integer;
+    mean : real;
+
+procedure bump(k : integer);
+begin
+   total := (total + k * 3) % 1000000;
+   count := count + 1
+end;
+
+procedure blend(x : real);
+begin
+   mean := (mean + x) / 2.0
+end;
+
+procedure step(k : integer);
+var t : integer;
+begin
+   t := k % 7;
+   bump(t + k);
+   blend(t * 0.5)
+end;
+
+procedure fan1(k : integer);
+begin
+   step(k);
+   step(k + 1);
+   step(k + 2);
+   step(k + 3);
+   step(k + 4);
+   step(k + 5);
+   step(k + 6);
+   step(k + 7);
+   step(k + 8);
+   step(k + 9)
+end;
+
+procedure fan2(k : integer);
+begin
+   fan1(k);
+   fan1(k * 2);
+   fan1(k * 3);
+   fan1(k * 4);
+   fan1(k * 5);
+   fan1(k * 6);
+   fan1(k * 7);
+   fan1(k * 8);
+   fan1(k * 9);
+   fan1(k * 10)
+end;
+
+procedure fan3(k : integer);
+begin
+   fan2(k);
+   fan2(k + 11);
+   fan2(k + 22);
+   fan2(k + 33);
+   fan2(k + 44);
+   fan2(k + 55);
+   fan2(k + 66);
+   fan2(k + 77);
+   fan2(k + 88);
+   fan2(k + 99)
+end;
+
+procedure fan4(k : integer);
+begin
+   fan3(k);
+   fan3(k + 1);
+   fan3(k + 2);
+   fan3(k + 3);
+   fan3(k + 4);
+   fan3(k + 5);
+   fan3(k + 6);
+   fan3(k + 7);
+   fan3(k + 8);
+   fan3(k + 9)
+end;
+
+begin
+   fan4(1);
+   fan4(2);
+   fan4(3);
+   fan4(4);
+   fan4(5);
+   fan4(6);
+   fan4(7);
+   fan4(8);
+   fan4(9);
+   fan4(10)
+end.
@@ -0,0 +1,44 @@
+program dispatch;
+var i, accepted, tokens, weight : integer;
+
+procedure scan(n : integer);
+var state, digit : integer;
+begin
+   state := 0;
+   while n > 0 do
+   begin
+      digit := n % 10;
+      n := n / 10;
+      case state of
+         0: if digit % 2 = 0 then state := 1 else state := 2;
+         1: state := 3;
+         2: state := 4;
+         3: if digit > 4 then state := 5 else state := 0;
+         4: state := 6;
+         5: state := 7;
+         6: state := 0;
+         7: begin
+               tokens := tokens + 1;
+               state := 0
+            end
+      end;
+      case digit * digit * digit of
+         0: weight := weight + 1;
+         8: weight := weight + 3;
+         125: weight := weight + 5;
+         343: weight := weight + 7;
+         729: weight := weight + 9
+      else
+         weight := weight - 1
+      end
+   end;
+   case state of
+      1, 3, 5: accepted := accepted + 1;
+      7: accepted := accepted + 2
+   end
+end;
+
+begin
+   for i := 1 to 20000 do
+      scan(i)
+end.
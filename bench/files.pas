@@ -0,0 +1,24 @@
+program files;
+{ Writes a million lines to a text file, then reads them back a line at a time. }
+var f : text;
+var i, lines, total : integer;
+var s : string;
+
+begin
+   assign(f, '/tmp/pascal_bench_files.txt');
+   rewrite(f);
+   for i := 1 to 1000000 do
+      writeln(f, 'line ', i, ' of the file, padded to a typical length');
+   close(f);
+
+   reset(f);
+   lines := 0;
+   total := 0;
+   while not eof(f) do
+   begin
+      readln(f, s);
+      lines := lines + 1;
+      total := total + length(s)
+   end;
+   close(f)
+end.
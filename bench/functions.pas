@@ -0,0 +1,25 @@
+program functions;
+var i, total, calls : integer;
+
+function fib(n : integer) : integer;
+begin
+   if n < 2 then
+      fib := n
+   else
+      fib := fib(n - 1) + fib(n - 2)
+end;
+
+function max(a : integer; b : integer) : integer;
+begin
+   if a > b then
+      max := a
+   else
+      max := b
+end;
+
+begin
+   total := fib(27);
+   calls := 0;
+   for i := 1 to 1000000 do
+      calls := max(calls, i % 1000)
+end.
@@ -0,0 +1,16 @@
+program input;
+{ Reads what input.gen prints. }
+var n, i, k, sum : integer;
+var x, total : real;
+
+begin
+   readln(n);
+   sum := 0;
+   total := 0.0;
+   for i := 1 to n do
+   begin
+      readln(k, x);
+      sum := sum + k;
+      total := total + x
+   end
+end.
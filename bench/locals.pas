@@ -0,0 +1,88 @@
+program locals;
+var total : integer;
+    mean : real;
+
+procedure work(n, m : integer; w : real);
+var a, b, c, d : integer;
+    x : real;
+begin
+   a := n * 3 + m;
+   b := (a * 7 + 11) % 1000;
+   c := a % 17 - b + n;
+   d := (c + b * a) % 4096;
+   a := a - (b - c) * 2 + (c + d) / 3;
+   b := b + a % 100 - d * 2;
+   x := w * 0.5 + a - b;
+   x := (x + c) / 2.0;
+   total := (total + a + b + c + d) % 1000000;
+   mean := (mean + x) / 2.0
+end;
+
+procedure fan1(k : integer);
+begin
+   work(k, 1, 0.5);
+   work(k, 2, 1.5);
+   work(k, 3, 2.5);
+   work(k, 4, 3.5);
+   work(k, 5, 4.5);
+   work(k, 6, 5.5);
+   work(k, 7, 6.5);
+   work(k, 8, 7.5);
+   work(k, 9, 8.5);
+   work(k, 10, 9.5)
+end;
+
+procedure fan2(k : integer);
+begin
+   fan1(k);
+   fan1(k + 1);
+   fan1(k + 2);
+   fan1(k + 3);
+   fan1(k + 4);
+   fan1(k + 5);
+   fan1(k + 6);
+   fan1(k + 7);
+   fan1(k + 8);
+   fan1(k + 9)
+end;
+
+procedure fan3(k : integer);
+begin
+   fan2(k);
+   fan2(k * 2);
+   fan2(k * 3);
+   fan2(k * 4);
+   fan2(k * 5);
+   fan2(k * 6);
+   fan2(k * 7);
+   fan2(k * 8);
+   fan2(k * 9);
+   fan2(k * 10)
+end;
+
+procedure fan4(k : integer);
+begin
+   fan3(k);
+   fan3(k + 11);
+   fan3(k + 22);
+   fan3(k + 33);
+   fan3(k + 44);
+   fan3(k + 55);
+   fan3(k + 66);
+   fan3(k + 77);
+   fan3(k + 88);
+   fan3(k + 99)
+end;
+
+begin
+   fan4(1);
+   fan4(2);
+   fan4(3);
+   fan4(4);
+   fan4(5);
+   fan4(6);
+   fan4(7);
+   fan4(8);
+   fan4(9);
+   fan4(10)
+end.
@@ -0,0 +1,27 @@
+program loops;
+var i, total, checksum : integer;
+    mean : real;
+
+procedure sweep(n : integer);
+var k, acc : integer;
+begin
+   acc := 0;
+   for k := 1 to n do
+      acc := (acc + k * 7) % 65536;
+   checksum := (checksum * 31 + acc) % 1000003
+end;
+
+begin
+   total := 0;
+   checksum := 0;
+   for i := 1 to 2000 do
+   begin
+      sweep(300);
+      total := total + i % 11
+   end;
+
+   for i := 300000 downto 1 do
+      total := (total + i) % 999983;
+
+   mean := total / 2000
+end.
@@ -0,0 +1,16 @@
+program output;
+var i, sum : integer;
+
+procedure row(k : integer);
+begin
+   writeln(k, ' ', k * k, ' ', k / 7, ' ', k * 0.25)
+end;
+
+begin
+   sum := 0;
+   for i := 1 to 1000000 do
+   begin
+      row(i);
+      sum := sum + i
+   end
+end.
@@ -0,0 +1,44 @@
+program params;
+type table = array [1..1000] of integer;
+type stats = record count, total, peak : integer end;
+var data : table;
+    summary : stats;
+    i, round, checksum : integer;
+
+procedure scan(const t : table; var s : stats);
+var i : integer;
+begin
+   for i := 1 to 1000 do
+   begin
+      s.count := s.count + 1;
+      s.total := (s.total + t[i]) % 1000000;
+      if t[i] > s.peak then
+         s.peak := t[i]
+   end
+end;
+
+procedure stir(var t : table; k : integer);
+var i : integer;
+begin
+   for i := 1 to 1000 do
+      t[i] := (t[i] * 7 + k) % 10007
+end;
+
+procedure accumulate(var acc : integer; k : integer);
+begin
+   acc := (acc + k) % 1000003
+end;
+
+begin
+   for i := 1 to 1000 do
+      data[i] := i;
+
+   checksum := 0;
+   for round := 1 to 300 do
+   begin
+      stir(data, round);
+      scan(data, summary);
+      for i := 1 to 100 do
+         accumulate(checksum, data[i])
+   end
+end.
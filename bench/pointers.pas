@@ -0,0 +1,36 @@
+program pointers;
+type list = ^cell;
+   cell = record value : integer; next : list end;
+var head, p : list;
+    round, i, sum, kept : integer;
+
+begin
+   sum := 0;
+   for round := 1 to 200 do
+   begin
+      head := nil;
+      for i := 1 to 500 do
+      begin
+         new(p);
+         p^.value := i % 17;
+         p^.next := head;
+         head := p
+      end;
+
+      p := head;
+      while p <> nil do
+      begin
+         sum := sum + p^.value;
+         p := p^.next
+      end;
+
+      while head <> nil do
+      begin
+         p := head;
+         head := head^.next;
+         dispose(p)
+      end
+   end;
+
+   kept := sum % 1000
+end.
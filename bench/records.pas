@@ -0,0 +1,35 @@
+program records;
+type particle = packed record x, y, vx, vy : real; alive : boolean; hits : integer end;
+var swarm : array [1..1000] of particle;
+    i, step, bounces : integer;
+    first : particle;
+
+begin
+   for i := 1 to 1000 do
+   begin
+      swarm[i].x := i % 100;
+      swarm[i].y := i % 37;
+      swarm[i].vx := (i % 7) * 0.5 - 1.5;
+      swarm[i].vy := (i % 5) * 0.25 - 0.5;
+      swarm[i].alive := true;
+      swarm[i].hits := 0
+   end;
+
+   bounces := 0;
+   for step := 1 to 200 do
+      for i := 1 to 1000 do
+         if swarm[i].alive then
+         begin
+            swarm[i].x := swarm[i].x + swarm[i].vx;
+            swarm[i].y := swarm[i].y + swarm[i].vy;
+            if (swarm[i].x < 0) or (swarm[i].x > 100) then
+            begin
+               swarm[i].vx := -swarm[i].vx;
+               swarm[i].hits := swarm[i].hits + 1;
+               bounces := bounces + 1
+            end;
+            if swarm[i].hits > 20 then
+               swarm[i].alive := false
+         end;
+   first := swarm[1]
+end.
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Usage: bench/run.sh <interpreter [flags]>...
+# Runs every bench/*.pas program with each interpreter command (quote it to
+# pass flags, e.g. "bin/pascal_threaded.out --register-vm") and prints the
+# executed instruction count and the best execution time of $RUNS runs.
+# A program with a <name>.gen script next to it reads what the script prints.
+
+RUNS=${RUNS:-5}
+DIR=$(dirname "$0")
+
+printf "%-16s %-40s %14s %12s\n" "program" "interpreter" "instructions" "best, ms"
+
+for prog in "$DIR"/*.pas
+do
+	input=/dev/null
+	if [ -f "${prog%.pas}.gen" ]
+	then
+		input=$(mktemp)
+		sh "${prog%.pas}.gen" > "$input"
+	fi
+
+	for interp in "$@"
+	do
+		best=""
+		count=""
+		i=0
+		while [ $i -lt "$RUNS" ]
+		do
+			# $interp is split on purpose, it may carry flags
+			stats=$($interp -q --stats $BENCH_FLAGS "$prog" 2>&1 >/dev/null <"$input")
+			count=$(echo "$stats" | sed -n 's/^instructions executed: //p')
+			ms=$(echo "$stats" | sed -n 's/^execution time: \([0-9.]*\) ms/\1/p')
+			if [ -z "$best" ] || awk -v a="$ms" -v b="$best" 'BEGIN { exit !(a < b) }'
+			then
+				best=$ms
+			fi
+			i=$((i + 1))
+		done
+		printf "%-16s %-40s %14s %12s\n" "$(basename "$prog")" "$(basename "$interp")" "$count" "$best"
+	done
+
+	if [ "$input" != /dev/null ]
+	then
+		rm -f "$input"
+	fi
+done
@@ -0,0 +1,42 @@
+program sets;
+var i, round, words, vowels, digits : integer;
+    s, c : string;
+    letters, seen, common : set of char;
+    inWord : boolean;
+
+begin
+   s := '';
+   for i := 1 to 500 do
+      s := s + 'The 42 quick brown foxes, ';
+   letters := ['a'..'z', 'A'..'Z'];
+
+   words := 0;
+   vowels := 0;
+   digits := 0;
+   for round := 1 to 10 do
+   begin
+      inWord := false;
+      seen := [];
+      for i := 1 to length(s) do
+      begin
+         c := s[i];
+         if c in letters then
+         begin
+            if not inWord then
+               words := words + 1;
+            inWord := true;
+            if c in ['a', 'e', 'i', 'o', 'u', 'A', 'E', 'I', 'O', 'U'] then
+               vowels := vowels + 1
+         end
+         else
+         begin
+            inWord := false;
+            if c in ['0'..'9'] then
+               digits := digits + 1
+         end;
+         seen := seen + [c]
+      end;
+      common := seen * letters - ['a'..'f']
+   end;
+   s := ''
+end.
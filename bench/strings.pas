@@ -0,0 +1,26 @@
+program strings;
+var i, round, n, matches : integer;
+    s, word, probe : string;
+
+begin
+   matches := 0;
+   n := 0;
+   for round := 1 to 20 do
+   begin
+      s := '';
+      for i := 1 to 20000 do
+         s := s + 'ab';
+      n := n + length(s);
+
+      for i := 1 to 20000 do
+         if s[i] = 'a' then
+            matches := matches + 1;
+
+      word := 'interned literal';
+      probe := 'interned' + ' literal';
+      for i := 1 to 2000 do
+         if word = probe then
+            matches := matches + 1
+   end;
+   s := ''
+end.
@@ -0,0 +1,39 @@
+program vectors;
+var i, round, isum : integer;
+    rsum, rdot, scale : real;
+    a, b, c : array [1..2000] of integer;
+    x, y, z : array [1..2000] of real;
+
+begin
+   for i := 1 to 2000 do
+   begin
+      b[i] := i * 7 % 1013;
+      c[i] := 2000 - i;
+      x[i] := i * 0.5;
+      y[i] := 1000 - i * 0.25
+   end;
+
+   isum := 0;
+   rsum := 0;
+   rdot := 0;
+   scale := 0.999;
+   for round := 1 to 500 do
+   begin
+      for i := 1 to 2000 do
+         a[i] := b[i] + c[i];
+      for i := 1 to 2000 do
+         c[i] := a[i] - b[i];
+      for i := 1 to 2000 do
+         isum := isum + a[i];
+      for i := 1 to 2000 do
+         z[i] := x[i] * scale + y[i];
+      for i := 1 to 2000 do
+         y[i] := z[i] - x[i];
+      for i := 1 to 2000 do
+         x[i] := x[i] * scale;
+      for i := 1 to 2000 do
+         rdot := rdot + x[i] * y[i]
+   end;
+   for i := 1 to 2000 do
+      rsum := rsum + z[i]
+end.
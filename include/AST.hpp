@@ -10,6 +10,10 @@
 namespace Pascal
 {
 	class Parser;
+	class VariableSymbol;
+	class ProcedureSymbol;
+	class BuiltinRoutineSymbol;
+	class Symbol;
 	
 	namespace AST
 	{
@@ -42,13 +46,17 @@ namespace Pascal
 		class BlockNode : public Node
 		{
 		public:
-			BlockNode(std::vector<std::unique_ptr<VarDeclNode>> varDecls,
+			BlockNode(std::vector<std::unique_ptr<TypeDeclNode>> typeDecls,
+					  std::vector<std::unique_ptr<VarDeclNode>> varDecls,
 					  std::vector<std::unique_ptr<ProcDeclNode>> procDecls,
 					  std::unique_ptr<CompoundNode> compound)
-				: m_VarDecls(std::move(varDecls)), m_ProcDecls(std::move(procDecls)),
-				  m_Compound(std::move(compound))
+				: m_TypeDecls(std::move(typeDecls)), m_VarDecls(std::move(varDecls)),
+				  m_ProcDecls(std::move(procDecls)), m_Compound(std::move(compound))
 			{}
 			
+			std::vector<std::unique_ptr<TypeDeclNode>> const& getTypeDecls() const
+			{ return m_TypeDecls; }
+
 			std::vector<std::unique_ptr<VarDeclNode>> const& getVarDecls() const
 			{ return m_VarDecls; }
 
@@ -58,14 +66,21 @@ namespace Pascal
 			CompoundNode const& getCompound() const
 			{ return *m_Compound; }
 
+			// Number of variable slots in the block's frame,
+			// filled in by the SemanticAnalyzer.
+			unsigned getFrameSize() const { return m_FrameSize; }
+			void setFrameSize(unsigned size) const { m_FrameSize = size; }
+
 			void accept(Visitor* visitor) const
 			{
 				visitor->visitBlockNode(*this);
 			}
 		private:
+			std::vector<std::unique_ptr<TypeDeclNode>> m_TypeDecls;
 		    std::vector<std::unique_ptr<VarDeclNode>> m_VarDecls;
 			std::vector<std::unique_ptr<ProcDeclNode>> m_ProcDecls;
 		    std::unique_ptr<CompoundNode> m_Compound;
+			mutable unsigned m_FrameSize = 0;
 		};
 
 		class VarDeclNode : public Node
@@ -89,11 +104,13 @@ namespace Pascal
 		class ParamNode : public Node
 		{
 		public:
-		    ParamNode(std::unique_ptr<VariableNode> var, std::unique_ptr<TypeNode> type)
-				: m_Var(std::move(var)), m_Type(std::move(type)) {}
+		    ParamNode(std::unique_ptr<VariableNode> var, std::unique_ptr<TypeNode> type, Token mode)
+				: m_Var(std::move(var)), m_Type(std::move(type)), m_Mode(mode) {}
 
 			VariableNode const& getVar() const { return *m_Var; }
 			TypeNode const& getType() const { return *m_Type; }
+			// The 'var' or 'const' keyword, a NONE token for value parameters.
+			Token const& getMode() const { return m_Mode; }
 
 			void accept(Visitor* visitor) const
 			{
@@ -102,14 +119,16 @@ namespace Pascal
 		private:
 			std::unique_ptr<VariableNode> m_Var;
 			std::unique_ptr<TypeNode> m_Type;
+			Token_t m_Mode;
 		};
 		
 		class ProcDeclNode : public Node
 		{
 		public:
 			ProcDeclNode(Token name, std::vector<std::unique_ptr<ParamNode>> params,
-						 std::unique_ptr<BlockNode> block)
-				: m_Name(name), m_Params(std::move(params)), m_Block(std::move(block)) {}
+						 std::unique_ptr<BlockNode> block, std::unique_ptr<TypeNode> result = nullptr)
+				: m_Name(name), m_Params(std::move(params)), m_Block(std::move(block)),
+				  m_Result(std::move(result)) {}
 
 		    Token getProcName() const
 			{ return m_Name; }
@@ -120,6 +139,15 @@ namespace Pascal
 			BlockNode const& getBlock() const
 			{ return *m_Block; }
 
+			// The type a function returns, null for procedures.
+			TypeNode const* getResultType() const
+			{ return m_Result.get(); }
+
+			std::shared_ptr<const ProcedureSymbol> const& getSymbol() const
+			{ return m_Symbol; }
+			void setSymbol(std::shared_ptr<const ProcedureSymbol> sym) const
+			{ m_Symbol = sym; }
+
 			void accept(Visitor* visitor) const
 			{
 				visitor->visitProcDeclNode(*this);
@@ -129,6 +157,8 @@ namespace Pascal
 		    Token_t m_Name;
 		    std::vector<std::unique_ptr<ParamNode>> m_Params;
 			std::unique_ptr<BlockNode> m_Block;
+			std::unique_ptr<TypeNode> m_Result;
+			mutable std::shared_ptr<const ProcedureSymbol> m_Symbol;
 		};
 		
 		class VariableNode : public Node
@@ -139,28 +169,121 @@ namespace Pascal
 
 		    Token getToken() const { return m_Name; }
 
+			// Resolved by the SemanticAnalyzer, nullptr when the name is undefined.
+			std::shared_ptr<const VariableSymbol> const& getSymbol() const
+			{ return m_Symbol; }
+			void setSymbol(std::shared_ptr<const VariableSymbol> sym) const
+			{ m_Symbol = sym; }
+
+			// Set instead of the symbol when the name is a function's, the
+			// call without arguments the name stands for.
+			std::shared_ptr<const ProcCallNode> const& getCall() const
+			{ return m_Call; }
+			void setCall(std::shared_ptr<const ProcCallNode> call) const
+			{ m_Call = std::move(call); }
+
 			void accept(Visitor* visitor) const
 			{
 				visitor->visitVariableNode(*this);
 			}
 		private:
 			Token_t m_Name;
+			mutable std::shared_ptr<const VariableSymbol> m_Symbol;
+			mutable std::shared_ptr<const ProcCallNode> m_Call;
+		};
+
+		// An integer literal with an optional sign.
+		struct IntegerLiteral
+		{
+			Token_t literal;
+			bool negative;
+
+			// Throws like std::stol for literals the SemanticAnalyzer rejects.
+			long getValue() const
+			{
+				long res = std::stol(literal.str);
+				return negative ? -res : res;
+			}
+		};
+
+		// <names> : <type>; in a record.
+		struct FieldDecl
+		{
+			std::vector<Token_t> names;
+			std::shared_ptr<const TypeNode> type;
 		};
 
+		// <name>, ^<name>, array[<low>..<high>] of <name>, set of
+		// <low>..<high>, set of char or [packed] record <fields> end
 		class TypeNode : public Node
 		{
 		public:
 			TypeNode(Token name)
-				: m_Name(name) {}
-
+				: m_Name(name), m_Keyword(nullToken), m_Low({ nullToken, false }),
+				  m_High({ nullToken, false }), m_Array(false), m_Set(false) {}
+			TypeNode(Token keyword, IntegerLiteral low, IntegerLiteral high, Token element)
+				: m_Name(element), m_Keyword(keyword), m_Low(std::move(low)),
+				  m_High(std::move(high)), m_Array(true), m_Set(false) {}
+			// 'element' is the 'char' of set of char, nullToken with bounds.
+			TypeNode(Token keyword, Token element, IntegerLiteral low, IntegerLiteral high)
+				: m_Name(element), m_Keyword(keyword), m_Low(std::move(low)),
+				  m_High(std::move(high)), m_Array(false), m_Set(true) {}
+			TypeNode(Token caret, Token target)
+				: m_Name(target), m_Keyword(caret), m_Low({ nullToken, false }),
+				  m_High({ nullToken, false }), m_Array(false), m_Set(false) {}
+			// The copies of a record type share its fields, which makes
+			// them one type (see SemanticAnalyzer::recordType).
+			TypeNode(Token keyword, bool packed, std::shared_ptr<const std::vector<FieldDecl>> fields)
+				: m_Name(nullToken), m_Keyword(keyword), m_Low({ nullToken, false }),
+				  m_High({ nullToken, false }), m_Array(false), m_Set(false),
+				  m_Packed(packed), m_Fields(std::move(fields)) {}
+
+			// Name of the type, of the element type for arrays and sets, of
+			// the type pointed to for pointers.
 		    Token getToken() const { return m_Name; }
 
+			bool isArray() const { return m_Array; }
+			bool isPointer() const { return m_Keyword.type == TokenType::CARET; }
+			bool isSet() const { return m_Set; }
+			bool isRecord() const { return m_Fields != nullptr; }
+			bool isPacked() const { return m_Packed; }
+			Token getKeyword() const { return m_Keyword; }
+			IntegerLiteral const& getLow() const { return m_Low; }
+			IntegerLiteral const& getHigh() const { return m_High; }
+			std::shared_ptr<const std::vector<FieldDecl>> const& getFields() const { return m_Fields; }
+
 			void accept(Visitor* visitor) const
 			{
 				visitor->visitTypeNode(*this);
 			}
 		private:
 		    Token_t m_Name;
+			Token_t m_Keyword;
+			IntegerLiteral m_Low;
+			IntegerLiteral m_High;
+			bool m_Array;
+			bool m_Set;
+			bool m_Packed = false;
+			std::shared_ptr<const std::vector<FieldDecl>> m_Fields;
+		};
+
+		// type <name> = <record type>;
+		class TypeDeclNode : public Node
+		{
+		public:
+			TypeDeclNode(Token name, std::unique_ptr<TypeNode> type)
+				: m_Name(name), m_Type(std::move(type)) {}
+
+			Token getName() const { return m_Name; }
+			TypeNode const& getType() const { return *m_Type; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitTypeDeclNode(*this);
+			}
+		private:
+			Token_t m_Name;
+			std::unique_ptr<TypeNode> m_Type;
 		};
 
 		class StatementNode : public Node
@@ -186,22 +309,116 @@ namespace Pascal
 		    std::vector<std::unique_ptr<StatementNode>> m_Statements;
 		};
 		
+		// <var>[<index>]
+		class IndexNode : public Node
+		{
+		public:
+			IndexNode(std::unique_ptr<VariableNode> var, Token bracket, std::unique_ptr<Node> index)
+				: m_Var(std::move(var)), m_Bracket(bracket), m_Index(std::move(index)) {}
+
+			VariableNode const& getVar() const { return *m_Var; }
+			Token getBracket() const { return m_Bracket; }
+			Node const& getIndex() const { return *m_Index; }
+
+			// The for loop whose range may keep the index within the bounds
+			// (see ForNode::getIndexing), set by the SemanticAnalyzer. nullptr
+			// when the index has to be checked on every access.
+			ForNode const* getLoop() const { return m_Loop; }
+			void setLoop(ForNode const* loop) const { m_Loop = loop; }
+			// A constant index within the bounds.
+			bool getInBounds() const { return m_InBounds; }
+			void setInBounds(bool inBounds) const { m_InBounds = inBounds; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitIndexNode(*this);
+			}
+		private:
+			std::unique_ptr<VariableNode> m_Var;
+			Token_t m_Bracket;
+			std::unique_ptr<Node> m_Index;
+			mutable ForNode const* m_Loop = nullptr;
+			mutable bool m_InBounds = false;
+		};
+
+		// <record>.<field>[.<field>...], where the record is a variable or
+		// an array element, or the object a pointer variable or element
+		// points to: <pointer>^ or <pointer>^.<field>[.<field>...]
+		class FieldNode : public Node
+		{
+		public:
+			FieldNode(std::unique_ptr<VariableNode> var, std::vector<Token_t> fields)
+				: m_Var(std::move(var)), m_Caret(nullToken), m_Fields(std::move(fields)) {}
+			FieldNode(std::unique_ptr<IndexNode> element, std::vector<Token_t> fields)
+				: m_Element(std::move(element)), m_Caret(nullToken), m_Fields(std::move(fields)) {}
+			// 'fields' may be empty after the caret.
+			FieldNode(std::unique_ptr<VariableNode> var, Token caret, std::vector<Token_t> fields)
+				: m_Var(std::move(var)), m_Caret(caret), m_Fields(std::move(fields)) {}
+			FieldNode(std::unique_ptr<IndexNode> element, Token caret, std::vector<Token_t> fields)
+				: m_Element(std::move(element)), m_Caret(caret), m_Fields(std::move(fields)) {}
+
+			VariableNode const& getVar() const { return m_Element ? m_Element->getVar() : *m_Var; }
+			// nullptr unless the record or the pointer is an array element.
+			IndexNode const* getElement() const { return m_Element.get(); }
+			bool isDereference() const { return m_Caret.type == TokenType::CARET; }
+			Token getCaret() const { return m_Caret; }
+			std::vector<Token_t> const& getFields() const { return m_Fields; }
+			// Of the last field, of the caret without one.
+			size_t getPos() const { return m_Fields.empty() ? m_Caret.pos : m_Fields.back().pos; }
+
+			// Set by the SemanticAnalyzer: the type of the last field and its
+			// first slot, counted from the record's.
+			std::shared_ptr<const Symbol> const& getType() const { return m_Type; }
+			unsigned getOffset() const { return m_Offset; }
+			void setField(std::shared_ptr<const Symbol> type, unsigned offset) const
+			{ m_Type = std::move(type); m_Offset = offset; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitFieldNode(*this);
+			}
+		private:
+			std::unique_ptr<VariableNode> m_Var;
+			std::unique_ptr<IndexNode> m_Element;
+			Token_t m_Caret;
+			std::vector<Token_t> m_Fields;
+			mutable std::shared_ptr<const Symbol> m_Type;
+			mutable unsigned m_Offset = 0;
+		};
+
 		class AssignmentNode : public StatementNode
 		{
 		public:
 			AssignmentNode(std::unique_ptr<VariableNode> var, std::unique_ptr<Node> expr)
 				: m_Var(std::move(var)), m_Expr(std::move(expr)) {}
-
-			VariableNode const& getVar() const { return *m_Var; }
+			AssignmentNode(std::unique_ptr<IndexNode> element, std::unique_ptr<Node> expr)
+				: m_Element(std::move(element)), m_Expr(std::move(expr)) {}
+			AssignmentNode(std::unique_ptr<FieldNode> field, std::unique_ptr<Node> expr)
+				: m_Field(std::move(field)), m_Expr(std::move(expr)) {}
+
+			// The array for an element assignment, the record for a field one.
+			VariableNode const& getVar() const
+			{ return m_Field ? m_Field->getVar() : m_Element ? m_Element->getVar() : *m_Var; }
+			// nullptr unless an array element is assigned.
+			IndexNode const* getElement() const { return m_Element.get(); }
+			// nullptr unless a field is assigned.
+			FieldNode const* getField() const { return m_Field.get(); }
 			Node const& getExpr() const { return *m_Expr; }
 
+			// Set by the SemanticAnalyzer when a whole record is copied.
+			std::shared_ptr<const Symbol> const& getRecord() const { return m_Record; }
+			void setRecord(std::shared_ptr<const Symbol> record) const { m_Record = std::move(record); }
+
 			void accept(Visitor* visitor) const
 			{
 				visitor->visitAssignmentNode(*this);
 			}
 		private:
 			std::unique_ptr<VariableNode> m_Var;
+			std::unique_ptr<IndexNode> m_Element;
+			std::unique_ptr<FieldNode> m_Field;
 			std::unique_ptr<Node> m_Expr;
+			mutable std::shared_ptr<const Symbol> m_Record;
 		};
 
 		class NullStatementNode : public StatementNode
@@ -259,6 +476,10 @@ namespace Pascal
 				: m_Number(number) {}
 
 			Token getToken() const { return m_Number; }
+			// An integer beyond a long where a bigint is expected, a
+			// bignum constant.
+			bool isBig() const { return m_Big; }
+			void setBig() const { m_Big = true; }
 
 			void accept(Visitor* visitor) const
 			{
@@ -266,18 +487,151 @@ namespace Pascal
 			}
 		private:
 			Token_t m_Number;
+			mutable bool m_Big = false;
+		};
+
+		class BooleanNode : public Node
+		{
+		public:
+			BooleanNode(Token literal)
+				: m_Literal(literal) {}
+
+			Token getToken() const { return m_Literal; }
+			bool getValue() const { return m_Literal.str == "true"; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitBooleanNode(*this);
+			}
+		private:
+			Token_t m_Literal;
+		};
+
+		class NilNode : public Node
+		{
+		public:
+			NilNode(Token literal)
+				: m_Literal(literal) {}
+
+			Token getToken() const { return m_Literal; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitNilNode(*this);
+			}
+		private:
+			Token_t m_Literal;
+		};
+
+		class StringNode : public Node
+		{
+		public:
+			StringNode(Token literal)
+				: m_Literal(literal) {}
+
+			// The text, with '' already turned into a quote.
+			Token getToken() const { return m_Literal; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitStringNode(*this);
+			}
+		private:
+			Token_t m_Literal;
+		};
+
+		// [<element>, <low>..<high>, ...]
+		class SetNode : public Node
+		{
+		public:
+			// 'high' is nullptr for a single element. Bounds that are a lone
+			// number or string literal are known at compile time, their token
+			// is kept in 'lowLiteral' and 'highLiteral' (nullToken otherwise).
+			struct Element
+			{
+				std::unique_ptr<Node> low;
+				std::unique_ptr<Node> high;
+				Token_t lowLiteral;
+				Token_t highLiteral;
+
+				bool isConstant() const
+				{
+					return lowLiteral.type != TokenType::NONE &&
+						(high == nullptr || highLiteral.type != TokenType::NONE);
+				}
+			};
+
+			SetNode(Token bracket, std::vector<Element> elements)
+				: m_Bracket(bracket), m_Elements(std::move(elements)) {}
+
+			Token getBracket() const { return m_Bracket; }
+			std::vector<Element> const& getElements() const { return m_Elements; }
+
+			// Ordinal of a literal bound: a number or a one character string.
+			// False for the other literals.
+			static bool literalValue(Token literal, long& value)
+			{
+				if (literal.type == TokenType::STRING_LITERAL)
+				{
+					if (literal.str.size() != 1)
+						return false;
+					value = static_cast<unsigned char>(literal.str[0]);
+					return true;
+				}
+				if (literal.str.find_first_not_of("0123456789") != std::string::npos)
+					return false;
+				try
+				{
+					value = std::stol(literal.str);
+				}
+				catch (std::exception const&)
+				{
+					return false;
+				}
+				return true;
+			}
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitSetNode(*this);
+			}
+		private:
+			Token_t m_Bracket;
+			std::vector<Element> m_Elements;
 		};
 
+		// A statement, or a value of an expression if 'isFunctionCall()'.
 		class ProcCallNode : public StatementNode
 		{
 		public:
 			ProcCallNode(Token procName,
-						 std::vector<std::unique_ptr<Node>> procArgs)
-				: m_Name(procName), m_Args(std::move(procArgs)) {}
+						 std::vector<std::unique_ptr<Node>> procArgs, bool functionCall = false)
+				: m_Name(procName), m_Args(std::move(procArgs)), m_FunctionCall(functionCall) {}
 
 			Token getProcName() const { return m_Name; }
 			std::vector<std::unique_ptr<Node>> const&
 			getArguments() const { return m_Args; }
+			bool isFunctionCall() const { return m_FunctionCall; }
+
+			std::shared_ptr<const ProcedureSymbol> const& getSymbol() const
+			{ return m_Symbol; }
+			void setSymbol(std::shared_ptr<const ProcedureSymbol> sym) const
+			{ m_Symbol = sym; }
+
+			// Set instead of the symbol when a builtin routine is called.
+			std::shared_ptr<const BuiltinRoutineSymbol> const& getBuiltin() const
+			{ return m_Builtin; }
+			void setBuiltin(std::shared_ptr<const BuiltinRoutineSymbol> sym) const
+			{ m_Builtin = sym; }
+			// The pointer type of the argument of new and dispose.
+			std::shared_ptr<const Symbol> const& getPointerType() const
+			{ return m_PointerType; }
+			void setPointerType(std::shared_ptr<const Symbol> type) const
+			{ m_PointerType = std::move(type); }
+			// Of read, readln, write and writeln: the first argument is the
+			// text file to use instead of the input or the output.
+			bool hasTextFile() const { return m_TextFile; }
+			void setTextFile() const { m_TextFile = true; }
 
 			void accept(Visitor* visitor) const
 			{
@@ -286,6 +640,168 @@ namespace Pascal
 		private:
 			Token_t m_Name;
 		    std::vector<std::unique_ptr<Node>> m_Args;
+			bool m_FunctionCall;
+			mutable std::shared_ptr<const ProcedureSymbol> m_Symbol;
+			mutable std::shared_ptr<const BuiltinRoutineSymbol> m_Builtin;
+			mutable std::shared_ptr<const Symbol> m_PointerType;
+			mutable bool m_TextFile = false;
+		};
+
+		class WhileNode : public StatementNode
+		{
+		public:
+			WhileNode(Token keyword, std::unique_ptr<Node> condition,
+					  std::unique_ptr<StatementNode> body)
+				: m_Keyword(keyword), m_Condition(std::move(condition)), m_Body(std::move(body)) {}
+
+			Token getKeyword() const { return m_Keyword; }
+			Node const& getCondition() const { return *m_Condition; }
+			StatementNode const& getBody() const { return *m_Body; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitWhileNode(*this);
+			}
+		private:
+			Token_t m_Keyword;
+			std::unique_ptr<Node> m_Condition;
+			std::unique_ptr<StatementNode> m_Body;
+		};
+
+		class RepeatNode : public StatementNode
+		{
+		public:
+			RepeatNode(Token keyword, std::vector<std::unique_ptr<StatementNode>> statements,
+					   std::unique_ptr<Node> condition)
+				: m_Keyword(keyword), m_Statements(std::move(statements)),
+				  m_Condition(std::move(condition)) {}
+
+			Token getKeyword() const { return m_Keyword; }
+			std::vector<std::unique_ptr<StatementNode>> const& getStatements() const
+			{ return m_Statements; }
+			Node const& getCondition() const { return *m_Condition; }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitRepeatNode(*this);
+			}
+		private:
+			Token_t m_Keyword;
+			std::vector<std::unique_ptr<StatementNode>> m_Statements;
+			std::unique_ptr<Node> m_Condition;
+		};
+
+		// for <var> := <from> to|downto <to> do <body>
+		class ForNode : public StatementNode
+		{
+		public:
+			ForNode(Token keyword, std::unique_ptr<VariableNode> var, std::unique_ptr<Node> from,
+					std::unique_ptr<Node> to, bool downto, std::unique_ptr<StatementNode> body)
+				: m_Keyword(keyword), m_Var(std::move(var)), m_From(std::move(from)),
+				  m_To(std::move(to)), m_Downto(downto), m_Body(std::move(body)) {}
+
+			Token getKeyword() const { return m_Keyword; }
+			VariableNode const& getVar() const { return *m_Var; }
+			Node const& getFrom() const { return *m_From; }
+			Node const& getTo() const { return *m_To; }
+			bool isDownto() const { return m_Downto; }
+			StatementNode const& getBody() const { return *m_Body; }
+
+			// How the element accesses of the body that refer to this loop (see
+			// IndexNode::getLoop) stay within their bounds: the loop's range is
+			// known to, or has to be checked to, lie within [getIndexLow(),
+			// getIndexHigh()]. Set by the SemanticAnalyzer.
+			enum class Indexing
+			{
+				NONE,
+				PROVEN,
+				GUARDED
+			};
+
+			Indexing getIndexing() const { return m_Indexing; }
+			long getIndexLow() const { return m_IndexLow; }
+			long getIndexHigh() const { return m_IndexHigh; }
+			void setIndexing(Indexing indexing, long low, long high) const
+			{
+				m_Indexing = indexing;
+				m_IndexLow = low;
+				m_IndexHigh = high;
+			}
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitForNode(*this);
+			}
+		private:
+			Token_t m_Keyword;
+			std::unique_ptr<VariableNode> m_Var;
+			std::unique_ptr<Node> m_From;
+			std::unique_ptr<Node> m_To;
+			bool m_Downto;
+			std::unique_ptr<StatementNode> m_Body;
+			mutable Indexing m_Indexing = Indexing::NONE;
+			mutable long m_IndexLow = 0;
+			mutable long m_IndexHigh = 0;
+		};
+
+		// if <condition> then <then> [else <else>]
+		class IfNode : public StatementNode
+		{
+		public:
+			IfNode(Token keyword, std::unique_ptr<Node> condition,
+				   std::unique_ptr<StatementNode> thenBranch, std::unique_ptr<StatementNode> elseBranch)
+				: m_Keyword(keyword), m_Condition(std::move(condition)),
+				  m_Then(std::move(thenBranch)), m_Else(std::move(elseBranch)) {}
+
+			Token getKeyword() const { return m_Keyword; }
+			Node const& getCondition() const { return *m_Condition; }
+			StatementNode const& getThen() const { return *m_Then; }
+			// nullptr without an else branch.
+			StatementNode const* getElse() const { return m_Else.get(); }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitIfNode(*this);
+			}
+		private:
+			Token_t m_Keyword;
+			std::unique_ptr<Node> m_Condition;
+			std::unique_ptr<StatementNode> m_Then;
+			std::unique_ptr<StatementNode> m_Else;
+		};
+
+		// case <selector> of <labels>: <statement>; ... [else <statement>] end
+		class CaseNode : public StatementNode
+		{
+		public:
+			typedef IntegerLiteral Label;
+
+			struct Branch
+			{
+				std::vector<Label> labels;
+				std::unique_ptr<StatementNode> statement;
+			};
+
+			CaseNode(Token keyword, std::unique_ptr<Node> selector, std::vector<Branch> branches,
+					 std::unique_ptr<StatementNode> elseBranch)
+				: m_Keyword(keyword), m_Selector(std::move(selector)),
+				  m_Branches(std::move(branches)), m_Else(std::move(elseBranch)) {}
+
+			Token getKeyword() const { return m_Keyword; }
+			Node const& getSelector() const { return *m_Selector; }
+			std::vector<Branch> const& getBranches() const { return m_Branches; }
+			// nullptr without an else branch.
+			StatementNode const* getElse() const { return m_Else.get(); }
+
+			void accept(Visitor* visitor) const
+			{
+				visitor->visitCaseNode(*this);
+			}
+		private:
+			Token_t m_Keyword;
+			std::unique_ptr<Node> m_Selector;
+			std::vector<Branch> m_Branches;
+			std::unique_ptr<StatementNode> m_Else;
 		};
 	}
 }
@@ -0,0 +1,43 @@
+#ifndef PASCAL_BIG_HEAP_HPP
+#define PASCAL_BIG_HEAP_HPP
+
+#include <BigNum.hpp>
+#include <Value.hpp>
+
+#include <deque>
+
+namespace Pascal
+{
+	// Owns the bignums of bigints that outgrew a long. Like the SetHeap it
+	// frees nothing before itself, bignums are immutable and shared by
+	// every value that holds them. Results that fit a long again are
+	// inline bigints.
+	class BigHeap
+	{
+	public:
+		BigHeap() = default;
+		BigHeap(BigHeap const&) = delete;
+		BigHeap& operator=(BigHeap const&) = delete;
+
+		// Of integers, bigints and bignums, false for anything else.
+		// Division by zero has to be checked by the caller.
+		bool add(Value const& a, Value const& b, Value& res);
+		bool sub(Value const& a, Value const& b, Value& res);
+		bool mul(Value const& a, Value const& b, Value& res);
+		bool div(Value const& a, Value const& b, Value& res);
+		bool mod(Value const& a, Value const& b, Value& res);
+		bool neg(Value const& a, Value& res);
+		// A bigint from an optional sign and decimal digits.
+		Value parse(const char* chars, size_t length);
+
+		unsigned long getCount() const { return m_Numbers.size(); }
+
+	private:
+		Value make(BigNum&& number);
+
+		// A deque never moves its elements.
+		std::deque<BigNum> m_Numbers;
+	};
+}
+
+#endif
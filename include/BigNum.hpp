@@ -0,0 +1,42 @@
+#ifndef PASCAL_BIG_NUM_HPP
+#define PASCAL_BIG_NUM_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Pascal
+{
+	// An integer of any size: a sign and the magnitude in 32 bit limbs, the
+	// least significant one first and the most significant one never zero.
+	// Zero has no limbs and is never negative.
+	struct BigNum
+	{
+		// Products of operands shorter than this are computed limb by limb,
+		// longer ones by Karatsuba's three half sized products.
+		static const size_t KARATSUBA_LIMBS = 32;
+
+		bool negative = false;
+		std::vector<uint32_t> limbs;
+
+		static BigNum fromLong(long value);
+		// 'chars' are an optional sign and decimal digits.
+		static BigNum fromString(const char* chars, size_t length);
+		// False if it doesn't fit a long.
+		bool toLong(long& res) const;
+		double toReal() const;
+		std::string toString() const;
+
+		BigNum negated() const;
+
+		// -1, 0 or 1 as a is less than, equal to or greater than b.
+		static int compare(BigNum const& a, BigNum const& b);
+		static BigNum add(BigNum const& a, BigNum const& b);
+		static BigNum sub(BigNum const& a, BigNum const& b);
+		static BigNum mul(BigNum const& a, BigNum const& b);
+		// Truncates like / and % on integers do, 'b' must not be zero.
+		static void divide(BigNum const& a, BigNum const& b, BigNum& quotient, BigNum& remainder);
+	};
+}
+
+#endif
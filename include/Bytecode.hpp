@@ -0,0 +1,335 @@
+#ifndef PASCAL_BYTECODE_HPP
+#define PASCAL_BYTECODE_HPP
+
+#include <Value.hpp>
+#include <BigHeap.hpp>
+#include <CallStack.hpp>
+#include <StringHeap.hpp>
+
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <cstdint>
+
+namespace Pascal
+{
+	// X(name, operands) - every opcode of the virtual machine.
+	// Operands 'a', 'b' and 'c' meaning is given in the comment next to each one.
+#define PASCAL_OPCODES(X)												\
+	X(NOP,          0) /*                                              */ \
+	X(CONST,        1) /* push constants[a]                            */ \
+	X(LOAD_LOCAL,   1) /* push frame[a]                                */ \
+	X(STORE_LOCAL,  1) /* frame[a] := pop                              */ \
+	X(LOAD_GLOBAL,  1) /* push globals[a]                              */ \
+	X(STORE_GLOBAL, 1) /* globals[a] := pop                            */ \
+	X(LOAD_OUTER,   2) /* push display[a][b]                           */ \
+	X(STORE_OUTER,  2) /* display[a][b] := pop                         */ \
+	/* Array elements, the index of a store is under the value         */ \
+	X(BOUNDS,       2) /* error unless a <= top <= b, top is kept      */ \
+	X(LOAD_ELEM,    1) /* push frame[a + pop]                          */ \
+	X(STORE_ELEM,   1) /* frame[a + index] := value, both popped       */ \
+	X(LOAD_GELEM,   1) /* push globals[a + pop]                        */ \
+	X(STORE_GELEM,  1)													\
+	X(LOAD_OELEM,   2) /* push display[a][b + pop]                     */ \
+	X(STORE_OELEM,  2)													\
+	/* References to slots, held by var parameters                     */ \
+	X(REF_LOCAL,    1) /* push reference to frame[a]                   */ \
+	X(REF_GLOBAL,   1) /* push reference to globals[a]                 */ \
+	X(REF_OUTER,    2) /* push reference to display[a][b]              */ \
+	X(REF_INDEX,    1) /* top := reference to top[a + pop]             */ \
+	X(LOAD_REF,     1) /* top := top[a]                                */ \
+	X(STORE_REF,    1) /* ref[a] := value, both popped, ref under it   */ \
+	/* Objects of the ObjectHeap, their fields are read and written    */ \
+	/* through pointers by LOAD_REF and STORE_REF                      */ \
+	X(NEW,          1) /* pop^ := new object starting as layouts[a]    */ \
+	X(DISPOSE,      1) /* free the object of a slots pop points to     */ \
+	X(DEREF,        0) /* error if the pointer on top is nil, it stays */ \
+	X(ADD,          0) /* push pop + pop                               */ \
+	X(SUB,          0)													\
+	X(MUL,          0)													\
+	X(DIV,          0)													\
+	X(MOD,          0)													\
+	X(NEG,          0)													\
+	/* Like the above but reporting integer overflow, see {$Q+}        */ \
+	X(ADD_CHECKED,  0)													\
+	X(SUB_CHECKED,  0)													\
+	X(MUL_CHECKED,  0)													\
+	X(DIV_CHECKED,  0)													\
+	X(NEG_CHECKED,  0)													\
+	X(NOT,          0) /* push not pop                                 */ \
+	X(EQ,           0) /* push pop = pop, false < true for booleans    */ \
+	X(NE,           0)													\
+	X(LT,           0)													\
+	X(LE,           0)													\
+	X(GT,           0)													\
+	X(GE,           0)													\
+	X(CHAR_AT,      0) /* push string[index], both popped, from 1      */ \
+	X(LENGTH,       0) /* top := length of the string top              */ \
+	/* Sets: the a values popped are the low, high pairs of ranges     */ \
+	/* followed by c single elements                                   */ \
+	X(SET_BUILD,    3) /* push constants[b] + the popped elements      */ \
+	X(IN,           0) /* push element in set, both popped             */ \
+	X(TO_REAL,      0) /* widen top of stack to real                   */ \
+	X(TO_BIG,       0) /* top of stack as a bigint if an integer       */ \
+	X(WRITE,        0) /* print pop to the output buffer               */ \
+	X(WRITELN,      0) /* end the line in the output buffer            */ \
+	X(READ,         0) /* pop^ := the next value of its type in input  */ \
+	X(READLN,       0) /* skip past the end of the input line          */ \
+	X(ASSIGN_FILE,  0) /* name pop^ (under the name) the string pop    */ \
+	X(RESET,        0) /* open the file pop for reading                */ \
+	X(REWRITE,      0) /* open the file pop for writing                */ \
+	X(CLOSE,        0) /* close the file pop                           */ \
+	X(AT_EOF,       1) /* a ? top := eof(file top) : push eof(input)   */ \
+	/* File forms of READ to WRITELN: the file is under the values     */ \
+	/* and references, popped too if a                                 */ \
+	X(FILE_READ,    1) /* pop^ := the next value of its type in file   */ \
+	X(FILE_READLN,  1) /* skip past the end of the file's line         */ \
+	X(FILE_WRITE,   1) /* print pop to the file's buffer               */ \
+	X(FILE_WRITELN, 1) /* end the line in the file's buffer            */ \
+	X(JUMP,         1) /* goto a                                       */ \
+	X(JUMP_FALSE,   1) /* goto a if not pop                            */ \
+	X(JUMP_TRUE,    1) /* goto a if pop                                */ \
+	X(JUMP_EQ,      1) /* goto a if pop = pop                          */ \
+	X(JUMP_NE,      1)													\
+	X(JUMP_LT,      1)													\
+	X(JUMP_LE,      1)													\
+	X(JUMP_GT,      1)													\
+	X(JUMP_GE,      1)													\
+	/* Case dispatch on the popped integer: the default JUMP follows,  */ \
+	/* then a JUMPs by ascending label, the label constant in b        */ \
+	X(CASE_LIST,    1) /* compare the labels one by one                */ \
+	X(CASE_FIND,    1) /* binary search over the labels                */ \
+	X(CASE_TABLE,   1) /* entry pop - k, k is constants[b] of default  */ \
+	/* Counted loops over integer frame[b] up to its limit frame[c]    */ \
+	X(FOR_INIT,     3) /* goto a if frame[b] > frame[c]                */ \
+	X(FOR_INIT_DN,  3) /* goto a if frame[b] < frame[c]                */ \
+	X(FOR_NEXT,     3) /* if frame[b] < frame[c]: frame[b]++, goto a   */ \
+	X(FOR_NEXT_DN,  3) /* if frame[b] > frame[c]: frame[b]--, goto a   */ \
+	X(VECTOR,       2) /* vectorLoops[b], goto a if no iteration left  */ \
+	X(CALL,         1) /* call procedures[a], arguments are on stack   */ \
+	X(TAIL_CALL,    1) /* CALL reusing the frame, the caller returns   */ \
+	X(RET,          0)													\
+	X(RET_VALUE,    1) /* RET pushing frame[a] where the arguments were */ \
+	X(HALT,         0)													\
+	/* Superinstructions, produced only by the PeepholeOptimizer       */ \
+	X(ADD_CONST,    1) /* top := top + constants[a]                    */ \
+	X(SUB_CONST,    1)													\
+	X(MUL_CONST,    1)													\
+	X(DIV_CONST,    1)													\
+	X(MOD_CONST,    1)													\
+	X(ADD_LOCAL,    1) /* top := top + frame[a]                        */ \
+	X(SUB_LOCAL,    1)													\
+	X(MUL_LOCAL,    1)													\
+	X(DIV_LOCAL,    1)													\
+	X(MOD_LOCAL,    1)													\
+	X(ADD_GLOBAL,   1) /* top := top + globals[a]                      */ \
+	X(SUB_GLOBAL,   1)													\
+	X(MUL_GLOBAL,   1)													\
+	X(DIV_GLOBAL,   1)													\
+	X(MOD_GLOBAL,   1)													\
+	X(LOAD_LOCAL2,  2) /* push frame[a], push frame[b]                 */ \
+	X(LOAD_GLOBAL2, 2) /* push globals[a], push globals[b]             */ \
+	X(INC_LOCAL,    2) /* frame[a] := frame[a] + constants[b]          */ \
+	X(INC_GLOBAL,   2) /* globals[a] := globals[a] + constants[b]      */ \
+	/* Register form, produced only by the RegisterTranslator.         */ \
+	/* r[i] is frame[i]: variables first, then temporaries             */ \
+	X(R_MOVE,       2) /* r[a] := r[b]                                 */ \
+	X(R_LOADK,      2) /* r[a] := constants[b]                         */ \
+	X(R_SET,        2) /* variable r[a] := r[b]                        */ \
+	X(R_SETK,       2) /* variable r[a] := constants[b]                */ \
+	X(R_GETGLOBAL,  2) /* r[a] := globals[b]                           */ \
+	X(R_SETGLOBAL,  2) /* globals[a] := r[b]                           */ \
+	X(R_GETOUTER,   3) /* r[a] := display[b][c]                        */ \
+	X(R_SETOUTER,   3) /* display[a][b] := r[c]                        */ \
+	X(R_ADD,        3) /* r[a] := r[b] + r[c]                          */ \
+	X(R_SUB,        3)													\
+	X(R_MUL,        3)													\
+	X(R_DIV,        3)													\
+	X(R_MOD,        3)													\
+	X(R_ADDK,       3) /* r[a] := r[b] + constants[c]                  */ \
+	X(R_SUBK,       3)													\
+	X(R_MULK,       3)													\
+	X(R_DIVK,       3)													\
+	X(R_MODK,       3)													\
+	X(R_NEG,        2) /* r[a] := -r[b]                                */ \
+	X(R_TO_REAL,    2) /* r[a] := real(r[b])                           */ \
+	X(R_NOT,        2) /* r[a] := not r[b]                             */ \
+	X(R_EQ,         3) /* r[a] := r[b] = r[c]                          */ \
+	X(R_NE,         3)													\
+	X(R_LT,         3)													\
+	X(R_LE,         3)													\
+	X(R_GT,         3)													\
+	X(R_GE,         3)													\
+	X(R_CALL,       2) /* call procedures[a], arguments are r[b]...    */ \
+	X(R_TAIL_CALL,  2) /* R_CALL reusing the frame                     */ \
+	X(R_JUMP_FALSE, 2) /* goto a if not r[b]                           */ \
+	X(R_JUMP_TRUE,  2) /* goto a if r[b]                               */ \
+	X(R_JUMP_EQ,    3) /* goto a if r[b] = r[c]                        */ \
+	X(R_JUMP_NE,    3)													\
+	X(R_JUMP_LT,    3)													\
+	X(R_JUMP_LE,    3)													\
+	X(R_JUMP_GT,    3)													\
+	X(R_JUMP_GE,    3)													\
+	X(R_JUMP_EQK,   3) /* goto a if r[b] = constants[c]                */ \
+	X(R_JUMP_NEK,   3)													\
+	X(R_JUMP_LTK,   3)													\
+	X(R_JUMP_LEK,   3)													\
+	X(R_JUMP_GTK,   3)													\
+	X(R_JUMP_GEK,   3)													\
+	X(R_CASE_LIST,  2) /* CASE_LIST on r[b], the JUMPs follow          */ \
+	X(R_CASE_FIND,  2)													\
+	X(R_CASE_TABLE, 2)													\
+	X(R_BOUNDS,     3) /* BOUNDS on r[a], b and c are the bounds       */ \
+	X(R_GETELEM,    3) /* r[a] := frame[b + r[c]]                      */ \
+	X(R_SETELEM,    3) /* frame[a + r[b]] := r[c]                      */ \
+	X(R_GETGELEM,   3) /* r[a] := globals[b + r[c]]                    */ \
+	X(R_SETGELEM,   3) /* globals[a + r[b]] := r[c]                    */
+
+	// Loops the Compiler runs as a kernel (see Vectorizer, VectorKernels).
+	enum class VectorKernel : uint8_t
+	{
+		COPY,	// a[i] := b[i]
+		FILL,	// a[i] := s
+		ADD,	// a[i] := b[i] + c[i]
+		SUB,	// a[i] := b[i] - c[i]
+		MUL,	// a[i] := b[i] * c[i]
+		SCALE,	// a[i] := b[i] * s
+		AXPY,	// a[i] := b[i] * s + c[i]
+		SUM,	// r := r + b[i]
+		DOT		// r := r + b[i] * c[i]
+	};
+
+	// A variable, or an array whose element 0 would be at 'slot', in the
+	// running frame (level 0) or in display[level]. constants[slot] if
+	// 'constant'.
+	struct VectorOperand
+	{
+		int32_t level = 0;
+		int32_t slot = 0;
+		bool constant = false;
+		long low = 0;
+		long high = -1;
+	};
+
+	// for i := frame[var] to frame[limit] do <kernel>, the arrays indexed
+	// by i alone. Every element has to be of 'element' type: the kernel
+	// stops before the first one that isn't (or is out of bounds), leaving
+	// the iterations from there on to the loop's bytecode.
+	struct VectorLoop
+	{
+		VectorKernel kernel;
+		ValueType element;
+		int32_t var;
+		int32_t limit;
+		// a, or r of the sums
+		VectorOperand target;
+		VectorOperand left;
+		VectorOperand right;
+		VectorOperand scalar;
+	};
+
+	std::string vectorKernelToString(VectorKernel kernel);
+
+	enum class OpCode : uint8_t
+	{
+#define PASCAL_OPCODE_ENUM(name, operands) name,
+		PASCAL_OPCODES(PASCAL_OPCODE_ENUM)
+#undef PASCAL_OPCODE_ENUM
+		OPCODES_COUNT
+	};
+
+	std::string opCodeToString(OpCode op);
+	unsigned opCodeOperands(OpCode op);
+	// Whether operand 'a' of the instruction is an index into the code.
+	bool opCodeIsJump(OpCode op);
+
+	struct Instruction
+	{
+		// Label address of the opcode's handler, filled in by the
+		// threaded dispatch loop before the first run.
+		const void* handler;
+		OpCode op;
+		int32_t a;
+		int32_t b;
+		int32_t c;
+	};
+
+	static_assert(sizeof(Instruction) <= 24, "Instruction must fit three words");
+
+	struct ProcedureCode
+	{
+		std::string name;
+		ARType type;
+		unsigned nestingLevel;
+		unsigned paramsCount;
+		size_t entry;
+		// Deepest operand stack the body can reach, or the number of
+		// temporaries of register code.
+		unsigned maxStack = 0;
+		bool registerCode = false;
+
+		// Initial (typed zero) value of every slot, parameters first.
+		std::vector<Value> slotsInit;
+		// Names of the declared variables. The slots past them belong to
+		// inlined procedures.
+		std::vector<std::string> slotsNames;
+		// Length of the array declared at the slot, 0 for the other slots.
+		std::vector<unsigned> arrayLengths;
+		// Fields of the record (of the record elements) declared at the
+		// slot, one per slot of the record. Empty for the other slots.
+		std::vector<std::vector<std::string>> recordFields;
+
+		unsigned getFrameSize() const { return slotsInit.size(); }
+	};
+
+	class Bytecode
+	{
+	public:
+		size_t emit(OpCode op, int32_t a = 0, int32_t b = 0, size_t pos = 0);
+		unsigned addConstant(Value const& value);
+		unsigned addProcedure(ProcedureCode const& proc);
+		unsigned addVectorLoop(VectorLoop const& loop);
+		// The typed zeros a new object starts with, one per slot.
+		unsigned addLayout(std::vector<Value> const& layout);
+		// Equal literals share one constant.
+		unsigned addString(std::string const& text);
+		unsigned addSet(SetBits const& bits);
+		// A bigint from decimal digits.
+		unsigned addBigInt(std::string const& digits);
+
+		std::vector<Instruction>& getCode() { return m_Code; }
+		std::vector<Instruction> const& getCode() const { return m_Code; }
+		std::vector<size_t>& getPositions() { return m_Positions; }
+		std::vector<size_t> const& getPositions() const { return m_Positions; }
+		std::vector<Value> const& getConstants() const { return m_Constants; }
+		std::vector<ProcedureCode>& getProcedures() { return m_Procedures; }
+		std::vector<ProcedureCode> const& getProcedures() const { return m_Procedures; }
+		std::vector<VectorLoop> const& getVectorLoops() const { return m_VectorLoops; }
+		std::vector<std::vector<Value>> const& getLayouts() const { return m_Layouts; }
+
+		// Source position of the instruction, for runtime errors.
+		size_t getPos(size_t index) const { return m_Positions[index]; }
+
+		// The code of a procedure runs from its entry up to the next one.
+		size_t getProcedureEnd(unsigned proc) const;
+
+		std::string disassemble() const;
+
+	private:
+		std::vector<Instruction> m_Code;
+		std::vector<size_t> m_Positions;
+		std::vector<Value> m_Constants;
+		std::vector<ProcedureCode> m_Procedures;
+		std::vector<VectorLoop> m_VectorLoops;
+		std::vector<std::vector<Value>> m_Layouts;
+
+		StringHeap m_Strings;
+		std::map<std::string, unsigned> m_Literals;
+		// A deque never moves its elements.
+		std::deque<SetBits> m_Sets;
+		BigHeap m_Bigs;
+	};
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef PASCAL_CALL_STACK_HPP
 #define PASCAL_CALL_STACK_HPP
 
+#include <Value.hpp>
+
 #include <string>
 #include <map>
 #include <deque>
@@ -16,32 +18,36 @@ namespace Pascal
 	};
 
 	std::string typeToString(ARType type);
-	
-	typedef struct
-	{
-		long value;
-	} ARObject; // Temporary
-	
+
+	struct ProcedureCode;
+	struct Instruction;
+
 	class ActivationRecord
 	{
 	public:
-		ActivationRecord(std::string const& name, ARType type, unsigned nestingLevel)
-			: m_Name(name), m_Type(type), m_NestingLevel(nestingLevel) {}
+		ActivationRecord(ProcedureCode const& proc, Value* slots,
+						 const Instruction* returnAddress, Value* savedDisplay)
+			: m_Proc(&proc), m_Slots(slots),
+			  m_ReturnAddress(returnAddress), m_SavedDisplay(savedDisplay) {}
 
-		ARObject& operator[](std::string const& name)
-		{ return m_Members[name]; }
+		Value& operator[](unsigned slot)
+		{ return m_Slots[slot]; }
 
-		std::string const& getName()     const { return m_Name; }
-		const ARType getType()           const { return m_Type; }
-		const unsigned getNestingLevel() const { return m_NestingLevel; }
+		std::string const& getName()     const;
+		const ARType getType()           const;
+		const unsigned getNestingLevel() const;
 		std::string toString()           const;
 
-	private:
-		std::string m_Name;
-		ARType m_Type;
-		unsigned m_NestingLevel;
+		ProcedureCode const& getProcedure()     const { return *m_Proc; }
+		Value* getSlots()                       const { return m_Slots; }
+		const Instruction* getReturnAddress()   const { return m_ReturnAddress; }
+		Value* getSavedDisplay()                const { return m_SavedDisplay; }
 
-		std::map<std::string, ARObject> m_Members;
+	private:
+		ProcedureCode const* m_Proc;
+		Value* m_Slots;
+		const Instruction* m_ReturnAddress;
+		Value* m_SavedDisplay;
 	};
 
 	class CallStack
@@ -62,11 +68,21 @@ namespace Pascal
 			return m_Records.back();
 		}
 
+		bool empty() const
+		{
+			return m_Records.empty();
+		}
+
+		size_t size() const
+		{
+			return m_Records.size();
+		}
+
 		std::string toString() const;
-		
+
 	private:
 		std::deque<ActivationRecord> m_Records;
 	};
-}    
+}
 
 #endif
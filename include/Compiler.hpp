@@ -0,0 +1,172 @@
+#ifndef PASCAL_COMPILER_HPP
+#define PASCAL_COMPILER_HPP
+
+#include <Visitor.hpp>
+#include <Lexer.hpp>
+#include <Bytecode.hpp>
+#include <Symbols.hpp>
+#include <Inliner.hpp>
+#include <Vectorizer.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+namespace Pascal
+{
+	// Lowers a checked AST (see SemanticAnalyzer) to stack machine bytecode.
+	// Calls the Inliner picks are expanded in place: the callee's variables
+	// get slots past the caller's own ones, one set per inlined procedure.
+	class Compiler : public AST::Visitor
+	{
+	public:
+		Compiler(Bytecode& code, Inliner* inliner = nullptr)
+			: m_Code(code), m_Inliner(inliner) {}
+
+		void visitProgramNode(AST::ProgramNode const& node);
+		void visitVarDeclNode(AST::VarDeclNode const& node);
+		void visitBlockNode(AST::BlockNode const& node);
+		void visitTypeNode(AST::TypeNode const& node);
+		void visitStatementNode(AST::StatementNode const& node);
+		void visitCompoundNode(AST::CompoundNode const& node);
+		void visitAssignmentNode(AST::AssignmentNode const& node);
+		void visitVariableNode(AST::VariableNode const& node);
+		void visitNullStatementNode(AST::NullStatementNode const& node);
+		void visitNumberNode(AST::NumberNode const& node);
+		void visitBinOpNode(AST::BinOpNode const& node);
+		void visitUnaryOpNode(AST::UnaryOpNode const& node);
+		void visitProcDeclNode(AST::ProcDeclNode const& node);
+		void visitParamNode(const AST::ParamNode &node);
+		void visitProcCallNode(const AST::ProcCallNode& node);
+		void visitWhileNode(AST::WhileNode const& node);
+		void visitRepeatNode(AST::RepeatNode const& node);
+		void visitForNode(AST::ForNode const& node);
+		void visitIfNode(AST::IfNode const& node);
+		void visitBooleanNode(AST::BooleanNode const& node);
+		void visitCaseNode(AST::CaseNode const& node);
+		void visitIndexNode(AST::IndexNode const& node);
+		void visitStringNode(AST::StringNode const& node);
+		void visitSetNode(AST::SetNode const& node);
+		void visitTypeDeclNode(AST::TypeDeclNode const& node);
+		void visitFieldNode(AST::FieldNode const& node);
+		void visitNilNode(AST::NilNode const& node);
+
+		// Without bounds checks an index out of range reads or writes
+		// whatever is next to the array.
+		void setBoundsChecks(bool enabled) { m_BoundsChecks = enabled; }
+		unsigned getElementAccesses() const { return m_ElementAccesses; }
+		unsigned getBoundsChecks() const { return m_BoundsCheckCount; }
+
+		// Whether integer + - * / report overflow where no {$Q+} or {$Q-}
+		// directive says otherwise.
+		void setOverflowChecks(bool enabled) { m_OverflowChecks = enabled; }
+
+		// Loops of a VectorKernel form try the kernel before their code.
+		void setVectorize(bool enabled) { m_Vectorize = enabled; }
+		unsigned getVectorizedLoops() const { return m_VectorizedLoops; }
+
+	private:
+		Bytecode& m_Code;
+		Inliner* m_Inliner;
+
+		unsigned m_CurrentProc = 0;
+		unsigned m_CurrentLevel = 0;
+		// The result of the function being compiled.
+		const VariableSymbol* m_Result = nullptr;
+		int m_Depth = 0;
+		// The statement being compiled is the last one the procedure runs.
+		bool m_TailPosition = false;
+
+		std::map<const ProcedureSymbol*, unsigned> m_ProcIndices;
+
+		// Nodes inlined into the current procedure, where each inlined
+		// procedure's slots start and the slots of the variables of the
+		// bodies being inlined.
+		unsigned m_Growth = 0;
+		unsigned m_InlineDepth = 0;
+		std::map<const ProcedureSymbol*, int32_t> m_InlineBases;
+		std::map<const VariableSymbol*, int32_t> m_InlineSlots;
+
+		// Hidden slots holding the limits of the for loops being compiled,
+		// one per nesting depth.
+		std::vector<int32_t> m_LimitSlots;
+		unsigned m_ForDepth = 0;
+
+		// Set while a condition is compiled as jumps, see emitBranch.
+		struct Branch
+		{
+			bool jumpIf;
+			std::vector<size_t>* jumps;
+			bool done;
+		};
+		Branch* m_Branch = nullptr;
+		// Hidden slot short-circuit 'and' and 'or' leave their value in.
+		int32_t m_BooleanSlot = -1;
+		// Set while a whole record is copied, see emitCopy: the slot of the
+		// record read next and the two hidden slots keeping the indices of
+		// the target and source elements.
+		int m_CopyPart = -1;
+		int32_t m_CopySlots = -1;
+		// Set while the argument of a reference parameter is compiled, its
+		// variable, element or field is addressed, see emitAddress.
+		bool m_Address = false;
+
+		bool m_BoundsChecks = true;
+		// Loops whose body is being compiled for a range of the control
+		// variable that keeps the accesses referring to them in bounds.
+		std::set<const AST::ForNode*> m_InBounds;
+		// Set while the checked copy of a loop body is compiled, the loops
+		// in it get a single copy.
+		bool m_CheckedCopy = false;
+		unsigned m_ElementAccesses = 0;
+		unsigned m_BoundsCheckCount = 0;
+
+		bool m_OverflowChecks = false;
+
+		// The layout index of the objects of each pointer type, see
+		// Bytecode::addLayout.
+		std::map<const Symbol*, unsigned> m_Layouts;
+
+		Vectorizer m_Vectorizer;
+		bool m_Vectorize = true;
+		unsigned m_VectorizedLoops = 0;
+
+		ProcedureCode& currentProc() { return m_Code.getProcedures()[m_CurrentProc]; }
+
+		size_t emit(OpCode op, int32_t a = 0, int32_t b = 0, size_t pos = 0);
+		OpCode arithmetic(OpCode op, OpCode checked, Token operation) const
+		{
+			return checksOverflow(operation, m_OverflowChecks) ? checked : op;
+		}
+		void emitBranch(AST::Node const& node, bool jumpIf, std::vector<size_t>& jumps, size_t pos);
+		void emitRelation(OpCode op, OpCode jumpIfTrue, OpCode jumpIfFalse, Branch* branch, size_t pos);
+		void emitInline(AST::ProcCallNode const& node, AST::ProcDeclNode const& decl);
+		void emitConversion(std::shared_ptr<const Symbol> const& type);
+		void emitBuiltin(AST::ProcCallNode const& node);
+		void emitLoad(VariableSymbol const& sym, size_t pos, unsigned offset = 0);
+		void emitStore(VariableSymbol const& sym, size_t pos, unsigned offset = 0);
+		void emitIndex(AST::IndexNode const& node);
+		void emitElement(VariableSymbol const& sym, bool store, size_t pos, unsigned offset = 0);
+		void emitAccess(VariableSymbol const& sym, AST::IndexNode const* element, unsigned offset,
+						bool store, size_t pos);
+		void emitDesignator(VariableSymbol const& sym, AST::IndexNode const* element, unsigned offset, size_t pos);
+		void emitCopy(AST::AssignmentNode const& node);
+		void emitReference(VariableSymbol const& sym, size_t pos);
+		void emitAddress(VariableSymbol const& sym, AST::IndexNode const* element, unsigned offset, size_t pos);
+		void emitPointer(AST::FieldNode const& node);
+		unsigned layoutOf(std::shared_ptr<const Symbol> const& pointer);
+		void emitForBody(AST::ForNode const& node, int32_t limit);
+		bool emitVector(AST::ForNode const& node, int32_t limit, size_t& vector);
+		VectorOperand vectorOperand(VariableSymbol const& sym) const;
+		int32_t localSlot(VariableSymbol const& sym) const;
+		void patch(size_t jump, size_t target) { m_Code.getCode()[jump].a = target; }
+		void patchAll(std::vector<size_t> const& jumps, size_t target);
+		void defineSlot(VariableSymbol const& sym);
+
+		static Value typedZero(std::shared_ptr<const Symbol> const& type);
+		static Value numberValue(AST::NumberNode const& node);
+	};
+}
+
+#endif
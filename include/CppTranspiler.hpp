@@ -0,0 +1,118 @@
+#ifndef PASCAL_CPP_TRANSPILER_HPP
+#define PASCAL_CPP_TRANSPILER_HPP
+
+#include <Visitor.hpp>
+#include <Symbols.hpp>
+#include <Value.hpp>
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Pascal
+{
+	// Emits a self-contained C++ translation unit for a checked AST (see
+	// SemanticAnalyzer). Global variables become namespace scope variables,
+	// procedures become functions. A procedure with nested procedures keeps
+	// its variables in a frame struct and passes its address down to them,
+	// the others use plain locals. The program prints its variables on
+	// exit the way the interpreter does. Calls of functions are hoisted
+	// into temporaries ahead of the statement, after copies of the
+	// operands evaluated before them, so the side effects come in the
+	// interpreter's order.
+	class CppTranspiler : public AST::Visitor
+	{
+	public:
+		void visitProgramNode(AST::ProgramNode const& node);
+		void visitVarDeclNode(AST::VarDeclNode const& node);
+		void visitBlockNode(AST::BlockNode const& node);
+		void visitTypeNode(AST::TypeNode const& node);
+		void visitStatementNode(AST::StatementNode const& node);
+		void visitCompoundNode(AST::CompoundNode const& node);
+		void visitAssignmentNode(AST::AssignmentNode const& node);
+		void visitVariableNode(AST::VariableNode const& node);
+		void visitNullStatementNode(AST::NullStatementNode const& node);
+		void visitNumberNode(AST::NumberNode const& node);
+		void visitBinOpNode(AST::BinOpNode const& node);
+		void visitUnaryOpNode(AST::UnaryOpNode const& node);
+		void visitProcDeclNode(AST::ProcDeclNode const& node);
+		void visitParamNode(const AST::ParamNode &node);
+		void visitProcCallNode(const AST::ProcCallNode& node);
+		void visitWhileNode(AST::WhileNode const& node);
+		void visitRepeatNode(AST::RepeatNode const& node);
+		void visitForNode(AST::ForNode const& node);
+		void visitIfNode(AST::IfNode const& node);
+		void visitBooleanNode(AST::BooleanNode const& node);
+		void visitCaseNode(AST::CaseNode const& node);
+		void visitIndexNode(AST::IndexNode const& node);
+		void visitStringNode(AST::StringNode const& node);
+		void visitSetNode(AST::SetNode const& node);
+		void visitTypeDeclNode(AST::TypeDeclNode const& node);
+		void visitFieldNode(AST::FieldNode const& node);
+		void visitNilNode(AST::NilNode const& node);
+
+		std::string toString() const;
+
+		// See Compiler::setOverflowChecks.
+		void setOverflowChecks(bool enabled) { m_OverflowChecks = enabled; }
+
+	private:
+		struct Scope
+		{
+			std::string frame;
+			// The variables are in 'frame', nested procedures get its address.
+			bool framed;
+		};
+
+		// scopes[level - 1]
+		std::vector<Scope> m_Scopes;
+		std::map<const ProcedureSymbol*, std::string> m_ProcNames;
+		std::map<const RecordTypeSymbol*, std::string> m_RecordNames;
+		unsigned m_ProcCount = 0;
+		unsigned m_LoopCount = 0;
+		unsigned m_TempCount = 0;
+		bool m_OverflowChecks = false;
+
+		std::stringstream m_Declarations;
+		std::stringstream m_Globals;
+		std::stringstream m_Structs;
+		std::stringstream m_Functions;
+		std::stringstream m_Main;
+
+		// Body of the function being emitted and where its variables go.
+		std::stringstream* m_Body = nullptr;
+		std::stringstream* m_DeclOut = nullptr;
+		std::string m_DeclPrefix;
+		unsigned m_Indent = 1;
+
+		std::vector<std::string> m_GlobalNames;
+
+		// The last visited expression.
+		std::string m_Expr;
+		ValueType m_ExprType = ValueType::NONE;
+
+		unsigned currentLevel() const { return m_Scopes.size(); }
+		std::string indent() const { return std::string(m_Indent, '\t'); }
+
+		std::string variableRef(VariableSymbol const& sym) const;
+		// Like hoist(), the condition is left in m_Expr.
+		std::string condition(AST::Node const& node, size_t where);
+		// Visits an expression, returning the statements of the calls it
+		// hoisted instead of emitting them.
+		std::string hoist(AST::Node const& node);
+		std::string temporary(std::string const& expr, bool reference = false);
+		void emitBuiltin(AST::ProcCallNode const& node);
+		void emitTransfer(AST::ProcCallNode const& node);
+		std::string linkTo(unsigned level) const;
+		std::string declType(std::shared_ptr<const Symbol> const& type);
+		std::string recordStruct(RecordTypeSymbol const& record);
+		std::string paramDecl(VariableSymbol const& param, bool pointer);
+
+		static ValueType typeOf(std::shared_ptr<const Symbol> const& type);
+		static std::string cppType(ValueType type);
+	};
+}
+
+#endif
@@ -32,6 +32,18 @@ namespace Pascal
 		void visitProcDeclNode(const AST::ProcDeclNode &node);
 		void visitParamNode(const AST::ParamNode &node);
 		void visitProcCallNode(const AST::ProcCallNode& node);
+		void visitWhileNode(AST::WhileNode const& node);
+		void visitRepeatNode(AST::RepeatNode const& node);
+		void visitForNode(AST::ForNode const& node);
+		void visitIfNode(AST::IfNode const& node);
+		void visitBooleanNode(AST::BooleanNode const& node);
+		void visitCaseNode(AST::CaseNode const& node);
+		void visitIndexNode(AST::IndexNode const& node);
+		void visitStringNode(AST::StringNode const& node);
+		void visitSetNode(AST::SetNode const& node);
+		void visitTypeDeclNode(AST::TypeDeclNode const& node);
+		void visitFieldNode(AST::FieldNode const& node);
+		void visitNilNode(AST::NilNode const& node);
 
 	private:
 		long internalCounter;
@@ -0,0 +1,108 @@
+#ifndef PASCAL_INLINER_HPP
+#define PASCAL_INLINER_HPP
+
+#include <Visitor.hpp>
+#include <Symbols.hpp>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Pascal
+{
+	// Decides which procedure calls the Compiler expands in place. Builds
+	// the call graph of a checked AST (see SemanticAnalyzer) from its
+	// ProcCallNodes. A procedure is inlinable when it has no nested
+	// procedures, arrays nor records, can't reach itself in the graph and
+	// its body has at most 'maxSize' nodes once the calls in it are
+	// inlined. A caller grows by at most 'maxGrowth' nodes.
+	class Inliner : public AST::Visitor
+	{
+	public:
+		Inliner(unsigned maxSize, unsigned maxGrowth)
+			: m_MaxSize(maxSize), m_MaxGrowth(maxGrowth) {}
+
+		void visitProgramNode(AST::ProgramNode const& node);
+		void visitVarDeclNode(AST::VarDeclNode const& node);
+		void visitBlockNode(AST::BlockNode const& node);
+		void visitTypeNode(AST::TypeNode const& node);
+		void visitStatementNode(AST::StatementNode const& node);
+		void visitCompoundNode(AST::CompoundNode const& node);
+		void visitAssignmentNode(AST::AssignmentNode const& node);
+		void visitVariableNode(AST::VariableNode const& node);
+		void visitNullStatementNode(AST::NullStatementNode const& node);
+		void visitNumberNode(AST::NumberNode const& node);
+		void visitBinOpNode(AST::BinOpNode const& node);
+		void visitUnaryOpNode(AST::UnaryOpNode const& node);
+		void visitProcDeclNode(AST::ProcDeclNode const& node);
+		void visitParamNode(const AST::ParamNode &node);
+		void visitProcCallNode(const AST::ProcCallNode& node);
+		void visitWhileNode(AST::WhileNode const& node);
+		void visitRepeatNode(AST::RepeatNode const& node);
+		void visitForNode(AST::ForNode const& node);
+		void visitIfNode(AST::IfNode const& node);
+		void visitBooleanNode(AST::BooleanNode const& node);
+		void visitCaseNode(AST::CaseNode const& node);
+		void visitIndexNode(AST::IndexNode const& node);
+		void visitStringNode(AST::StringNode const& node);
+		void visitSetNode(AST::SetNode const& node);
+		void visitTypeDeclNode(AST::TypeDeclNode const& node);
+		void visitFieldNode(AST::FieldNode const& node);
+		void visitNilNode(AST::NilNode const& node);
+
+		// Declaration of the procedure if its calls are to be inlined.
+		AST::ProcDeclNode const* getInlinable(ProcedureSymbol const& sym) const;
+		// Nodes an inlined call adds to the caller.
+		unsigned getExpandedSize(ProcedureSymbol const& sym) const;
+		// Whether the local may be read before the procedure assigns it,
+		// so inlined code has to reset it to zero first.
+		bool needsReset(ProcedureSymbol const& sym, VariableSymbol const& var) const;
+		unsigned getMaxGrowth() const { return m_MaxGrowth; }
+
+		void addInlined(ProcedureSymbol const& callee, std::string const& caller, size_t pos);
+		unsigned getInlinedCount() const { return m_Inlined.size(); }
+		// One line per inlined call site.
+		std::string getReport() const;
+
+	private:
+		struct Procedure
+		{
+			AST::ProcDeclNode const* decl = nullptr;
+			// One entry per call site.
+			std::vector<const ProcedureSymbol*> calls;
+			// Variables by their first use: true for an assignment.
+			std::map<const VariableSymbol*, bool> assignedFirst;
+			unsigned size = 0;
+			unsigned expandedSize = 0;
+			bool visited = false;
+			bool inlinable = false;
+		};
+
+		struct Site
+		{
+			size_t pos;
+			std::string callee;
+			std::string caller;
+		};
+
+		unsigned m_MaxSize;
+		unsigned m_MaxGrowth;
+
+		// The main program is the nullptr procedure.
+		std::map<const ProcedureSymbol*, Procedure> m_Procedures;
+		std::vector<const ProcedureSymbol*> m_Enclosing;
+		// Depth of the loop bodies, if and case branches being visited, which
+		// may not run at all.
+		unsigned m_Conditional = 0;
+
+		std::vector<Site> m_Inlined;
+
+		Procedure& current() { return m_Procedures[m_Enclosing.back()]; }
+		void decide(const ProcedureSymbol* sym);
+		bool reaches(const ProcedureSymbol* from, const ProcedureSymbol* to,
+					 std::set<const ProcedureSymbol*>& visited) const;
+	};
+}
+
+#endif
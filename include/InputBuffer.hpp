@@ -0,0 +1,68 @@
+#ifndef PASCAL_INPUT_BUFFER_HPP
+#define PASCAL_INPUT_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <sys/stat.h>
+
+namespace Pascal
+{
+	// What read and readln take their values from. A regular file is
+	// mapped whole, anything else is read a large chunk at a time. Numbers
+	// are parsed in place without locales or streams, so a value is a run
+	// of characters up to the next blank, a tab or a line break.
+	class InputBuffer
+	{
+	public:
+		static constexpr size_t SIZE = 1 << 18;
+
+		explicit InputBuffer(int fd = 0);
+		~InputBuffer();
+
+		InputBuffer(InputBuffer const&) = delete;
+		InputBuffer& operator=(InputBuffer const&) = delete;
+
+		// Each skips the blanks and line breaks before the value and is
+		// false at the end of the input or when the value isn't one of its
+		// kind, integers that don't fit a long included.
+		bool readInteger(long& value);
+		bool readReal(double& value);
+		// The sign and decimal digits of an integer of any size, left in
+		// the buffer until the next read.
+		bool readDigits(const char*& chars, size_t& length);
+
+		// The rest of the current line without its line break, false only
+		// at the end of the input.
+		bool readLine(const char*& chars, size_t& length);
+		// Past the next line break.
+		void skipLine();
+
+		bool atEnd();
+
+		// Copies what is left of 'file' out of the mapping if it is mapped,
+		// before a rewrite truncates it under the mapping.
+		void unmap(struct stat const& file);
+
+	private:
+		bool skipBlanks();
+		size_t token();
+		bool more();
+		bool map();
+
+		int m_Fd;
+		// What is left of the input read so far.
+		const char* m_Pos = nullptr;
+		const char* m_End = nullptr;
+		// Nothing more to read after m_End.
+		bool m_Exhausted = false;
+		bool m_Started = false;
+
+		std::vector<char> m_Buffer;
+		void* m_Mapped = nullptr;
+		size_t m_MappedSize = 0;
+		dev_t m_Device = 0;
+		ino_t m_Inode = 0;
+	};
+}
+
+#endif
@@ -1,34 +1,164 @@
 #ifndef PASCAL_INTERPRETER_HPP
 #define PASCAL_INTERPRETER_HPP
 
-#include <Visitor.hpp>
+#include <BigHeap.hpp>
+#include <Bytecode.hpp>
 #include <CallStack.hpp>
+#include <InputBuffer.hpp>
+#include <Jit.hpp>
+#include <ObjectHeap.hpp>
+#include <OutputBuffer.hpp>
+#include <SetHeap.hpp>
+#include <StringHeap.hpp>
+#include <TextFile.hpp>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+// The execution loop dispatches either through a portable 'switch' or,
+// with GCC/Clang, through labels-as-values (direct threading). Build with
+// PASCAL_SWITCH_DISPATCH defined (make DISPATCH=switch) to force the former.
+#if defined(__GNUC__) && !defined(PASCAL_SWITCH_DISPATCH)
+#define PASCAL_THREADED_DISPATCH
+#endif
 
 namespace Pascal
 {
-	class Interpreter : public AST::Visitor
+	class Interpreter
 	{
 	public:
-		void visitProgramNode(AST::ProgramNode const& node);
-		void visitVarDeclNode(AST::VarDeclNode const& node);
-		void visitBlockNode(AST::BlockNode const& node);
-		void visitTypeNode(AST::TypeNode const& node);
-		void visitStatementNode(AST::StatementNode const& node);
-		void visitCompoundNode(AST::CompoundNode const& node);
-		void visitAssignmentNode(AST::AssignmentNode const& node);
-		void visitVariableNode(AST::VariableNode const& node);
-		void visitNullStatementNode(AST::NullStatementNode const& node);
-		void visitNumberNode(AST::NumberNode const& node);
-		void visitBinOpNode(AST::BinOpNode const& node);
-		void visitUnaryOpNode(AST::UnaryOpNode const& node);
-		void visitProcDeclNode(const AST::ProcDeclNode &node);
-		void visitParamNode(const AST::ParamNode &node);
-		void visitProcCallNode(const AST::ProcCallNode& node);
+		// 'stackSize' is the number of value slots shared by all frames.
+		Interpreter(Bytecode& code, size_t stackSize = 1 << 20);
+
+		void run();
+
+		// Counts executed opcode pairs, for choosing superinstructions.
+		void setProfiling(bool enabled) { m_Profiling = enabled; }
+		std::string getPairProfile(unsigned top) const;
+
+		// Compiles procedures called 'threshold' times to native code.
+		void enableJit(unsigned threshold);
+		Jit const* getJit() const { return m_Jit.get(); }
+
+		// Leaves writing the output to a thread of its own, so the program
+		// goes on while what it printed earlier is written.
+		void enableAsyncOutput() { m_Output.startWriter(); }
+
+		// Frees the objects still allocated when the program ends at once,
+		// leaving the interpreter's heap as it was before the run.
+		void setHeapReset(bool enabled) { m_HeapReset = enabled; }
+		ObjectHeap const& getHeap() const { return m_Objects; }
+		// Objects left to the reset at the end of the last run.
+		unsigned long getReclaimedCount() const { return m_Reclaimed; }
+
+		unsigned long getExecutedCount() const { return m_Executed; }
+		static const char* getDispatchName();
 
 	private:
+		Bytecode& m_Code;
 		CallStack m_CallStack;
-		ARObject m_Accum;
+
+		std::unique_ptr<Value[]> m_Stack;
+		size_t m_StackSize;
+
+		// display[level] - slots of the innermost active frame of that nesting level.
+		std::vector<Value*> m_Display;
+
+		unsigned long m_Executed = 0;
+		bool m_Profiling = false;
+		std::vector<unsigned long> m_PairCounts;
+
+		std::unique_ptr<Jit> m_Jit;
+
+		// Strings built while running, freed with the interpreter.
+		StringHeap m_Strings;
+		// Likewise sets and bignums.
+		SetHeap m_Sets;
+		BigHeap m_Bigs;
+		// The objects of new and dispose.
+		ObjectHeap m_Objects;
+		// What write and writeln print, the variables printed at exit too.
+		OutputBuffer m_Output;
+		// What read and readln take.
+		InputBuffer m_Input;
+		// The files of text variables, indexed by their handles. Those
+		// still open are closed at the end of the run.
+		std::deque<TextFile> m_Files;
+		bool m_HeapReset = false;
+		unsigned long m_Reclaimed = 0;
+
+		// Label table the instructions were threaded with.
+		const void* const* m_ThreadedWith = nullptr;
+
+		template <bool PROFILE>
+		void execute(const Instruction* start);
+
+		// add() that also concatenates strings, unites sets and adds
+		// bignums.
+		bool plus(Value const& a, Value const& b, Value& res)
+		{
+			if (PASCAL_LIKELY(add(a, b, res)))
+				return true;
+			if (a.isString() && b.isString())
+				res = m_Strings.concat(a, b);
+			else if (a.isSet() && b.isSet())
+				res = m_Sets.unite(a, b);
+			else
+				return m_Bigs.add(a, b, res);
+			return true;
+		}
+
+		// sub() that also takes the difference of sets.
+		bool minus(Value const& a, Value const& b, Value& res)
+		{
+			if (PASCAL_LIKELY(sub(a, b, res)))
+				return true;
+			if (!a.isSet() || !b.isSet())
+				return m_Bigs.sub(a, b, res);
+			res = m_Sets.subtract(a, b);
+			return true;
+		}
+
+		// mul() that also intersects sets.
+		bool times(Value const& a, Value const& b, Value& res)
+		{
+			if (PASCAL_LIKELY(mul(a, b, res)))
+				return true;
+			if (!a.isSet() || !b.isSet())
+				return m_Bigs.mul(a, b, res);
+			res = m_Sets.intersect(a, b);
+			return true;
+		}
+
+		bool divide(Value const& a, Value const& b, Value& res)
+		{
+			return PASCAL_LIKELY(div(a, b, res)) || m_Bigs.div(a, b, res);
+		}
+
+		bool modulo(Value const& a, Value const& b, Value& res)
+		{
+			return PASCAL_LIKELY(mod(a, b, res)) || m_Bigs.mod(a, b, res);
+		}
+
+		bool negate(Value const& a, Value& res)
+		{
+			return PASCAL_LIKELY(neg(a, res)) || m_Bigs.neg(a, res);
+		}
+
+		// The next value of the type of 'var' from 'input'.
+		bool read(InputBuffer& input, Value& var);
+
+		// Copies the inputs mapped from the file 'name' out of their
+		// mappings, it is about to be rewritten.
+		void unmapInputs(std::string const& name);
+
+		// nullptr unless 'file' was assigned.
+		TextFile* textFile(Value const& file)
+		{
+			return (file.as.integer >= 0) ? &m_Files[file.as.integer] : nullptr;
+		}
 	};
-}    
+}
 
 #endif
@@ -0,0 +1,99 @@
+#ifndef PASCAL_JIT_HPP
+#define PASCAL_JIT_HPP
+
+#include <Bytecode.hpp>
+#include <OutputBuffer.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define PASCAL_JIT_X86_64
+#endif
+
+namespace Pascal
+{
+	// Interpreter state handed to and taken back from native code.
+	struct JitContext
+	{
+		Value* base;
+		Value* sp;
+		Value* globals;
+		Value** display;
+		// Instruction the interpreter goes on with.
+		int64_t exitIp;
+		uint64_t bailouts;
+	};
+
+	// Baseline JIT tier. Once a procedure was called 'threshold' times its
+	// stack code is compiled to x86-64 by stitching a machine code template
+	// for every instruction. Native code works on the interpreter's frame
+	// and operand stack, so it can hand over to the interpreter before any
+	// instruction: it does so for calls and returns, and bails out when a
+	// template's guard fails (operand types without a fast path, division
+	// by zero). Procedures with unknown instructions are left interpreted,
+	// so are those whose native runs keep bailing out.
+	class Jit
+	{
+	public:
+		// Native write and writeln print to 'output'.
+		Jit(Bytecode& code, unsigned threshold, OutputBuffer& output);
+		~Jit();
+
+		Jit(Jit const&) = delete;
+		Jit& operator=(Jit const&) = delete;
+
+		static bool isSupported();
+
+		void countInvocation(unsigned proc)
+		{
+			if (m_Invocations[proc] < m_Threshold && ++m_Invocations[proc] == m_Threshold)
+				compile(proc);
+		}
+
+		// A loop iteration counts as much as a call, so a procedure that
+		// loops long enough is compiled while it runs.
+		void countBackEdge(unsigned proc) { countInvocation(proc); }
+
+		// Native address of every instruction control can enter native code
+		// at (procedure entries, call continuations and jump targets), or
+		// nullptr.
+		const void* const* getEntries() const { return m_Entries.data(); }
+
+		// 'proc' is the procedure the entry belongs to.
+		void run(JitContext& ctx, unsigned proc, const void* entry);
+
+		unsigned getCompiledCount() const { return m_Compiled; }
+		unsigned long getNativeRuns() const { return m_NativeRuns; }
+		unsigned long getBailouts() const { return m_Bailouts; }
+		unsigned getDroppedCount() const { return m_Dropped; }
+
+	private:
+		typedef void (*Trampoline)(JitContext* ctx, const void* entry);
+
+		Bytecode& m_Code;
+		OutputBuffer& m_Output;
+		unsigned m_Threshold;
+		std::vector<unsigned> m_Invocations;
+		// Native runs in a row that ended in a bailout, per procedure.
+		std::vector<unsigned> m_BailedRuns;
+		std::vector<const void*> m_Entries;
+
+		Trampoline m_Trampoline = nullptr;
+		const uint8_t* m_Exit = nullptr;
+		std::vector<std::pair<void*, size_t>> m_Chunks;
+
+		unsigned m_Compiled = 0;
+		unsigned long m_NativeRuns = 0;
+		unsigned long m_Bailouts = 0;
+		unsigned m_Dropped = 0;
+
+		bool compile(unsigned proc);
+		void drop(unsigned proc);
+		const uint8_t* install(std::vector<uint8_t> const& code);
+	};
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef PASCAL_LEXER_HPP
 #define PASCAL_LEXER_HPP
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
@@ -19,23 +20,51 @@ namespace Pascal
 		END,
 		VAR,
 		PROCEDURE,
+		FUNCTION,
+		WHILE,
+		DO,
+		REPEAT,
+		UNTIL,
+		FOR,
+		TO,
+		DOWNTO,
+		IF,
+		THEN,
+		ELSE,
+		CASE,
+		OF,
+		ARRAY,
+		SET,
+		IN,
+		TYPE,
+		RECORD,
+		PACKED,
+		CONST,
+		NIL,
 
 		IDENTIFIER,
 
 		// Punctuation
 		DOT,
 		COMMA,
+		RANGE,
 		COLON,
 		SEMICOLON,
 		ASSIGNMENT,
+		CARET,
 
-		// Logical operators
-		// TODO: Implement logical operators
+		// Relational operators
 		EQUAL,
+		NOT_EQUAL,
 		GREATER,
 		LESS,
 		GREATER_EQUAL,
 		LESS_EQUAL,
+
+		// Logical operators
+		AND,
+		OR,
+		NOT,
 		
 		// Ariphmetic operations
 		PLUS,
@@ -60,18 +89,35 @@ namespace Pascal
 	};
 
 	std::string tokenTypeToString(TokenType type);
+
+	// The {$Q+} or {$Q-} directive last seen before a token, DEFAULT
+	// if there was none.
+	enum class OverflowChecks : uint8_t
+	{
+		DEFAULT = 0,
+		ON,
+		OFF
+	};
 	
 	typedef struct
 	{
 		TokenType type;
 		std::string str;
 		size_t pos;
+		OverflowChecks checks;
 	} Token_t;
 
 	extern const Token_t nullToken;
 		
 	typedef Token_t const& Token;
 
+	// Whether the arithmetic of 'token' reports integer overflow,
+	// 'byDefault' where no directive says.
+	inline bool checksOverflow(Token token, bool byDefault)
+	{
+		return (token.checks == OverflowChecks::DEFAULT) ? byDefault : (token.checks == OverflowChecks::ON);
+	}
+
 	typedef std::shared_ptr<std::vector<Token_t>> TokenList;
 	
     TokenList Tokenize(std::shared_ptr<std::string> const& file);
@@ -0,0 +1,72 @@
+#ifndef PASCAL_OBJECT_HEAP_HPP
+#define PASCAL_OBJECT_HEAP_HPP
+
+#include <Value.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace Pascal
+{
+	// Owns the objects new allocates, a slot per field like a frame. Objects
+	// of up to MAX_POOLED slots come from a free list per size, refilled from
+	// chunks holding objects of that size alone: allocating and disposing
+	// are O(1), and the nodes of a structure built in a loop end up next to
+	// each other. Larger objects are allocated one by one, and kept on a
+	// free list of their size too once disposed of.
+	class ObjectHeap
+	{
+	public:
+		static const unsigned MAX_POOLED = 16;
+		// Slots of a chunk, about 64 KiB.
+		static const unsigned CHUNK_SLOTS = 4096;
+
+		ObjectHeap() = default;
+		ObjectHeap(ObjectHeap const&) = delete;
+		ObjectHeap& operator=(ObjectHeap const&) = delete;
+
+		// An object starting as 'layout', the typed zeros of its fields.
+		Value* allocate(std::vector<Value> const& layout);
+		// 'slots' is the size of the layout the object was allocated with.
+		// False if it was already disposed of.
+		bool free(Value* object, unsigned slots);
+		// Frees every object at once.
+		void reset();
+
+		unsigned long getAllocations() const { return m_Allocations; }
+		unsigned long getLiveObjects() const { return m_LiveObjects; }
+		size_t getLiveBytes() const { return m_LiveBytes; }
+		size_t getPeakBytes() const { return m_PeakBytes; }
+
+	private:
+		// A free object links to the next one through its first slot, whose
+		// type is NONE: no field of a live object has it.
+		struct Pool
+		{
+			Value* free = nullptr;
+			Value* next = nullptr;
+			Value* end = nullptr;
+		};
+
+		struct LargePool
+		{
+			unsigned slots;
+			Value* free;
+		};
+
+		Pool m_Pools[MAX_POOLED + 1];
+		std::vector<std::unique_ptr<Value[]>> m_Chunks;
+		std::vector<std::unique_ptr<Value[]>> m_Large;
+		// A handful of sizes at most, one per large record type.
+		std::vector<LargePool> m_LargePools;
+
+		LargePool& largePool(unsigned slots);
+
+		unsigned long m_Allocations = 0;
+		unsigned long m_LiveObjects = 0;
+		size_t m_LiveBytes = 0;
+		size_t m_PeakBytes = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PASCAL_OUTPUT_BUFFER_HPP
+#define PASCAL_OUTPUT_BUFFER_HPP
+
+#include <Value.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace Pascal
+{
+	// What write and writeln print. It is collected in a large buffer that
+	// goes out with a single write() when full, on flush and when the
+	// buffer is destroyed. With a writer thread started, full buffers are
+	// handed to it instead and written while the program goes on.
+	class OutputBuffer
+	{
+	public:
+		static constexpr size_t SIZE = 1 << 16;
+
+		explicit OutputBuffer(int fd = 1);
+		~OutputBuffer();
+
+		OutputBuffer(OutputBuffer const&) = delete;
+		OutputBuffer& operator=(OutputBuffer const&) = delete;
+
+		void put(char c)
+		{
+			if (PASCAL_UNLIKELY(m_Used == SIZE))
+				spill();
+			m_Data[m_Used++] = c;
+		}
+
+		void put(const char* chars, size_t count);
+		void putInteger(long value);
+		// Six significant digits, like the variables printed at exit.
+		void putReal(double value);
+		// Numbers, booleans and strings the way write prints them, false
+		// for anything else.
+		bool putValue(Value const& value);
+
+		// Returns once everything put so far is written, by the writer
+		// thread too.
+		void flush();
+
+		// From now on full buffers are written by a thread of their own,
+		// unless there is a single CPU.
+		void startWriter();
+
+		// Called by native code.
+		static bool write(OutputBuffer* output, Value const* value);
+		static void writeLine(OutputBuffer* output);
+
+	private:
+		class Writer;
+
+		// Makes room, writing the buffer or handing it to the writer.
+		void spill();
+
+		int m_Fd;
+		std::unique_ptr<char[]> m_Owned;
+		// m_Owned, or the writer's buffer being filled.
+		char* m_Data;
+		size_t m_Used = 0;
+		std::unique_ptr<Writer> m_Writer;
+	};
+}
+
+#endif
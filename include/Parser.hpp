@@ -18,9 +18,16 @@ namespace Pascal
 		std::unique_ptr<AST::CompoundNode> parseCompound();
 		std::unique_ptr<AST::StatementNode> parseStatement();
 		std::unique_ptr<AST::AssignmentNode> parseAssignment();
-		std::unique_ptr<AST::ProcDeclNode> parseProcDecl();
+		std::unique_ptr<AST::WhileNode> parseWhile();
+		std::unique_ptr<AST::RepeatNode> parseRepeat();
+		std::unique_ptr<AST::ForNode> parseFor();
+		std::unique_ptr<AST::IfNode> parseIf();
+		std::unique_ptr<AST::CaseNode> parseCase();
+		AST::IntegerLiteral parseIntegerLiteral();
+		std::unique_ptr<AST::ProcDeclNode> parseProcDecl(bool function);
 		
 		std::unique_ptr<AST::Node> parseExpr();
+		std::unique_ptr<AST::Node> parseSum();
 		std::unique_ptr<AST::Node> parseMultDiv();
 		std::unique_ptr<AST::Node> parseUnary();
 	private:
@@ -37,8 +44,17 @@ namespace Pascal
 		inline Token currentToken();
 		inline Token previousToken();
 		
+		inline std::unique_ptr<AST::TypeDeclNode> parseTypeDecl();
 		inline void parseVarDecls(std::vector<std::unique_ptr<AST::VarDeclNode>>& res);
 		inline void parseParam(std::vector<std::unique_ptr<AST::ParamNode>>& res);
+		inline AST::TypeNode parseType();
+		inline std::unique_ptr<AST::IndexNode> parseIndex(Token id);
+		inline std::vector<Token_t> parseFieldNames();
+		inline std::vector<Token_t> parseDereferenceFields();
+		inline std::shared_ptr<const std::vector<AST::FieldDecl>> parseFieldDecls();
+		inline std::vector<std::unique_ptr<AST::Node>> parseArguments();
+		inline std::unique_ptr<AST::SetNode> parseSet();
+		inline std::unique_ptr<AST::Node> parseSetBound(Token_t& literal);
 	};
 }
 
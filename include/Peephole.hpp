@@ -0,0 +1,42 @@
+#ifndef PASCAL_PEEPHOLE_HPP
+#define PASCAL_PEEPHOLE_HPP
+
+#include <Bytecode.hpp>
+
+#include <initializer_list>
+#include <vector>
+
+namespace Pascal
+{
+	// Rewrites common instruction sequences into superinstructions.
+	// The patterns come from the opcode pair profile of bench/ and tests/
+	// (see --profile-pairs): a variable or constant operand feeding an
+	// arithmetic operation, two loads in a row and 'x := x + k'.
+	class PeepholeOptimizer
+	{
+	public:
+		PeepholeOptimizer(Bytecode& code)
+			: m_Code(code) {}
+
+		void run();
+
+		unsigned getFusedCount() const { return m_Fused; }
+
+	private:
+		Bytecode& m_Code;
+		unsigned m_Fused = 0;
+
+		// Instructions control can enter other than by falling through.
+		std::vector<bool> m_Targets;
+
+		bool matches(size_t pos, std::initializer_list<OpCode> ops) const;
+		bool fuseIncrement(size_t pos, OpCode load, OpCode store, OpCode inc,
+						   Instruction& res);
+
+		static OpCode withConst(OpCode op);
+		static OpCode withLocal(OpCode op);
+		static OpCode withGlobal(OpCode op);
+	};
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef PASCAL_REGISTER_TRANSLATOR_HPP
+#define PASCAL_REGISTER_TRANSLATOR_HPP
+
+#include <Bytecode.hpp>
+
+#include <set>
+#include <vector>
+
+namespace Pascal
+{
+	// Rewrites the stack code of every procedure into register code
+	// ('R_ADD r3, r1, r2'). Registers are the frame slots: the variables
+	// keep the slots given by the SemanticAnalyzer and the operand stack
+	// becomes temporaries allocated right after them. Procedures using an
+	// instruction the translator doesn't know stay in the stack form, both
+	// forms call each other.
+	class RegisterTranslator
+	{
+	public:
+		RegisterTranslator(Bytecode& code)
+			: m_Code(code) {}
+
+		void run();
+
+		unsigned getTranslatedCount() const { return m_Translated; }
+
+	private:
+		// A value of the simulated operand stack.
+		struct Operand
+		{
+			bool constant;	// 'index' is a constant, not a register
+			bool temporary;	// register owned by the allocator
+			int32_t index;
+		};
+
+		Bytecode& m_Code;
+		unsigned m_Translated = 0;
+
+		std::vector<Instruction> m_Result;
+		std::vector<size_t> m_ResultPositions;
+
+		std::vector<Operand> m_Stack;
+
+		// Linear scan over the temporaries' live intervals. A temporary
+		// lives from its definition to its only use, so the intervals are
+		// expired as the values are popped and a new one takes the lowest
+		// free register.
+		std::set<int32_t> m_FreeTemps;
+		int32_t m_FirstTemp = 0;
+		int32_t m_NextTemp = 0;
+		int32_t m_MaxRegister = 0;
+
+		// Result index of the last instruction that defined a temporary.
+		size_t m_LastDefinition = 0;
+
+		bool translate(ProcedureCode& proc, size_t begin, size_t end);
+
+		int32_t allocateTemp();
+		void release(Operand const& operand);
+		void useRegister(int32_t reg);
+
+		Operand pop();
+		void pushTemp(int32_t reg);
+		// Loads constant operands into a temporary.
+		Operand toRegister(Operand const& operand, size_t pos);
+
+		void emit(OpCode op, int32_t a, int32_t b, int32_t c, size_t pos);
+		void emitDefinition(OpCode op, int32_t a, int32_t b, int32_t c, size_t pos);
+		void emitArithmetic(OpCode op, size_t pos);
+		// Relations have no constant forms, their operands are registers.
+		void emitComparison(OpCode op, size_t pos);
+		bool emitCompareJump(OpCode op, int32_t target, size_t pos);
+		// Slot of the element at a constant index, if it is in the frame.
+		bool constantSlot(Operand const& index, int32_t offset, int32_t frameSize, int32_t& slot) const;
+		void emitStoreLocal(ProcedureCode const& proc, int32_t slot, size_t pos);
+		bool emitCall(OpCode op, ProcedureCode const& callee, int32_t index, size_t pos);
+	};
+}
+
+#endif
@@ -22,7 +22,50 @@ namespace Pascal
 		WRONG_ARGUMENTS_COUNT,
 	    PROCEDURE_AS_FUNCTION,
 		CANT_PARSE_LITERAL,
-		DIVISION_BY_ZERO
+		LITERAL_OUT_OF_RANGE,
+		DIVISION_BY_ZERO,
+		INTEGER_OVERFLOW,
+		ILLEGAL_OPERANDS,
+		STACK_OVERFLOW,
+		ILLEGAL_CONTROL_VARIABLE,
+		CONTROL_VARIABLE_ASSIGNMENT,
+		ILLEGAL_CASE_LABEL,
+		DUPLICATE_CASE_LABEL,
+		ILLEGAL_ARRAY_BOUNDS,
+		INDEXING_NON_ARRAY,
+		ARRAY_WITHOUT_INDEX,
+		INDEX_OUT_OF_RANGE,
+		UNTERMINATED_STRING,
+		STRING_ELEMENT_ASSIGNMENT,
+		ILLEGAL_SET_BOUNDS,
+		ILLEGAL_SET_ELEMENT,
+		ILLEGAL_TYPE_DECLARATION,
+		ILLEGAL_FIELD_TYPE,
+		ILLEGAL_PARAMETER_TYPE,
+		FIELD_OF_NON_RECORD,
+		UNKNOWN_FIELD,
+		RECORD_WITHOUT_FIELD,
+		INCOMPATIBLE_RECORDS,
+		ILLEGAL_ELEMENT_TYPE,
+		NOT_A_VARIABLE_ARGUMENT,
+		INCOMPATIBLE_ARGUMENT,
+		INCOMPATIBLE_ASSIGNMENT,
+		INCOMPATIBLE_VALUE_ARGUMENT,
+		CONST_PARAMETER_ASSIGNMENT,
+		ILLEGAL_RESULT_TYPE,
+		ILLEGAL_POINTER_TYPE,
+		DEREFERENCING_NON_POINTER,
+		NOT_A_POINTER_ARGUMENT,
+		NIL_DEREFERENCE,
+		DISPOSED_TWICE,
+		NOT_A_READABLE_ARGUMENT,
+		READ_PAST_END,
+		INVALID_INPUT,
+		NOT_A_TEXT_ARGUMENT,
+		UNASSIGNED_FILE,
+		CANT_OPEN_FILE,
+		FILE_NOT_OPEN_FOR_READING,
+		FILE_NOT_OPEN_FOR_WRITING
 	};
 
 	enum class WarningType
@@ -61,6 +104,9 @@ namespace Pascal
 
 		static unsigned GetErrorsCount();
 		static unsigned GetWarningsCount();
+
+		// "file:line:column" of the position in the current file.
+		static std::string PosToString(size_t where);
 		
 	private:
 		static std::vector<ReportFile> includeStack;
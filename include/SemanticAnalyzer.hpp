@@ -4,13 +4,21 @@
 #include <Visitor.hpp>
 #include <AST.hpp>
 #include <Symbols.hpp>
+#include <Value.hpp>
+
+#include <map>
+#include <vector>
 
 namespace Pascal
 {
 	class SemanticAnalyzer : public AST::Visitor
 	{
 	public:
-		SemanticAnalyzer();
+		SemanticAnalyzer(bool dumpScopes = true);
+		// Pointer types and the records pointing back to them own each
+		// other, the pointer types lose their targets here: the checked
+		// AST must not outlive the analyzer.
+		~SemanticAnalyzer();
 
 		void visitProgramNode(AST::ProgramNode const& node);
 		void visitVarDeclNode(AST::VarDeclNode const& node);
@@ -27,12 +35,114 @@ namespace Pascal
 		void visitProcDeclNode(AST::ProcDeclNode const& node);
 		void visitParamNode(const AST::ParamNode &node);
 		void visitProcCallNode(const AST::ProcCallNode& node);
+		void visitWhileNode(AST::WhileNode const& node);
+		void visitRepeatNode(AST::RepeatNode const& node);
+		void visitForNode(AST::ForNode const& node);
+		void visitIfNode(AST::IfNode const& node);
+		void visitBooleanNode(AST::BooleanNode const& node);
+		void visitCaseNode(AST::CaseNode const& node);
+		void visitIndexNode(AST::IndexNode const& node);
+		void visitStringNode(AST::StringNode const& node);
+		void visitSetNode(AST::SetNode const& node);
+		void visitTypeDeclNode(AST::TypeDeclNode const& node);
+		void visitFieldNode(AST::FieldNode const& node);
+		void visitNilNode(AST::NilNode const& node);
 		
 	    std::shared_ptr<SymbolTable> getSymbolTable() const
 		{ return m_Symtab; }
 	private:
 		std::shared_ptr<SymbolTable> m_Symtab;
 		unsigned m_CurrentScopeLevel;
+		bool m_DumpScopes;
+
+		// A for loop being visited. The range its control variable has to
+		// stay in for the element accesses that follow it to be in bounds.
+		struct Loop
+		{
+			AST::ForNode const* node;
+			const Symbol* var;
+			// The range of the control variable if both limits are constant.
+			bool constant;
+			long first;
+			long last;
+			bool indexed;
+			long low;
+			long high;
+		};
+		std::vector<Loop> m_Loops;
+
+		// The procedures whose bodies are being visited, innermost last.
+		std::vector<const ProcedureSymbol*> m_Procedures;
+
+		// The last visited expression is 'var' + 'offset', the constant
+		// 'offset' without a variable, if 'known'.
+		struct Affine
+		{
+			bool known;
+			const VariableSymbol* var;
+			long offset;
+		};
+		Affine m_Affine = { false, nullptr, 0 };
+
+		// The variable of the IndexNode being visited, the only one that may
+		// name a whole array.
+		AST::VariableNode const* m_IndexedVar = nullptr;
+
+		// The only node that may name a whole record: the record a field is
+		// selected from or either side of an assignment. Its type is kept
+		// if it does.
+		AST::Node const* m_WholeNode = nullptr;
+		std::shared_ptr<const Symbol> m_WholeRecord;
+
+		// The argument of a var or const parameter being visited: it may
+		// name a whole array and needn't have been assigned before.
+		AST::Node const* m_ReferenceArgument = nullptr;
+
+		// The expression being visited is assigned or passed to a bigint,
+		// integer literals may be beyond a long.
+		bool m_BigContext = false;
+
+		// The type of the expression visited last, NONE for whole arrays
+		// and records and for expressions in error.
+		ValueType m_ExprType = ValueType::NONE;
+
+		// The variable, element or field visited last, its variable and
+		// its type. Assigning a field of an object assigns no variable.
+		struct Designator
+		{
+			AST::Node const* node;
+			std::shared_ptr<Symbol> var;
+			std::shared_ptr<const Symbol> type;
+			bool dereferenced;
+		};
+		Designator m_Designator = { nullptr, nullptr, nullptr, false };
+
+		// Record types by the fields the copies of their TypeNode share.
+		std::map<const std::vector<AST::FieldDecl>*, std::shared_ptr<RecordTypeSymbol>> m_Records;
+		// Pointer types whose target is looked up once the types or the
+		// variables of the block are declared, see resolvePointers, and
+		// every pointer type.
+		std::vector<std::shared_ptr<PointerTypeSymbol>> m_Pointers;
+		std::vector<std::shared_ptr<PointerTypeSymbol>> m_AllPointers;
+
+		std::shared_ptr<const Symbol> resolveType(AST::TypeNode const& type);
+		std::shared_ptr<RecordTypeSymbol> recordType(AST::TypeNode const& type, std::string const& name, size_t pos);
+		std::shared_ptr<ArrayTypeSymbol> arrayType(AST::TypeNode const& type, std::string const& name);
+		std::shared_ptr<PointerTypeSymbol> pointerType(AST::TypeNode const& type, std::string const& name);
+		void resolvePointers();
+		bool namesArray(AST::TypeNode const& type) const;
+		std::shared_ptr<const Symbol> designate(AST::Node const& node);
+		void referenceArgument(AST::Node const& arg, VariableSymbol const& param, size_t pos);
+		void pointerArgument(AST::ProcCallNode const& node, bool allocates);
+		void readArgument(AST::ProcCallNode const& node, unsigned i);
+		void writeArgument(AST::ProcCallNode const& node);
+		void textArgument(AST::ProcCallNode const& node, bool assigns);
+		bool designatesText(AST::Node const& arg) const;
+		bool assignsBigint(AST::AssignmentNode const& node) const;
+		void assignDesignated(size_t pos);
+		void wholeRecord(AST::Node const& node, std::shared_ptr<const Symbol> const& type, size_t pos);
+		Loop* findLoop(const Symbol* var);
+		static bool isString(const VariableSymbol* var);
 	};
 }
 
@@ -0,0 +1,37 @@
+#ifndef PASCAL_SET_HEAP_HPP
+#define PASCAL_SET_HEAP_HPP
+
+#include <Value.hpp>
+
+#include <deque>
+
+namespace Pascal
+{
+	// Owns the sets built while running. Like the StringHeap it frees
+	// nothing before itself, so set Values are copied as plain pointers.
+	// An operator whose result equals one of its operands returns that
+	// operand, adding to a set the elements it has costs no memory.
+	class SetHeap
+	{
+	public:
+		SetHeap() = default;
+		SetHeap(SetHeap const&) = delete;
+		SetHeap& operator=(SetHeap const&) = delete;
+		SetHeap(SetHeap&&) = default;
+		SetHeap& operator=(SetHeap&&) = default;
+
+		Value make(SetBits const& bits);
+		// a + b, a * b and a - b, both must be sets.
+		Value unite(Value const& a, Value const& b);
+		Value intersect(Value const& a, Value const& b);
+		Value subtract(Value const& a, Value const& b);
+
+	private:
+		Value result(SetBits& bits, Value const& a, Value const& b);
+
+		// A deque never moves its elements.
+		std::deque<SetBits> m_Sets;
+	};
+}
+
+#endif
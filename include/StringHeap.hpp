@@ -0,0 +1,48 @@
+#ifndef PASCAL_STRING_HEAP_HPP
+#define PASCAL_STRING_HEAP_HPP
+
+#include <Value.hpp>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Pascal
+{
+	// Owns the strings too long to be kept inside a Value. Nothing is freed
+	// before the heap itself, so Values are copied without reference counts.
+	// A string whose text ends its buffer is appended to in place, which
+	// leaves the shorter one untouched: appending in a loop grows the
+	// buffer geometrically instead of copying the text every time. Small
+	// buffers are cut from large chunks, so that making a string, like each
+	// line readln reads, costs no allocation of its own.
+	class StringHeap
+	{
+	public:
+		static constexpr size_t CHUNK = 1 << 16;
+
+		StringHeap() = default;
+		StringHeap(StringHeap const&) = delete;
+		StringHeap& operator=(StringHeap const&) = delete;
+		StringHeap(StringHeap&&) = default;
+		StringHeap& operator=(StringHeap&&) = default;
+
+		Value make(const char* chars, size_t length);
+		// Both must be strings.
+		Value concat(Value const& a, Value const& b);
+
+	private:
+		Value makeLong(StringBuffer* buffer, size_t length);
+		StringBuffer* allocate(size_t capacity);
+
+		// A deque never moves its elements.
+		std::deque<LongString> m_Strings;
+		std::deque<StringBuffer> m_Buffers;
+		std::vector<std::unique_ptr<char[]>> m_Chunks;
+		// Characters used of the last chunk.
+		size_t m_Used = 0;
+		std::vector<std::unique_ptr<char[]>> m_Large;
+	};
+}
+
+#endif
@@ -13,9 +13,14 @@ namespace Pascal
 	{
 		NONE = 0,
 		BUILTIN_TYPE,
+		ARRAY_TYPE,
+		SET_TYPE,
+		RECORD_TYPE,
+		POINTER_TYPE,
 		VARIABLE,
 		PROCEDURE,
-		FUNCTION
+		FUNCTION,
+		BUILTIN_ROUTINE
 	};
     
 	class Symbol
@@ -53,6 +58,180 @@ namespace Pascal
 		}
 	};
 
+	// record <fields> end. A field takes the slot at its offset from the
+	// record's first one, a record field as many as its record does.
+	// Offsets are fixed here, once.
+	class RecordTypeSymbol : public Symbol
+	{
+	public:
+		struct Field
+		{
+			std::string name;
+			std::shared_ptr<const Symbol> type;
+			unsigned offset;
+		};
+
+		// The slots in order, nested fields named <field>.<field>.
+		struct Leaf
+		{
+			std::string path;
+			std::shared_ptr<const Symbol> type;
+		};
+
+		RecordTypeSymbol(std::string const& name, bool packed,
+						 std::vector<std::pair<std::string, std::shared_ptr<const Symbol>>> const& fields,
+						 size_t whereDefined)
+			: Symbol(name, whereDefined), m_Packed(packed)
+		{
+			for (auto const& e : fields)
+			{
+				m_Fields.push_back({ e.first, e.second, static_cast<unsigned>(m_Leaves.size()) });
+				if (e.second == nullptr || e.second->getType() != SymbolType::RECORD_TYPE)
+				{
+					m_Leaves.push_back({ e.first, e.second });
+					continue;
+				}
+				for (auto const& leaf : reinterpret_cast<const RecordTypeSymbol*>(e.second.get())->getLeaves())
+					m_Leaves.push_back({ e.first + "." + leaf.path, leaf.type });
+			}
+		}
+
+		const SymbolType getType() const { return SymbolType::RECORD_TYPE; }
+
+		bool isPacked() const { return m_Packed; }
+		std::vector<Field> const& getFields() const { return m_Fields; }
+		std::vector<Leaf> const& getLeaves() const { return m_Leaves; }
+		unsigned getSize() const { return m_Leaves.size(); }
+
+		// Slots a value of the type takes: the size of a record, one otherwise.
+		static unsigned slotsOf(std::shared_ptr<const Symbol> const& type)
+		{
+			if (type == nullptr || type->getType() != SymbolType::RECORD_TYPE)
+				return 1;
+			return reinterpret_cast<const RecordTypeSymbol*>(type.get())->getSize();
+		}
+
+		// nullptr if there is no such field.
+		const Field* find(std::string const& name) const
+		{
+			for (auto const& e : m_Fields)
+			{
+				if (e.name == name)
+					return &e;
+			}
+			return nullptr;
+		}
+
+		std::string toString() const
+		{
+			std::stringstream ss;
+			ss << "<RecordTypeSymbol(name=\"" << getName() << "\", fields=" << m_Fields.size() << ")>";
+			return ss.str();
+		}
+
+	private:
+		bool m_Packed;
+		std::vector<Field> m_Fields;
+		std::vector<Leaf> m_Leaves;
+	};
+
+	// array[low..high] of <element>, its elements take consecutive slots,
+	// every field of a record element one. Named after a type declaration
+	// if it has one.
+	class ArrayTypeSymbol : public Symbol
+	{
+	public:
+		ArrayTypeSymbol(std::shared_ptr<const Symbol> element, long low, long high, size_t whereDefined,
+						std::string const& name = "")
+			: Symbol(!name.empty() ? name : "array[" + std::to_string(low) + ".." + std::to_string(high) +
+					 "] of " + ((element == nullptr) ? "?" : element->getName()), whereDefined),
+			  m_Element(element), m_Low(low), m_High(high) {}
+
+		const SymbolType getType() const { return SymbolType::ARRAY_TYPE; }
+
+		std::shared_ptr<const Symbol> const& getElement() const { return m_Element; }
+		long getLow() const { return m_Low; }
+		long getHigh() const { return m_High; }
+		unsigned getLength() const { return m_High - m_Low + 1; }
+		// Slots an element takes.
+		unsigned getStride() const { return RecordTypeSymbol::slotsOf(m_Element); }
+
+		std::string toString() const
+		{
+			std::stringstream ss;
+			ss << "<ArrayTypeSymbol(name=\"" << getName() << "\")>";
+			return ss.str();
+		}
+
+	private:
+		std::shared_ptr<const Symbol> m_Element;
+		long m_Low;
+		long m_High;
+	};
+
+	// set of low..high or set of char, every set takes 256 bits.
+	class SetTypeSymbol : public Symbol
+	{
+	public:
+		SetTypeSymbol(bool chars, long low, long high, size_t whereDefined)
+			: Symbol(chars ? std::string("set of char") :
+					 "set of " + std::to_string(low) + ".." + std::to_string(high), whereDefined),
+			  m_Chars(chars), m_Low(low), m_High(high) {}
+
+		const SymbolType getType() const { return SymbolType::SET_TYPE; }
+
+		bool isChars() const { return m_Chars; }
+		long getLow() const { return m_Low; }
+		long getHigh() const { return m_High; }
+
+		std::string toString() const
+		{
+			std::stringstream ss;
+			ss << "<SetTypeSymbol(name=\"" << getName() << "\")>";
+			return ss.str();
+		}
+
+	private:
+		bool m_Chars;
+		long m_Low;
+		long m_High;
+	};
+
+	// ^<type>, named after a type declaration if it has one. The type
+	// pointed to may be declared after the pointer type, it is set once
+	// the declarations of the block are known.
+	class PointerTypeSymbol : public Symbol
+	{
+	public:
+		PointerTypeSymbol(std::string const& target, size_t whereDefined, std::string const& name = "")
+			: Symbol(!name.empty() ? name : "^" + target, whereDefined), m_TargetName(target) {}
+
+		const SymbolType getType() const { return SymbolType::POINTER_TYPE; }
+
+		std::string const& getTargetName() const { return m_TargetName; }
+		// nullptr until it is set, and if it is undefined.
+		std::shared_ptr<const Symbol> const& getTarget() const { return m_Target; }
+		void setTarget(std::shared_ptr<const Symbol> target) { m_Target = std::move(target); }
+
+		std::string toString() const
+		{
+			std::stringstream ss;
+			ss << "<PointerTypeSymbol(name=\"" << getName() << "\", target=\"" << m_TargetName << "\")>";
+			return ss.str();
+		}
+
+	private:
+		std::string m_TargetName;
+		std::shared_ptr<const Symbol> m_Target;
+	};
+
+	enum class ParamMode
+	{
+		VALUE,
+		VAR,
+		CONST
+	};
+
 	class VariableSymbol : public Symbol
 	{
 	public:
@@ -86,28 +265,65 @@ namespace Pascal
 		const bool getUsed() const
 		{ return m_Used; }
 
+		// Whether a procedure nested in the declaring scope assigns it.
+		const bool getAssignedByNested() const
+		{ return m_AssignedByNested; }
+
 		std::shared_ptr<const Symbol> getParent() const
 		{ return m_Parent; }
+
+		// Where the variable lives at runtime: the nesting level of the
+		// scope that declared it and its index in that scope's frame.
+		unsigned getScopeLevel() const { return m_ScopeLevel; }
+		unsigned getSlot() const { return m_Slot; }
 		
 		void undirty() { m_Dirty = false; }
 		void beUsed()  { m_Used = true; }
+		void beAssignedByNested() { m_AssignedByNested = true; }
+		void setLocation(unsigned scopeLevel, unsigned slot)
+		{ m_ScopeLevel = scopeLevel; m_Slot = slot; }
+
+		ParamMode getMode() const { return m_Mode; }
+		void setMode(ParamMode mode) { m_Mode = mode; }
+
+		// Whether the slot holds a reference to the argument instead of its
+		// value: var parameters do, const ones of records and arrays too.
+		bool isReference() const
+		{
+			return m_Mode == ParamMode::VAR || (m_Mode == ParamMode::CONST && m_Parent != nullptr &&
+				(m_Parent->getType() == SymbolType::ARRAY_TYPE || m_Parent->getType() == SymbolType::RECORD_TYPE));
+		}
 		
 	private:
 		bool m_Dirty = true;
 		bool m_Used = false;
+		bool m_AssignedByNested = false;
 		std::shared_ptr<const Symbol> m_Parent;
+		unsigned m_ScopeLevel = 0;
+		unsigned m_Slot = 0;
+		ParamMode m_Mode = ParamMode::VALUE;
 	};
 
 	class ProcedureSymbol : public Symbol
 	{
 	public:
+		// The parameters are the symbols of the procedure's own scope. A
+		// function's result is a variable of that scope too, named after
+		// the function but not defined in it.
 		ProcedureSymbol(std::string const& name, size_t whereDefined,
-					    std::vector<VariableSymbol> const& params)
-			: Symbol(name, whereDefined), m_Params(params) {}
+					    std::vector<std::shared_ptr<const VariableSymbol>> const& params, unsigned scopeLevel,
+						std::shared_ptr<const VariableSymbol> result = nullptr)
+			: Symbol(name, whereDefined), m_Params(params), m_ScopeLevel(scopeLevel), m_Result(result) {}
 		
 		const SymbolType getType() const { return SymbolType::PROCEDURE; }
-		std::vector<VariableSymbol> const& getArgs() const
+		std::vector<std::shared_ptr<const VariableSymbol>> const& getArgs() const
 		{ return m_Params; }
+
+		bool isFunction() const { return m_Result != nullptr; }
+		std::shared_ptr<const VariableSymbol> const& getResult() const { return m_Result; }
+
+		// Nesting level of the procedure's own scope.
+		unsigned getScopeLevel() const { return m_ScopeLevel; }
 		
 		std::string toString() const
 		{
@@ -117,17 +333,67 @@ namespace Pascal
 			{
 				for (unsigned i = 0; i < m_Params.size(); i++)
 				{
-					ss << m_Params[i].toString();
+					ss << m_Params[i]->toString();
 					if (i != m_Params.size() - 1)
 						ss << ", ";
 				}
 			}
-			ss << "])>";
+			ss << "]";
+			if (m_Result != nullptr)
+				ss << ", result=" << m_Result->toString();
+			ss << ")>";
 			return ss.str();
 		}
 
 	private:
-		std::vector<VariableSymbol> m_Params;
+		std::vector<std::shared_ptr<const VariableSymbol>> m_Params;
+		unsigned m_ScopeLevel;
+		std::shared_ptr<const VariableSymbol> m_Result;
+	};
+	
+	enum class Builtin
+	{
+		LENGTH,
+		NEW,
+		DISPOSE,
+		WRITE,
+		WRITELN,
+		READ,
+		READLN,
+		ASSIGN,
+		RESET,
+		REWRITE,
+		CLOSE,
+		END_OF_FILE
+	};
+
+	// A routine of the language itself, the Compiler gives it an opcode.
+	class BuiltinRoutineSymbol : public Symbol
+	{
+	public:
+		// The args count of routines taking any number of arguments.
+		static constexpr unsigned ANY_ARGS = ~0u;
+
+		BuiltinRoutineSymbol(std::string const& name, Builtin routine, unsigned argsCount, bool function)
+			: Symbol(name, 0), m_Routine(routine), m_ArgsCount(argsCount), m_Function(function) {}
+
+		const SymbolType getType() const { return SymbolType::BUILTIN_ROUTINE; }
+
+		Builtin getRoutine() const { return m_Routine; }
+		unsigned getArgsCount() const { return m_ArgsCount; }
+		bool isFunction() const { return m_Function; }
+
+		std::string toString() const
+		{
+			std::stringstream ss;
+			ss << "<BuiltinRoutineSymbol(name=\"" << getName() << "\")>";
+			return ss.str();
+		}
+
+	private:
+		Builtin m_Routine;
+		unsigned m_ArgsCount;
+		bool m_Function;
 	};
 	
 	class SymbolTable
@@ -141,8 +407,18 @@ namespace Pascal
 	    std::shared_ptr<Symbol> change(std::string const& name);
 
 		bool isBelongThisScope(std::shared_ptr<Symbol> sym) const;
+
+		unsigned allocateSlot() { return m_SlotCount++; }
+		unsigned allocateSlots(unsigned count)
+		{
+			unsigned first = m_SlotCount;
+			m_SlotCount += count;
+			return first;
+		}
 		
 		std::string const& getName() const { return m_ScopeName; }
+		unsigned getScopeLevel() const { return m_ScopeLevel; }
+		unsigned getSlotCount() const { return m_SlotCount; }
 		std::shared_ptr<SymbolTable> getEnclosingScope() { return m_EnclosingScope; }
 		std::map<std::string, std::shared_ptr<Symbol>> const&
 		getSymbols() const { return m_Symbols; }
@@ -152,6 +428,7 @@ namespace Pascal
 	private:
 		std::string m_ScopeName;
 		unsigned m_ScopeLevel;
+		unsigned m_SlotCount = 0;
 		
 		std::map<std::string, std::shared_ptr<Symbol>> m_Symbols;
 		std::shared_ptr<SymbolTable> m_EnclosingScope;
@@ -0,0 +1,43 @@
+#ifndef PASCAL_TEXT_FILE_HPP
+#define PASCAL_TEXT_FILE_HPP
+
+#include <InputBuffer.hpp>
+#include <OutputBuffer.hpp>
+
+#include <memory>
+#include <string>
+
+namespace Pascal
+{
+	// A text variable's file: the name given by assign and, once reset or
+	// rewritten, the buffer it is read from or written to. Reopening or
+	// destroying it closes what was open, flushing what was written.
+	class TextFile
+	{
+	public:
+		TextFile() = default;
+		~TextFile();
+
+		TextFile(TextFile const&) = delete;
+		TextFile& operator=(TextFile const&) = delete;
+
+		void assign(std::string name);
+		// False if the file can't be opened.
+		bool reset();
+		bool rewrite();
+		void close();
+
+		std::string const& getName() const { return m_Name; }
+		// nullptr unless open for reading, or writing.
+		InputBuffer* getInput() const { return m_Input.get(); }
+		OutputBuffer* getOutput() const { return m_Output.get(); }
+
+	private:
+		std::string m_Name;
+		int m_Fd = -1;
+		std::unique_ptr<InputBuffer> m_Input;
+		std::unique_ptr<OutputBuffer> m_Output;
+	};
+}
+
+#endif
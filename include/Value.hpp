@@ -0,0 +1,419 @@
+#ifndef PASCAL_VALUE_HPP
+#define PASCAL_VALUE_HPP
+
+#include <string>
+#include <cstdint>
+#include <memory>
+
+#if defined(__GNUC__)
+#define PASCAL_LIKELY(x)   __builtin_expect(!!(x), 1)
+#define PASCAL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define PASCAL_LIKELY(x)   (x)
+#define PASCAL_UNLIKELY(x) (x)
+#endif
+
+namespace Pascal
+{
+	enum class ValueType : uint8_t
+	{
+		NONE = 0,
+		INTEGER,
+		REAL,
+		BOOLEAN,
+		STRING,
+		SET,
+		// The slot of a variable, held by var parameters.
+		REFERENCE,
+		// The first slot of an object from an ObjectHeap, or nil.
+		POINTER,
+		// The handle of a text file of the interpreter, -1 until assigned.
+		TEXT,
+		// Integers of bigint variables: inline while they fit a long, then
+		// BigNums from a BigHeap. These two come last, see assign().
+		BIGINT,
+		BIGNUM
+	};
+
+	std::string typeToString(ValueType type);
+
+	struct LongString;
+	struct SetBits;
+	struct BigNum;
+
+	// Runtime value: a one byte tag and an 8 byte payload, 16 bytes in total.
+	// Trivially copyable, so frames and temporaries never touch the heap.
+	struct Value
+	{
+		ValueType type;
+		union
+		{
+			long integer;
+			double real;
+			bool boolean;
+			// Strings of up to 7 characters are kept inline: the first byte
+			// holds (length << 1) | 1, which no aligned pointer has, and the
+			// characters follow. Longer ones point into a StringHeap.
+			char chars[8];
+			LongString const* string;
+			// Sets are immutable, shared by every value that holds them.
+			SetBits const* set;
+			// Likewise bignums.
+			BigNum const* big;
+			// Of references and pointers alike, so that LOAD_REF and
+			// STORE_REF reach the fields of objects too.
+			Value* ref;
+		} as;
+
+		static Value Integer(long value)
+		{
+			Value res;
+			res.type = ValueType::INTEGER;
+			res.as.integer = value;
+			return res;
+		}
+
+		static Value Real(double value)
+		{
+			Value res;
+			res.type = ValueType::REAL;
+			res.as.real = value;
+			return res;
+		}
+
+		static Value Boolean(bool value)
+		{
+			Value res;
+			res.type = ValueType::BOOLEAN;
+			res.as.integer = 0;
+			res.as.boolean = value;
+			return res;
+		}
+
+		static const size_t SHORT_STRING = 7;
+
+		// 'length' must not exceed SHORT_STRING.
+		static Value ShortString(const char* chars, size_t length)
+		{
+			Value res;
+			res.type = ValueType::STRING;
+			res.as.integer = 0;
+			res.as.chars[0] = static_cast<char>((length << 1) | 1);
+			for (size_t i = 0; i < length; i++)
+				res.as.chars[i + 1] = chars[i];
+			return res;
+		}
+
+		static Value String(LongString const* string)
+		{
+			Value res;
+			res.type = ValueType::STRING;
+			res.as.string = string;
+			return res;
+		}
+
+		static Value Set(SetBits const* set)
+		{
+			Value res;
+			res.type = ValueType::SET;
+			res.as.set = set;
+			return res;
+		}
+
+		static Value Reference(Value* slot)
+		{
+			Value res;
+			res.type = ValueType::REFERENCE;
+			res.as.ref = slot;
+			return res;
+		}
+
+		static Value BigInt(long value)
+		{
+			Value res;
+			res.type = ValueType::BIGINT;
+			res.as.integer = value;
+			return res;
+		}
+
+		static Value Big(BigNum const* number)
+		{
+			Value res;
+			res.type = ValueType::BIGNUM;
+			res.as.big = number;
+			return res;
+		}
+
+		// nullptr is nil.
+		static Value Pointer(Value* object)
+		{
+			Value res;
+			res.type = ValueType::POINTER;
+			res.as.ref = object;
+			return res;
+		}
+
+		static Value Text(long handle)
+		{
+			Value res;
+			res.type = ValueType::TEXT;
+			res.as.integer = handle;
+			return res;
+		}
+
+		static Value None()
+		{
+			Value res;
+			res.type = ValueType::NONE;
+			res.as.integer = 0;
+			return res;
+		}
+
+		bool isInteger() const { return type == ValueType::INTEGER; }
+		bool isReal()    const { return type == ValueType::REAL; }
+		bool isBoolean() const { return type == ValueType::BOOLEAN; }
+		bool isString()  const { return type == ValueType::STRING; }
+		bool isSet()     const { return type == ValueType::SET; }
+		bool isReference() const { return type == ValueType::REFERENCE; }
+		bool isPointer() const { return type == ValueType::POINTER; }
+		bool isText()    const { return type == ValueType::TEXT; }
+		bool isNumber()  const { return isInteger() || isReal(); }
+		bool isBigInt()  const { return type == ValueType::BIGINT; }
+		bool isBigNum()  const { return type == ValueType::BIGNUM; }
+		// An integer or a bigint, either in 'as.integer'.
+		bool isMachineInteger() const { return isInteger() || isBigInt(); }
+
+		bool isShortString() const { return (as.chars[0] & 1) != 0; }
+		size_t stringLength() const;
+		const char* stringChars() const;
+
+		double toReal() const
+		{ return isInteger() ? static_cast<double>(as.integer) : as.real; }
+
+		std::string toString() const;
+	};
+
+	static_assert(sizeof(Value) == 16, "Value must stay two words wide");
+
+	// The header of a string longer than Value::SHORT_STRING: its first
+	// 'length' characters of 'buffer', which later strings may extend.
+	struct StringBuffer;
+	struct LongString
+	{
+		size_t length;
+		StringBuffer* buffer;
+	};
+
+	// Its characters belong to the StringHeap too.
+	struct StringBuffer
+	{
+		size_t used;
+		size_t capacity;
+		char* chars;
+	};
+
+	// set of 0..255, one bit per element. Four words, so that an AVX2
+	// register holds a whole set and SSE2 ones half of it.
+	struct SetBits
+	{
+		static constexpr long MAX_ELEMENT = 255;
+
+		alignas(32) uint64_t words[4];
+		// Whether the elements are printed as characters.
+		bool chars;
+
+		static const SetBits EMPTY;
+		static const SetBits EMPTY_CHARS;
+
+		bool contains(long element) const
+		{
+			return element >= 0 && element <= MAX_ELEMENT && ((words[element >> 6] >> (element & 63)) & 1) != 0;
+		}
+
+		// Elements low..high, both within 0..MAX_ELEMENT.
+		void insert(long low, long high)
+		{
+			for (long e = low; e <= high; e++)
+				words[e >> 6] |= uint64_t(1) << (e & 63);
+		}
+
+		bool operator==(SetBits const& other) const
+		{
+			return words[0] == other.words[0] && words[1] == other.words[1] &&
+				words[2] == other.words[2] && words[3] == other.words[3] && chars == other.chars;
+		}
+	};
+
+	// Ordinal of a set element: an integer or a one character string.
+	inline bool ordinal(Value const& value, long& res)
+	{
+		if (value.isInteger())
+			res = value.as.integer;
+		else if (value.isString() && value.stringLength() == 1)
+			res = static_cast<unsigned char>(value.stringChars()[0]);
+		else
+			return false;
+		return true;
+	}
+
+	inline size_t Value::stringLength() const
+	{
+		return isShortString() ? static_cast<unsigned char>(as.chars[0]) >> 1 : as.string->length;
+	}
+
+	inline const char* Value::stringChars() const
+	{
+		return isShortString() ? as.chars + 1 : as.string->buffer->chars;
+	}
+
+	// Both tags are packed into one word so that the integer fast path
+	// costs a single compare.
+	inline bool bothIntegers(Value const& a, Value const& b)
+	{
+		return ((static_cast<unsigned>(a.type) << 8) | static_cast<unsigned>(b.type)) ==
+			((static_cast<unsigned>(ValueType::INTEGER) << 8) | static_cast<unsigned>(ValueType::INTEGER));
+	}
+
+	enum class Relation : uint8_t
+	{
+		EQ, NE, LT, LE, GT, GE
+	};
+
+	// Slow paths for mixed or non-integer operands, see Value.cpp.
+	// Return false when the operands can't be combined.
+	bool addSlow(Value const& a, Value const& b, Value& res);
+	bool subSlow(Value const& a, Value const& b, Value& res);
+	bool mulSlow(Value const& a, Value const& b, Value& res);
+	bool divSlow(Value const& a, Value const& b, Value& res);
+	bool modSlow(Value const& a, Value const& b, Value& res);
+	bool negSlow(Value const& a, Value& res);
+	bool lessSlow(Value const& a, Value const& b, bool& res);
+	bool equalSlow(Value const& a, Value const& b, bool& res);
+	bool compareSets(Relation rel, Value const& a, Value const& b, bool& res);
+
+	inline bool add(Value const& a, Value const& b, Value& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			res = Value::Integer(a.as.integer + b.as.integer);
+			return true;
+		}
+		return addSlow(a, b, res);
+	}
+
+	inline bool sub(Value const& a, Value const& b, Value& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			res = Value::Integer(a.as.integer - b.as.integer);
+			return true;
+		}
+		return subSlow(a, b, res);
+	}
+
+	inline bool mul(Value const& a, Value const& b, Value& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			res = Value::Integer(a.as.integer * b.as.integer);
+			return true;
+		}
+		return mulSlow(a, b, res);
+	}
+
+	// Division by zero has to be checked by the caller.
+	inline bool div(Value const& a, Value const& b, Value& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			// LONG_MIN / -1 wraps instead of trapping.
+			res = Value::Integer((b.as.integer == -1) ?
+				static_cast<long>(0UL - static_cast<unsigned long>(a.as.integer)) : a.as.integer / b.as.integer);
+			return true;
+		}
+		return divSlow(a, b, res);
+	}
+
+	inline bool mod(Value const& a, Value const& b, Value& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			res = Value::Integer((b.as.integer == -1) ? 0 : a.as.integer % b.as.integer);
+			return true;
+		}
+		return modSlow(a, b, res);
+	}
+
+	inline bool neg(Value const& a, Value& res)
+	{
+		if (PASCAL_LIKELY(a.isInteger()))
+		{
+			res = Value::Integer(-a.as.integer);
+			return true;
+		}
+		return negSlow(a, res);
+	}
+
+	// Numbers compare as reals unless both are integers, booleans as
+	// false < true.
+	inline bool less(Value const& a, Value const& b, bool& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			res = a.as.integer < b.as.integer;
+			return true;
+		}
+		return lessSlow(a, b, res);
+	}
+
+	inline bool equal(Value const& a, Value const& b, bool& res)
+	{
+		if (PASCAL_LIKELY(bothIntegers(a, b)))
+		{
+			res = a.as.integer == b.as.integer;
+			return true;
+		}
+		return equalSlow(a, b, res);
+	}
+
+	// Every relation is 'less' or 'equal', maybe with the operands swapped
+	// and the result negated, so a relation and its complement never agree
+	// (not even on NaN) and a branch may test either of them.
+	// Sets compare by inclusion, see compareSets.
+	inline bool compare(Relation rel, Value const& a, Value const& b, bool& res)
+	{
+		if (PASCAL_UNLIKELY(a.isSet()))
+			return compareSets(rel, a, b, res);
+
+		bool ok;
+		switch (rel)
+		{
+		case Relation::EQ: return equal(a, b, res);
+		case Relation::NE: ok = equal(a, b, res); res = !res; return ok;
+		case Relation::LT: return less(a, b, res);
+		case Relation::GE: ok = less(a, b, res); res = !res; return ok;
+		case Relation::GT: return less(b, a, res);
+		case Relation::LE: ok = less(b, a, res); res = !res; return ok;
+		}
+		return false;
+	}
+
+	inline bool isZero(Value const& a)
+	{
+		return (a.isMachineInteger() && a.as.integer == 0) || (a.isReal() && a.as.real == 0.0);
+	}
+
+	void assignSlow(Value& slot, Value const& value);
+
+	// Stores 'value' into a typed slot, widening integers to reals when
+	// the slot was declared as real and to bigints when it was a bigint.
+	inline void assign(Value& slot, Value const& value)
+	{
+		if (PASCAL_UNLIKELY(slot.type != value.type))
+			assignSlow(slot, value);
+		else
+			slot = value;
+	}
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PASCAL_VECTOR_KERNELS_HPP
+#define PASCAL_VECTOR_KERNELS_HPP
+
+#include <Bytecode.hpp>
+
+#include <string>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PASCAL_VECTOR_X86_64
+#endif
+
+namespace Pascal
+{
+	// Runs the loops of VectorLoop form, for the Interpreter and the Jit,
+	// and the set operators.
+	// Values are 16 bytes, so an SSE2 register holds one and an AVX2
+	// register two: the kernels compute on the payloads and keep the tags.
+	// Integer arithmetic wraps like the interpreter's, real sums and dot
+	// products add in the loop's order so that results are bit-identical.
+	class VectorKernels
+	{
+	public:
+		// Runs as many iterations of the loop as possible, from its control
+		// variable on, and leaves the variable at the next one to run.
+		// Returns true if none is left.
+		static bool run(VectorLoop const& loop, Value* base, Value* const* display, Value const* constants);
+
+		// Set operators on the elements alone, the 'chars' flag of the
+		// result is left to the caller.
+		static void setUnion(SetBits& res, SetBits const& a, SetBits const& b);
+		static void setIntersection(SetBits& res, SetBits const& a, SetBits const& b);
+		static void setDifference(SetBits& res, SetBits const& a, SetBits const& b);
+		static bool setsEqual(SetBits const& a, SetBits const& b);
+		// Whether every element of 'a' is in 'b'.
+		static bool setIncluded(SetBits const& a, SetBits const& b);
+
+		// "scalar", "sse2" or "avx2", false if the CPU lacks it. The widest
+		// one available is picked at startup.
+		static bool select(std::string const& isa);
+		static const char* getIsaName();
+	};
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef PASCAL_VECTORIZER_HPP
+#define PASCAL_VECTORIZER_HPP
+
+#include <Visitor.hpp>
+#include <Lexer.hpp>
+#include <Symbols.hpp>
+#include <Bytecode.hpp>
+
+#include <string>
+#include <vector>
+
+namespace Pascal
+{
+	// Recognizes the upward for loops of a checked AST (see SemanticAnalyzer)
+	// whose body is a single assignment of one of the VectorKernel forms,
+	// every array in it indexed by the control variable alone. Iterations of
+	// such a loop touch nothing another one does but the sum, so the
+	// Compiler may hand the loop to a kernel.
+	class Vectorizer : public AST::Visitor
+	{
+	public:
+		struct Match
+		{
+			VectorKernel kernel;
+			// a, or r of the sums
+			const VariableSymbol* target = nullptr;
+			const VariableSymbol* left = nullptr;
+			const VariableSymbol* right = nullptr;
+			// s, a variable or a number
+			const VariableSymbol* scalar = nullptr;
+			AST::NumberNode const* number = nullptr;
+			// Element type shared by the arrays.
+			std::shared_ptr<const Symbol> element;
+			// The + - * of the right side.
+			std::vector<const Token_t*> operations;
+		};
+
+		bool match(AST::ForNode const& node, Match& res);
+
+		void visitProgramNode(AST::ProgramNode const& node);
+		void visitVarDeclNode(AST::VarDeclNode const& node);
+		void visitBlockNode(AST::BlockNode const& node);
+		void visitTypeNode(AST::TypeNode const& node);
+		void visitStatementNode(AST::StatementNode const& node);
+		void visitCompoundNode(AST::CompoundNode const& node);
+		void visitAssignmentNode(AST::AssignmentNode const& node);
+		void visitVariableNode(AST::VariableNode const& node);
+		void visitNullStatementNode(AST::NullStatementNode const& node);
+		void visitNumberNode(AST::NumberNode const& node);
+		void visitBinOpNode(AST::BinOpNode const& node);
+		void visitUnaryOpNode(AST::UnaryOpNode const& node);
+		void visitProcDeclNode(AST::ProcDeclNode const& node);
+		void visitParamNode(const AST::ParamNode &node);
+		void visitProcCallNode(const AST::ProcCallNode& node);
+		void visitWhileNode(AST::WhileNode const& node);
+		void visitRepeatNode(AST::RepeatNode const& node);
+		void visitForNode(AST::ForNode const& node);
+		void visitIfNode(AST::IfNode const& node);
+		void visitBooleanNode(AST::BooleanNode const& node);
+		void visitCaseNode(AST::CaseNode const& node);
+		void visitIndexNode(AST::IndexNode const& node);
+		void visitStringNode(AST::StringNode const& node);
+		void visitSetNode(AST::SetNode const& node);
+		void visitTypeDeclNode(AST::TypeDeclNode const& node);
+		void visitFieldNode(AST::FieldNode const& node);
+		void visitNilNode(AST::NilNode const& node);
+
+	private:
+		const VariableSymbol* m_Var = nullptr;
+		const VariableSymbol* m_Sum = nullptr;
+		bool m_Assigned = false;
+
+		// The right side in postfix: 'E' an element a[i], 'S' a scalar, 'R'
+		// the sum, '+', '-' and '*'. 'I' is the control variable itself and
+		// 'X' anything else.
+		std::string m_Shape;
+		std::vector<const VariableSymbol*> m_Arrays;
+		const VariableSymbol* m_Scalar = nullptr;
+		AST::NumberNode const* m_Number = nullptr;
+		std::vector<const Token_t*> m_Operations;
+
+		static bool isArray(VariableSymbol const& sym);
+	};
+}
+
+#endif
@@ -5,6 +5,7 @@ namespace Pascal
 {
 	namespace AST
 	{
+		class Node;
 		class ProgramNode;
 		class VarDeclNode;
 		class BlockNode;
@@ -20,6 +21,18 @@ namespace Pascal
 		class ProcDeclNode;
 		class ParamNode;
 		class ProcCallNode;
+		class WhileNode;
+		class RepeatNode;
+		class ForNode;
+		class IfNode;
+		class BooleanNode;
+		class CaseNode;
+		class IndexNode;
+		class StringNode;
+		class SetNode;
+		class TypeDeclNode;
+		class FieldNode;
+		class NilNode;
 		
 		class Visitor
 		{
@@ -41,6 +54,18 @@ namespace Pascal
 			virtual void visitProcDeclNode      (AST::ProcDeclNode      const& node) = 0;
 			virtual void visitParamNode         (AST::ParamNode         const& node) = 0;
 			virtual void visitProcCallNode      (AST::ProcCallNode      const& node) = 0;
+			virtual void visitWhileNode         (AST::WhileNode         const& node) = 0;
+			virtual void visitRepeatNode        (AST::RepeatNode        const& node) = 0;
+			virtual void visitForNode           (AST::ForNode           const& node) = 0;
+			virtual void visitIfNode            (AST::IfNode            const& node) = 0;
+			virtual void visitBooleanNode       (AST::BooleanNode       const& node) = 0;
+			virtual void visitCaseNode          (AST::CaseNode          const& node) = 0;
+			virtual void visitIndexNode         (AST::IndexNode         const& node) = 0;
+			virtual void visitStringNode        (AST::StringNode        const& node) = 0;
+			virtual void visitSetNode           (AST::SetNode           const& node) = 0;
+			virtual void visitTypeDeclNode      (AST::TypeDeclNode      const& node) = 0;
+			virtual void visitFieldNode         (AST::FieldNode         const& node) = 0;
+			virtual void visitNilNode           (AST::NilNode           const& node) = 0;
 		};
 	}
 }
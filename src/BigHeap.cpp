@@ -0,0 +1,96 @@
+#include <pscpch.hpp>
+#include <BigHeap.hpp>
+
+namespace Pascal
+{
+	// 'scratch' holds the value of an inline integer.
+	static BigNum const* operand(Value const& value, BigNum& scratch)
+	{
+		if (value.isBigNum())
+			return value.as.big;
+		if (!value.isMachineInteger())
+			return nullptr;
+		scratch = BigNum::fromLong(value.as.integer);
+		return &scratch;
+	}
+
+#define BIG_OPERANDS(a, b)												\
+	BigNum leftScratch, rightScratch;									\
+	BigNum const* left = operand((a), leftScratch);						\
+	BigNum const* right = operand((b), rightScratch);					\
+	if (left == nullptr || right == nullptr)							\
+		return false
+
+	bool BigHeap::add(Value const& a, Value const& b, Value& res)
+	{
+		BIG_OPERANDS(a, b);
+		res = make(BigNum::add(*left, *right));
+		return true;
+	}
+
+	bool BigHeap::sub(Value const& a, Value const& b, Value& res)
+	{
+		BIG_OPERANDS(a, b);
+		res = make(BigNum::sub(*left, *right));
+		return true;
+	}
+
+	bool BigHeap::mul(Value const& a, Value const& b, Value& res)
+	{
+		BIG_OPERANDS(a, b);
+		res = make(BigNum::mul(*left, *right));
+		return true;
+	}
+
+	bool BigHeap::div(Value const& a, Value const& b, Value& res)
+	{
+		BIG_OPERANDS(a, b);
+		BigNum quotient, remainder;
+		BigNum::divide(*left, *right, quotient, remainder);
+		res = make(std::move(quotient));
+		return true;
+	}
+
+	bool BigHeap::mod(Value const& a, Value const& b, Value& res)
+	{
+		BIG_OPERANDS(a, b);
+		BigNum quotient, remainder;
+		BigNum::divide(*left, *right, quotient, remainder);
+		res = make(std::move(remainder));
+		return true;
+	}
+
+#undef BIG_OPERANDS
+
+	bool BigHeap::neg(Value const& a, Value& res)
+	{
+		BigNum scratch;
+		BigNum const* number = operand(a, scratch);
+		if (number == nullptr)
+			return false;
+		res = make(number->negated());
+		return true;
+	}
+
+	// Up to 18 digits always fit a long.
+	Value BigHeap::parse(const char* chars, size_t length)
+	{
+		size_t sign = (length > 0 && (chars[0] == '-' || chars[0] == '+')) ? 1 : 0;
+		if (length - sign > 18)
+			return make(BigNum::fromString(chars, length));
+
+		long value = 0;
+		for (size_t i = sign; i < length; i++)
+			value = value * 10 + (chars[i] - '0');
+		return Value::BigInt((sign != 0 && chars[0] == '-') ? -value : value);
+	}
+
+	Value BigHeap::make(BigNum&& number)
+	{
+		long value;
+		if (number.toLong(value))
+			return Value::BigInt(value);
+		m_Numbers.push_back(std::move(number));
+		return Value::Big(&m_Numbers.back());
+	}
+}
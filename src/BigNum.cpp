@@ -0,0 +1,373 @@
+#include <pscpch.hpp>
+#include <BigNum.hpp>
+
+#include <algorithm>
+
+namespace Pascal
+{
+	typedef std::vector<uint32_t> Limbs;
+
+	static const uint64_t BASE = uint64_t(1) << 32;
+
+	static void trim(Limbs& limbs)
+	{
+		while (!limbs.empty() && limbs.back() == 0)
+			limbs.pop_back();
+	}
+
+	static BigNum make(bool negative, Limbs&& limbs)
+	{
+		BigNum res;
+		res.limbs = std::move(limbs);
+		trim(res.limbs);
+		res.negative = negative && !res.limbs.empty();
+		return res;
+	}
+
+	static int compareMagnitudes(Limbs const& a, Limbs const& b)
+	{
+		if (a.size() != b.size())
+			return (a.size() < b.size()) ? -1 : 1;
+		for (size_t i = a.size(); i-- > 0; )
+		{
+			if (a[i] != b[i])
+				return (a[i] < b[i]) ? -1 : 1;
+		}
+		return 0;
+	}
+
+	static Limbs addMagnitudes(Limbs const& a, Limbs const& b)
+	{
+		Limbs const& longer = (a.size() >= b.size()) ? a : b;
+		Limbs const& shorter = (a.size() >= b.size()) ? b : a;
+		Limbs res(longer.size() + 1);
+		uint64_t carry = 0;
+		for (size_t i = 0; i < longer.size(); i++)
+		{
+			uint64_t sum = uint64_t(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+			res[i] = static_cast<uint32_t>(sum);
+			carry = sum >> 32;
+		}
+		res[longer.size()] = static_cast<uint32_t>(carry);
+		trim(res);
+		return res;
+	}
+
+	// 'a' must not be less than 'b'.
+	static Limbs subMagnitudes(Limbs const& a, Limbs const& b)
+	{
+		Limbs res(a.size());
+		uint64_t borrow = 0;
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			uint64_t diff = uint64_t(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+			res[i] = static_cast<uint32_t>(diff);
+			borrow = (diff >> 32) & 1;
+		}
+		trim(res);
+		return res;
+	}
+
+	// res += part * BASE^shift, 'res' being long enough for the sum.
+	static void addShifted(Limbs& res, Limbs const& part, size_t shift)
+	{
+		uint64_t carry = 0;
+		size_t i = 0;
+		for (; i < part.size(); i++)
+		{
+			uint64_t sum = uint64_t(res[shift + i]) + part[i] + carry;
+			res[shift + i] = static_cast<uint32_t>(sum);
+			carry = sum >> 32;
+		}
+		for (; carry != 0; i++)
+		{
+			uint64_t sum = uint64_t(res[shift + i]) + carry;
+			res[shift + i] = static_cast<uint32_t>(sum);
+			carry = sum >> 32;
+		}
+	}
+
+	static Limbs slice(Limbs const& limbs, size_t first, size_t last)
+	{
+		first = std::min(first, limbs.size());
+		last = std::min(last, limbs.size());
+		Limbs res(limbs.begin() + first, limbs.begin() + last);
+		trim(res);
+		return res;
+	}
+
+	static Limbs mulMagnitudes(Limbs const& a, Limbs const& b)
+	{
+		if (a.empty() || b.empty())
+			return Limbs();
+
+		if (std::min(a.size(), b.size()) < BigNum::KARATSUBA_LIMBS)
+		{
+			Limbs res(a.size() + b.size());
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				uint64_t carry = 0;
+				for (size_t j = 0; j < b.size(); j++)
+				{
+					uint64_t t = uint64_t(a[i]) * b[j] + res[i + j] + carry;
+					res[i + j] = static_cast<uint32_t>(t);
+					carry = t >> 32;
+				}
+				res[i + b.size()] = static_cast<uint32_t>(carry);
+			}
+			trim(res);
+			return res;
+		}
+
+		// a = a1 * BASE^m + a0 and likewise b, then
+		// a * b = z2 * BASE^2m + z1 * BASE^m + z0 with
+		// z1 = (a0 + a1) * (b0 + b1) - z2 - z0.
+		size_t m = std::max(a.size(), b.size()) / 2;
+		Limbs a0 = slice(a, 0, m);
+		Limbs a1 = slice(a, m, a.size());
+		Limbs b0 = slice(b, 0, m);
+		Limbs b1 = slice(b, m, b.size());
+
+		Limbs z0 = mulMagnitudes(a0, b0);
+		Limbs z2 = mulMagnitudes(a1, b1);
+		Limbs z1 = mulMagnitudes(addMagnitudes(a0, a1), addMagnitudes(b0, b1));
+		z1 = subMagnitudes(subMagnitudes(z1, z2), z0);
+
+		Limbs res(a.size() + b.size() + 1);
+		addShifted(res, z0, 0);
+		addShifted(res, z1, m);
+		addShifted(res, z2, 2 * m);
+		trim(res);
+		return res;
+	}
+
+	// Knuth's algorithm D, 'v' must not be zero.
+	static void divideMagnitudes(Limbs const& u, Limbs const& v, Limbs& q, Limbs& r)
+	{
+		if (compareMagnitudes(u, v) < 0)
+		{
+			q.clear();
+			r = u;
+			return;
+		}
+
+		size_t n = v.size();
+		if (n == 1)
+		{
+			q.assign(u.size(), 0);
+			uint64_t rem = 0;
+			for (size_t i = u.size(); i-- > 0; )
+			{
+				uint64_t cur = (rem << 32) | u[i];
+				q[i] = static_cast<uint32_t>(cur / v[0]);
+				rem = cur % v[0];
+			}
+			trim(q);
+			r.assign(rem != 0, static_cast<uint32_t>(rem));
+			return;
+		}
+
+		// Scaled so that the top limb of the divisor has its high bit set,
+		// which keeps each estimated quotient limb at most 2 too large.
+		int s = __builtin_clz(v[n - 1]);
+		Limbs vn(n);
+		for (size_t i = n - 1; i > 0; i--)
+			vn[i] = (v[i] << s) | static_cast<uint32_t>(uint64_t(v[i - 1]) >> (32 - s));
+		vn[0] = v[0] << s;
+		Limbs un(u.size() + 1);
+		un[u.size()] = static_cast<uint32_t>(uint64_t(u.back()) >> (32 - s));
+		for (size_t i = u.size() - 1; i > 0; i--)
+			un[i] = (u[i] << s) | static_cast<uint32_t>(uint64_t(u[i - 1]) >> (32 - s));
+		un[0] = u[0] << s;
+
+		size_t m = u.size() - n;
+		q.assign(m + 1, 0);
+		for (size_t j = m + 1; j-- > 0; )
+		{
+			uint64_t top = (uint64_t(un[j + n]) << 32) | un[j + n - 1];
+			uint64_t qhat = top / vn[n - 1];
+			uint64_t rhat = top % vn[n - 1];
+			while (qhat >= BASE || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2]))
+			{
+				qhat--;
+				rhat += vn[n - 1];
+				if (rhat >= BASE)
+					break;
+			}
+
+			uint64_t carry = 0;
+			uint64_t borrow = 0;
+			for (size_t i = 0; i < n; i++)
+			{
+				uint64_t product = qhat * vn[i] + carry;
+				carry = product >> 32;
+				uint64_t diff = uint64_t(un[i + j]) - static_cast<uint32_t>(product) - borrow;
+				un[i + j] = static_cast<uint32_t>(diff);
+				borrow = (diff >> 32) & 1;
+			}
+			uint64_t diff = uint64_t(un[j + n]) - carry - borrow;
+			un[j + n] = static_cast<uint32_t>(diff);
+
+			// Still one too large: add the divisor back.
+			if ((diff >> 63) != 0)
+			{
+				qhat--;
+				carry = 0;
+				for (size_t i = 0; i < n; i++)
+				{
+					uint64_t sum = uint64_t(un[i + j]) + vn[i] + carry;
+					un[i + j] = static_cast<uint32_t>(sum);
+					carry = sum >> 32;
+				}
+				un[j + n] += static_cast<uint32_t>(carry);
+			}
+			q[j] = static_cast<uint32_t>(qhat);
+		}
+		trim(q);
+
+		r.resize(n);
+		for (size_t i = 0; i < n; i++)
+			r[i] = static_cast<uint32_t>((un[i] >> s) | (uint64_t(un[i + 1]) << (32 - s)));
+		trim(r);
+	}
+
+	BigNum BigNum::fromLong(long value)
+	{
+		BigNum res;
+		res.negative = value < 0;
+		uint64_t magnitude = res.negative ? uint64_t(0) - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+		for (; magnitude != 0; magnitude >>= 32)
+			res.limbs.push_back(static_cast<uint32_t>(magnitude));
+		return res;
+	}
+
+	// Nine digits at a time, like toString.
+	BigNum BigNum::fromString(const char* chars, size_t length)
+	{
+		bool negative = length > 0 && chars[0] == '-';
+		size_t i = (length > 0 && (chars[0] == '-' || chars[0] == '+')) ? 1 : 0;
+		Limbs limbs;
+		while (i < length)
+		{
+			size_t count = (length - i) % 9;
+			if (count == 0)
+				count = 9;
+			uint64_t chunk = 0;
+			uint64_t scale = 1;
+			for (size_t k = 0; k < count; k++)
+			{
+				chunk = chunk * 10 + (chars[i + k] - '0');
+				scale *= 10;
+			}
+			i += count;
+
+			uint64_t carry = chunk;
+			for (auto& e : limbs)
+			{
+				uint64_t t = uint64_t(e) * scale + carry;
+				e = static_cast<uint32_t>(t);
+				carry = t >> 32;
+			}
+			if (carry != 0)
+				limbs.push_back(static_cast<uint32_t>(carry));
+		}
+		return make(negative, std::move(limbs));
+	}
+
+	bool BigNum::toLong(long& res) const
+	{
+		if (limbs.size() > 2)
+			return false;
+		uint64_t magnitude = 0;
+		for (size_t i = limbs.size(); i-- > 0; )
+			magnitude = (magnitude << 32) | limbs[i];
+
+		uint64_t limit = uint64_t(1) << 63;
+		if (negative ? magnitude > limit : magnitude >= limit)
+			return false;
+		res = static_cast<long>(negative ? uint64_t(0) - magnitude : magnitude);
+		return true;
+	}
+
+	double BigNum::toReal() const
+	{
+		double res = 0.0;
+		for (size_t i = limbs.size(); i-- > 0; )
+			res = res * static_cast<double>(BASE) + limbs[i];
+		return negative ? -res : res;
+	}
+
+	// Nine digits at a time.
+	std::string BigNum::toString() const
+	{
+		if (limbs.empty())
+			return "0";
+
+		Limbs rest = limbs;
+		std::vector<uint32_t> chunks;
+		while (!rest.empty())
+		{
+			uint64_t rem = 0;
+			for (size_t i = rest.size(); i-- > 0; )
+			{
+				uint64_t cur = (rem << 32) | rest[i];
+				rest[i] = static_cast<uint32_t>(cur / 1000000000);
+				rem = cur % 1000000000;
+			}
+			trim(rest);
+			chunks.push_back(static_cast<uint32_t>(rem));
+		}
+
+		std::string res = negative ? "-" : "";
+		res += std::to_string(chunks.back());
+		for (size_t i = chunks.size() - 1; i-- > 0; )
+		{
+			std::string digits = std::to_string(chunks[i]);
+			res += std::string(9 - digits.size(), '0') + digits;
+		}
+		return res;
+	}
+
+	BigNum BigNum::negated() const
+	{
+		BigNum res = *this;
+		res.negative = !negative && !limbs.empty();
+		return res;
+	}
+
+	int BigNum::compare(BigNum const& a, BigNum const& b)
+	{
+		if (a.negative != b.negative)
+			return a.negative ? -1 : 1;
+		int res = compareMagnitudes(a.limbs, b.limbs);
+		return a.negative ? -res : res;
+	}
+
+	BigNum BigNum::add(BigNum const& a, BigNum const& b)
+	{
+		if (a.negative == b.negative)
+			return make(a.negative, addMagnitudes(a.limbs, b.limbs));
+		if (compareMagnitudes(a.limbs, b.limbs) >= 0)
+			return make(a.negative, subMagnitudes(a.limbs, b.limbs));
+		return make(b.negative, subMagnitudes(b.limbs, a.limbs));
+	}
+
+	BigNum BigNum::sub(BigNum const& a, BigNum const& b)
+	{
+		return add(a, b.negated());
+	}
+
+	BigNum BigNum::mul(BigNum const& a, BigNum const& b)
+	{
+		return make(a.negative != b.negative, mulMagnitudes(a.limbs, b.limbs));
+	}
+
+	void BigNum::divide(BigNum const& a, BigNum const& b, BigNum& quotient, BigNum& remainder)
+	{
+		Limbs q;
+		Limbs r;
+		divideMagnitudes(a.limbs, b.limbs, q, r);
+		quotient = make(a.negative != b.negative, std::move(q));
+		remainder = make(a.negative, std::move(r));
+	}
+}
@@ -0,0 +1,239 @@
+#include <pscpch.hpp>
+#include <Bytecode.hpp>
+
+namespace Pascal
+{
+	std::string opCodeToString(OpCode op)
+	{
+		switch (op)
+		{
+#define PASCAL_OPCODE_NAME(name, operands) case OpCode::name: return #name;
+			PASCAL_OPCODES(PASCAL_OPCODE_NAME)
+#undef PASCAL_OPCODE_NAME
+		case OpCode::OPCODES_COUNT:
+			break;
+		}
+		return "UNKNOWN";
+	}
+
+	unsigned opCodeOperands(OpCode op)
+	{
+		switch (op)
+		{
+#define PASCAL_OPCODE_OPERANDS(name, operands) case OpCode::name: return operands;
+			PASCAL_OPCODES(PASCAL_OPCODE_OPERANDS)
+#undef PASCAL_OPCODE_OPERANDS
+		case OpCode::OPCODES_COUNT:
+			break;
+		}
+		return 0;
+	}
+
+	bool opCodeIsJump(OpCode op)
+	{
+		switch (op)
+		{
+		case OpCode::JUMP:
+		case OpCode::JUMP_FALSE:
+		case OpCode::JUMP_TRUE:
+		case OpCode::JUMP_EQ:
+		case OpCode::JUMP_NE:
+		case OpCode::JUMP_LT:
+		case OpCode::JUMP_LE:
+		case OpCode::JUMP_GT:
+		case OpCode::JUMP_GE:
+		case OpCode::FOR_INIT:
+		case OpCode::FOR_INIT_DN:
+		case OpCode::FOR_NEXT:
+		case OpCode::FOR_NEXT_DN:
+		case OpCode::VECTOR:
+		case OpCode::R_JUMP_FALSE:
+		case OpCode::R_JUMP_TRUE:
+		case OpCode::R_JUMP_EQ:
+		case OpCode::R_JUMP_NE:
+		case OpCode::R_JUMP_LT:
+		case OpCode::R_JUMP_LE:
+		case OpCode::R_JUMP_GT:
+		case OpCode::R_JUMP_GE:
+		case OpCode::R_JUMP_EQK:
+		case OpCode::R_JUMP_NEK:
+		case OpCode::R_JUMP_LTK:
+		case OpCode::R_JUMP_LEK:
+		case OpCode::R_JUMP_GTK:
+		case OpCode::R_JUMP_GEK:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	std::string vectorKernelToString(VectorKernel kernel)
+	{
+		switch (kernel)
+		{
+		case VectorKernel::COPY:  return "COPY";
+		case VectorKernel::FILL:  return "FILL";
+		case VectorKernel::ADD:   return "ADD";
+		case VectorKernel::SUB:   return "SUB";
+		case VectorKernel::MUL:   return "MUL";
+		case VectorKernel::SCALE: return "SCALE";
+		case VectorKernel::AXPY:  return "AXPY";
+		case VectorKernel::SUM:   return "SUM";
+		case VectorKernel::DOT:   return "DOT";
+		}
+		return "UNKNOWN";
+	}
+
+	size_t Bytecode::emit(OpCode op, int32_t a, int32_t b, size_t pos)
+	{
+		m_Code.push_back({ nullptr, op, a, b, 0 });
+		m_Positions.push_back(pos);
+		return m_Code.size() - 1;
+	}
+
+	unsigned Bytecode::addConstant(Value const& value)
+	{
+		for (unsigned i = 0; i < m_Constants.size(); i++)
+		{
+			Value const& e = m_Constants[i];
+			if (e.type == value.type && e.as.integer == value.as.integer)
+				return i;
+		}
+
+		m_Constants.push_back(value);
+		return m_Constants.size() - 1;
+	}
+
+	unsigned Bytecode::addString(std::string const& text)
+	{
+		if (text.size() <= Value::SHORT_STRING)
+			return addConstant(Value::ShortString(text.data(), text.size()));
+
+		auto it = m_Literals.find(text);
+		if (it != m_Literals.end())
+			return it->second;
+
+		m_Constants.push_back(m_Strings.make(text.data(), text.size()));
+		m_Literals[text] = m_Constants.size() - 1;
+		return m_Constants.size() - 1;
+	}
+
+	unsigned Bytecode::addSet(SetBits const& bits)
+	{
+		for (SetBits const& e : m_Sets)
+		{
+			if (e == bits)
+				return addConstant(Value::Set(&e));
+		}
+
+		m_Sets.push_back(bits);
+		return addConstant(Value::Set(&m_Sets.back()));
+	}
+
+	unsigned Bytecode::addBigInt(std::string const& digits)
+	{
+		return addConstant(m_Bigs.parse(digits.data(), digits.size()));
+	}
+
+	unsigned Bytecode::addProcedure(ProcedureCode const& proc)
+	{
+		m_Procedures.push_back(proc);
+		return m_Procedures.size() - 1;
+	}
+
+	unsigned Bytecode::addLayout(std::vector<Value> const& layout)
+	{
+		m_Layouts.push_back(layout);
+		return m_Layouts.size() - 1;
+	}
+
+	unsigned Bytecode::addVectorLoop(VectorLoop const& loop)
+	{
+		m_VectorLoops.push_back(loop);
+		return m_VectorLoops.size() - 1;
+	}
+
+	size_t Bytecode::getProcedureEnd(unsigned proc) const
+	{
+		size_t entry = m_Procedures[proc].entry;
+		size_t res = m_Code.size();
+		for (auto const& e : m_Procedures)
+		{
+			if (e.entry > entry && e.entry < res)
+				res = e.entry;
+		}
+		return res;
+	}
+
+	std::string Bytecode::disassemble() const
+	{
+		std::stringstream ss;
+		// The JUMPs of the last case dispatch, the default first.
+		size_t caseBegin = 0;
+		size_t caseEnd = 0;
+		bool caseTable = false;
+
+		for (size_t i = 0; i < m_Code.size(); i++)
+		{
+			for (auto const& proc : m_Procedures)
+			{
+				if (proc.entry == i)
+				{
+					ss << "<" << proc.name << ">:" << std::endl;
+				}
+			}
+
+			Instruction const& e = m_Code[i];
+			ss << std::setw(6) << i << "  " << std::left << std::setw(14) <<
+				opCodeToString(e.op) << std::right;
+
+			unsigned operands = opCodeOperands(e.op);
+			if (operands >= 1)
+				ss << " " << e.a;
+			if (operands >= 2)
+				ss << ", " << e.b;
+			if (operands >= 3)
+				ss << ", " << e.c;
+
+			if (e.op == OpCode::CONST || e.op == OpCode::ADD_CONST || e.op == OpCode::SUB_CONST ||
+				e.op == OpCode::MUL_CONST || e.op == OpCode::DIV_CONST || e.op == OpCode::MOD_CONST)
+				ss << "\t; " << m_Constants[e.a].toString();
+			else if (e.op == OpCode::INC_LOCAL || e.op == OpCode::INC_GLOBAL || e.op == OpCode::SET_BUILD)
+				ss << "\t; " << m_Constants[e.b].toString();
+			else if (e.op == OpCode::R_LOADK || e.op == OpCode::R_SETK)
+				ss << "\t; " << m_Constants[e.b].toString();
+			else if (e.op == OpCode::R_ADDK || e.op == OpCode::R_SUBK || e.op == OpCode::R_MULK ||
+					 e.op == OpCode::R_DIVK || e.op == OpCode::R_MODK ||
+					 e.op == OpCode::R_JUMP_EQK || e.op == OpCode::R_JUMP_NEK ||
+					 e.op == OpCode::R_JUMP_LTK || e.op == OpCode::R_JUMP_LEK ||
+					 e.op == OpCode::R_JUMP_GTK || e.op == OpCode::R_JUMP_GEK)
+				ss << "\t; " << m_Constants[e.c].toString();
+			else if (e.op == OpCode::CALL || e.op == OpCode::R_CALL ||
+					 e.op == OpCode::TAIL_CALL || e.op == OpCode::R_TAIL_CALL)
+				ss << "\t; " << m_Procedures[e.a].name;
+			else if (e.op == OpCode::VECTOR)
+				ss << "\t; " << vectorKernelToString(m_VectorLoops[e.b].kernel) << " of " <<
+					typeToString(m_VectorLoops[e.b].element);
+			else if (e.op == OpCode::NEW)
+				ss << "\t; " << m_Layouts[e.a].size() << " slots";
+			else if (i == caseBegin && i < caseEnd)
+				ss << "\t; else";
+			else if (i > caseBegin && i < caseEnd && caseTable)
+				ss << "\t; " << m_Constants[m_Code[caseBegin].b].as.integer + static_cast<long>(i - caseBegin - 1);
+			else if (i > caseBegin && i < caseEnd)
+				ss << "\t; " << m_Constants[e.b].toString();
+
+			if (e.op == OpCode::CASE_LIST || e.op == OpCode::CASE_FIND || e.op == OpCode::CASE_TABLE ||
+				e.op == OpCode::R_CASE_LIST || e.op == OpCode::R_CASE_FIND || e.op == OpCode::R_CASE_TABLE)
+			{
+				caseBegin = i + 1;
+				caseEnd = i + 2 + e.a;
+				caseTable = (e.op == OpCode::CASE_TABLE || e.op == OpCode::R_CASE_TABLE);
+			}
+
+			ss << std::endl;
+		}
+
+		return ss.str();
+	}
+}
@@ -1,8 +1,21 @@
 #include <pscpch.hpp>
 #include <CallStack.hpp>
+#include <Bytecode.hpp>
 
 namespace Pascal
 {
+	// Elements of an array printed before the rest is elided.
+	static const unsigned ARRAY_SHOWN = 16;
+
+	// (<field>: <value>, ...), the slots of a record from the first on.
+	static std::string recordToString(const Value* slots, std::vector<std::string> const& fields)
+	{
+		std::string res = "(";
+		for (unsigned k = 0; k < fields.size(); k++)
+			res += ((k == 0) ? "" : ", ") + fields[k] + ": " + slots[k].toString();
+		return res + ")";
+	}
+
 	std::string typeToString(ARType type)
 	{
 		switch (type)
@@ -16,17 +29,50 @@ namespace Pascal
 		}
 	}
 	
+	std::string const& ActivationRecord::getName() const
+	{
+		return m_Proc->name;
+	}
+
+	const ARType ActivationRecord::getType() const
+	{
+		return m_Proc->type;
+	}
+
+	const unsigned ActivationRecord::getNestingLevel() const
+	{
+		return m_Proc->nestingLevel;
+	}
+	
 	std::string ActivationRecord::toString() const
 	{
 		std::stringstream ss;
 
-		ss << m_NestingLevel << ": " << typeToString(m_Type)
-		   << " " << m_Name << std::endl;
+		ss << getNestingLevel() << ": " << typeToString(getType())
+		   << " " << getName() << std::endl;
 
-		for (auto const& p : m_Members)
+		for (unsigned i = 0; i < m_Proc->slotsNames.size(); i++)
 		{
-			ss << "-- " << std::setw(8) << p.first << " : " <<
-				p.second.value << std::endl;
+			ss << "-- " << std::setw(8) << m_Proc->slotsNames[i] << " : ";
+
+			unsigned length = m_Proc->arrayLengths[i];
+			std::vector<std::string> const& fields = m_Proc->recordFields[i];
+			unsigned stride = fields.empty() ? 1 : fields.size();
+			if (length == 0)
+			{
+				ss << (fields.empty() ? m_Slots[i].toString() : recordToString(m_Slots + i, fields)) << std::endl;
+				i += stride - 1;
+				continue;
+			}
+
+			ss << "[";
+			for (unsigned k = 0; k < length && k < ARRAY_SHOWN; k++)
+			{
+				ss << ((k == 0) ? "" : ", ") << (fields.empty() ? m_Slots[i + k].toString() :
+												 recordToString(m_Slots + i + k * stride, fields));
+			}
+			ss << ((length > ARRAY_SHOWN) ? ", ...]" : "]") << std::endl;
+			i += length * stride - 1;
 		}
 		
 		return ss.str();
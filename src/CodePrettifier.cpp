@@ -14,12 +14,20 @@ namespace Pascal
 	
 	void CodePrettifier::visitVarDeclNode(AST::VarDeclNode const& node)
 	{
-		ss << node.getVar().getToken().str << " : " <<
-			node.getType().getToken().str << ";";
+		ss << node.getVar().getToken().str << " : ";
+		node.getType().accept(this);
+		ss << ";";
 	}
 	
 	void CodePrettifier::visitBlockNode(AST::BlockNode const& node)
 	{
+		for (auto const& e : node.getTypeDecls())
+		{
+			ss << std::string(currentScopeLevel*4, ' ') << "type ";
+			e->accept(this);
+			ss << std::endl;
+		}
+
 		for (auto const& e : node.getVarDecls())
 		{
 			ss << std::string(currentScopeLevel*4, ' ') << "var ";
@@ -36,9 +44,35 @@ namespace Pascal
 		node.getCompound().accept(this);
 	}
 	
+	// Records on one line.
 	void CodePrettifier::visitTypeNode(AST::TypeNode const& node)
 	{
-		
+		if (node.isRecord())
+		{
+			ss << (node.isPacked() ? "packed record " : "record ");
+			for (auto const& field : *node.getFields())
+			{
+				for (size_t i = 0; i < field.names.size(); i++)
+					ss << ((i == 0) ? "" : ", ") << field.names[i].str;
+				ss << " : ";
+				field.type->accept(this);
+				ss << "; ";
+			}
+			ss << "end";
+			return;
+		}
+
+		if (node.isPointer())
+			ss << "^";
+		else if (node.isSet() && node.getToken().type == TokenType::NONE)
+			ss << "set of " << node.getLow().literal.str << ".." << node.getHigh().literal.str;
+		else if (node.isSet())
+			ss << "set of ";
+		else if (node.isArray())
+			ss << "array [" << (node.getLow().negative ? "-" : "") << node.getLow().literal.str << ".." <<
+				(node.getHigh().negative ? "-" : "") << node.getHigh().literal.str << "] of ";
+		if (!node.isSet() || node.getToken().type != TokenType::NONE)
+			ss << node.getToken().str;
 	}
 	
 	void CodePrettifier::visitStatementNode(AST::StatementNode const& node)
@@ -59,7 +93,12 @@ namespace Pascal
 	
 	void CodePrettifier::visitAssignmentNode(AST::AssignmentNode const& node)
 	{
-		node.getVar().accept(this);
+		if (node.getField() != nullptr)
+			node.getField()->accept(this);
+		else if (node.getElement() != nullptr)
+			node.getElement()->accept(this);
+		else
+			node.getVar().accept(this);
 		ss << " := ";
 		node.getExpr().accept(this);
 		ss << ";" << std::endl;
@@ -82,20 +121,30 @@ namespace Pascal
 	
 	void CodePrettifier::visitBinOpNode(AST::BinOpNode const& node)
 	{
+		// Relations bind looser than 'and' and 'or'.
+		bool relation = (node.getOperation().type >= TokenType::EQUAL &&
+						 node.getOperation().type <= TokenType::LESS_EQUAL) ||
+			node.getOperation().type == TokenType::IN;
+		if (relation)
+			ss << "(";
 		node.getLeft().accept(this);
 	    ss << " " << node.getOperation().str << " ";
 		node.getRight().accept(this);
+		if (relation)
+			ss << ")";
 	}
 	
 	void CodePrettifier::visitUnaryOpNode(AST::UnaryOpNode const& node)
 	{
 		ss << node.getOperation().str;
+		if (node.getOperation().type == TokenType::NOT)
+			ss << " ";
 		node.getExpr().accept(this);
 	}
 	
 	void CodePrettifier::visitProcDeclNode(AST::ProcDeclNode const& node)
 	{
-		ss << "procedure " << node.getProcName().str;
+		ss << ((node.getResultType() != nullptr) ? "function " : "procedure ") << node.getProcName().str;
 		if (!node.getParams().empty())
 		{
 			ss << "(";
@@ -107,6 +156,8 @@ namespace Pascal
 			}
 			ss << ")";
 		}
+		if (node.getResultType() != nullptr)
+			ss << " : " << node.getResultType()->getToken().str;
 		ss << ";" << std::endl;
 
 		currentScopeLevel++;
@@ -117,6 +168,8 @@ namespace Pascal
 	
 	void CodePrettifier::visitParamNode(const AST::ParamNode &node)
 	{
+		if (node.getMode().type != TokenType::NONE)
+			ss << node.getMode().str << " ";
 		ss << node.getVar().getToken().str << currentScopeLevel << " : " <<
 			node.getType().getToken().str;
 	}
@@ -133,11 +186,161 @@ namespace Pascal
 					ss << ", ";
 			}
 		}
-		ss << ");";
+		ss << (node.isFunctionCall() ? ")" : ");");
+	}
+
+	void CodePrettifier::visitWhileNode(AST::WhileNode const& node)
+	{
+		ss << "while ";
+		node.getCondition().accept(this);
+		ss << " do ";
+		currentScopeLevel++;
+		node.getBody().accept(this);
+		currentScopeLevel--;
+	}
+
+	void CodePrettifier::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		ss << "repeat" << std::endl;
+		for (auto const& e : node.getStatements())
+		{
+			ss << std::string((currentScopeLevel+1)*4, ' ');
+			e->accept(this);
+		}
+		ss << std::endl << std::string(currentScopeLevel*4, ' ') << "until ";
+		node.getCondition().accept(this);
+		ss << ";" << std::endl;
+	}
+
+	void CodePrettifier::visitForNode(AST::ForNode const& node)
+	{
+		ss << "for ";
+		node.getVar().accept(this);
+		ss << " := ";
+		node.getFrom().accept(this);
+		ss << ((node.isDownto()) ? (" downto ") : (" to "));
+		node.getTo().accept(this);
+		ss << " do ";
+		currentScopeLevel++;
+		node.getBody().accept(this);
+		currentScopeLevel--;
+	}
+
+	void CodePrettifier::visitIfNode(AST::IfNode const& node)
+	{
+		ss << "if ";
+		node.getCondition().accept(this);
+		ss << " then ";
+		currentScopeLevel++;
+		node.getThen().accept(this);
+		currentScopeLevel--;
+
+		if (node.getElse() != nullptr)
+		{
+			// The statement before 'else' takes no semicolon.
+			std::string text = ss.str();
+			size_t last = text.find_last_not_of("\n");
+			if (last != std::string::npos && text[last] == ';')
+				ss.seekp(last);
+			ss << std::endl << std::string(currentScopeLevel*4, ' ') << "else ";
+			currentScopeLevel++;
+			node.getElse()->accept(this);
+			currentScopeLevel--;
+		}
+	}
+
+	void CodePrettifier::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		ss << node.getToken().str;
+	}
+
+	void CodePrettifier::visitCaseNode(AST::CaseNode const& node)
+	{
+		ss << "case ";
+		node.getSelector().accept(this);
+		ss << " of" << std::endl;
+		currentScopeLevel++;
+		for (auto const& branch : node.getBranches())
+		{
+			ss << std::string(currentScopeLevel*4, ' ');
+			for (size_t i = 0; i < branch.labels.size(); i++)
+				ss << ((i == 0) ? "" : ", ") << (branch.labels[i].negative ? "-" : "") << branch.labels[i].literal.str;
+			ss << ": ";
+			currentScopeLevel++;
+			branch.statement->accept(this);
+			currentScopeLevel--;
+		}
+		if (node.getElse() != nullptr)
+		{
+			ss << std::string(currentScopeLevel*4, ' ') << "else ";
+			currentScopeLevel++;
+			node.getElse()->accept(this);
+			currentScopeLevel--;
+		}
+		currentScopeLevel--;
+		ss << std::endl << std::string(currentScopeLevel*4, ' ') << "end;" << std::endl;
 	}
 
 	std::string CodePrettifier::toString() const
 	{
 		return ss.str();
 	}
+
+	void CodePrettifier::visitIndexNode(AST::IndexNode const& node)
+	{
+		node.getVar().accept(this);
+		ss << "[";
+		node.getIndex().accept(this);
+		ss << "]";
+	}
+
+	void CodePrettifier::visitStringNode(AST::StringNode const& node)
+	{
+		ss << "'";
+		for (char ch : node.getToken().str)
+			ss << ((ch == '\'') ? "''" : std::string(1, ch));
+		ss << "'";
+	}
+
+	void CodePrettifier::visitSetNode(AST::SetNode const& node)
+	{
+		ss << "[";
+		for (size_t i = 0; i < node.getElements().size(); i++)
+		{
+			auto const& e = node.getElements()[i];
+			if (i != 0)
+				ss << ", ";
+			e.low->accept(this);
+			if (e.high != nullptr)
+			{
+				ss << "..";
+				e.high->accept(this);
+			}
+		}
+		ss << "]";
+	}
+
+	void CodePrettifier::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{
+		ss << node.getName().str << " = ";
+		node.getType().accept(this);
+		ss << ";";
+	}
+
+	void CodePrettifier::visitFieldNode(AST::FieldNode const& node)
+	{
+		if (node.getElement() != nullptr)
+			node.getElement()->accept(this);
+		else
+			node.getVar().accept(this);
+		if (node.isDereference())
+			ss << "^";
+		for (auto const& e : node.getFields())
+			ss << "." << e.str;
+	}
+
+	void CodePrettifier::visitNilNode(AST::NilNode const& node)
+	{
+		ss << "nil";
+	}
 }
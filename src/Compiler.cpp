@@ -0,0 +1,1412 @@
+#include <pscpch.hpp>
+#include <Compiler.hpp>
+#include <AST.hpp>
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace Pascal
+{
+	// Case dispatch: up to this many labels are compared one by one, and a
+	// jump table may have this many entries per label.
+	static const size_t CASE_LIST_MAX = 4;
+	static const unsigned long CASE_TABLE_SPREAD = 3;
+
+	void Compiler::visitProgramNode(AST::ProgramNode const& node)
+	{
+		ProcedureCode main;
+		main.name = node.getName().str;
+		main.type = ARType::PROGRAM;
+		main.nestingLevel = 1;
+		main.paramsCount = 0;
+		main.entry = 0;
+
+		m_CurrentProc = m_Code.addProcedure(main);
+		m_CurrentLevel = 1;
+		m_Depth = 0;
+
+		node.getBlock().accept(this);
+	}
+
+	void Compiler::visitVarDeclNode(AST::VarDeclNode const& node)
+	{
+		defineSlot(*node.getVar().getSymbol());
+	}
+
+	void Compiler::visitBlockNode(AST::BlockNode const& node)
+	{
+		currentProc().slotsInit.resize(node.getFrameSize(), Value::None());
+		currentProc().slotsNames.resize(node.getFrameSize());
+		currentProc().arrayLengths.resize(node.getFrameSize(), 0);
+		currentProc().recordFields.resize(node.getFrameSize());
+
+		for (auto const& e : node.getVarDecls())
+			e->accept(this);
+
+		for (auto const& e : node.getProcDecls())
+			e->accept(this);
+
+		// A function returns its result after its last statement, a call
+		// there isn't the last thing it does.
+		currentProc().entry = m_Code.getCode().size();
+		m_TailPosition = (currentProc().type == ARType::PROCEDURE);
+		node.getCompound().accept(this);
+		m_TailPosition = false;
+
+		if (currentProc().type == ARType::PROGRAM)
+			emit(OpCode::HALT);
+		else if (currentProc().type == ARType::FUNCTION)
+			emit(OpCode::RET_VALUE, m_Result->getSlot());
+		else
+			emit(OpCode::RET);
+	}
+
+	void Compiler::visitTypeNode(AST::TypeNode const& node)
+	{ }
+
+	void Compiler::visitStatementNode(AST::StatementNode const& node)
+	{
+		node.accept(this);
+	}
+
+	void Compiler::visitCompoundNode(AST::CompoundNode const& node)
+	{
+		bool tail = m_TailPosition;
+		std::vector<std::unique_ptr<AST::StatementNode>> const& statements = node.getStatements();
+		for (size_t i = 0; i < statements.size(); i++)
+		{
+			m_TailPosition = tail && i + 1 == statements.size();
+			statements[i]->accept(this);
+		}
+		m_TailPosition = tail;
+	}
+
+	void Compiler::visitAssignmentNode(AST::AssignmentNode const& node)
+	{
+		if (node.getRecord() != nullptr)
+		{
+			emitCopy(node);
+			return;
+		}
+
+		if (node.getField() != nullptr && node.getField()->isDereference())
+		{
+			AST::FieldNode const& field = *node.getField();
+			emitPointer(field);
+			node.getExpr().accept(this);
+			emit(OpCode::STORE_REF, field.getOffset(), 0, field.getPos());
+			return;
+		}
+
+		if (node.getField() != nullptr)
+		{
+			AST::FieldNode const& field = *node.getField();
+			if (field.getElement() != nullptr)
+				emitIndex(*field.getElement());
+			else if (field.getVar().getSymbol()->isReference())
+				emitReference(*field.getVar().getSymbol(), field.getVar().getToken().pos);
+			node.getExpr().accept(this);
+			emitAccess(*field.getVar().getSymbol(), field.getElement(), field.getOffset(), true, field.getPos());
+			return;
+		}
+
+		if (node.getElement() != nullptr)
+		{
+			emitIndex(*node.getElement());
+			node.getExpr().accept(this);
+			emitElement(*node.getVar().getSymbol(), true, node.getElement()->getBracket().pos);
+			return;
+		}
+
+		if (node.getVar().getSymbol()->isReference())
+			emitReference(*node.getVar().getSymbol(), node.getVar().getToken().pos);
+		node.getExpr().accept(this);
+		emitStore(*node.getVar().getSymbol(), node.getVar().getToken().pos);
+	}
+
+	void Compiler::visitVariableNode(AST::VariableNode const& node)
+	{
+		if (node.getCall() != nullptr)
+		{
+			node.getCall()->accept(this);
+			return;
+		}
+		emitDesignator(*node.getSymbol(), nullptr, 0, node.getToken().pos);
+	}
+
+	void Compiler::visitNullStatementNode(AST::NullStatementNode const& node)
+	{ }
+
+	void Compiler::visitNumberNode(AST::NumberNode const& node)
+	{
+		if (node.isBig())
+			emit(OpCode::CONST, m_Code.addBigInt(node.getToken().str), 0, node.getToken().pos);
+		else
+			emit(OpCode::CONST, m_Code.addConstant(numberValue(node)), 0, node.getToken().pos);
+	}
+
+	void Compiler::visitBinOpNode(AST::BinOpNode const& node)
+	{
+		Branch* branch = m_Branch;
+		m_Branch = nullptr;
+
+		size_t pos = node.getOperation().pos;
+		TokenType type = node.getOperation().type;
+		if (type == TokenType::AND || type == TokenType::OR)
+		{
+			if (branch == nullptr)
+			{
+				// The paths meet with no new value on the stack. The slot is
+				// written after both operands ran, so nested ones may use it.
+				if (m_BooleanSlot < 0)
+				{
+					m_BooleanSlot = currentProc().slotsInit.size();
+					currentProc().slotsInit.push_back(Value::Boolean(false));
+				}
+
+				std::vector<size_t> jumps;
+				emitBranch(node, false, jumps, pos);
+				emit(OpCode::CONST, m_Code.addConstant(Value::Boolean(true)), 0, pos);
+				emit(OpCode::STORE_LOCAL, m_BooleanSlot, 0, pos);
+				size_t end = emit(OpCode::JUMP);
+				patchAll(jumps, m_Code.getCode().size());
+				emit(OpCode::CONST, m_Code.addConstant(Value::Boolean(false)), 0, pos);
+				emit(OpCode::STORE_LOCAL, m_BooleanSlot, 0, pos);
+				patch(end, m_Code.getCode().size());
+				emit(OpCode::LOAD_LOCAL, m_BooleanSlot, 0, pos);
+				return;
+			}
+
+			// A false operand decides an 'and', a true one an 'or'. When
+			// that is the outcome jumped on, both operands jump straight
+			// there, otherwise the left one skips the right one.
+			bool jumpIf = branch->jumpIf;
+			if (jumpIf != (type == TokenType::AND))
+			{
+				emitBranch(node.getLeft(), jumpIf, *branch->jumps, pos);
+				emitBranch(node.getRight(), jumpIf, *branch->jumps, pos);
+			}
+			else
+			{
+				std::vector<size_t> skip;
+				emitBranch(node.getLeft(), !jumpIf, skip, pos);
+				emitBranch(node.getRight(), jumpIf, *branch->jumps, pos);
+				patchAll(skip, m_Code.getCode().size());
+			}
+			branch->done = true;
+			return;
+		}
+
+		node.getLeft().accept(this);
+		node.getRight().accept(this);
+
+		switch (type)
+		{
+		case TokenType::PLUS:
+			emit(arithmetic(OpCode::ADD, OpCode::ADD_CHECKED, node.getOperation()), 0, 0, pos);
+			break;
+		case TokenType::MINUS:
+			emit(arithmetic(OpCode::SUB, OpCode::SUB_CHECKED, node.getOperation()), 0, 0, pos);
+			break;
+		case TokenType::PRODUCT:
+			emit(arithmetic(OpCode::MUL, OpCode::MUL_CHECKED, node.getOperation()), 0, 0, pos);
+			break;
+		case TokenType::DIVISION:
+			emit(arithmetic(OpCode::DIV, OpCode::DIV_CHECKED, node.getOperation()), 0, 0, pos);
+			break;
+		case TokenType::MOD:
+			emit(OpCode::MOD, 0, 0, pos);
+			break;
+		case TokenType::EQUAL:
+			emitRelation(OpCode::EQ, OpCode::JUMP_EQ, OpCode::JUMP_NE, branch, pos);
+			break;
+		case TokenType::NOT_EQUAL:
+			emitRelation(OpCode::NE, OpCode::JUMP_NE, OpCode::JUMP_EQ, branch, pos);
+			break;
+		case TokenType::LESS:
+			emitRelation(OpCode::LT, OpCode::JUMP_LT, OpCode::JUMP_GE, branch, pos);
+			break;
+		case TokenType::LESS_EQUAL:
+			emitRelation(OpCode::LE, OpCode::JUMP_LE, OpCode::JUMP_GT, branch, pos);
+			break;
+		case TokenType::GREATER:
+			emitRelation(OpCode::GT, OpCode::JUMP_GT, OpCode::JUMP_LE, branch, pos);
+			break;
+		case TokenType::GREATER_EQUAL:
+			emitRelation(OpCode::GE, OpCode::JUMP_GE, OpCode::JUMP_LT, branch, pos);
+			break;
+		case TokenType::IN:
+			emit(OpCode::IN, 0, 0, pos);
+			break;
+		default:
+			throw std::runtime_error("unbelivable");
+		}
+	}
+
+	void Compiler::visitUnaryOpNode(AST::UnaryOpNode const& node)
+	{
+		Branch* branch = m_Branch;
+		m_Branch = nullptr;
+
+		size_t pos = node.getOperation().pos;
+		if (branch != nullptr && node.getOperation().type == TokenType::NOT)
+		{
+			emitBranch(node.getExpr(), !branch->jumpIf, *branch->jumps, pos);
+			branch->done = true;
+			return;
+		}
+
+		node.getExpr().accept(this);
+		switch (node.getOperation().type)
+		{
+		case TokenType::PLUS:
+			break;
+		case TokenType::MINUS:
+			emit(arithmetic(OpCode::NEG, OpCode::NEG_CHECKED, node.getOperation()), 0, 0, pos);
+			break;
+		case TokenType::NOT:
+			emit(OpCode::NOT, 0, 0, pos);
+			break;
+		default:
+			throw std::runtime_error("unbelivable");
+		}
+	}
+
+	void Compiler::visitProcDeclNode(AST::ProcDeclNode const& node)
+	{
+		ProcedureCode proc;
+		proc.name = node.getProcName().str;
+		proc.type = node.getSymbol()->isFunction() ? ARType::FUNCTION : ARType::PROCEDURE;
+		proc.nestingLevel = m_CurrentLevel + 1;
+		proc.paramsCount = node.getParams().size();
+		proc.entry = 0;
+		proc.slotsInit.resize(node.getBlock().getFrameSize(), Value::None());
+		proc.slotsNames.resize(node.getBlock().getFrameSize());
+		proc.arrayLengths.resize(node.getBlock().getFrameSize(), 0);
+		proc.recordFields.resize(node.getBlock().getFrameSize());
+
+		unsigned oldProc = m_CurrentProc;
+		int oldDepth = m_Depth;
+		unsigned oldGrowth = m_Growth;
+		std::map<const ProcedureSymbol*, int32_t> oldBases;
+		oldBases.swap(m_InlineBases);
+		std::vector<int32_t> oldLimits;
+		oldLimits.swap(m_LimitSlots);
+		int32_t oldBooleanSlot = m_BooleanSlot;
+		int32_t oldCopySlots = m_CopySlots;
+		const VariableSymbol* oldResult = m_Result;
+
+		m_CurrentProc = m_Code.addProcedure(proc);
+		m_ProcIndices[node.getSymbol().get()] = m_CurrentProc;
+		m_CurrentLevel++;
+		m_Depth = 0;
+		m_Growth = 0;
+		m_BooleanSlot = -1;
+		m_CopySlots = -1;
+
+		for (auto const& e : node.getParams())
+			e->accept(this);
+		m_Result = node.getSymbol()->getResult().get();
+		if (m_Result != nullptr)
+			defineSlot(*m_Result);
+
+		node.getBlock().accept(this);
+
+		m_CurrentLevel--;
+		m_CurrentProc = oldProc;
+		m_Depth = oldDepth;
+		m_Growth = oldGrowth;
+		m_InlineBases.swap(oldBases);
+		m_LimitSlots.swap(oldLimits);
+		m_BooleanSlot = oldBooleanSlot;
+		m_CopySlots = oldCopySlots;
+		m_Result = oldResult;
+	}
+
+	void Compiler::visitParamNode(const AST::ParamNode &node)
+	{
+		defineSlot(*node.getVar().getSymbol());
+	}
+
+	void Compiler::visitProcCallNode(const AST::ProcCallNode& node)
+	{
+		m_Branch = nullptr;
+		if (node.getBuiltin() != nullptr)
+		{
+			emitBuiltin(node);
+			return;
+		}
+
+		ProcedureSymbol const& sym = *node.getSymbol();
+
+		if (m_Inliner != nullptr)
+		{
+			// The calls in an inlined body were counted in its expanded size.
+			AST::ProcDeclNode const* decl = m_Inliner->getInlinable(sym);
+			if (decl != nullptr && (m_InlineDepth > 0 ||
+				m_Growth + m_Inliner->getExpandedSize(sym) <= m_Inliner->getMaxGrowth()))
+			{
+				emitInline(node, *decl);
+				return;
+			}
+		}
+
+		size_t args = m_Code.getCode().size();
+		for (unsigned i = 0; i < node.getArguments().size(); i++)
+		{
+			m_Address = sym.getArgs()[i]->isReference();
+			node.getArguments()[i]->accept(this);
+			if (!sym.getArgs()[i]->isReference())
+				emitConversion(sym.getArgs()[i]->getParent());
+		}
+
+		// A callee nested in this procedure would still need its frame, as
+		// would references to its slots. Functions are called from
+		// expressions, which the caller goes on with.
+		bool tail = m_TailPosition && !sym.isFunction() && sym.getScopeLevel() <= m_CurrentLevel;
+		for (size_t i = args; i < m_Code.getCode().size(); i++)
+		{
+			if (m_Code.getCode()[i].op == OpCode::REF_LOCAL)
+				tail = false;
+		}
+		OpCode call = tail ? OpCode::TAIL_CALL : OpCode::CALL;
+		emit(call, m_ProcIndices.at(&sym), 0, node.getProcName().pos);
+	}
+
+	// The condition is tested at the bottom, one jump per iteration.
+	void Compiler::visitWhileNode(AST::WhileNode const& node)
+	{
+		bool tail = m_TailPosition;
+		m_TailPosition = false;
+
+		size_t jump = emit(OpCode::JUMP);
+		size_t body = m_Code.getCode().size();
+		node.getBody().accept(this);
+
+		patch(jump, m_Code.getCode().size());
+		std::vector<size_t> jumps;
+		emitBranch(node.getCondition(), true, jumps, node.getKeyword().pos);
+		patchAll(jumps, body);
+
+		m_TailPosition = tail;
+	}
+
+	void Compiler::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		bool tail = m_TailPosition;
+		m_TailPosition = false;
+
+		size_t body = m_Code.getCode().size();
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+		std::vector<size_t> jumps;
+		emitBranch(node.getCondition(), false, jumps, node.getKeyword().pos);
+		patchAll(jumps, body);
+
+		m_TailPosition = tail;
+	}
+
+	// The limit is evaluated once into a hidden slot, FOR_INIT and FOR_NEXT
+	// then compare and step the variable's slot in place. The accesses that
+	// stay in bounds for a range of the variable (see ForNode::getIndexing)
+	// skip their checks, when the range isn't known to be kept the body is
+	// compiled twice: the unchecked copy runs if the first and the last
+	// value of the variable are in the range, the checked one otherwise.
+	void Compiler::visitForNode(AST::ForNode const& node)
+	{
+		bool tail = m_TailPosition;
+		m_TailPosition = false;
+
+		if (m_ForDepth == m_LimitSlots.size())
+		{
+			m_LimitSlots.push_back(currentProc().slotsInit.size());
+			currentProc().slotsInit.push_back(Value::Integer(0));
+		}
+		int32_t limit = m_LimitSlots[m_ForDepth];
+
+		VariableSymbol const& var = *node.getVar().getSymbol();
+		size_t pos = node.getKeyword().pos;
+
+		node.getFrom().accept(this);
+		node.getTo().accept(this);
+		emit(OpCode::STORE_LOCAL, limit, 0, pos);
+		emitStore(var, node.getVar().getToken().pos);
+
+		size_t vector;
+		bool vectorized = emitVector(node, limit, vector);
+
+		size_t init = emit(node.isDownto() ? OpCode::FOR_INIT_DN : OpCode::FOR_INIT,
+						   0, localSlot(var), pos);
+		m_Code.getCode()[init].c = limit;
+
+		bool versioned = m_BoundsChecks && !m_CheckedCopy &&
+			node.getIndexing() == AST::ForNode::Indexing::GUARDED;
+		std::vector<size_t> checked;
+		if (versioned)
+		{
+			int32_t low = localSlot(var);
+			int32_t high = limit;
+			if (node.isDownto())
+				std::swap(low, high);
+
+			emit(OpCode::LOAD_LOCAL, low, 0, pos);
+			emit(OpCode::CONST, m_Code.addConstant(Value::Integer(node.getIndexLow())), 0, pos);
+			checked.push_back(emit(OpCode::JUMP_LT, 0, 0, pos));
+			emit(OpCode::LOAD_LOCAL, high, 0, pos);
+			emit(OpCode::CONST, m_Code.addConstant(Value::Integer(node.getIndexHigh())), 0, pos);
+			checked.push_back(emit(OpCode::JUMP_GT, 0, 0, pos));
+		}
+
+		if (versioned || node.getIndexing() == AST::ForNode::Indexing::PROVEN)
+			m_InBounds.insert(&node);
+		emitForBody(node, limit);
+		m_InBounds.erase(&node);
+
+		if (versioned)
+		{
+			size_t end = emit(OpCode::JUMP);
+			patchAll(checked, m_Code.getCode().size());
+
+			m_CheckedCopy = true;
+			emitForBody(node, limit);
+			m_CheckedCopy = false;
+			patch(end, m_Code.getCode().size());
+		}
+		patch(init, m_Code.getCode().size());
+		if (vectorized)
+			patch(vector, m_Code.getCode().size());
+
+		m_TailPosition = tail;
+	}
+
+	// Both branches inherit the tail position, the condition doesn't.
+	void Compiler::visitIfNode(AST::IfNode const& node)
+	{
+		bool tail = m_TailPosition;
+		m_TailPosition = false;
+		std::vector<size_t> jumps;
+		emitBranch(node.getCondition(), false, jumps, node.getKeyword().pos);
+		m_TailPosition = tail;
+
+		node.getThen().accept(this);
+		if (node.getElse() != nullptr)
+		{
+			size_t end = emit(OpCode::JUMP);
+			patchAll(jumps, m_Code.getCode().size());
+			node.getElse()->accept(this);
+			patch(end, m_Code.getCode().size());
+		}
+		else
+		{
+			patchAll(jumps, m_Code.getCode().size());
+		}
+	}
+
+	void Compiler::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		Branch* branch = m_Branch;
+		m_Branch = nullptr;
+
+		if (branch != nullptr)
+		{
+			if (node.getValue() == branch->jumpIf)
+				branch->jumps->push_back(emit(OpCode::JUMP, 0, 0, node.getToken().pos));
+			branch->done = true;
+			return;
+		}
+
+		emit(OpCode::CONST, m_Code.addConstant(Value::Boolean(node.getValue())), 0, node.getToken().pos);
+	}
+
+	// A few labels are compared one by one, dense ones index a jump table
+	// and the others are binary searched. The entries jump to the branches,
+	// which all inherit the tail position, the selector doesn't.
+	void Compiler::visitCaseNode(AST::CaseNode const& node)
+	{
+		bool tail = m_TailPosition;
+		m_TailPosition = false;
+		node.getSelector().accept(this);
+		m_TailPosition = tail;
+
+		std::vector<AST::CaseNode::Branch> const& branches = node.getBranches();
+		std::vector<std::pair<long, size_t>> labels;
+		for (size_t i = 0; i < branches.size(); i++)
+		{
+			for (auto const& label : branches[i].labels)
+				labels.push_back({ label.getValue(), i });
+		}
+		std::sort(labels.begin(), labels.end());
+
+		OpCode op = OpCode::CASE_LIST;
+		unsigned long count = labels.size();
+		if (labels.size() > CASE_LIST_MAX)
+		{
+			unsigned long span = static_cast<unsigned long>(labels.back().first) -
+				static_cast<unsigned long>(labels.front().first) + 1;
+			if (span <= CASE_TABLE_SPREAD * labels.size())
+			{
+				op = OpCode::CASE_TABLE;
+				count = span;
+			}
+			else
+			{
+				op = OpCode::CASE_FIND;
+			}
+		}
+
+		size_t pos = node.getKeyword().pos;
+		emit(op, count, 0, pos);
+
+		// Code index of every entry and the branch it goes to, the default
+		// one goes past the last branch.
+		std::vector<std::pair<size_t, size_t>> entries;
+		int32_t low = (op == OpCode::CASE_TABLE) ?
+			m_Code.addConstant(Value::Integer(labels.front().first)) : 0;
+		entries.push_back({ emit(OpCode::JUMP, 0, low, pos), branches.size() });
+		if (op == OpCode::CASE_TABLE)
+		{
+			size_t next = 0;
+			for (unsigned long i = 0; i < count; i++)
+			{
+				long value = labels.front().first + static_cast<long>(i);
+				size_t branch = branches.size();
+				if (labels[next].first == value)
+					branch = labels[next++].second;
+				entries.push_back({ emit(OpCode::JUMP, 0, 0, pos), branch });
+			}
+		}
+		else
+		{
+			for (auto const& e : labels)
+			{
+				int32_t label = m_Code.addConstant(Value::Integer(e.first));
+				entries.push_back({ emit(OpCode::JUMP, 0, label, pos), e.second });
+			}
+		}
+
+		std::vector<size_t> starts;
+		std::vector<size_t> ends;
+		for (size_t i = 0; i < branches.size(); i++)
+		{
+			starts.push_back(m_Code.getCode().size());
+			branches[i].statement->accept(this);
+			if (i + 1 < branches.size() || node.getElse() != nullptr)
+				ends.push_back(emit(OpCode::JUMP));
+		}
+		starts.push_back(m_Code.getCode().size());
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+
+		for (auto const& e : entries)
+			patch(e.first, starts[e.second]);
+		patchAll(ends, m_Code.getCode().size());
+	}
+
+	// A boolean element is tested like a variable, its value is pushed.
+	void Compiler::visitIndexNode(AST::IndexNode const& node)
+	{
+		m_Branch = nullptr;
+		VariableSymbol const& sym = *node.getVar().getSymbol();
+		if (typedZero(sym.getParent()).isString())
+		{
+			emitLoad(sym, node.getVar().getToken().pos);
+			node.getIndex().accept(this);
+			emit(OpCode::CHAR_AT, 0, 0, node.getBracket().pos);
+			return;
+		}
+
+		emitDesignator(sym, &node, 0, node.getBracket().pos);
+	}
+
+	void Compiler::visitStringNode(AST::StringNode const& node)
+	{
+		emit(OpCode::CONST, m_Code.addString(node.getToken().str), 0, node.getToken().pos);
+	}
+
+	void Compiler::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{ }
+
+	// A boolean field is tested like a variable, its value is pushed. The
+	// fields of an object are reached through the pointer, read again for
+	// each part of a record copied.
+	void Compiler::visitFieldNode(AST::FieldNode const& node)
+	{
+		m_Branch = nullptr;
+		if (!node.isDereference())
+		{
+			emitDesignator(*node.getVar().getSymbol(), node.getElement(), node.getOffset(), node.getPos());
+			return;
+		}
+
+		bool address = m_Address;
+		int part = std::max(m_CopyPart, 0);
+		m_Address = false;
+		m_CopyPart = -1;
+		emitPointer(node);
+		if (address)
+		{
+			emit(OpCode::CONST, m_Code.addConstant(Value::Integer(0)), 0, node.getPos());
+			emit(OpCode::REF_INDEX, node.getOffset(), 0, node.getPos());
+			return;
+		}
+		emit(OpCode::LOAD_REF, node.getOffset() + part, 0, node.getPos());
+	}
+
+	void Compiler::visitNilNode(AST::NilNode const& node)
+	{
+		emit(OpCode::CONST, m_Code.addConstant(Value::Pointer(nullptr)), 0, node.getToken().pos);
+	}
+
+	// The literal elements are folded into one constant set at compile
+	// time. The others are pushed, ranges as low, high pairs before the
+	// single elements (Pascal leaves the order unspecified), and added to it.
+	void Compiler::visitSetNode(AST::SetNode const& node)
+	{
+		m_Branch = nullptr;
+
+		SetBits constant = SetBits::EMPTY;
+		std::vector<AST::SetNode::Element const*> ranges;
+		std::vector<AST::SetNode::Element const*> singles;
+		for (auto const& e : node.getElements())
+		{
+			long low = 0;
+			long high = 0;
+			if (!e.isConstant() || !AST::SetNode::literalValue(e.lowLiteral, low) ||
+				(e.high != nullptr && !AST::SetNode::literalValue(e.highLiteral, high)))
+			{
+				(e.high != nullptr ? ranges : singles).push_back(&e);
+				continue;
+			}
+
+			if (e.high == nullptr)
+				high = low;
+			if (low <= high)
+				constant.insert(low, std::min(high, SetBits::MAX_ELEMENT));
+			constant.chars = constant.chars || e.lowLiteral.type == TokenType::STRING_LITERAL;
+		}
+
+		for (auto e : ranges)
+		{
+			e->low->accept(this);
+			e->high->accept(this);
+		}
+		for (auto e : singles)
+			e->low->accept(this);
+
+		unsigned bits = m_Code.addSet(constant);
+		if (ranges.empty() && singles.empty())
+		{
+			emit(OpCode::CONST, bits, 0, node.getBracket().pos);
+			return;
+		}
+		size_t build = emit(OpCode::SET_BUILD, 2 * ranges.size() + singles.size(), bits, node.getBracket().pos);
+		m_Code.getCode()[build].c = singles.size();
+	}
+
+	// Compiles a condition as jumps taken when it comes out 'jumpIf',
+	// appended to 'jumps', falling through otherwise. Relations become
+	// compare-and-jumps and 'and', 'or' and 'not' only route the jumps,
+	// so no boolean is pushed for them.
+	void Compiler::emitBranch(AST::Node const& node, bool jumpIf, std::vector<size_t>& jumps, size_t pos)
+	{
+		Branch branch = { jumpIf, &jumps, false };
+		m_Branch = &branch;
+		node.accept(this);
+		m_Branch = nullptr;
+
+		if (!branch.done)
+			jumps.push_back(emit(jumpIf ? OpCode::JUMP_TRUE : OpCode::JUMP_FALSE, 0, 0, pos));
+	}
+
+	// The complement relation is the one jumped on when the branch is
+	// taken on false, see compare().
+	void Compiler::emitRelation(OpCode op, OpCode jumpIfTrue, OpCode jumpIfFalse, Branch* branch, size_t pos)
+	{
+		if (branch == nullptr)
+		{
+			emit(op, 0, 0, pos);
+			return;
+		}
+
+		branch->jumps->push_back(emit(branch->jumpIf ? jumpIfTrue : jumpIfFalse, 0, 0, pos));
+		branch->done = true;
+	}
+
+	// An argument bound to a value parameter is widened the way assign()
+	// widens what a store puts into a slot of the parameter's type.
+	void Compiler::emitConversion(std::shared_ptr<const Symbol> const& type)
+	{
+		Value zero = typedZero(type);
+		if (zero.isReal())
+			emit(OpCode::TO_REAL);
+		else if (zero.isBigInt())
+			emit(OpCode::TO_BIG);
+	}
+
+	// Binds the arguments like CALL does and zeroes the locals that may be
+	// read before they are assigned, then compiles the callee's body with
+	// its variables in the caller's frame. A function's result is pushed
+	// from its slot there, the expression the call is in goes on.
+	void Compiler::emitInline(AST::ProcCallNode const& node, AST::ProcDeclNode const& decl)
+	{
+		ProcedureSymbol const& sym = *node.getSymbol();
+		if (m_InlineDepth == 0)
+			m_Growth += m_Inliner->getExpandedSize(sym);
+
+		auto found = m_InlineBases.find(&sym);
+		int32_t base;
+		if (found != m_InlineBases.end())
+		{
+			base = found->second;
+		}
+		else
+		{
+			base = currentProc().slotsInit.size();
+			m_InlineBases[&sym] = base;
+			currentProc().slotsInit.resize(base + decl.getBlock().getFrameSize(), Value::None());
+		}
+
+		std::vector<const VariableSymbol*> vars;
+		for (auto const& e : decl.getParams())
+			vars.push_back(e->getVar().getSymbol().get());
+		for (auto const& e : decl.getBlock().getVarDecls())
+			vars.push_back(e->getVar().getSymbol().get());
+		if (sym.isFunction())
+			vars.push_back(sym.getResult().get());
+
+		// An argument may inline the same function, which unbinds its slots.
+		for (unsigned i = 0; i < node.getArguments().size(); i++)
+		{
+			node.getArguments()[i]->accept(this);
+			emitConversion(sym.getArgs()[i]->getParent());
+		}
+
+		for (auto var : vars)
+		{
+			currentProc().slotsInit[base + var->getSlot()] = typedZero(var->getParent());
+			m_InlineSlots[var] = base + var->getSlot();
+		}
+		for (unsigned i = decl.getParams().size(); i-- > 0; )
+			emitStore(*vars[i], node.getProcName().pos);
+
+		for (unsigned i = decl.getParams().size(); i < vars.size(); i++)
+		{
+			if (!m_Inliner->needsReset(sym, *vars[i]))
+				continue;
+
+			emit(OpCode::CONST, m_Code.addConstant(typedZero(vars[i]->getParent())));
+			emitStore(*vars[i], node.getProcName().pos);
+		}
+
+		bool tail = m_TailPosition;
+		m_TailPosition = tail && !sym.isFunction();
+		m_InlineDepth++;
+		decl.getBlock().getCompound().accept(this);
+		m_InlineDepth--;
+		m_TailPosition = tail;
+
+		if (sym.isFunction())
+		{
+			emitLoad(*sym.getResult(), node.getProcName().pos);
+			m_Branch = nullptr;
+		}
+
+		for (auto var : vars)
+			m_InlineSlots.erase(var);
+
+		// The checked copy of a loop body inlines the same calls again.
+		if (!m_CheckedCopy)
+			m_Inliner->addInlined(sym, currentProc().name, node.getProcName().pos);
+	}
+
+	size_t Compiler::emit(OpCode op, int32_t a, int32_t b, size_t pos)
+	{
+		switch (op)
+		{
+		case OpCode::CONST:
+		case OpCode::LOAD_LOCAL:
+		case OpCode::LOAD_GLOBAL:
+		case OpCode::LOAD_OUTER:
+		case OpCode::REF_LOCAL:
+		case OpCode::REF_GLOBAL:
+		case OpCode::REF_OUTER:
+			m_Depth++;
+			break;
+		case OpCode::STORE_LOCAL:
+		case OpCode::STORE_GLOBAL:
+		case OpCode::STORE_OUTER:
+		case OpCode::ADD:
+		case OpCode::SUB:
+		case OpCode::MUL:
+		case OpCode::DIV:
+		case OpCode::MOD:
+		case OpCode::ADD_CHECKED:
+		case OpCode::SUB_CHECKED:
+		case OpCode::MUL_CHECKED:
+		case OpCode::DIV_CHECKED:
+		case OpCode::JUMP_FALSE:
+		case OpCode::JUMP_TRUE:
+		case OpCode::EQ:
+		case OpCode::NE:
+		case OpCode::LT:
+		case OpCode::LE:
+		case OpCode::GT:
+		case OpCode::GE:
+		case OpCode::CASE_LIST:
+		case OpCode::CASE_FIND:
+		case OpCode::CASE_TABLE:
+		case OpCode::CHAR_AT:
+		case OpCode::IN:
+		case OpCode::REF_INDEX:
+		case OpCode::NEW:
+		case OpCode::DISPOSE:
+		case OpCode::WRITE:
+		case OpCode::READ:
+		case OpCode::RESET:
+		case OpCode::REWRITE:
+		case OpCode::CLOSE:
+			m_Depth--;
+			break;
+		case OpCode::FILE_READ:
+		case OpCode::FILE_WRITE:
+			m_Depth -= 1 + a;
+			break;
+		case OpCode::FILE_READLN:
+		case OpCode::FILE_WRITELN:
+			m_Depth -= a;
+			break;
+		case OpCode::AT_EOF:
+			m_Depth += 1 - a;
+			break;
+		case OpCode::JUMP_EQ:
+		case OpCode::JUMP_NE:
+		case OpCode::JUMP_LT:
+		case OpCode::JUMP_LE:
+		case OpCode::JUMP_GT:
+		case OpCode::JUMP_GE:
+		case OpCode::STORE_ELEM:
+		case OpCode::STORE_GELEM:
+		case OpCode::STORE_OELEM:
+		case OpCode::STORE_REF:
+		case OpCode::ASSIGN_FILE:
+			m_Depth -= 2;
+			break;
+		case OpCode::CALL:
+		case OpCode::TAIL_CALL:
+			m_Depth -= m_Code.getProcedures()[a].paramsCount;
+			if (m_Code.getProcedures()[a].type == ARType::FUNCTION)
+				m_Depth++;
+			break;
+		case OpCode::SET_BUILD:
+			m_Depth -= a - 1;
+			break;
+		default:
+			break;
+		}
+
+		if (static_cast<unsigned>(m_Depth) > currentProc().maxStack)
+			currentProc().maxStack = m_Depth;
+
+		return m_Code.emit(op, a, b, pos);
+	}
+
+	// The arguments are pushed like a call's, the routine's opcode takes
+	// them. new and assign take the address of their variable, write
+	// prints each argument as soon as it is computed and read stores into
+	// each one as soon as its address is. A text file to read or write
+	// stays under them, the last opcode pops it.
+	void Compiler::emitBuiltin(AST::ProcCallNode const& node)
+	{
+		Builtin routine = node.getBuiltin()->getRoutine();
+		size_t pos = node.getProcName().pos;
+		auto const& args = node.getArguments();
+		bool reading = (routine == Builtin::READ || routine == Builtin::READLN);
+		if (reading || routine == Builtin::WRITE || routine == Builtin::WRITELN)
+		{
+			bool file = node.hasTextFile();
+			bool line = (routine == Builtin::READLN || routine == Builtin::WRITELN);
+			if (file && args.size() == 1 && !line)
+				return;
+
+			OpCode transfer = reading ? (file ? OpCode::FILE_READ : OpCode::READ) :
+				(file ? OpCode::FILE_WRITE : OpCode::WRITE);
+			for (size_t i = 0; i < args.size(); i++)
+			{
+				m_Address = reading && !(file && i == 0);
+				args[i]->accept(this);
+				if (!file || i != 0)
+					emit(transfer, file && !line && i + 1 == args.size(), 0, pos);
+			}
+			if (line && reading)
+				emit(file ? OpCode::FILE_READLN : OpCode::READLN, file, 0, pos);
+			else if (line)
+				emit(file ? OpCode::FILE_WRITELN : OpCode::WRITELN, file, 0, pos);
+			return;
+		}
+
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			m_Address = (routine == Builtin::NEW) || (routine == Builtin::ASSIGN && i == 0);
+			args[i]->accept(this);
+		}
+
+		switch (routine)
+		{
+		case Builtin::LENGTH:
+			emit(OpCode::LENGTH, 0, 0, pos);
+			break;
+		case Builtin::NEW:
+			emit(OpCode::NEW, layoutOf(node.getPointerType()), 0, pos);
+			break;
+		case Builtin::DISPOSE:
+			emit(OpCode::DISPOSE, m_Code.getLayouts()[layoutOf(node.getPointerType())].size(), 0, pos);
+			break;
+		case Builtin::ASSIGN:
+			emit(OpCode::ASSIGN_FILE, 0, 0, pos);
+			break;
+		case Builtin::RESET:
+			emit(OpCode::RESET, 0, 0, pos);
+			break;
+		case Builtin::REWRITE:
+			emit(OpCode::REWRITE, 0, 0, pos);
+			break;
+		case Builtin::CLOSE:
+			emit(OpCode::CLOSE, 0, 0, pos);
+			break;
+		case Builtin::END_OF_FILE:
+			emit(OpCode::AT_EOF, !args.empty(), 0, pos);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// 'offset' selects a field of a record, records are never inlined
+	// locals (see Inliner). A reference parameter's variable is read
+	// through the reference in its slot.
+	void Compiler::emitLoad(VariableSymbol const& sym, size_t pos, unsigned offset)
+	{
+		if (sym.isReference())
+		{
+			emitReference(sym, pos);
+			emit(OpCode::LOAD_REF, offset, 0, pos);
+			return;
+		}
+
+		auto inlined = m_InlineSlots.find(&sym);
+		if (inlined != m_InlineSlots.end())
+			emit(OpCode::LOAD_LOCAL, inlined->second, 0, pos);
+		else if (sym.getScopeLevel() == m_CurrentLevel)
+			emit(OpCode::LOAD_LOCAL, sym.getSlot() + offset, 0, pos);
+		else if (sym.getScopeLevel() == 1)
+			emit(OpCode::LOAD_GLOBAL, sym.getSlot() + offset, 0, pos);
+		else
+			emit(OpCode::LOAD_OUTER, sym.getScopeLevel(), sym.getSlot() + offset, pos);
+	}
+
+	// The reference of a reference parameter is under the value.
+	void Compiler::emitStore(VariableSymbol const& sym, size_t pos, unsigned offset)
+	{
+		if (sym.isReference())
+		{
+			emit(OpCode::STORE_REF, offset, 0, pos);
+			return;
+		}
+
+		auto inlined = m_InlineSlots.find(&sym);
+		if (inlined != m_InlineSlots.end())
+			emit(OpCode::STORE_LOCAL, inlined->second, 0, pos);
+		else if (sym.getScopeLevel() == m_CurrentLevel)
+			emit(OpCode::STORE_LOCAL, sym.getSlot() + offset, 0, pos);
+		else if (sym.getScopeLevel() == 1)
+			emit(OpCode::STORE_GLOBAL, sym.getSlot() + offset, 0, pos);
+		else
+			emit(OpCode::STORE_OUTER, sym.getScopeLevel(), sym.getSlot() + offset, pos);
+	}
+
+	// Leaves the index on the stack, checked unless an enclosing loop keeps
+	// it in bounds, and scaled to the slots of a record element. The
+	// elements of an array passed by reference are reached through a
+	// reference to element 'low', which is left instead.
+	void Compiler::emitIndex(AST::IndexNode const& node)
+	{
+		VariableSymbol const& sym = *node.getVar().getSymbol();
+		if (sym.isReference())
+			emitReference(sym, node.getBracket().pos);
+		node.getIndex().accept(this);
+
+		const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym.getParent().get());
+		m_ElementAccesses++;
+		if (m_BoundsChecks && !node.getInBounds() && m_InBounds.count(node.getLoop()) == 0)
+		{
+			emit(OpCode::BOUNDS, array->getLow(), array->getHigh(), node.getBracket().pos);
+			m_BoundsCheckCount++;
+		}
+
+		if (array->getStride() != 1)
+		{
+			emit(OpCode::CONST, m_Code.addConstant(Value::Integer(array->getStride())), 0, node.getBracket().pos);
+			emit(OpCode::MUL, 0, 0, node.getBracket().pos);
+		}
+
+		if (sym.isReference())
+			emit(OpCode::REF_INDEX, -array->getLow() * array->getStride(), 0, node.getBracket().pos);
+	}
+
+	// Arrays are never inlined locals (see Inliner), element 'low' is at
+	// the variable's slot. 'offset' selects a field of a record element.
+	void Compiler::emitElement(VariableSymbol const& sym, bool store, size_t pos, unsigned offset)
+	{
+		if (sym.isReference())
+		{
+			emit(store ? OpCode::STORE_REF : OpCode::LOAD_REF, offset, 0, pos);
+			return;
+		}
+
+		const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym.getParent().get());
+		int32_t base = static_cast<int32_t>(sym.getSlot() + offset) - array->getLow() * array->getStride();
+
+		if (sym.getScopeLevel() == m_CurrentLevel)
+			emit(store ? OpCode::STORE_ELEM : OpCode::LOAD_ELEM, base, 0, pos);
+		else if (sym.getScopeLevel() == 1)
+			emit(store ? OpCode::STORE_GELEM : OpCode::LOAD_GELEM, base, 0, pos);
+		else
+			emit(store ? OpCode::STORE_OELEM : OpCode::LOAD_OELEM, sym.getScopeLevel(), base, pos);
+	}
+
+	// The index of an element is on the stack, under the value of a store.
+	void Compiler::emitAccess(VariableSymbol const& sym, AST::IndexNode const* element, unsigned offset,
+							  bool store, size_t pos)
+	{
+		if (element != nullptr)
+			emitElement(sym, store, pos, offset);
+		else if (store)
+			emitStore(sym, pos, offset);
+		else
+			emitLoad(sym, pos, offset);
+	}
+
+	// Pushes the slot 'offset' of a variable or of an array element, or a
+	// reference to it for a reference parameter. While a record is copied
+	// the part copied is added to it, the index of an element is computed
+	// for the first part and kept for the others.
+	void Compiler::emitDesignator(VariableSymbol const& sym, AST::IndexNode const* element,
+								  unsigned offset, size_t pos)
+	{
+		if (m_Address)
+		{
+			m_Address = false;
+			emitAddress(sym, element, offset, pos);
+			return;
+		}
+
+		int part = m_CopyPart;
+		m_CopyPart = -1;
+
+		if (element != nullptr && part <= 0)
+			emitIndex(*element);
+		if (element != nullptr && part == 0)
+			emit(OpCode::STORE_LOCAL, m_CopySlots + 1, 0, pos);
+		if (element != nullptr && part >= 0)
+			emit(OpCode::LOAD_LOCAL, m_CopySlots + 1, 0, pos);
+
+		emitAccess(sym, element, offset + std::max(part, 0), false, pos);
+	}
+
+	// Records are copied a slot at a time, the right side is read again for
+	// each of them (see emitDesignator). Elements are indexed once.
+	void Compiler::emitCopy(AST::AssignmentNode const& node)
+	{
+		if (m_CopySlots < 0)
+		{
+			m_CopySlots = currentProc().slotsInit.size();
+			currentProc().slotsInit.resize(m_CopySlots + 2, Value::Integer(0));
+		}
+
+		AST::FieldNode const* field = node.getField();
+		bool dereference = field != nullptr && field->isDereference();
+		AST::IndexNode const* element = (field != nullptr) ? field->getElement() : node.getElement();
+		if (dereference)
+			element = nullptr;
+		unsigned offset = (field != nullptr) ? field->getOffset() : 0;
+		VariableSymbol const& sym = *node.getVar().getSymbol();
+		size_t pos = node.getVar().getToken().pos;
+
+		if (element != nullptr)
+		{
+			emitIndex(*element);
+			emit(OpCode::STORE_LOCAL, m_CopySlots, 0, pos);
+		}
+
+		unsigned size = RecordTypeSymbol::slotsOf(node.getRecord());
+		for (unsigned k = 0; k < size; k++)
+		{
+			if (dereference)
+				emitPointer(*field);
+			else if (element != nullptr)
+				emit(OpCode::LOAD_LOCAL, m_CopySlots, 0, pos);
+			else if (sym.isReference())
+				emitReference(sym, pos);
+			m_CopyPart = k;
+			node.getExpr().accept(this);
+			m_CopyPart = -1;
+			if (dereference)
+				emit(OpCode::STORE_REF, offset + k, 0, pos);
+			else
+				emitAccess(sym, element, offset + k, true, pos);
+		}
+	}
+
+	// The reference a reference parameter's slot holds.
+	void Compiler::emitReference(VariableSymbol const& sym, size_t pos)
+	{
+		if (sym.getScopeLevel() == m_CurrentLevel)
+			emit(OpCode::LOAD_LOCAL, sym.getSlot(), 0, pos);
+		else if (sym.getScopeLevel() == 1)
+			emit(OpCode::LOAD_GLOBAL, sym.getSlot(), 0, pos);
+		else
+			emit(OpCode::LOAD_OUTER, sym.getScopeLevel(), sym.getSlot(), pos);
+	}
+
+	// Pushes a reference to the slot 'offset' of a variable or of an array
+	// element, the argument of a reference parameter. Reference parameters
+	// are passed on.
+	void Compiler::emitAddress(VariableSymbol const& sym, AST::IndexNode const* element,
+							   unsigned offset, size_t pos)
+	{
+		if (sym.isReference())
+		{
+			if (element != nullptr)
+				emitIndex(*element);
+			else
+				emitReference(sym, pos);
+			if (offset != 0)
+			{
+				emit(OpCode::CONST, m_Code.addConstant(Value::Integer(0)), 0, pos);
+				emit(OpCode::REF_INDEX, offset, 0, pos);
+			}
+			return;
+		}
+
+		int32_t slot = localSlot(sym) + offset;
+		int32_t base = 0;
+		if (element != nullptr)
+		{
+			const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym.getParent().get());
+			slot = sym.getSlot();
+			base = static_cast<int32_t>(offset) - array->getLow() * array->getStride();
+		}
+
+		if (m_InlineSlots.count(&sym) != 0 || sym.getScopeLevel() == m_CurrentLevel)
+			emit(OpCode::REF_LOCAL, slot, 0, pos);
+		else if (sym.getScopeLevel() == 1)
+			emit(OpCode::REF_GLOBAL, slot, 0, pos);
+		else
+			emit(OpCode::REF_OUTER, sym.getScopeLevel(), slot, pos);
+
+		if (element != nullptr)
+		{
+			emitIndex(*element);
+			emit(OpCode::REF_INDEX, base, 0, pos);
+		}
+	}
+
+	// Pushes the pointer a caret follows, checked not to be nil.
+	void Compiler::emitPointer(AST::FieldNode const& node)
+	{
+		VariableSymbol const& sym = *node.getVar().getSymbol();
+		if (node.getElement() != nullptr)
+		{
+			emitIndex(*node.getElement());
+			emitElement(sym, false, node.getElement()->getBracket().pos);
+		}
+		else
+		{
+			emitLoad(sym, node.getVar().getToken().pos);
+		}
+		emit(OpCode::DEREF, 0, 0, node.getCaret().pos);
+	}
+
+	// The objects of a pointer type start as the typed zeros of the fields
+	// of the record it points to, or of its single value.
+	unsigned Compiler::layoutOf(std::shared_ptr<const Symbol> const& pointer)
+	{
+		auto found = m_Layouts.find(pointer.get());
+		if (found != m_Layouts.end())
+			return found->second;
+
+		std::shared_ptr<const Symbol> const& target = reinterpret_cast<const PointerTypeSymbol*>(pointer.get())->getTarget();
+		std::vector<Value> layout;
+		if (target != nullptr && target->getType() == SymbolType::RECORD_TYPE)
+		{
+			for (auto const& e : reinterpret_cast<const RecordTypeSymbol*>(target.get())->getLeaves())
+				layout.push_back(typedZero(e.type));
+		}
+		else
+		{
+			layout.push_back(typedZero(target));
+		}
+
+		unsigned res = m_Code.addLayout(layout);
+		m_Layouts[pointer.get()] = res;
+		return res;
+	}
+
+	void Compiler::emitForBody(AST::ForNode const& node, int32_t limit)
+	{
+		size_t body = m_Code.getCode().size();
+		m_ForDepth++;
+		node.getBody().accept(this);
+		m_ForDepth--;
+
+		size_t next = emit(node.isDownto() ? OpCode::FOR_NEXT_DN : OpCode::FOR_NEXT,
+						   body, localSlot(*node.getVar().getSymbol()), node.getKeyword().pos);
+		m_Code.getCode()[next].c = limit;
+	}
+
+	// The kernel runs the loop from the control variable on, it exits
+	// to the end of the loop if it could run all of it.
+	bool Compiler::emitVector(AST::ForNode const& node, int32_t limit, size_t& vector)
+	{
+		Vectorizer::Match match;
+		if (!m_Vectorize || !m_Vectorizer.match(node, match))
+			return false;
+
+		std::string const& element = match.element->getName();
+		if (element != "integer" && element != "real" &&
+			match.kernel != VectorKernel::COPY && match.kernel != VectorKernel::FILL)
+			return false;
+		// The kernels wrap around on integer overflow.
+		for (const Token_t* operation : match.operations)
+		{
+			if (element == "integer" && checksOverflow(*operation, m_OverflowChecks))
+				return false;
+		}
+
+		VectorLoop loop;
+		loop.kernel = match.kernel;
+		loop.element = typedZero(match.element).type;
+		loop.var = localSlot(*node.getVar().getSymbol());
+		loop.limit = limit;
+		loop.target = vectorOperand(*match.target);
+		if (match.left != nullptr)
+			loop.left = vectorOperand(*match.left);
+		if (match.right != nullptr)
+			loop.right = vectorOperand(*match.right);
+		if (match.scalar != nullptr)
+		{
+			loop.scalar = vectorOperand(*match.scalar);
+		}
+		else if (match.number != nullptr)
+		{
+			loop.scalar.constant = true;
+			loop.scalar.slot = m_Code.addConstant(numberValue(*match.number));
+		}
+
+		vector = emit(OpCode::VECTOR, 0, m_Code.addVectorLoop(loop), node.getKeyword().pos);
+		m_VectorizedLoops++;
+		return true;
+	}
+
+	// Addressed the way emitLoad and emitElement do.
+	VectorOperand Compiler::vectorOperand(VariableSymbol const& sym) const
+	{
+		VectorOperand res;
+		if (m_InlineSlots.count(&sym) != 0 || sym.getScopeLevel() == m_CurrentLevel)
+		{
+			res.slot = localSlot(sym);
+		}
+		else
+		{
+			res.level = sym.getScopeLevel();
+			res.slot = sym.getSlot();
+		}
+
+		if (sym.getParent() != nullptr && sym.getParent()->getType() == SymbolType::ARRAY_TYPE)
+		{
+			const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym.getParent().get());
+			res.slot -= array->getLow();
+			res.low = array->getLow();
+			res.high = array->getHigh();
+		}
+		return res;
+	}
+
+	void Compiler::patchAll(std::vector<size_t> const& jumps, size_t target)
+	{
+		for (size_t jump : jumps)
+			patch(jump, target);
+	}
+
+	// Slot of a variable of the procedure being compiled.
+	int32_t Compiler::localSlot(VariableSymbol const& sym) const
+	{
+		auto inlined = m_InlineSlots.find(&sym);
+		return (inlined != m_InlineSlots.end()) ? inlined->second : sym.getSlot();
+	}
+
+	// Every field of a record starts as the zero of its own type. The slot
+	// of a reference parameter is the argument's reference alone.
+	void Compiler::defineSlot(VariableSymbol const& sym)
+	{
+		ProcedureCode& proc = currentProc();
+		proc.slotsNames[sym.getSlot()] = sym.getName();
+		if (sym.isReference())
+			return;
+
+		std::shared_ptr<const Symbol> type = sym.getParent();
+		unsigned length = 1;
+		if (type != nullptr && type->getType() == SymbolType::ARRAY_TYPE)
+		{
+			const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(type.get());
+			length = array->getLength();
+			type = array->getElement();
+			proc.arrayLengths[sym.getSlot()] = length;
+		}
+
+		if (type == nullptr || type->getType() != SymbolType::RECORD_TYPE)
+		{
+			std::fill_n(proc.slotsInit.begin() + sym.getSlot(), length, typedZero(type));
+			return;
+		}
+
+		std::vector<RecordTypeSymbol::Leaf> const& leaves =
+			reinterpret_cast<const RecordTypeSymbol*>(type.get())->getLeaves();
+		for (unsigned i = 0; i < length; i++)
+		{
+			for (unsigned k = 0; k < leaves.size(); k++)
+				proc.slotsInit[sym.getSlot() + i * leaves.size() + k] = typedZero(leaves[k].type);
+		}
+		for (auto const& e : leaves)
+			proc.recordFields[sym.getSlot()].push_back(e.path);
+	}
+
+	Value Compiler::typedZero(std::shared_ptr<const Symbol> const& type)
+	{
+		if (type != nullptr && type->getType() == SymbolType::POINTER_TYPE)
+			return Value::Pointer(nullptr);
+		else if (type != nullptr && type->getName() == "real")
+			return Value::Real(0.0);
+		else if (type != nullptr && type->getName() == "boolean")
+			return Value::Boolean(false);
+		else if (type != nullptr && type->getName() == "string")
+			return Value::ShortString("", 0);
+		else if (type != nullptr && type->getName() == "bigint")
+			return Value::BigInt(0);
+		else if (type != nullptr && type->getName() == "text")
+			return Value::Text(-1);
+		else if (type != nullptr && type->getType() == SymbolType::SET_TYPE)
+			return Value::Set(reinterpret_cast<const SetTypeSymbol*>(type.get())->isChars() ?
+							  &SetBits::EMPTY_CHARS : &SetBits::EMPTY);
+		else
+			return Value::Integer(0);
+	}
+
+	Value Compiler::numberValue(AST::NumberNode const& node)
+	{
+		std::string const& str = node.getToken().str;
+		if (str.find_first_of(".e") != std::string::npos)
+			return Value::Real(std::strtod(str.c_str(), nullptr));
+		return Value::Integer(std::stol(str));
+	}
+}
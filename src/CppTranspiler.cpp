@@ -0,0 +1,1743 @@
+#include <pscpch.hpp>
+#include <AST.hpp>
+#include <CppTranspiler.hpp>
+#include <ReportsManager.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Pascal
+{
+	static const char* const PRELUDE = R"(#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+inline void pascal_error(const char* where, const char* msg)
+{
+	std::cout << where << " error: " << msg << std::endl;
+	std::exit(1);
+}
+
+template <typename A, typename B>
+inline auto pascal_div(A a, B b, const char* where) -> decltype(a / b)
+{
+	if (b == 0)
+		pascal_error(where, "division by zero");
+	return a / b;
+}
+
+template <typename A, typename B>
+inline auto pascal_mod(A a, B b, const char* where) -> decltype(a % b)
+{
+	if (b == 0)
+		pascal_error(where, "division by zero");
+	return a % b;
+}
+
+// Integer arithmetic of unchecked code wraps around like the
+// interpreter's, on unsigned longs since signed overflow is undefined.
+inline long pascal_add(long a, long b)
+{
+	return static_cast<long>(static_cast<unsigned long>(a) + static_cast<unsigned long>(b));
+}
+
+inline long pascal_sub(long a, long b)
+{
+	return static_cast<long>(static_cast<unsigned long>(a) - static_cast<unsigned long>(b));
+}
+
+inline long pascal_mul(long a, long b)
+{
+	return static_cast<long>(static_cast<unsigned long>(a) * static_cast<unsigned long>(b));
+}
+
+inline long pascal_neg(long a)
+{
+	return static_cast<long>(0UL - static_cast<unsigned long>(a));
+}
+
+// idiv traps on LONG_MIN / -1, the quotient wraps and the remainder is 0.
+inline long pascal_div(long a, long b, const char* where)
+{
+	if (b == 0)
+		pascal_error(where, "division by zero");
+	return (b == -1) ? pascal_neg(a) : a / b;
+}
+
+inline long pascal_mod(long a, long b, const char* where)
+{
+	if (b == 0)
+		pascal_error(where, "division by zero");
+	return (b == -1) ? 0 : a % b;
+}
+
+// Integer arithmetic of {$Q+} code.
+inline void pascal_overflow(bool overflow, const char* where)
+{
+	if (overflow)
+		pascal_error(where, "integer overflow");
+}
+
+inline long pascal_checked_add(long a, long b, const char* where)
+{
+	long res;
+	pascal_overflow(__builtin_add_overflow(a, b, &res), where);
+	return res;
+}
+
+inline long pascal_checked_sub(long a, long b, const char* where)
+{
+	long res;
+	pascal_overflow(__builtin_sub_overflow(a, b, &res), where);
+	return res;
+}
+
+inline long pascal_checked_mul(long a, long b, const char* where)
+{
+	long res;
+	pascal_overflow(__builtin_mul_overflow(a, b, &res), where);
+	return res;
+}
+
+inline long pascal_checked_div(long a, long b, const char* where)
+{
+	if (b == 0)
+		pascal_error(where, "division by zero");
+	pascal_overflow(a == LONG_MIN && b == -1, where);
+	return a / b;
+}
+
+inline long pascal_checked_neg(long a, const char* where)
+{
+	pascal_overflow(a == LONG_MIN, where);
+	return -a;
+}
+
+inline long pascal_index(long index, long low, long high, const char* where)
+{
+	if (index < low || index > high)
+		pascal_error(where, "index out of range");
+	return index - low;
+}
+
+inline std::string pascal_char(std::string const& str, long index, const char* where)
+{
+	if (index < 1 || index > static_cast<long>(str.size()))
+		pascal_error(where, "index out of range");
+	return std::string(1, str[index - 1]);
+}
+
+inline long pascal_length(std::string const& str) { return static_cast<long>(str.size()); }
+
+template <typename T>
+inline T* pascal_deref(T* pointer, const char* where)
+{
+	if (pointer == nullptr)
+		pascal_error(where, "dereferencing nil");
+	return pointer;
+}
+
+inline void pascal_put(long value) { std::cout << value; }
+inline void pascal_put(double value) { std::cout << value; }
+inline void pascal_put(bool value) { std::cout << (value ? "true" : "false"); }
+
+inline void pascal_put(std::string const& value)
+{
+	std::cout << "'";
+	for (char ch : value)
+		std::cout << ((ch == '\'') ? "''" : std::string(1, ch));
+	std::cout << "'";
+}
+
+template <typename T>
+inline void pascal_put(T* value) { std::cout << ((value == nullptr) ? "nil" : "^"); }
+
+struct pascal_text
+{
+	long handle = -1;
+};
+
+inline void pascal_put(pascal_text) { std::cout << "text"; }
+
+// bigint: a sign and 32 bit limbs, the least significant one first and
+// the most significant one never zero.
+typedef std::vector<unsigned> pascal_limbs;
+
+struct pascal_bigint
+{
+	bool negative = false;
+	pascal_limbs limbs;
+
+	pascal_bigint() = default;
+
+	pascal_bigint(long value) : negative(value < 0)
+	{
+		for (unsigned long m = negative ? 0UL - value : value; m != 0; m >>= 32)
+			limbs.push_back(static_cast<unsigned>(m));
+	}
+
+	explicit operator double() const
+	{
+		double res = 0.0;
+		for (size_t i = limbs.size(); i-- > 0; )
+			res = res * 4294967296.0 + limbs[i];
+		return negative ? -res : res;
+	}
+};
+
+inline void pascal_trim(pascal_limbs& limbs)
+{
+	while (!limbs.empty() && limbs.back() == 0)
+		limbs.pop_back();
+}
+
+inline pascal_bigint pascal_big(bool negative, pascal_limbs limbs)
+{
+	pascal_trim(limbs);
+	pascal_bigint res;
+	res.negative = negative && !limbs.empty();
+	res.limbs = std::move(limbs);
+	return res;
+}
+
+inline int pascal_compare(pascal_limbs const& a, pascal_limbs const& b)
+{
+	if (a.size() != b.size())
+		return (a.size() < b.size()) ? -1 : 1;
+	for (size_t i = a.size(); i-- > 0; )
+	{
+		if (a[i] != b[i])
+			return (a[i] < b[i]) ? -1 : 1;
+	}
+	return 0;
+}
+
+// |a| + |b| or |a| - |b|, 'a' being the longer or the larger one.
+inline pascal_limbs pascal_add(pascal_limbs const& a, pascal_limbs const& b, bool subtract)
+{
+	pascal_limbs res(a.size() + 1);
+	long long carry = 0;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		long long other = (i < b.size()) ? b[i] : 0;
+		long long sum = a[i] + (subtract ? -other : other) + carry;
+		res[i] = static_cast<unsigned>(sum);
+		carry = sum >> 32;
+	}
+	res[a.size()] = static_cast<unsigned>(carry);
+	pascal_trim(res);
+	return res;
+}
+
+inline int pascal_compare(pascal_bigint const& a, pascal_bigint const& b)
+{
+	if (a.negative != b.negative)
+		return a.negative ? -1 : 1;
+	int res = pascal_compare(a.limbs, b.limbs);
+	return a.negative ? -res : res;
+}
+
+inline bool operator==(pascal_bigint const& a, pascal_bigint const& b) { return pascal_compare(a, b) == 0; }
+inline bool operator!=(pascal_bigint const& a, pascal_bigint const& b) { return pascal_compare(a, b) != 0; }
+inline bool operator<(pascal_bigint const& a, pascal_bigint const& b) { return pascal_compare(a, b) < 0; }
+inline bool operator<=(pascal_bigint const& a, pascal_bigint const& b) { return pascal_compare(a, b) <= 0; }
+inline bool operator>(pascal_bigint const& a, pascal_bigint const& b) { return pascal_compare(a, b) > 0; }
+inline bool operator>=(pascal_bigint const& a, pascal_bigint const& b) { return pascal_compare(a, b) >= 0; }
+
+inline pascal_bigint operator-(pascal_bigint a)
+{
+	a.negative = !a.negative && !a.limbs.empty();
+	return a;
+}
+
+inline pascal_bigint operator+(pascal_bigint const& a, pascal_bigint const& b)
+{
+	if (a.negative == b.negative)
+		return pascal_big(a.negative, (a.limbs.size() >= b.limbs.size()) ?
+						  pascal_add(a.limbs, b.limbs, false) : pascal_add(b.limbs, a.limbs, false));
+	if (pascal_compare(a.limbs, b.limbs) >= 0)
+		return pascal_big(a.negative, pascal_add(a.limbs, b.limbs, true));
+	return pascal_big(b.negative, pascal_add(b.limbs, a.limbs, true));
+}
+
+inline pascal_bigint operator-(pascal_bigint const& a, pascal_bigint const& b) { return a + -b; }
+
+inline pascal_bigint operator*(pascal_bigint const& a, pascal_bigint const& b)
+{
+	pascal_limbs res(a.limbs.size() + b.limbs.size());
+	for (size_t i = 0; i < a.limbs.size(); i++)
+	{
+		unsigned long carry = 0;
+		for (size_t j = 0; j < b.limbs.size(); j++)
+		{
+			unsigned long t = static_cast<unsigned long>(a.limbs[i]) * b.limbs[j] + res[i + j] + carry;
+			res[i + j] = static_cast<unsigned>(t);
+			carry = t >> 32;
+		}
+		res[i + b.limbs.size()] = static_cast<unsigned>(carry);
+	}
+	return pascal_big(a.negative != b.negative, res);
+}
+
+// Truncating like integers do, a bit at a time.
+inline void pascal_divide(pascal_bigint const& a, pascal_bigint const& b, pascal_bigint& q, pascal_bigint& r)
+{
+	pascal_limbs quotient(a.limbs.size());
+	pascal_limbs rest;
+	for (size_t i = a.limbs.size() * 32; i-- > 0; )
+	{
+		unsigned carry = (a.limbs[i / 32] >> (i % 32)) & 1;
+		for (auto& e : rest)
+		{
+			unsigned top = e >> 31;
+			e = (e << 1) | carry;
+			carry = top;
+		}
+		if (carry != 0)
+			rest.push_back(carry);
+		if (pascal_compare(rest, b.limbs) >= 0)
+		{
+			rest = pascal_add(rest, b.limbs, true);
+			quotient[i / 32] |= 1U << (i % 32);
+		}
+	}
+	q = pascal_big(a.negative != b.negative, quotient);
+	r = pascal_big(a.negative, rest);
+}
+
+inline pascal_bigint operator/(pascal_bigint const& a, pascal_bigint const& b)
+{
+	pascal_bigint q, r;
+	pascal_divide(a, b, q, r);
+	return q;
+}
+
+inline pascal_bigint operator%(pascal_bigint const& a, pascal_bigint const& b)
+{
+	pascal_bigint q, r;
+	pascal_divide(a, b, q, r);
+	return r;
+}
+
+// Nine digits at a time.
+inline void pascal_put(pascal_bigint const& value)
+{
+	pascal_limbs rest = value.limbs;
+	std::vector<unsigned> chunks;
+	do
+	{
+		unsigned long rem = 0;
+		for (size_t i = rest.size(); i-- > 0; )
+		{
+			unsigned long cur = (rem << 32) | rest[i];
+			rest[i] = static_cast<unsigned>(cur / 1000000000);
+			rem = cur % 1000000000;
+		}
+		pascal_trim(rest);
+		chunks.push_back(static_cast<unsigned>(rem));
+	} while (!rest.empty());
+
+	std::cout << (value.negative ? "-" : "") << chunks.back();
+	for (size_t i = chunks.size() - 1; i-- > 0; )
+		std::cout << std::setw(9) << std::setfill('0') << chunks[i] << std::setfill(' ');
+}
+
+struct pascal_set
+{
+	unsigned long words[4];
+	bool chars;
+};
+
+inline bool pascal_has(pascal_set const& set, long e)
+{
+	return e >= 0 && e <= 255 && ((set.words[e >> 6] >> (e & 63)) & 1) != 0;
+}
+
+inline long pascal_ord(long value, const char*) { return value; }
+
+inline long pascal_ord(std::string const& value, const char* where)
+{
+	if (value.size() != 1)
+		pascal_error(where, "illegal operand types");
+	return static_cast<unsigned char>(value[0]);
+}
+
+template <typename L, typename H>
+inline pascal_set pascal_include(pascal_set set, L const& low, H const& high, const char* where)
+{
+	long first = pascal_ord(low, where);
+	long last = pascal_ord(high, where);
+	set.chars = set.chars || std::is_same<L, std::string>::value;
+	if (first > last)
+		return set;
+	if (first < 0 || last > 255)
+		pascal_error(where, "set elements must be integers within 0..255 or characters");
+	for (long e = first; e <= last; e++)
+		set.words[e >> 6] |= 1UL << (e & 63);
+	return set;
+}
+
+template <typename T>
+inline bool pascal_in(T const& value, pascal_set const& set, const char* where)
+{
+	return pascal_has(set, pascal_ord(value, where));
+}
+
+inline pascal_set operator+(pascal_set a, pascal_set const& b)
+{
+	for (int k = 0; k < 4; k++)
+		a.words[k] |= b.words[k];
+	a.chars = a.chars || b.chars;
+	return a;
+}
+
+inline pascal_set operator*(pascal_set a, pascal_set const& b)
+{
+	for (int k = 0; k < 4; k++)
+		a.words[k] &= b.words[k];
+	a.chars = a.chars || b.chars;
+	return a;
+}
+
+inline pascal_set operator-(pascal_set a, pascal_set const& b)
+{
+	for (int k = 0; k < 4; k++)
+		a.words[k] &= ~b.words[k];
+	a.chars = a.chars || b.chars;
+	return a;
+}
+
+inline bool operator<=(pascal_set const& a, pascal_set const& b)
+{
+	for (int k = 0; k < 4; k++)
+		if ((a.words[k] & ~b.words[k]) != 0)
+			return false;
+	return true;
+}
+
+inline bool operator==(pascal_set const& a, pascal_set const& b) { return a <= b && b <= a; }
+inline bool operator!=(pascal_set const& a, pascal_set const& b) { return !(a == b); }
+inline bool operator>=(pascal_set const& a, pascal_set const& b) { return b <= a; }
+inline bool operator<(pascal_set const& a, pascal_set const& b) { return !(b <= a); }
+inline bool operator>(pascal_set const& a, pascal_set const& b) { return !(a <= b); }
+
+inline void pascal_put_element(long e, bool chars)
+{
+	if (chars)
+		pascal_put(std::string(1, static_cast<char>(e)));
+	else
+		std::cout << e;
+}
+
+inline void pascal_put(pascal_set const& value)
+{
+	std::cout << "[";
+	bool first = true;
+	for (long e = 0; e <= 255; e++)
+	{
+		if (!pascal_has(value, e))
+			continue;
+		long last = e;
+		while (pascal_has(value, last + 1))
+			last++;
+
+		if (!first)
+			std::cout << ", ";
+		first = false;
+		pascal_put_element(e, value.chars);
+		if (last > e)
+		{
+			std::cout << "..";
+			pascal_put_element(last, value.chars);
+		}
+		e = last;
+	}
+	std::cout << "]";
+}
+
+template <typename T, unsigned long N>
+inline void pascal_show(const char* name, T const (&values)[N])
+{
+	std::cout << "-- " << std::setw(8) << name << " : [";
+	for (unsigned long i = 0; i < N && i < 16; i++)
+	{
+		if (i != 0)
+			std::cout << ", ";
+		pascal_put(values[i]);
+	}
+	std::cout << ((N > 16) ? ", ...]" : "]") << std::endl;
+}
+
+inline void pascal_show(const char* name, long value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : " << value << std::endl;
+}
+
+inline void pascal_show(const char* name, double value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : " << value << std::endl;
+}
+
+inline void pascal_show(const char* name, bool value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : " << (value ? "true" : "false") << std::endl;
+}
+
+inline void pascal_show(const char* name, std::string const& value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : ";
+	pascal_put(value);
+	std::cout << std::endl;
+}
+
+inline void pascal_show(const char* name, pascal_bigint const& value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : ";
+	pascal_put(value);
+	std::cout << std::endl;
+}
+
+inline void pascal_show(const char* name, pascal_text value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : text" << std::endl;
+}
+
+inline void pascal_show(const char* name, pascal_set const& value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : ";
+	pascal_put(value);
+	std::cout << std::endl;
+}
+
+// Arrays don't bind to the reference, they are shown element by element.
+template <typename T>
+inline void pascal_show(const char* name, T*& value)
+{
+	std::cout << "-- " << std::setw(8) << name << " : ";
+	pascal_put(value);
+	std::cout << std::endl;
+}
+
+// write and writeln, strings go without quotes.
+template <typename T>
+inline void pascal_write(T const& value) { pascal_put(value); }
+inline void pascal_write(std::string const& value) { std::cout << value; }
+
+// read and readln, a number runs up to the next blank or line break, a
+// string to the end of the line.
+inline std::string pascal_token(const char* where)
+{
+	std::string token;
+	if (!(std::cin >> token))
+		pascal_error(where, "reading past the end of the input");
+	return token;
+}
+
+inline void pascal_invalid_input(bool invalid, const char* where)
+{
+	if (invalid)
+		pascal_error(where, "the input is not a value of the variable's type");
+}
+
+inline void pascal_read(long& var, const char* where)
+{
+	std::string token = pascal_token(where);
+	char* end;
+	errno = 0;
+	var = std::strtol(token.c_str(), &end, 10);
+	pascal_invalid_input(*end != '\0' || errno == ERANGE, where);
+}
+
+inline void pascal_read(double& var, const char* where)
+{
+	std::string token = pascal_token(where);
+	char* end;
+	var = std::strtod(token.c_str(), &end);
+	pascal_invalid_input(*end != '\0', where);
+}
+
+// Of decimal digits, literals beyond a long too.
+inline pascal_bigint pascal_digits(const char* digits)
+{
+	pascal_bigint res;
+	for (; *digits != '\0'; digits++)
+		res = res * pascal_bigint(10) + pascal_bigint(*digits - '0');
+	return res;
+}
+
+inline void pascal_read(pascal_bigint& var, const char* where)
+{
+	std::string token = pascal_token(where);
+	size_t first = (token[0] == '-' || token[0] == '+') ? 1 : 0;
+	pascal_invalid_input(first == token.size() ||
+		token.find_first_not_of("0123456789", first) != std::string::npos, where);
+	pascal_bigint res = pascal_digits(token.c_str() + first);
+	var = (token[0] == '-') ? -res : res;
+}
+
+inline void pascal_read(std::string& var, const char* where)
+{
+	if (std::cin.peek() == EOF)
+		pascal_error(where, "reading past the end of the input");
+	var.clear();
+	for (int c; (c = std::cin.peek()) != EOF && c != '\n'; std::cin.get())
+		var += static_cast<char>(c);
+	if (!var.empty() && var.back() == '\r')
+		var.pop_back();
+}
+
+inline void pascal_readln()
+{
+	std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+}
+
+// A text variable holds the index of its file once assigned. A file is
+// read in chunks as large as the interpreter's.
+struct pascal_file
+{
+	std::string name;
+	std::ifstream in;
+	std::ofstream out;
+	std::vector<char> buffer = std::vector<char>(1 << 18);
+};
+
+inline std::deque<pascal_file>& pascal_files()
+{
+	static std::deque<pascal_file> files;
+	return files;
+}
+
+inline void pascal_assign(pascal_text& file, std::string const& name)
+{
+	if (file.handle < 0)
+	{
+		pascal_files().emplace_back();
+		file.handle = static_cast<long>(pascal_files().size()) - 1;
+	}
+	pascal_file& f = pascal_files()[file.handle];
+	f.in.close();
+	f.out.close();
+	f.name = name;
+}
+
+inline pascal_file& pascal_assigned(pascal_text file, const char* where)
+{
+	if (file.handle < 0)
+		pascal_error(where, "the file was not assigned a name");
+	return pascal_files()[file.handle];
+}
+
+inline void pascal_reset(pascal_text file, const char* where)
+{
+	pascal_file& f = pascal_assigned(file, where);
+	f.in.close();
+	f.out.close();
+	f.in.rdbuf()->pubsetbuf(f.buffer.data(), f.buffer.size());
+	f.in.open(f.name, std::ios::binary);
+	if (!f.in.is_open())
+		pascal_error(where, "can't open the file");
+}
+
+inline void pascal_rewrite(pascal_text file, const char* where)
+{
+	pascal_file& f = pascal_assigned(file, where);
+	f.in.close();
+	f.out.close();
+	f.out.open(f.name, std::ios::binary | std::ios::trunc);
+	if (!f.out.is_open())
+		pascal_error(where, "can't open the file");
+}
+
+inline void pascal_close(pascal_text file)
+{
+	if (file.handle < 0)
+		return;
+	pascal_files()[file.handle].in.close();
+	pascal_files()[file.handle].out.close();
+}
+
+inline std::streambuf* pascal_input(pascal_text file, const char* where)
+{
+	if (file.handle < 0 || !pascal_files()[file.handle].in.is_open())
+		pascal_error(where, "the file is not open for reading");
+	return pascal_files()[file.handle].in.rdbuf();
+}
+
+inline std::streambuf* pascal_output(pascal_text file, const char* where)
+{
+	if (file.handle < 0 || !pascal_files()[file.handle].out.is_open())
+		pascal_error(where, "the file is not open for writing");
+	return pascal_files()[file.handle].out.rdbuf();
+}
+
+inline bool pascal_eof(std::streambuf* input)
+{
+	return input->sgetc() == std::char_traits<char>::eof();
+}
+
+// Makes a file what std::cin or std::cout read or write while it lives.
+struct pascal_redirect
+{
+	std::ios& stream;
+	std::streambuf* old;
+
+	pascal_redirect(std::ios& stream, std::streambuf* file) : stream(stream), old(stream.rdbuf(file)) {}
+	~pascal_redirect() { stream.rdbuf(old); }
+};
+
+)";
+
+	static std::string quote(std::string const& str)
+	{
+		std::string res = "\"";
+		for (char ch : str)
+		{
+			if (ch == '"' || ch == '\\')
+				res += '\\';
+			res += ch;
+		}
+		return res + "\"";
+	}
+
+	void CppTranspiler::visitProgramNode(AST::ProgramNode const& node)
+	{
+		m_Scopes.push_back({ "", false });
+		m_Body = &m_Main;
+		m_DeclOut = &m_Globals;
+		m_DeclPrefix = "static ";
+
+		node.getBlock().accept(this);
+
+		m_Main << "\tstd::cout << \"CALL STACK: \" << std::endl;" << std::endl;
+		m_Main << "\tstd::cout << \"1: PROGRAM " << node.getName().str << "\" << std::endl;" << std::endl;
+		for (auto const& e : m_GlobalNames)
+			m_Main << "\tpascal_show(" << quote(e) << ", v_" << e << ");" << std::endl;
+		m_Main << "\tstd::cout << std::endl;" << std::endl;
+		m_Main << "\treturn 0;" << std::endl;
+
+		m_Scopes.pop_back();
+	}
+
+	void CppTranspiler::visitVarDeclNode(AST::VarDeclNode const& node)
+	{
+		VariableSymbol const& sym = *node.getVar().getSymbol();
+		if (sym.getParent() != nullptr && sym.getParent()->getType() == SymbolType::ARRAY_TYPE)
+		{
+			const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym.getParent().get());
+			*m_DeclOut << m_DeclPrefix << declType(array->getElement()) << " v_" <<
+				sym.getName() << "[" << array->getLength() << "] = {};" << std::endl;
+		}
+		else if (sym.getParent() != nullptr && sym.getParent()->getType() == SymbolType::RECORD_TYPE)
+		{
+			*m_DeclOut << m_DeclPrefix << declType(sym.getParent()) << " v_" << sym.getName() <<
+				" = {};" << std::endl;
+		}
+		else
+		{
+			// Empty sets of char print as characters once filled.
+			bool chars = sym.getParent() != nullptr && sym.getParent()->getType() == SymbolType::SET_TYPE &&
+				reinterpret_cast<const SetTypeSymbol*>(sym.getParent().get())->isChars();
+			*m_DeclOut << m_DeclPrefix << declType(sym.getParent()) << " v_" <<
+				sym.getName() << (chars ? " = { {}, true };" : " = {};") << std::endl;
+		}
+
+		if (currentLevel() == 1)
+			m_GlobalNames.push_back(sym.getName());
+	}
+
+	void CppTranspiler::visitBlockNode(AST::BlockNode const& node)
+	{
+		for (auto const& e : node.getVarDecls())
+			e->accept(this);
+
+		for (auto const& e : node.getProcDecls())
+			e->accept(this);
+
+		node.getCompound().accept(this);
+	}
+
+	void CppTranspiler::visitTypeNode(AST::TypeNode const& node)
+	{ }
+
+	void CppTranspiler::visitStatementNode(AST::StatementNode const& node)
+	{
+		node.accept(this);
+	}
+
+	void CppTranspiler::visitCompoundNode(AST::CompoundNode const& node)
+	{
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+	}
+
+	void CppTranspiler::visitAssignmentNode(AST::AssignmentNode const& node)
+	{
+		// The index is checked before the right side is evaluated.
+		if (node.getElement() != nullptr || node.getField() != nullptr)
+		{
+			if (node.getField() != nullptr)
+				node.getField()->accept(this);
+			else
+				node.getElement()->accept(this);
+			*m_Body << indent() << "{" << std::endl;
+			m_Indent++;
+			*m_Body << indent() << "auto& element = " << m_Expr << ";" << std::endl;
+			node.getExpr().accept(this);
+			*m_Body << indent() << "element = " << m_Expr << ";" << std::endl;
+			m_Indent--;
+			*m_Body << indent() << "}" << std::endl;
+			return;
+		}
+
+		node.getExpr().accept(this);
+		if (m_ExprType == ValueType::BIGINT && typeOf(node.getVar().getSymbol()->getParent()) == ValueType::REAL)
+			m_Expr = "static_cast<double>(" + m_Expr + ")";
+		*m_Body << indent() << variableRef(*node.getVar().getSymbol()) << " = " << m_Expr << ";" << std::endl;
+	}
+
+	void CppTranspiler::visitVariableNode(AST::VariableNode const& node)
+	{
+		if (node.getCall() != nullptr)
+		{
+			node.getCall()->accept(this);
+			return;
+		}
+		m_Expr = variableRef(*node.getSymbol());
+		m_ExprType = typeOf(node.getSymbol()->getParent());
+	}
+
+	// Indices a loop keeps within the bounds are not checked.
+	void CppTranspiler::visitIndexNode(AST::IndexNode const& node)
+	{
+		VariableSymbol const& sym = *node.getVar().getSymbol();
+		const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym.getParent().get());
+
+		node.getIndex().accept(this);
+		if (m_ExprType != ValueType::INTEGER)
+			ReportsManager::ReportError(node.getBracket().pos, ErrorType::ILLEGAL_OPERANDS, false);
+
+		if (typeOf(sym.getParent()) == ValueType::STRING)
+		{
+			m_Expr = "pascal_char(" + variableRef(sym) + ", " + m_Expr + ", " +
+				quote(ReportsManager::PosToString(node.getBracket().pos)) + ")";
+			m_ExprType = ValueType::STRING;
+			return;
+		}
+
+		if (node.getInBounds() ||
+			(node.getLoop() != nullptr && node.getLoop()->getIndexing() == AST::ForNode::Indexing::PROVEN))
+		{
+			m_Expr = variableRef(sym) + "[" + m_Expr + " - " + std::to_string(array->getLow()) + "L]";
+		}
+		else
+		{
+			m_Expr = variableRef(sym) + "[pascal_index(" + m_Expr + ", " + std::to_string(array->getLow()) +
+				"L, " + std::to_string(array->getHigh()) + "L, " +
+				quote(ReportsManager::PosToString(node.getBracket().pos)) + ")]";
+		}
+		m_ExprType = typeOf(array->getElement());
+	}
+
+	void CppTranspiler::visitNullStatementNode(AST::NullStatementNode const& node)
+	{ }
+
+	void CppTranspiler::visitStringNode(AST::StringNode const& node)
+	{
+		m_Expr = "std::string(" + quote(node.getToken().str) + ")";
+		m_ExprType = ValueType::STRING;
+	}
+
+	// The literal elements make up the initial value, the others are
+	// added to it like the interpreter does: ranges first.
+	void CppTranspiler::visitSetNode(AST::SetNode const& node)
+	{
+		SetBits constant = SetBits::EMPTY;
+		std::vector<AST::SetNode::Element const*> dynamic;
+		for (auto const& e : node.getElements())
+		{
+			long low = 0;
+			long high = 0;
+			if (!e.isConstant() || !AST::SetNode::literalValue(e.lowLiteral, low) ||
+				(e.high != nullptr && !AST::SetNode::literalValue(e.highLiteral, high)))
+			{
+				dynamic.push_back(&e);
+				continue;
+			}
+
+			if (e.high == nullptr)
+				high = low;
+			if (low <= high)
+				constant.insert(low, std::min(high, SetBits::MAX_ELEMENT));
+			constant.chars = constant.chars || e.lowLiteral.type == TokenType::STRING_LITERAL;
+		}
+		std::stable_partition(dynamic.begin(), dynamic.end(),
+							  [](AST::SetNode::Element const* e) { return e->high != nullptr; });
+
+		std::string res = "pascal_set{ { ";
+		for (int k = 0; k < 4; k++)
+			res += std::to_string(constant.words[k]) + "UL" + ((k < 3) ? ", " : " }, ");
+		res += constant.chars ? "true }" : "false }";
+
+		for (auto e : dynamic)
+		{
+			std::string hoisted = hoist(*e->low);
+			if (!hoisted.empty())
+			{
+				res = temporary(res);
+				*m_Body << hoisted;
+			}
+			std::string low = m_Expr;
+			ValueType lowType = m_ExprType;
+			std::string high = low;
+			ValueType highType = lowType;
+			if (e->high != nullptr)
+			{
+				hoisted = hoist(*e->high);
+				if (!hoisted.empty())
+				{
+					res = temporary(res);
+					low = temporary(low);
+					*m_Body << hoisted;
+				}
+				high = m_Expr;
+				highType = m_ExprType;
+			}
+			if ((lowType != ValueType::INTEGER && lowType != ValueType::STRING) ||
+				(highType != ValueType::INTEGER && highType != ValueType::STRING))
+				ReportsManager::ReportError(node.getBracket().pos, ErrorType::ILLEGAL_OPERANDS, false);
+
+			res = "pascal_include(" + res + ", " + low + ", " + high + ", " +
+				quote(ReportsManager::PosToString(node.getBracket().pos)) + ")";
+		}
+
+		m_Expr = res;
+		m_ExprType = ValueType::SET;
+	}
+
+	void CppTranspiler::visitNumberNode(AST::NumberNode const& node)
+	{
+		std::string const& str = node.getToken().str;
+		if (node.isBig())
+		{
+			m_Expr = "pascal_digits(" + quote(str) + ")";
+			m_ExprType = ValueType::BIGINT;
+		}
+		else if (str.find_first_of(".e") != std::string::npos)
+		{
+			m_Expr = str;
+			m_ExprType = ValueType::REAL;
+		}
+		else
+		{
+			m_Expr = str + "L";
+			m_ExprType = ValueType::INTEGER;
+		}
+	}
+
+	static bool isNumeric(ValueType type)
+	{
+		return type == ValueType::INTEGER || type == ValueType::REAL || type == ValueType::BIGINT;
+	}
+
+	void CppTranspiler::visitBinOpNode(AST::BinOpNode const& node)
+	{
+		Token const& op = node.getOperation();
+		bool shortCircuit = op.type == TokenType::AND || op.type == TokenType::OR;
+
+		node.getLeft().accept(this);
+		std::string left = m_Expr;
+		ValueType leftType = m_ExprType;
+
+		if (shortCircuit)
+			m_Indent++;
+		std::string hoisted = hoist(node.getRight());
+		if (shortCircuit)
+			m_Indent--;
+		std::string right = m_Expr;
+		ValueType rightType = m_ExprType;
+		if (!hoisted.empty() && !shortCircuit)
+		{
+			left = temporary(left);
+			*m_Body << hoisted;
+		}
+
+		// The interpreter fails on these at runtime, C++ wouldn't compile them.
+		bool numbers = isNumeric(leftType) && isNumeric(rightType);
+		bool booleans = leftType == ValueType::BOOLEAN && rightType == ValueType::BOOLEAN;
+		bool strings = leftType == ValueType::STRING && rightType == ValueType::STRING;
+		bool sets = leftType == ValueType::SET && rightType == ValueType::SET;
+		bool pointers = leftType == ValueType::POINTER && rightType == ValueType::POINTER;
+
+		// && and || short-circuit like the interpreter does, calls on the
+		// right are made only when the left side doesn't decide.
+		std::string relation;
+		switch (op.type)
+		{
+		case TokenType::AND:
+		case TokenType::OR:
+			if (!booleans)
+				ReportsManager::ReportError(op.pos, ErrorType::ILLEGAL_OPERANDS, false);
+			m_ExprType = ValueType::BOOLEAN;
+			if (hoisted.empty())
+			{
+				m_Expr = "(" + left + ((op.type == TokenType::AND) ? " && " : " || ") + right + ")";
+				return;
+			}
+			m_Expr = "t" + std::to_string(++m_TempCount);
+			*m_Body << indent() << "bool " << m_Expr << " = " << left << ";" << std::endl <<
+				indent() << "if (" << ((op.type == TokenType::AND) ? "" : "!") << m_Expr << ")" << std::endl <<
+				indent() << "{" << std::endl << hoisted << indent() << "\t" << m_Expr << " = " << right << ";" <<
+				std::endl << indent() << "}" << std::endl;
+			return;
+		case TokenType::EQUAL:         relation = " == "; break;
+		case TokenType::NOT_EQUAL:     relation = " != "; break;
+		case TokenType::LESS:          relation = " < ";  break;
+		case TokenType::LESS_EQUAL:    relation = " <= "; break;
+		case TokenType::GREATER:       relation = " > ";  break;
+		case TokenType::GREATER_EQUAL: relation = " >= "; break;
+		case TokenType::IN:
+			if (rightType != ValueType::SET || (leftType != ValueType::INTEGER && leftType != ValueType::STRING))
+				ReportsManager::ReportError(op.pos, ErrorType::ILLEGAL_OPERANDS, false);
+			m_ExprType = ValueType::BOOLEAN;
+			m_Expr = "pascal_in(" + left + ", " + right + ", " + quote(ReportsManager::PosToString(op.pos)) + ")";
+			return;
+		default:
+			break;
+		}
+
+		// Bigints mixed with reals are reals, with integers bigints.
+		if (numbers && leftType != rightType && (leftType == ValueType::REAL || rightType == ValueType::REAL))
+		{
+			if (leftType == ValueType::BIGINT)
+				left = "static_cast<double>(" + left + ")";
+			if (rightType == ValueType::BIGINT)
+				right = "static_cast<double>(" + right + ")";
+		}
+		if (!relation.empty())
+		{
+			if (!numbers && !booleans && !strings && !sets &&
+				!(pointers && (op.type == TokenType::EQUAL || op.type == TokenType::NOT_EQUAL)))
+				ReportsManager::ReportError(op.pos, ErrorType::ILLEGAL_OPERANDS, false);
+			m_ExprType = ValueType::BOOLEAN;
+			m_Expr = "(" + left + relation + right + ")";
+			return;
+		}
+
+		if ((strings && op.type == TokenType::PLUS) ||
+			(sets && (op.type == TokenType::PLUS || op.type == TokenType::MINUS || op.type == TokenType::PRODUCT)))
+		{
+			m_Expr = "(" + left + " " + op.str + " " + right + ")";
+			return;
+		}
+		if (!numbers || (op.type == TokenType::MOD &&
+						 (leftType == ValueType::REAL || rightType == ValueType::REAL)))
+			ReportsManager::ReportError(op.pos, ErrorType::ILLEGAL_OPERANDS, false);
+
+		if (leftType == ValueType::REAL || rightType == ValueType::REAL)
+			m_ExprType = ValueType::REAL;
+		else if (leftType == ValueType::BIGINT || rightType == ValueType::BIGINT)
+			m_ExprType = ValueType::BIGINT;
+		else
+			m_ExprType = ValueType::INTEGER;
+
+		std::string where = quote(ReportsManager::PosToString(op.pos));
+		if (m_ExprType == ValueType::INTEGER && op.type != TokenType::MOD && checksOverflow(op, m_OverflowChecks))
+		{
+			const char* function = (op.type == TokenType::PLUS) ? "pascal_checked_add(" :
+				(op.type == TokenType::MINUS) ? "pascal_checked_sub(" :
+				(op.type == TokenType::PRODUCT) ? "pascal_checked_mul(" : "pascal_checked_div(";
+			m_Expr = function + left + ", " + right + ", " + where + ")";
+			return;
+		}
+
+		if (m_ExprType == ValueType::INTEGER && op.type != TokenType::DIVISION && op.type != TokenType::MOD)
+		{
+			const char* function = (op.type == TokenType::PLUS) ? "pascal_add(" :
+				(op.type == TokenType::MINUS) ? "pascal_sub(" : "pascal_mul(";
+			m_Expr = function + left + ", " + right + ")";
+			return;
+		}
+
+		switch (op.type)
+		{
+		case TokenType::PLUS:
+			m_Expr = "(" + left + " + " + right + ")";
+			break;
+		case TokenType::MINUS:
+			m_Expr = "(" + left + " - " + right + ")";
+			break;
+		case TokenType::PRODUCT:
+			m_Expr = "(" + left + " * " + right + ")";
+			break;
+		case TokenType::DIVISION:
+			m_Expr = "pascal_div(" + left + ", " + right + ", " + where + ")";
+			break;
+		case TokenType::MOD:
+			m_Expr = "pascal_mod(" + left + ", " + right + ", " + where + ")";
+			break;
+		default:
+			throw std::runtime_error("unbelivable");
+		}
+	}
+
+	void CppTranspiler::visitUnaryOpNode(AST::UnaryOpNode const& node)
+	{
+		node.getExpr().accept(this);
+		if (node.getOperation().type == TokenType::NOT)
+		{
+			if (m_ExprType != ValueType::BOOLEAN)
+				ReportsManager::ReportError(node.getOperation().pos, ErrorType::ILLEGAL_OPERANDS, false);
+			m_Expr = "(!" + m_Expr + ")";
+			return;
+		}
+
+		if (!isNumeric(m_ExprType))
+			ReportsManager::ReportError(node.getOperation().pos, ErrorType::ILLEGAL_OPERANDS, false);
+
+		switch (node.getOperation().type)
+		{
+		case TokenType::PLUS:
+			break;
+		case TokenType::MINUS:
+			if (m_ExprType == ValueType::INTEGER && checksOverflow(node.getOperation(), m_OverflowChecks))
+				m_Expr = "pascal_checked_neg(" + m_Expr + ", " +
+					quote(ReportsManager::PosToString(node.getOperation().pos)) + ")";
+			else if (m_ExprType == ValueType::INTEGER)
+				m_Expr = "pascal_neg(" + m_Expr + ")";
+			else
+				m_Expr = "(-" + m_Expr + ")";
+			break;
+		default:
+			throw std::runtime_error("unbelivable");
+		}
+	}
+
+	void CppTranspiler::visitProcDeclNode(AST::ProcDeclNode const& node)
+	{
+		std::string id = std::to_string(++m_ProcCount) + "_" + node.getProcName().str;
+		std::string name = "p" + id;
+		bool framed = !node.getBlock().getProcDecls().empty();
+		bool linked = currentLevel() >= 2;
+		std::string parentFrame = m_Scopes.back().frame;
+
+		m_ProcNames[node.getSymbol().get()] = name;
+
+		std::shared_ptr<const VariableSymbol> const& result = node.getSymbol()->getResult();
+		std::stringstream signature;
+		signature << ((result != nullptr) ? declType(result->getParent()) : "void") << " " << name << "(";
+		if (linked)
+			signature << parentFrame << "* link";
+		for (unsigned i = 0; i < node.getParams().size(); i++)
+		{
+			VariableSymbol const& param = *node.getParams()[i]->getVar().getSymbol();
+			if (linked || i != 0)
+				signature << ", ";
+			signature << paramDecl(param, false);
+		}
+		signature << ")";
+
+		std::stringstream fields;
+		std::stringstream body;
+		Scope scope = { framed ? "f" + id : "", framed };
+
+		if (framed)
+		{
+			m_Declarations << "struct " << scope.frame << ";" << std::endl;
+			fields << "struct " << scope.frame << std::endl << "{" << std::endl;
+			body << "\t" << scope.frame << " frame;" << std::endl;
+			if (linked)
+			{
+				fields << "\t" << parentFrame << "* link = nullptr;" << std::endl;
+				body << "\tframe.link = link;" << std::endl;
+			}
+			for (auto const& e : node.getParams())
+			{
+				VariableSymbol const& param = *e->getVar().getSymbol();
+				fields << "\t" << paramDecl(param, true) << " = {};" << std::endl;
+				body << "\tframe.v_" << param.getName() << " = " << (param.isReference() ? "&v_" : "v_") <<
+					param.getName() << ";" << std::endl;
+			}
+		}
+		m_Declarations << signature.str() << ";" << std::endl;
+
+		std::stringstream* oldBody = m_Body;
+		std::stringstream* oldDeclOut = m_DeclOut;
+		std::string oldDeclPrefix = m_DeclPrefix;
+
+		m_Scopes.push_back(scope);
+		m_Body = &body;
+		m_DeclOut = framed ? &fields : &body;
+		m_DeclPrefix = "\t";
+
+		if (result != nullptr)
+			*m_DeclOut << "\t" << declType(result->getParent()) << " v_" << result->getName() <<
+				" = {};" << std::endl;
+
+		node.getBlock().accept(this);
+		if (result != nullptr)
+			body << "\treturn " << variableRef(*result) << ";" << std::endl;
+
+		m_Scopes.pop_back();
+		m_Body = oldBody;
+		m_DeclOut = oldDeclOut;
+		m_DeclPrefix = oldDeclPrefix;
+
+		if (framed)
+			m_Structs << fields.str() << "};" << std::endl << std::endl;
+		m_Functions << signature.str() << std::endl << "{" << std::endl << body.str() <<
+			"}" << std::endl << std::endl;
+	}
+
+	void CppTranspiler::visitParamNode(const AST::ParamNode &node)
+	{ }
+
+	void CppTranspiler::visitProcCallNode(const AST::ProcCallNode& node)
+	{
+		if (node.getBuiltin() != nullptr)
+		{
+			emitBuiltin(node);
+			return;
+		}
+
+		ProcedureSymbol const& sym = *node.getSymbol();
+
+		std::stringstream call;
+		call << m_ProcNames.at(&sym) << "(";
+		bool first = true;
+		if (sym.getScopeLevel() >= 3)
+		{
+			call << linkTo(sym.getScopeLevel() - 1);
+			first = false;
+		}
+		// The arguments of reference parameters, arrays included, are
+		// bound as references.
+		auto const& params = sym.getArgs();
+		std::vector<std::string> args;
+		for (auto const& e : node.getArguments())
+		{
+			std::string hoisted = hoist(*e);
+			if (!hoisted.empty())
+			{
+				for (size_t i = 0; i < args.size(); i++)
+					args[i] = temporary(args[i], params[i]->isReference() || (params[i]->getParent() != nullptr &&
+						params[i]->getParent()->getType() == SymbolType::ARRAY_TYPE));
+				*m_Body << hoisted;
+			}
+			args.push_back(m_Expr);
+		}
+		for (auto const& e : args)
+		{
+			if (!first)
+				call << ", ";
+			call << e;
+			first = false;
+		}
+		call << ")";
+
+		if (sym.isFunction())
+		{
+			m_Expr = temporary(call.str());
+			m_ExprType = typeOf(sym.getResult()->getParent());
+			return;
+		}
+		*m_Body << indent() << call.str() << ";" << std::endl;
+	}
+
+	// A condition with calls is evaluated in the loop, which is left
+	// with a break.
+	void CppTranspiler::visitWhileNode(AST::WhileNode const& node)
+	{
+		m_Indent++;
+		std::string hoisted = condition(node.getCondition(), node.getKeyword().pos);
+		m_Indent--;
+		if (hoisted.empty())
+		{
+			*m_Body << indent() << "while (" << m_Expr << ")" << std::endl << indent() << "{" << std::endl;
+		}
+		else
+		{
+			*m_Body << indent() << "for (;;)" << std::endl << indent() << "{" << std::endl << hoisted <<
+				indent() << "\tif (!" << m_Expr << ")" << std::endl << indent() << "\t\tbreak;" << std::endl;
+		}
+		m_Indent++;
+		node.getBody().accept(this);
+		m_Indent--;
+		*m_Body << indent() << "}" << std::endl;
+	}
+
+	void CppTranspiler::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		std::stringstream statements;
+		std::stringstream* body = m_Body;
+		m_Body = &statements;
+		m_Indent++;
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+		m_Body = body;
+		std::string hoisted = condition(node.getCondition(), node.getKeyword().pos);
+		m_Indent--;
+
+		if (hoisted.empty())
+		{
+			*m_Body << indent() << "do" << std::endl << indent() << "{" << std::endl << statements.str() <<
+				indent() << "}" << std::endl << indent() << "while (!" << m_Expr << ");" << std::endl;
+		}
+		else
+		{
+			*m_Body << indent() << "for (;;)" << std::endl << indent() << "{" << std::endl << statements.str() <<
+				hoisted << indent() << "\tif (" << m_Expr << ")" << std::endl << indent() << "\t\tbreak;" <<
+				std::endl << indent() << "}" << std::endl;
+		}
+	}
+
+	void CppTranspiler::visitIfNode(AST::IfNode const& node)
+	{
+		*m_Body << condition(node.getCondition(), node.getKeyword().pos);
+		*m_Body << indent() << "if (" << m_Expr << ")" << std::endl << indent() << "{" << std::endl;
+		m_Indent++;
+		node.getThen().accept(this);
+		m_Indent--;
+		*m_Body << indent() << "}" << std::endl;
+
+		if (node.getElse() != nullptr)
+		{
+			*m_Body << indent() << "else" << std::endl << indent() << "{" << std::endl;
+			m_Indent++;
+			node.getElse()->accept(this);
+			m_Indent--;
+			*m_Body << indent() << "}" << std::endl;
+		}
+	}
+
+	void CppTranspiler::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		m_Expr = node.getValue() ? "true" : "false";
+		m_ExprType = ValueType::BOOLEAN;
+	}
+
+	// The selector is evaluated once; C++ picks the dispatch for a switch
+	// the same way the Compiler does.
+	void CppTranspiler::visitCaseNode(AST::CaseNode const& node)
+	{
+		node.getSelector().accept(this);
+		if (m_ExprType != ValueType::INTEGER)
+			ReportsManager::ReportError(node.getKeyword().pos, ErrorType::ILLEGAL_OPERANDS, false);
+
+		*m_Body << indent() << "switch (" << m_Expr << ")" << std::endl << indent() << "{" << std::endl;
+		for (auto const& branch : node.getBranches())
+		{
+			for (auto const& label : branch.labels)
+				*m_Body << indent() << "case " << label.getValue() << "L:" << std::endl;
+			*m_Body << indent() << "{" << std::endl;
+			m_Indent++;
+			branch.statement->accept(this);
+			*m_Body << indent() << "break;" << std::endl;
+			m_Indent--;
+			*m_Body << indent() << "}" << std::endl;
+		}
+		*m_Body << indent() << "default:" << std::endl << indent() << "{" << std::endl;
+		m_Indent++;
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+		*m_Body << indent() << "break;" << std::endl;
+		m_Indent--;
+		*m_Body << indent() << "}" << std::endl << indent() << "}" << std::endl;
+	}
+
+	// The bounds are evaluated once, before the variable is set. Like in the
+	// interpreter the variable keeps the last value it was given.
+	void CppTranspiler::visitForNode(AST::ForNode const& node)
+	{
+		std::string id = std::to_string(++m_LoopCount);
+		std::string var = variableRef(*node.getVar().getSymbol());
+
+		node.getFrom().accept(this);
+		if (m_ExprType != ValueType::INTEGER)
+			ReportsManager::ReportError(node.getKeyword().pos, ErrorType::ILLEGAL_OPERANDS, false);
+		std::string from = m_Expr;
+
+		std::string hoisted = hoist(node.getTo());
+		if (m_ExprType != ValueType::INTEGER)
+			ReportsManager::ReportError(node.getKeyword().pos, ErrorType::ILLEGAL_OPERANDS, false);
+		if (!hoisted.empty())
+		{
+			from = temporary(from);
+			*m_Body << hoisted;
+		}
+
+		*m_Body << indent() << "{" << std::endl;
+		m_Indent++;
+		*m_Body << indent() << "long first" << id << " = " << from << ";" << std::endl <<
+			indent() << "long last" << id << " = " << m_Expr << ";" << std::endl <<
+			indent() << var << " = first" << id << ";" << std::endl <<
+			indent() << "if (" << var << (node.isDownto() ? " >= " : " <= ") << "last" << id << ")" << std::endl <<
+			indent() << "\tfor (;; " << var << (node.isDownto() ? "--" : "++") << ")" << std::endl <<
+			indent() << "\t{" << std::endl;
+		m_Indent += 2;
+		node.getBody().accept(this);
+		m_Indent -= 2;
+		*m_Body << indent() << "\t\tif (" << var << " == last" << id << ")" << std::endl <<
+			indent() << "\t\t\tbreak;" << std::endl << indent() << "\t}" << std::endl;
+		m_Indent--;
+		*m_Body << indent() << "}" << std::endl;
+	}
+
+	void CppTranspiler::emitBuiltin(AST::ProcCallNode const& node)
+	{
+		switch (node.getBuiltin()->getRoutine())
+		{
+		case Builtin::LENGTH:
+			node.getArguments()[0]->accept(this);
+			if (m_ExprType != ValueType::STRING)
+				ReportsManager::ReportError(node.getProcName().pos, ErrorType::ILLEGAL_OPERANDS, false);
+			m_Expr = "pascal_length(" + m_Expr + ")";
+			m_ExprType = ValueType::INTEGER;
+			break;
+		case Builtin::NEW:
+		{
+			node.getArguments()[0]->accept(this);
+			std::shared_ptr<const Symbol> const& target =
+				reinterpret_cast<const PointerTypeSymbol*>(node.getPointerType().get())->getTarget();
+			bool chars = target != nullptr && target->getType() == SymbolType::SET_TYPE &&
+				reinterpret_cast<const SetTypeSymbol*>(target.get())->isChars();
+			*m_Body << indent() << m_Expr << " = new " << declType(target) << (chars ? "{ {}, true };" : "();") <<
+				std::endl;
+			break;
+		}
+		case Builtin::DISPOSE:
+			node.getArguments()[0]->accept(this);
+			*m_Body << indent() << "delete " << m_Expr << ";" << std::endl;
+			break;
+		case Builtin::WRITE:
+		case Builtin::WRITELN:
+		case Builtin::READ:
+		case Builtin::READLN:
+			emitTransfer(node);
+			break;
+		case Builtin::ASSIGN:
+		{
+			node.getArguments()[0]->accept(this);
+			std::string file = m_Expr;
+			node.getArguments()[1]->accept(this);
+			if (m_ExprType != ValueType::STRING)
+				ReportsManager::ReportError(node.getProcName().pos, ErrorType::ILLEGAL_OPERANDS, false);
+			*m_Body << indent() << "pascal_assign(" << file << ", " << m_Expr << ");" << std::endl;
+			break;
+		}
+		case Builtin::RESET:
+		case Builtin::REWRITE:
+			node.getArguments()[0]->accept(this);
+			*m_Body << indent() << (node.getBuiltin()->getRoutine() == Builtin::RESET ? "pascal_reset(" : "pascal_rewrite(") <<
+				m_Expr << ", " << quote(ReportsManager::PosToString(node.getProcName().pos)) << ");" << std::endl;
+			break;
+		case Builtin::CLOSE:
+			node.getArguments()[0]->accept(this);
+			*m_Body << indent() << "pascal_close(" << m_Expr << ");" << std::endl;
+			break;
+		case Builtin::END_OF_FILE:
+			if (node.getArguments().empty())
+			{
+				m_Expr = "pascal_eof(std::cin.rdbuf())";
+			}
+			else
+			{
+				node.getArguments()[0]->accept(this);
+				m_Expr = "pascal_eof(pascal_input(" + m_Expr + ", " +
+					quote(ReportsManager::PosToString(node.getProcName().pos)) + "))";
+			}
+			m_ExprType = ValueType::BOOLEAN;
+			break;
+		}
+	}
+
+	// read and write of a text file redirect std::cin or std::cout to it
+	// for the statement.
+	void CppTranspiler::emitTransfer(AST::ProcCallNode const& node)
+	{
+		Builtin routine = node.getBuiltin()->getRoutine();
+		bool reading = (routine == Builtin::READ || routine == Builtin::READLN);
+		std::string where = quote(ReportsManager::PosToString(node.getProcName().pos));
+		auto const& args = node.getArguments();
+		size_t first = 0;
+		if (node.hasTextFile())
+		{
+			args[0]->accept(this);
+			*m_Body << indent() << "{" << std::endl;
+			m_Indent++;
+			*m_Body << indent() << "pascal_redirect file(" << (reading ? "std::cin, pascal_input(" : "std::cout, pascal_output(") <<
+				m_Expr << ", " << where << "));" << std::endl;
+			first = 1;
+		}
+
+		for (size_t i = first; i < args.size(); i++)
+		{
+			args[i]->accept(this);
+			if (reading)
+			{
+				*m_Body << indent() << "pascal_read(" << m_Expr << ", " << where << ");" << std::endl;
+				continue;
+			}
+			if (!isNumeric(m_ExprType) && m_ExprType != ValueType::BOOLEAN && m_ExprType != ValueType::STRING)
+				ReportsManager::ReportError(node.getProcName().pos, ErrorType::ILLEGAL_OPERANDS, false);
+			*m_Body << indent() << "pascal_write(" << m_Expr << ");" << std::endl;
+		}
+		if (routine == Builtin::READLN)
+			*m_Body << indent() << "pascal_readln();" << std::endl;
+		else if (routine == Builtin::WRITELN)
+			*m_Body << indent() << "std::cout << '\\n';" << std::endl;
+
+		if (node.hasTextFile())
+		{
+			m_Indent--;
+			*m_Body << indent() << "}" << std::endl;
+		}
+	}
+
+	void CppTranspiler::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{ }
+
+	void CppTranspiler::visitFieldNode(AST::FieldNode const& node)
+	{
+		if (node.getElement() != nullptr)
+			node.getElement()->accept(this);
+		else
+			node.getVar().accept(this);
+
+		if (node.isDereference())
+			m_Expr = "(*pascal_deref(" + m_Expr + ", " + quote(ReportsManager::PosToString(node.getCaret().pos)) + "))";
+		for (auto const& e : node.getFields())
+			m_Expr += ".f_" + e.str;
+		m_ExprType = typeOf(node.getType());
+	}
+
+	void CppTranspiler::visitNilNode(AST::NilNode const& node)
+	{
+		m_Expr = "nullptr";
+		m_ExprType = ValueType::POINTER;
+	}
+
+	std::string CppTranspiler::toString() const
+	{
+		std::stringstream ss;
+		ss << PRELUDE << m_Declarations.str() << std::endl << m_Globals.str() << std::endl <<
+			m_Structs.str() << m_Functions.str() << "int main()" << std::endl << "{" <<
+			std::endl << m_Main.str() << "}" << std::endl;
+		return ss.str();
+	}
+
+	std::string CppTranspiler::condition(AST::Node const& node, size_t where)
+	{
+		std::string hoisted = hoist(node);
+		if (m_ExprType != ValueType::BOOLEAN)
+			ReportsManager::ReportError(where, ErrorType::ILLEGAL_OPERANDS, false);
+		return hoisted;
+	}
+
+	std::string CppTranspiler::hoist(AST::Node const& node)
+	{
+		std::stringstream hoisted;
+		std::stringstream* body = m_Body;
+		m_Body = &hoisted;
+		node.accept(this);
+		m_Body = body;
+		return hoisted.str();
+	}
+
+	// Integer literals, booleans and temporaries.
+	static bool keepsValue(std::string const& expr)
+	{
+		if (expr == "true" || expr == "false")
+			return true;
+		size_t first = (expr[0] == 't') ? 1 : 0;
+		size_t last = (expr.back() == 'L') ? expr.size() - 1 : expr.size();
+		if (first + (last != expr.size()) != 1 || first >= last)
+			return false;
+		return std::all_of(expr.begin() + first, expr.begin() + last, [](char c) { return c >= '0' && c <= '9'; });
+	}
+
+	// Copies what a call hoisted after it could change, or binds a
+	// reference to it.
+	std::string CppTranspiler::temporary(std::string const& expr, bool reference)
+	{
+		if (!reference && keepsValue(expr))
+			return expr;
+		std::string name = "t" + std::to_string(++m_TempCount);
+		*m_Body << indent() << (reference ? "auto& " : "auto ") << name << " = " << expr << ";" << std::endl;
+		return name;
+	}
+
+	// Frames keep pointers to the arguments of reference parameters.
+	std::string CppTranspiler::variableRef(VariableSymbol const& sym) const
+	{
+		unsigned level = sym.getScopeLevel();
+		std::string name = "v_" + sym.getName();
+
+		if (level == 1 || (level == currentLevel() && !m_Scopes.back().framed))
+			return name;
+		else if (level == currentLevel())
+			name = "frame." + name;
+		else
+			name = linkTo(level) + "->" + name;
+		return sym.isReference() ? "(*" + name + ")" : name;
+	}
+
+	// Address of the innermost active frame of the level.
+	std::string CppTranspiler::linkTo(unsigned level) const
+	{
+		if (level == currentLevel())
+			return "&frame";
+
+		std::string res = "link";
+		for (unsigned i = currentLevel() - 1; i > level; i--)
+			res += "->link";
+		return res;
+	}
+
+	ValueType CppTranspiler::typeOf(std::shared_ptr<const Symbol> const& type)
+	{
+		if (type != nullptr && type->getName() == "real")
+			return ValueType::REAL;
+		else if (type != nullptr && type->getName() == "boolean")
+			return ValueType::BOOLEAN;
+		else if (type != nullptr && type->getName() == "string")
+			return ValueType::STRING;
+		else if (type != nullptr && type->getName() == "bigint")
+			return ValueType::BIGINT;
+		else if (type != nullptr && type->getName() == "text")
+			return ValueType::TEXT;
+		else if (type != nullptr && type->getType() == SymbolType::SET_TYPE)
+			return ValueType::SET;
+		else if (type != nullptr && type->getType() == SymbolType::RECORD_TYPE)
+			return ValueType::NONE;
+		else if (type != nullptr && type->getType() == SymbolType::POINTER_TYPE)
+			return ValueType::POINTER;
+		else
+			return ValueType::INTEGER;
+	}
+
+	std::string CppTranspiler::declType(std::shared_ptr<const Symbol> const& type)
+	{
+		if (type != nullptr && type->getType() == SymbolType::POINTER_TYPE)
+			return declType(reinterpret_cast<const PointerTypeSymbol*>(type.get())->getTarget()) + "*";
+		if (type == nullptr || type->getType() != SymbolType::RECORD_TYPE)
+			return cppType(typeOf(type));
+		return recordStruct(*reinterpret_cast<const RecordTypeSymbol*>(type.get()));
+	}
+
+	// Only bools are not aligned to 8 bytes.
+	static unsigned alignmentOf(std::shared_ptr<const Symbol> const& type)
+	{
+		if (type != nullptr && type->getName() == "boolean")
+			return 1;
+		if (type == nullptr || type->getType() != SymbolType::RECORD_TYPE)
+			return 8;
+
+		unsigned res = 1;
+		for (auto const& e : reinterpret_cast<const RecordTypeSymbol*>(type.get())->getFields())
+			res = std::max(res, alignmentOf(e.type));
+		return res;
+	}
+
+	// Emits the struct of a record the first time it is used, with the
+	// functions printing it. The slots of the interpreter have no padding to
+	// save, a packed record gets its fields ordered by alignment here instead.
+	// The struct is declared ahead of its fields, which may point to it.
+	std::string CppTranspiler::recordStruct(RecordTypeSymbol const& record)
+	{
+		auto found = m_RecordNames.find(&record);
+		if (found != m_RecordNames.end())
+			return found->second;
+
+		std::vector<RecordTypeSymbol::Field> fields = record.getFields();
+		if (record.isPacked())
+		{
+			std::stable_sort(fields.begin(), fields.end(),
+				[](RecordTypeSymbol::Field const& a, RecordTypeSymbol::Field const& b)
+				{ return alignmentOf(a.type) > alignmentOf(b.type); });
+		}
+
+		std::string name = "r" + std::to_string(m_RecordNames.size() + 1) + "_" + record.getName();
+		m_RecordNames[&record] = name;
+		m_Declarations << "struct " << name << ";" << std::endl;
+
+		std::stringstream ss;
+		ss << "struct " << name << std::endl << "{" << std::endl;
+		for (auto const& e : fields)
+		{
+			bool chars = e.type != nullptr && e.type->getType() == SymbolType::SET_TYPE &&
+				reinterpret_cast<const SetTypeSymbol*>(e.type.get())->isChars();
+			ss << "\t" << declType(e.type) << " f_" << e.name << (chars ? " = { {}, true };" : " = {};") <<
+				std::endl;
+		}
+		ss << "};" << std::endl << std::endl;
+
+		ss << "inline void pascal_put(" << name << " const& value)" << std::endl << "{" << std::endl;
+		for (unsigned k = 0; k < record.getLeaves().size(); k++)
+		{
+			std::string path = record.getLeaves()[k].path;
+			std::string member = "value.f_" + path;
+			for (size_t dot = member.find('.', 6); dot != std::string::npos; dot = member.find('.', dot + 1))
+				member.insert(dot + 1, "f_");
+			ss << "\tstd::cout << " << quote(((k == 0) ? "(" : ", ") + path + ": ") << ";" << std::endl <<
+				"\tpascal_put(" << member << ");" << std::endl;
+		}
+		ss << "\tstd::cout << " << (record.getLeaves().empty() ? "\"()\"" : "\")\"") << ";" << std::endl <<
+			"}" << std::endl << std::endl;
+
+		ss << "inline void pascal_show(const char* name, " << name << " const& value)" << std::endl <<
+			"{" << std::endl << "\tstd::cout << \"-- \" << std::setw(8) << name << \" : \";" << std::endl <<
+			"\tpascal_put(value);" << std::endl << "\tstd::cout << std::endl;" << std::endl << "}" <<
+			std::endl << std::endl;
+
+		m_Declarations << ss.str();
+		return name;
+	}
+
+	// A reference parameter is a C++ reference to the argument, or the
+	// pointer to it a frame keeps if 'pointer'.
+	std::string CppTranspiler::paramDecl(VariableSymbol const& param, bool pointer)
+	{
+		std::string name = "v_" + param.getName();
+		if (!param.isReference())
+			return declType(param.getParent()) + " " + name;
+
+		std::string declarator = (pointer ? "*" : "&") + name;
+		std::string qualifier = (param.getMode() == ParamMode::CONST) ? " const" : "";
+		std::shared_ptr<const Symbol> type = param.getParent();
+		if (type == nullptr || type->getType() != SymbolType::ARRAY_TYPE)
+			return declType(type) + qualifier + " " + declarator;
+
+		const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(type.get());
+		return declType(array->getElement()) + qualifier + " (" + declarator + ")[" +
+			std::to_string(array->getLength()) + "]";
+	}
+
+	std::string CppTranspiler::cppType(ValueType type)
+	{
+		switch (type)
+		{
+		case ValueType::REAL:
+			return "double";
+		case ValueType::BOOLEAN:
+			return "bool";
+		case ValueType::STRING:
+			return "std::string";
+		case ValueType::SET:
+			return "pascal_set";
+		case ValueType::BIGINT:
+			return "pascal_bigint";
+		case ValueType::TEXT:
+			return "pascal_text";
+		default:
+			return "long";
+		}
+	}
+}
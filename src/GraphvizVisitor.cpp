@@ -66,6 +66,11 @@ namespace Pascal
 	{
 		derivateStack.push_back(createNode("Block"));
 		
+		for (auto const& e : node.getTypeDecls())
+		{
+			e->accept(this);
+		}
+
 		for (auto const& e : node.getVarDecls())
 		{
 			e->accept(this);
@@ -83,7 +88,29 @@ namespace Pascal
 
 	void GraphvizVisitor::visitTypeNode(AST::TypeNode const& node)
 	{
-	    createNode(node.getToken().str);
+		if (node.isRecord())
+		{
+			derivateStack.push_back(createNode(node.isPacked() ? "packed record" : "record"));
+			for (auto const& field : *node.getFields())
+			{
+				std::string names;
+				for (auto const& e : field.names)
+					names += (names.empty() ? "" : ", ") + e.str;
+				derivateStack.push_back(createNode(names));
+				field.type->accept(this);
+				derivateStack.pop_back();
+			}
+			derivateStack.pop_back();
+			return;
+		}
+		if (!node.isArray())
+		{
+			createNode((node.isPointer() ? "^" : "") + node.getToken().str);
+			return;
+		}
+		createNode("array [" + std::string(node.getLow().negative ? "-" : "") + node.getLow().literal.str + ".." +
+				   std::string(node.getHigh().negative ? "-" : "") + node.getHigh().literal.str + "] of " +
+				   node.getToken().str);
 	}
 
 	void GraphvizVisitor::visitStatementNode(AST::StatementNode const& node)
@@ -106,7 +133,12 @@ namespace Pascal
 	void GraphvizVisitor::visitAssignmentNode(AST::AssignmentNode const& node)
 	{
 		derivateStack.push_back(createNode(":="));
-		node.getVar().accept(this);
+		if (node.getField() != nullptr)
+			node.getField()->accept(this);
+		else if (node.getElement() != nullptr)
+			node.getElement()->accept(this);
+		else
+			node.getVar().accept(this);
 		node.getExpr().accept(this);
 		derivateStack.pop_back();
 	}
@@ -144,7 +176,8 @@ namespace Pascal
 
 	void GraphvizVisitor::visitProcDeclNode(const AST::ProcDeclNode &node)
 	{
-		std::string name = "ProcDecl: \"" + node.getProcName().str + "\"";
+		std::string name = ((node.getResultType() != nullptr) ? "FuncDecl: \"" : "ProcDecl: \"") +
+			node.getProcName().str + "\"";
 	    derivateStack.push_back(createNode(name));
 	    for (auto const& e : node.getParams())
 		{
@@ -156,7 +189,8 @@ namespace Pascal
 
 	void GraphvizVisitor::visitParamNode(const AST::ParamNode &node)
 	{
-		derivateStack.push_back(createNode("Param"));
+		derivateStack.push_back(createNode((node.getMode().type != TokenType::NONE) ?
+										   "Param: " + node.getMode().str : "Param"));
 		node.getVar().accept(this);
 		node.getType().accept(this);
 		derivateStack.pop_back();
@@ -169,4 +203,124 @@ namespace Pascal
 			e->accept(this);
 		derivateStack.pop_back();
 	}
+
+	void GraphvizVisitor::visitWhileNode(AST::WhileNode const& node)
+	{
+		derivateStack.push_back(createNode("While"));
+		node.getCondition().accept(this);
+		node.getBody().accept(this);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		derivateStack.push_back(createNode("Repeat"));
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+		node.getCondition().accept(this);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitForNode(AST::ForNode const& node)
+	{
+		derivateStack.push_back(createNode((node.isDownto()) ? ("For downto") : ("For to")));
+		node.getVar().accept(this);
+		node.getFrom().accept(this);
+		node.getTo().accept(this);
+		node.getBody().accept(this);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitIfNode(AST::IfNode const& node)
+	{
+		derivateStack.push_back(createNode("If"));
+		node.getCondition().accept(this);
+		node.getThen().accept(this);
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		createNode(node.getToken().str);
+	}
+
+	void GraphvizVisitor::visitCaseNode(AST::CaseNode const& node)
+	{
+		derivateStack.push_back(createNode("Case"));
+		node.getSelector().accept(this);
+		for (auto const& branch : node.getBranches())
+		{
+			std::string labels;
+			for (auto const& label : branch.labels)
+				labels += (labels.empty() ? "" : ", ") + std::string(label.negative ? "-" : "") + label.literal.str;
+			derivateStack.push_back(createNode(labels));
+			branch.statement->accept(this);
+			derivateStack.pop_back();
+		}
+		if (node.getElse() != nullptr)
+		{
+			derivateStack.push_back(createNode("else"));
+			node.getElse()->accept(this);
+			derivateStack.pop_back();
+		}
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitIndexNode(AST::IndexNode const& node)
+	{
+		derivateStack.push_back(createNode("[]"));
+		node.getVar().accept(this);
+		node.getIndex().accept(this);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitStringNode(AST::StringNode const& node)
+	{
+		createNode("'" + node.getToken().str + "'");
+	}
+
+	void GraphvizVisitor::visitSetNode(AST::SetNode const& node)
+	{
+		derivateStack.push_back(createNode("[]"));
+		for (auto const& e : node.getElements())
+		{
+			if (e.high == nullptr)
+			{
+				e.low->accept(this);
+				continue;
+			}
+			derivateStack.push_back(createNode(".."));
+			e.low->accept(this);
+			e.high->accept(this);
+			derivateStack.pop_back();
+		}
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{
+		derivateStack.push_back(createNode("TypeDecl"));
+		createNode(node.getName().str);
+		node.getType().accept(this);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitFieldNode(AST::FieldNode const& node)
+	{
+		derivateStack.push_back(createNode(node.isDereference() ? "^" : "."));
+		if (node.getElement() != nullptr)
+			node.getElement()->accept(this);
+		else
+			node.getVar().accept(this);
+		for (auto const& e : node.getFields())
+			createNode(e.str);
+		derivateStack.pop_back();
+	}
+
+	void GraphvizVisitor::visitNilNode(AST::NilNode const& node)
+	{
+		createNode("nil");
+	}
 }
@@ -0,0 +1,310 @@
+#include <pscpch.hpp>
+#include <Inliner.hpp>
+#include <AST.hpp>
+#include <ReportsManager.hpp>
+
+namespace Pascal
+{
+	void Inliner::visitProgramNode(AST::ProgramNode const& node)
+	{
+		m_Enclosing.push_back(nullptr);
+		node.getBlock().accept(this);
+		m_Enclosing.pop_back();
+
+		for (auto& e : m_Procedures)
+		{
+			if (e.first != nullptr)
+				decide(e.first);
+		}
+	}
+
+	void Inliner::visitVarDeclNode(AST::VarDeclNode const& node)
+	{ }
+
+	void Inliner::visitBlockNode(AST::BlockNode const& node)
+	{
+		for (auto const& e : node.getProcDecls())
+			e->accept(this);
+
+		node.getCompound().accept(this);
+	}
+
+	void Inliner::visitTypeNode(AST::TypeNode const& node)
+	{ }
+
+	void Inliner::visitStatementNode(AST::StatementNode const& node)
+	{
+		node.accept(this);
+	}
+
+	void Inliner::visitCompoundNode(AST::CompoundNode const& node)
+	{
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+	}
+
+	// Only statements that surely run may count as the first use. The
+	// right side is read before the target is written.
+	void Inliner::visitAssignmentNode(AST::AssignmentNode const& node)
+	{
+		current().size++;
+		AST::IndexNode const* element = (node.getField() != nullptr) ?
+			node.getField()->getElement() : node.getElement();
+		if (element != nullptr)
+			element->getIndex().accept(this);
+		else if (node.getField() != nullptr && node.getField()->isDereference())
+			current().assignedFirst.insert({ node.getVar().getSymbol().get(), false });
+		node.getExpr().accept(this);
+		if (element == nullptr && node.getField() == nullptr)
+			current().assignedFirst.insert({ node.getVar().getSymbol().get(), m_Conditional == 0 });
+	}
+
+	void Inliner::visitVariableNode(AST::VariableNode const& node)
+	{
+		if (node.getCall() != nullptr)
+		{
+			node.getCall()->accept(this);
+			return;
+		}
+		current().size++;
+		current().assignedFirst.insert({ node.getSymbol().get(), false });
+	}
+
+	void Inliner::visitNullStatementNode(AST::NullStatementNode const& node)
+	{ }
+
+	void Inliner::visitNumberNode(AST::NumberNode const& node)
+	{
+		current().size++;
+	}
+
+	void Inliner::visitBinOpNode(AST::BinOpNode const& node)
+	{
+		current().size++;
+		node.getLeft().accept(this);
+		node.getRight().accept(this);
+	}
+
+	void Inliner::visitUnaryOpNode(AST::UnaryOpNode const& node)
+	{
+		current().size++;
+		node.getExpr().accept(this);
+	}
+
+	// A function's result is read when it returns.
+	void Inliner::visitProcDeclNode(AST::ProcDeclNode const& node)
+	{
+		m_Enclosing.push_back(node.getSymbol().get());
+		current().decl = &node;
+		node.getBlock().accept(this);
+		if (node.getSymbol()->isFunction())
+			current().assignedFirst.insert({ node.getSymbol()->getResult().get(), false });
+		m_Enclosing.pop_back();
+	}
+
+	void Inliner::visitParamNode(const AST::ParamNode &node)
+	{ }
+
+	void Inliner::visitProcCallNode(const AST::ProcCallNode& node)
+	{
+		current().size++;
+		if (node.getSymbol() != nullptr)
+			current().calls.push_back(node.getSymbol().get());
+		for (auto const& e : node.getArguments())
+			e->accept(this);
+	}
+
+	void Inliner::visitWhileNode(AST::WhileNode const& node)
+	{
+		current().size++;
+		node.getCondition().accept(this);
+		m_Conditional++;
+		node.getBody().accept(this);
+		m_Conditional--;
+	}
+
+	void Inliner::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		current().size++;
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+		node.getCondition().accept(this);
+	}
+
+	void Inliner::visitForNode(AST::ForNode const& node)
+	{
+		current().size += 2;
+		node.getFrom().accept(this);
+		node.getTo().accept(this);
+		current().assignedFirst.insert({ node.getVar().getSymbol().get(), m_Conditional == 0 });
+		m_Conditional++;
+		node.getBody().accept(this);
+		m_Conditional--;
+	}
+
+	// Either branch may be skipped.
+	void Inliner::visitIfNode(AST::IfNode const& node)
+	{
+		current().size++;
+		node.getCondition().accept(this);
+		m_Conditional++;
+		node.getThen().accept(this);
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+		m_Conditional--;
+	}
+
+	void Inliner::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		current().size++;
+	}
+
+	// At most one branch runs.
+	void Inliner::visitIndexNode(AST::IndexNode const& node)
+	{
+		current().size++;
+		node.getIndex().accept(this);
+	}
+
+	void Inliner::visitStringNode(AST::StringNode const& node)
+	{
+		current().size++;
+	}
+
+	void Inliner::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{ }
+
+	void Inliner::visitFieldNode(AST::FieldNode const& node)
+	{
+		current().size++;
+		if (node.getElement() != nullptr)
+			node.getElement()->getIndex().accept(this);
+		else if (node.isDereference())
+			current().assignedFirst.insert({ node.getVar().getSymbol().get(), false });
+	}
+
+	void Inliner::visitNilNode(AST::NilNode const& node)
+	{
+		current().size++;
+	}
+
+	void Inliner::visitSetNode(AST::SetNode const& node)
+	{
+		current().size++;
+		for (auto const& e : node.getElements())
+		{
+			e.low->accept(this);
+			if (e.high != nullptr)
+				e.high->accept(this);
+		}
+	}
+
+	void Inliner::visitCaseNode(AST::CaseNode const& node)
+	{
+		current().size++;
+		node.getSelector().accept(this);
+		m_Conditional++;
+		for (auto const& branch : node.getBranches())
+		{
+			current().size += branch.labels.size();
+			branch.statement->accept(this);
+		}
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+		m_Conditional--;
+	}
+
+	AST::ProcDeclNode const* Inliner::getInlinable(ProcedureSymbol const& sym) const
+	{
+		auto it = m_Procedures.find(&sym);
+		if (it == m_Procedures.end() || !it->second.inlinable)
+			return nullptr;
+		return it->second.decl;
+	}
+
+	unsigned Inliner::getExpandedSize(ProcedureSymbol const& sym) const
+	{
+		auto it = m_Procedures.find(&sym);
+		return (it == m_Procedures.end()) ? 0 : it->second.expandedSize;
+	}
+
+	bool Inliner::needsReset(ProcedureSymbol const& sym, VariableSymbol const& var) const
+	{
+		auto it = m_Procedures.find(&sym);
+		if (it == m_Procedures.end())
+			return true;
+
+		auto use = it->second.assignedFirst.find(&var);
+		return use != it->second.assignedFirst.end() && !use->second;
+	}
+
+	void Inliner::addInlined(ProcedureSymbol const& callee, std::string const& caller, size_t pos)
+	{
+		m_Inlined.push_back({ pos, callee.getName(), caller });
+	}
+
+	std::string Inliner::getReport() const
+	{
+		std::stringstream ss;
+		for (auto const& e : m_Inlined)
+			ss << ReportsManager::PosToString(e.pos) << ": inlined " << e.callee <<
+				" into " << e.caller << std::endl;
+		return ss.str();
+	}
+
+	// Callees first: a procedure is measured with the calls to inlinable
+	// procedures expanded. Recursive procedures are never inlined, so the
+	// callees looked at don't lead back here.
+	void Inliner::decide(const ProcedureSymbol* sym)
+	{
+		Procedure& proc = m_Procedures[sym];
+		if (proc.visited)
+			return;
+		proc.visited = true;
+
+		std::set<const ProcedureSymbol*> visited;
+		if (!proc.decl->getBlock().getProcDecls().empty() || reaches(sym, sym, visited))
+			return;
+		// Elements and fields are addressed by their slot in the frame, see
+		// Compiler::emitElement, and arguments are stored into the slots
+		// of the parameters by value.
+		for (auto const& e : proc.decl->getParams())
+		{
+			if (e->getVar().getSymbol()->isReference())
+				return;
+		}
+		for (auto const& e : proc.decl->getBlock().getVarDecls())
+		{
+			std::shared_ptr<const Symbol> type = e->getVar().getSymbol()->getParent();
+			if (type != nullptr &&
+				(type->getType() == SymbolType::ARRAY_TYPE || type->getType() == SymbolType::RECORD_TYPE))
+				return;
+		}
+
+		proc.expandedSize = proc.size;
+		for (auto callee : proc.calls)
+		{
+			decide(callee);
+			if (m_Procedures[callee].inlinable)
+				proc.expandedSize += m_Procedures[callee].expandedSize;
+		}
+		proc.inlinable = proc.expandedSize <= m_MaxSize;
+	}
+
+	bool Inliner::reaches(const ProcedureSymbol* from, const ProcedureSymbol* to,
+						  std::set<const ProcedureSymbol*>& visited) const
+	{
+		auto it = m_Procedures.find(from);
+		if (it == m_Procedures.end())
+			return false;
+
+		for (auto callee : it->second.calls)
+		{
+			if (callee == to)
+				return true;
+			if (visited.insert(callee).second && reaches(callee, to, visited))
+				return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,329 @@
+#include <pscpch.hpp>
+#include <InputBuffer.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Pascal
+{
+	// Exactly representable, so a mantissa of at most 53 bits scaled by one
+	// of them is rounded once, like the parse of the whole text would be.
+	static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	// Spaces, tabs, line breaks and the other control characters.
+	static bool isBlank(char c)
+	{
+		return static_cast<unsigned char>(c) <= ' ';
+	}
+
+	static bool isDigit(char c)
+	{
+		return static_cast<unsigned>(c - '0') < 10;
+	}
+
+	// Skips the digits at 'p', false if there are none.
+	static bool digits(const char*& p, const char* end)
+	{
+		const char* first = p;
+		while (p != end && isDigit(*p))
+			p++;
+		return p != first;
+	}
+
+	InputBuffer::InputBuffer(int fd)
+		: m_Fd(fd)
+	{
+	}
+
+	InputBuffer::~InputBuffer()
+	{
+		if (m_Mapped != nullptr)
+			munmap(m_Mapped, m_MappedSize);
+	}
+
+	bool InputBuffer::readInteger(long& value)
+	{
+		if (!skipBlanks())
+			return false;
+		size_t length = token();
+		const char* p = m_Pos;
+		const char* end = m_Pos + length;
+
+		bool negative = *p == '-';
+		if (*p == '-' || *p == '+')
+			p++;
+		if (p == end)
+			return false;
+
+		uint64_t magnitude = 0;
+		for (; p != end; p++)
+		{
+			unsigned digit = static_cast<unsigned>(*p - '0');
+			if (digit > 9 || __builtin_mul_overflow(magnitude, 10, &magnitude) ||
+				__builtin_add_overflow(magnitude, digit, &magnitude))
+				return false;
+		}
+
+		uint64_t limit = uint64_t(1) << 63;
+		if (negative ? magnitude > limit : magnitude >= limit)
+			return false;
+		value = static_cast<long>(negative ? uint64_t(0) - magnitude : magnitude);
+		m_Pos = end;
+		return true;
+	}
+
+	// Digits, an optional fraction and an optional exponent. Up to 19
+	// significant digits with a small enough exponent are converted here,
+	// the rest by from_chars.
+	bool InputBuffer::readReal(double& value)
+	{
+		if (!skipBlanks())
+			return false;
+		size_t length = token();
+		const char* first = m_Pos;
+		const char* end = m_Pos + length;
+		const char* p = first;
+
+		bool negative = *p == '-';
+		if (*p == '-' || *p == '+')
+			p++;
+		const char* number = p;
+
+		uint64_t mantissa = 0;
+		int significant = 0;
+		int exponent = 0;
+		bool exact = true;
+		for (; p != end && isDigit(*p); p++)
+		{
+			if (significant > 0 || *p != '0')
+				significant++;
+			mantissa = mantissa * 10 + (*p - '0');
+		}
+		bool whole = p != number;
+		if (p != end && *p == '.')
+		{
+			const char* fraction = ++p;
+			for (; p != end && isDigit(*p); p++)
+			{
+				if (significant > 0 || *p != '0')
+					significant++;
+				mantissa = mantissa * 10 + (*p - '0');
+			}
+			exponent -= static_cast<int>(p - fraction);
+			if (!whole && p == fraction)
+				return false;
+		}
+		else if (!whole)
+		{
+			return false;
+		}
+
+		if (p != end && (*p == 'e' || *p == 'E'))
+		{
+			p++;
+			bool down = p != end && *p == '-';
+			if (p != end && (*p == '-' || *p == '+'))
+				p++;
+			const char* power = p;
+			if (!digits(p, end))
+				return false;
+			if (p - power > 4)
+				exact = false;
+			else
+			{
+				int scale = 0;
+				for (const char* d = power; d != p; d++)
+					scale = scale * 10 + (*d - '0');
+				exponent += down ? -scale : scale;
+			}
+		}
+		if (p != end)
+			return false;
+
+		if (exact && significant <= 19 && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+		{
+			double res = static_cast<double>(mantissa);
+			res = (exponent < 0) ? res / POWERS_OF_TEN[-exponent] : res * POWERS_OF_TEN[exponent];
+			value = negative ? -res : res;
+		}
+		else
+		{
+			// from_chars takes a minus but no plus.
+			auto res = std::from_chars((*first == '+') ? first + 1 : first, end, value);
+			if (res.ec != std::errc() || res.ptr != end)
+				return false;
+		}
+		m_Pos = end;
+		return true;
+	}
+
+	bool InputBuffer::readDigits(const char*& chars, size_t& length)
+	{
+		if (!skipBlanks())
+			return false;
+		size_t count = token();
+		const char* p = m_Pos;
+		const char* end = m_Pos + count;
+		if (*p == '-' || *p == '+')
+			p++;
+		if (!digits(p, end) || p != end)
+			return false;
+
+		chars = m_Pos;
+		length = count;
+		m_Pos = end;
+		return true;
+	}
+
+	bool InputBuffer::readLine(const char*& chars, size_t& length)
+	{
+		if (atEnd())
+			return false;
+
+		size_t count = 0;
+		for (;;)
+		{
+			const void* found = memchr(m_Pos + count, '\n', m_End - m_Pos - count);
+			if (found != nullptr)
+			{
+				count = static_cast<const char*>(found) - m_Pos;
+				break;
+			}
+			count = m_End - m_Pos;
+			if (!more())
+				break;
+		}
+
+		chars = m_Pos;
+		m_Pos += count;
+		length = (count > 0 && chars[count - 1] == '\r') ? count - 1 : count;
+		return true;
+	}
+
+	void InputBuffer::skipLine()
+	{
+		for (;;)
+		{
+			const void* found = memchr(m_Pos, '\n', m_End - m_Pos);
+			if (found != nullptr)
+			{
+				m_Pos = static_cast<const char*>(found) + 1;
+				return;
+			}
+			m_Pos = m_End;
+			if (!more())
+				return;
+		}
+	}
+
+	bool InputBuffer::atEnd()
+	{
+		return m_Pos == m_End && !more();
+	}
+
+	// False if only blanks are left.
+	bool InputBuffer::skipBlanks()
+	{
+		for (;;)
+		{
+			while (m_Pos != m_End && isBlank(*m_Pos))
+				m_Pos++;
+			if (m_Pos != m_End || !more())
+				return m_Pos != m_End;
+		}
+	}
+
+	// The length of the value at m_Pos, which is in the buffer whole.
+	size_t InputBuffer::token()
+	{
+		size_t length = 0;
+		for (;;)
+		{
+			while (m_Pos + length != m_End && !isBlank(m_Pos[length]))
+				length++;
+			if (m_Pos + length != m_End || !more())
+				return length;
+		}
+	}
+
+	// The rest of the mapping is all there is to read, the file is about
+	// to be emptied.
+	void InputBuffer::unmap(struct stat const& file)
+	{
+		if (m_Mapped == nullptr || file.st_dev != m_Device || file.st_ino != m_Inode)
+			return;
+
+		m_Buffer.assign(m_Pos, m_End);
+		munmap(m_Mapped, m_MappedSize);
+		m_Mapped = nullptr;
+		m_Pos = m_Buffer.data();
+		m_End = m_Pos + m_Buffer.size();
+	}
+
+	// Reads more after what is left from m_Pos on, which is moved to the
+	// start of the buffer, or maps the whole input the first time. False
+	// if nothing was added.
+	bool InputBuffer::more()
+	{
+		if (m_Exhausted)
+			return false;
+		if (!m_Started)
+		{
+			m_Started = true;
+			if (map())
+				return m_Pos != m_End;
+		}
+
+		size_t kept = m_End - m_Pos;
+		if (kept > 0 && m_Pos != m_Buffer.data())
+			memmove(m_Buffer.data(), m_Pos, kept);
+		if (m_Buffer.size() - kept < SIZE / 2)
+			m_Buffer.resize(std::max(SIZE, m_Buffer.size() * 2));
+
+		ssize_t got;
+		do
+			got = ::read(m_Fd, m_Buffer.data() + kept, m_Buffer.size() - kept);
+		while (got < 0 && errno == EINTR);
+
+		m_Pos = m_Buffer.data();
+		m_End = m_Pos + kept + std::max<ssize_t>(got, 0);
+		if (got <= 0)
+		{
+			m_Exhausted = true;
+			return false;
+		}
+		return true;
+	}
+
+	// A regular file is mapped from where the descriptor is on.
+	bool InputBuffer::map()
+	{
+		struct stat info;
+		if (fstat(m_Fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+			return false;
+		off_t offset = lseek(m_Fd, 0, SEEK_CUR);
+		if (offset < 0 || offset > info.st_size)
+			return false;
+
+		void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, m_Fd, 0);
+		if (mapped == MAP_FAILED)
+			return false;
+		madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+		m_Mapped = mapped;
+		m_MappedSize = info.st_size;
+		m_Device = info.st_dev;
+		m_Inode = info.st_ino;
+		m_Pos = static_cast<const char*>(mapped) + offset;
+		m_End = static_cast<const char*>(mapped) + info.st_size;
+		m_Exhausted = true;
+		return true;
+	}
+}
@@ -3,116 +3,1293 @@
 #include "Lexer.hpp"
 #include "ReportsManager.hpp"
 #include <Interpreter.hpp>
-#include <AST.hpp>
-#include <pthread.h>
+#include <VectorKernels.hpp>
+#include <climits>
 #include <stdexcept>
 
 namespace Pascal
 {
-	void Interpreter::visitProgramNode(AST::ProgramNode const& node)
+	static const size_t OPCODES_COUNT = static_cast<size_t>(OpCode::OPCODES_COUNT);
+	
+	// The main frame, which holds the global arrays, comes on top of 'stackSize'.
+	Interpreter::Interpreter(Bytecode& code, size_t stackSize)
+		: m_Code(code), m_StackSize(stackSize + code.getProcedures()[0].getFrameSize())
 	{
-		m_CallStack.push(ActivationRecord(node.getName().str, ARType::PROGRAM, 1));
-		node.getBlock().accept(this);
-		std::cout << m_CallStack.toString() << std::endl;
-		m_CallStack.pop();
+		m_Stack.reset(new Value[m_StackSize]);
+		unsigned maxLevel = 1;
+		for (auto const& e : m_Code.getProcedures())
+			maxLevel = std::max(maxLevel, e.nestingLevel);
+		m_Display.resize(maxLevel + 1, nullptr);
 	}
-	
-	void Interpreter::visitVarDeclNode(AST::VarDeclNode const& node)
-	{ }
 
-	void Interpreter::visitBlockNode(AST::BlockNode const& node)
+	void Interpreter::enableJit(unsigned threshold)
 	{
-		node.getCompound().accept(this);
+		m_Jit.reset(new Jit(m_Code, threshold, m_Output));
 	}
 
-	void Interpreter::visitTypeNode(AST::TypeNode const& node)
-	{ }
+	const char* Interpreter::getDispatchName()
+	{
+#ifdef PASCAL_THREADED_DISPATCH
+		return "threaded";
+#else
+		return "switch";
+#endif
+	}
 
-	void Interpreter::visitStatementNode(AST::StatementNode const& node)
-	{ }
+	void Interpreter::run()
+	{
+		ProcedureCode const& main = m_Code.getProcedures()[0];
+		Value* globals = m_Stack.get();
 
-	void Interpreter::visitCompoundNode(AST::CompoundNode const& node)
+		std::copy(main.slotsInit.begin(), main.slotsInit.end(), globals);
+		m_Display[main.nestingLevel] = globals;
+		m_CallStack.push(ActivationRecord(main, globals, nullptr, nullptr));
+
+		// Whatever was printed before goes out before the program's output.
+		std::cout.flush();
+
+		const Instruction* entry = m_Code.getCode().data() + main.entry;
+		if (m_Profiling)
+		{
+			m_PairCounts.assign(OPCODES_COUNT * OPCODES_COUNT, 0);
+			execute<true>(entry);
+		}
+		else
+		{
+			execute<false>(entry);
+		}
+
+		std::string variables = m_CallStack.toString();
+		m_Output.put(variables.data(), variables.size());
+		m_Output.put('\n');
+		m_Output.flush();
+		m_CallStack.pop();
+		m_Files.clear();
+
+		m_Reclaimed = 0;
+		if (m_HeapReset)
+		{
+			m_Reclaimed = m_Objects.getLiveObjects();
+			m_Objects.reset();
+		}
+	}
+
+	std::string Interpreter::getPairProfile(unsigned top) const
 	{
-		for (auto const& e : node.getStatements())
-			e->accept(this);
+		std::vector<std::pair<unsigned long, size_t>> pairs;
+		for (size_t i = 0; i < m_PairCounts.size(); i++)
+		{
+			if (m_PairCounts[i] != 0)
+				pairs.push_back({ m_PairCounts[i], i });
+		}
+		std::sort(pairs.rbegin(), pairs.rend());
+
+		std::stringstream ss;
+		ss << "OPCODE PAIRS" << std::endl;
+		for (size_t i = 0; i < pairs.size() && i < top; i++)
+		{
+			OpCode first = static_cast<OpCode>(pairs[i].second / OPCODES_COUNT);
+			OpCode second = static_cast<OpCode>(pairs[i].second % OPCODES_COUNT);
+			ss << std::setw(12) << pairs[i].first << "  " << std::left <<
+				std::setw(20) << opCodeToString(first) << opCodeToString(second) <<
+				std::right << std::endl;
+		}
+		return ss.str();
+	}
+
+	void Interpreter::unmapInputs(std::string const& name)
+	{
+		struct stat info;
+		if (stat(name.c_str(), &info) != 0)
+			return;
+		m_Input.unmap(info);
+		for (auto const& e : m_Files)
+		{
+			if (e.getInput() != nullptr)
+				e.getInput()->unmap(info);
+		}
 	}
 
-	void Interpreter::visitAssignmentNode(AST::AssignmentNode const& node)
+	// Variables keep the type they were declared with, a string takes the
+	// rest of the line.
+	bool Interpreter::read(InputBuffer& input, Value& var)
 	{
-		node.getExpr().accept(this);
-		m_CallStack.peek()[node.getVar().getToken().str] = m_Accum;
+		const char* chars;
+		size_t length;
+		switch (var.type)
+		{
+		case ValueType::INTEGER:
+			return input.readInteger(var.as.integer);
+		case ValueType::REAL:
+			return input.readReal(var.as.real);
+		case ValueType::STRING:
+			if (!input.readLine(chars, length))
+				return false;
+			var = m_Strings.make(chars, length);
+			return true;
+		case ValueType::BIGINT:
+		case ValueType::BIGNUM:
+			if (!input.readDigits(chars, length))
+				return false;
+			var = m_Bigs.parse(chars, length);
+			return true;
+		default:
+			return false;
+		}
 	}
 
-	void Interpreter::visitVariableNode(AST::VariableNode const& node)
+#define COUNT()															\
+	do																	\
+	{																	\
+		executed++;														\
+		if (PROFILE)													\
+		{																\
+			m_PairCounts[static_cast<size_t>(prevOp) * OPCODES_COUNT +	\
+						 static_cast<size_t>(ip->op)]++;				\
+			prevOp = ip->op;											\
+		}																\
+	} while (0)
+
+#ifdef PASCAL_THREADED_DISPATCH
+#define CASE(name) L_##name:
+#define DISPATCH() do { COUNT(); goto *ip->handler; } while (0)
+#define LOOP_BEGIN DISPATCH();
+#define LOOP_END
+#else
+#define CASE(name) case OpCode::name:
+#define DISPATCH() continue
+#define LOOP_BEGIN for (;;) { COUNT(); switch (ip->op) {
+#define LOOP_END default: throw std::runtime_error("unbelivable"); } }
+#endif
+
+#define POSITION() m_Code.getPos(ip - code)
+// What the program wrote so far goes out before the error.
+#define RUNTIME_ERROR(type) (m_Output.flush(), ReportsManager::ReportError(POSITION(), ErrorType::type, false))
+#define OPERANDS_ERROR() RUNTIME_ERROR(ILLEGAL_OPERANDS)
+
+	// top := top <function> right
+#define ARITHMETIC(function, right)										\
+	do																	\
+	{																	\
+		if (!function(sp[-1], (right), sp[-1]))							\
+			OPERANDS_ERROR();											\
+	} while (0)
+
+	// top := top <function> right, reporting an integer result that
+	// doesn't fit where 'builtin' (one of __builtin_*_overflow) says so.
+#define CHECKED(builtin, function, right)								\
+	do																	\
+	{																	\
+		Value const& operand = (right);									\
+		if (PASCAL_LIKELY(bothIntegers(sp[-1], operand)))				\
+		{																\
+			if (builtin(sp[-1].as.integer, operand.as.integer, &sp[-1].as.integer)) \
+				RUNTIME_ERROR(INTEGER_OVERFLOW);						\
+		}																\
+		else if (!function(sp[-1], operand, sp[-1]))					\
+			OPERANDS_ERROR();											\
+	} while (0)
+
+#define DIVISION(function, right)										\
+	do																	\
+	{																	\
+		Value const& divisor = (right);									\
+		if (isZero(divisor))											\
+			RUNTIME_ERROR(DIVISION_BY_ZERO);							\
+		if (!function(sp[-1], divisor, sp[-1]))							\
+			OPERANDS_ERROR();											\
+	} while (0)
+
+	// Arguments are the first slots of the new frame, the remaining ones
+	// get their typed zero values.
+#define ENTER(proc, frame)												\
+	do																	\
+	{																	\
+		Value* newBase = (frame);										\
+		Value* newTop = newBase + (proc).getFrameSize();				\
+																		\
+		if (newTop + (proc).maxStack > stackEnd)						\
+			RUNTIME_ERROR(STACK_OVERFLOW);								\
+																		\
+		std::copy((proc).slotsInit.begin() + (proc).paramsCount, (proc).slotsInit.end(), \
+				  newBase + (proc).paramsCount);						\
+		m_CallStack.push(ActivationRecord((proc), newBase, ip + 1, display[(proc).nestingLevel])); \
+		display[(proc).nestingLevel] = newBase;							\
+																		\
+		base = newBase;													\
+		sp = newTop;													\
+		ip = code + (proc).entry;										\
+	} while (0)
+
+	// The caller's frame is done with: the callee's arguments move down to
+	// its base and the callee takes over its activation record, returning
+	// where the caller would have.
+#define TAIL_ENTER(proc, args)											\
+	do																	\
+	{																	\
+		ActivationRecord& record = m_CallStack.peek();					\
+		display[record.getNestingLevel()] = record.getSavedDisplay();	\
+																		\
+		Value* newTop = base + (proc).getFrameSize();					\
+		if (newTop + (proc).maxStack > stackEnd)						\
+			RUNTIME_ERROR(STACK_OVERFLOW);								\
+																		\
+		std::copy((args), (args) + (proc).paramsCount, base);			\
+		std::copy((proc).slotsInit.begin() + (proc).paramsCount, (proc).slotsInit.end(), \
+				  base + (proc).paramsCount);							\
+		record = ActivationRecord((proc), base, record.getReturnAddress(), \
+								  display[(proc).nestingLevel]);		\
+		display[(proc).nestingLevel] = base;							\
+																		\
+		sp = newTop;													\
+		ip = code + (proc).entry;										\
+	} while (0)
+
+	// Runs native code from here on if the current instruction has some,
+	// until it hands an instruction back to the interpreter.
+#define ENTER_NATIVE()													\
+	do																	\
+	{																	\
+		if (native != nullptr && native[ip - code] != nullptr)			\
+		{																\
+			JitContext ctx = { base, sp, globals, display, 0, 0 };		\
+			m_Jit->run(ctx, &m_CallStack.peek().getProcedure() - procedures, \
+					   native[ip - code]);								\
+			ip = code + ctx.exitIp;										\
+			sp = ctx.sp;												\
+		}																\
+	} while (0)
+
+	// Taken backward jumps count towards compiling the running procedure,
+	// whose code may then be entered at the jump target.
+#define BACK_EDGE()														\
+	do																	\
+	{																	\
+		if (jit != nullptr)												\
+		{																\
+			jit->countBackEdge(&m_CallStack.peek().getProcedure() - procedures); \
+			ENTER_NATIVE();												\
+		}																\
+	} while (0)
+
+	// goto a if 'taken'
+#define JUMP_IF(taken)													\
+	do																	\
+	{																	\
+		if (taken)														\
+		{																\
+			const Instruction* target = code + ip->a;					\
+			bool backward = target <= ip;								\
+			ip = target;												\
+			if (backward)												\
+				BACK_EDGE();											\
+		}																\
+		else															\
+		{																\
+			ip++;														\
+		}																\
+	} while (0)
+
+	// goto a if the popped boolean is 'expected'
+#define CONDITIONAL_JUMP(condition, expected)							\
+	do																	\
+	{																	\
+		Value const& value = (condition);								\
+		if (!value.isBoolean())											\
+			OPERANDS_ERROR();											\
+		JUMP_IF(value.as.boolean == (expected));						\
+	} while (0)
+
+	// res := left <rel> right
+#define COMPARE(rel, left, right, res)									\
+	do																	\
+	{																	\
+		if (!compare(Relation::rel, (left), (right), (res)))			\
+			OPERANDS_ERROR();											\
+	} while (0)
+
+	// top := top <rel> pop
+#define RELATION(rel)													\
+	do																	\
+	{																	\
+		bool res;														\
+		sp--;															\
+		COMPARE(rel, sp[-1], sp[0], res);								\
+		sp[-1] = Value::Boolean(res);									\
+	} while (0)
+
+	// goto a if left <rel> right
+#define COMPARE_JUMP(rel, left, right)									\
+	do																	\
+	{																	\
+		bool taken;														\
+		COMPARE(rel, (left), (right), taken);							\
+		JUMP_IF(taken);													\
+	} while (0)
+
+	// The JUMPs after a case dispatch: the default, then the label entries.
+	static inline const Instruction* caseList(const Instruction* ip, long selector, const Value* constants)
 	{
-		m_Accum = m_CallStack.peek()[node.getToken().str];
+		const Instruction* entries = ip + 2;
+		for (int32_t i = 0; i < ip->a; i++)
+		{
+			if (constants[entries[i].b].as.integer == selector)
+				return entries + i;
+		}
+		return ip + 1;
 	}
 
-	void Interpreter::visitNullStatementNode(AST::NullStatementNode const& node)
-	{ }
+	static inline const Instruction* caseFind(const Instruction* ip, long selector, const Value* constants)
+	{
+		const Instruction* first = ip + 2;
+		const Instruction* last = first + ip->a;
+		while (first < last)
+		{
+			const Instruction* middle = first + (last - first) / 2;
+			long label = constants[middle->b].as.integer;
+			if (label == selector)
+				return middle;
+			if (label < selector)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		return ip + 1;
+	}
 
-	void Interpreter::visitNumberNode(AST::NumberNode const& node)
+	// Values below the lowest label wrap around past the table.
+	static inline const Instruction* caseTable(const Instruction* ip, long selector, const Value* constants)
 	{
-		m_Accum.value = std::stol(node.getToken().str);
+		unsigned long index = static_cast<unsigned long>(selector) -
+			static_cast<unsigned long>(constants[ip[1].b].as.integer);
+		return (index < static_cast<unsigned long>(ip->a)) ? ip + 2 + index : ip + 1;
 	}
 
-	void Interpreter::visitBinOpNode(AST::BinOpNode const& node)
+	// goto the target of the entry 'find' picks for the integer selector,
+	// always forward
+#define CASE_DISPATCH(find, selector)									\
+	do																	\
+	{																	\
+		Value const& value = (selector);								\
+		if (!value.isInteger())											\
+			OPERANDS_ERROR();											\
+		ip = code + find(ip, value.as.integer, constants)->a;			\
+	} while (0)
+
+#define CHECK_INDEX(index, low, high)									\
+	do																	\
+	{																	\
+		Value const& value = (index);									\
+		if (!value.isInteger())											\
+			OPERANDS_ERROR();											\
+		if (value.as.integer < (low) || value.as.integer > (high))		\
+			RUNTIME_ERROR(INDEX_OUT_OF_RANGE);							\
+	} while (0)
+
+	// Slot of the element 'index' of the array whose element 0 would be
+	// at 'frame[offset]'.
+#define ELEMENT(frame, offset, index)									\
+	(frame)[(offset) + ((index).isInteger() ? (index).as.integer : (OPERANDS_ERROR(), 0))]
+
+	// r[a] := r[b] <function> right
+#define REGISTER_ARITHMETIC(function, right)							\
+	do																	\
+	{																	\
+		if (!function(base[ip->b], (right), base[ip->a]))				\
+			OPERANDS_ERROR();											\
+	} while (0)
+
+#define REGISTER_DIVISION(function, right)								\
+	do																	\
+	{																	\
+		Value const& divisor = (right);									\
+		if (isZero(divisor))											\
+			RUNTIME_ERROR(DIVISION_BY_ZERO);							\
+		if (!function(base[ip->b], divisor, base[ip->a]))				\
+			OPERANDS_ERROR();											\
+	} while (0)
+
+	// r[a] := r[b] <rel> r[c]
+#define REGISTER_RELATION(rel)											\
+	do																	\
+	{																	\
+		bool res;														\
+		COMPARE(rel, base[ip->b], base[ip->c], res);					\
+		base[ip->a] = Value::Boolean(res);								\
+	} while (0)
+
+	template <bool PROFILE>
+	void Interpreter::execute(const Instruction* start)
 	{
-		node.getLeft().accept(this);
-		ARObject left = m_Accum;
-		node.getRight().accept(this);
-		ARObject right = m_Accum;
-		switch (node.getOperation().type)
-		{
-		case TokenType::PLUS:
-			m_Accum.value = left.value + right.value;
-			break;
-		case TokenType::MINUS:
-			m_Accum.value = left.value - right.value;
-			break;
-		case TokenType::PRODUCT:
-			m_Accum.value = left.value * right.value;
-			break;
-		case TokenType::DIVISION:
-			if (right.value == 0)
+		const Instruction* code = m_Code.getCode().data();
+
+#ifdef PASCAL_THREADED_DISPATCH
+		static const void* labels[] = {
+#define PASCAL_OPCODE_LABEL(name, operands) &&L_##name,
+			PASCAL_OPCODES(PASCAL_OPCODE_LABEL)
+#undef PASCAL_OPCODE_LABEL
+		};
+
+		if (m_ThreadedWith != labels)
+		{
+			for (auto& e : m_Code.getCode())
+				e.handler = labels[static_cast<size_t>(e.op)];
+			m_ThreadedWith = labels;
+		}
+#endif
+
+		const Instruction* ip = start;
+		const Value* constants = m_Code.getConstants().data();
+		ProcedureCode const* procedures = m_Code.getProcedures().data();
+		VectorLoop const* vectorLoops = m_Code.getVectorLoops().data();
+		Value** display = m_Display.data();
+		Value* const globals = display[1];
+		Value* const stackEnd = m_Stack.get() + m_StackSize;
+		Jit* jit = m_Jit.get();
+		const void* const* native = jit ? jit->getEntries() : nullptr;
+		Value* base = m_CallStack.peek().getSlots();
+		Value* sp = base + m_CallStack.peek().getProcedure().getFrameSize();
+		unsigned long executed = 0;
+		OpCode prevOp = OpCode::HALT;
+
+		LOOP_BEGIN
+
+		CASE(NOP)
+		{
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(CONST)
+		{
+			*sp++ = constants[ip->a];
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_LOCAL)
+		{
+			*sp++ = base[ip->a];
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_LOCAL)
+		{
+			assign(base[ip->a], *--sp);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_GLOBAL)
+		{
+			*sp++ = globals[ip->a];
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_GLOBAL)
+		{
+			assign(globals[ip->a], *--sp);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_OUTER)
+		{
+			*sp++ = display[ip->a][ip->b];
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_OUTER)
+		{
+			assign(display[ip->a][ip->b], *--sp);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(BOUNDS)
+		{
+			CHECK_INDEX(sp[-1], ip->a, ip->b);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_ELEM)
+		{
+			sp[-1] = ELEMENT(base, ip->a, sp[-1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_ELEM)
+		{
+			sp -= 2;
+			assign(ELEMENT(base, ip->a, sp[0]), sp[1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_GELEM)
+		{
+			sp[-1] = ELEMENT(globals, ip->a, sp[-1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_GELEM)
+		{
+			sp -= 2;
+			assign(ELEMENT(globals, ip->a, sp[0]), sp[1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_OELEM)
+		{
+			sp[-1] = ELEMENT(display[ip->a], ip->b, sp[-1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_OELEM)
+		{
+			sp -= 2;
+			assign(ELEMENT(display[ip->a], ip->b, sp[0]), sp[1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(REF_LOCAL)
+		{
+			*sp++ = Value::Reference(base + ip->a);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(REF_GLOBAL)
+		{
+			*sp++ = Value::Reference(globals + ip->a);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(REF_OUTER)
+		{
+			*sp++ = Value::Reference(display[ip->a] + ip->b);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(REF_INDEX)
+		{
+			sp--;
+			if (!sp[0].isInteger())
+				OPERANDS_ERROR();
+			sp[-1].as.ref += ip->a + sp[0].as.integer;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_REF)
+		{
+			sp[-1] = sp[-1].as.ref[ip->a];
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(STORE_REF)
+		{
+			sp -= 2;
+			assign(sp[0].as.ref[ip->a], sp[1]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(NEW)
+		{
+			sp--;
+			*sp[0].as.ref = Value::Pointer(m_Objects.allocate(m_Code.getLayouts()[ip->a]));
+			ip++;
+			DISPATCH();
+		}
+
+		// Disposing of nil does nothing.
+		CASE(DISPOSE)
+		{
+			sp--;
+			if (!sp[0].isPointer())
+				OPERANDS_ERROR();
+			if (sp[0].as.ref != nullptr && !m_Objects.free(sp[0].as.ref, ip->a))
+				RUNTIME_ERROR(DISPOSED_TWICE);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(DEREF)
+		{
+			if (PASCAL_UNLIKELY(!sp[-1].isPointer()))
+				OPERANDS_ERROR();
+			if (PASCAL_UNLIKELY(sp[-1].as.ref == nullptr))
+				RUNTIME_ERROR(NIL_DEREFERENCE);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(ADD)
+		{
+			sp--;
+			ARITHMETIC(plus, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(SUB)
+		{
+			sp--;
+			ARITHMETIC(minus, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(MUL)
+		{
+			sp--;
+			ARITHMETIC(times, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(DIV)
+		{
+			sp--;
+			DIVISION(divide, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(MOD)
+		{
+			sp--;
+			DIVISION(modulo, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(NEG)
+		{
+			if (!negate(sp[-1], sp[-1]))
+				OPERANDS_ERROR();
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(ADD_CHECKED)
+		{
+			sp--;
+			CHECKED(__builtin_add_overflow, plus, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(SUB_CHECKED)
+		{
+			sp--;
+			CHECKED(__builtin_sub_overflow, minus, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(MUL_CHECKED)
+		{
+			sp--;
+			CHECKED(__builtin_mul_overflow, times, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(DIV_CHECKED)
+		{
+			sp--;
+			if (bothIntegers(sp[-1], sp[0]) && sp[-1].as.integer == LONG_MIN && sp[0].as.integer == -1)
+				RUNTIME_ERROR(INTEGER_OVERFLOW);
+			DIVISION(divide, sp[0]);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(NEG_CHECKED)
+		{
+			if (sp[-1].isInteger() && sp[-1].as.integer == LONG_MIN)
+				RUNTIME_ERROR(INTEGER_OVERFLOW);
+			if (!negate(sp[-1], sp[-1]))
+				OPERANDS_ERROR();
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(WRITE)
+		{
+			sp--;
+			if (!m_Output.putValue(sp[0]))
+				OPERANDS_ERROR();
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(WRITELN)
+		{
+			m_Output.put('\n');
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(READ)
+		{
+			sp--;
+			if (PASCAL_UNLIKELY(!read(m_Input, *sp[0].as.ref)))
 			{
-				ReportsManager::ReportError(node.getOperation().pos, ErrorType::DIVISION_BY_ZERO, false);
+				if (m_Input.atEnd())
+					RUNTIME_ERROR(READ_PAST_END);
+				RUNTIME_ERROR(INVALID_INPUT);
+			}
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(READLN)
+		{
+			m_Input.skipLine();
+			ip++;
+			DISPATCH();
+		}
+
+		// A text variable gets its handle when it is first assigned.
+		CASE(ASSIGN_FILE)
+		{
+			sp -= 2;
+			if (!sp[1].isString())
+				OPERANDS_ERROR();
+			Value& var = *sp[0].as.ref;
+			if (var.as.integer < 0)
+			{
+				m_Files.emplace_back();
+				var = Value::Text(m_Files.size() - 1);
+			}
+			m_Files[var.as.integer].assign(std::string(sp[1].stringChars(), sp[1].stringLength()));
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(RESET)
+		CASE(REWRITE)
+		{
+			sp--;
+			TextFile* file = textFile(sp[0]);
+			if (file == nullptr)
+				RUNTIME_ERROR(UNASSIGNED_FILE);
+			if (ip->op == OpCode::REWRITE)
+				unmapInputs(file->getName());
+			if (!((ip->op == OpCode::RESET) ? file->reset() : file->rewrite()))
+				RUNTIME_ERROR(CANT_OPEN_FILE);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(CLOSE)
+		{
+			sp--;
+			TextFile* file = textFile(sp[0]);
+			if (file != nullptr)
+				file->close();
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(AT_EOF)
+		{
+			if (ip->a == 0)
+			{
+				*sp++ = Value::Boolean(m_Input.atEnd());
 			}
 			else
 			{
-				m_Accum.value = left.value / right.value;
+				TextFile* file = textFile(sp[-1]);
+				if (file == nullptr || file->getInput() == nullptr)
+					RUNTIME_ERROR(FILE_NOT_OPEN_FOR_READING);
+				sp[-1] = Value::Boolean(file->getInput()->atEnd());
 			}
-			break;
-		case TokenType::MOD:
-			m_Accum.value = left.value % right.value;
-			break;
-		default:
-			throw std::runtime_error("unbelivable");
+			ip++;
+			DISPATCH();
 		}
-	}
 
-	void Interpreter::visitUnaryOpNode(AST::UnaryOpNode const& node)
-	{
-		node.getExpr().accept(this);
-		switch (node.getOperation().type)
-		{
-		case TokenType::PLUS:
-			m_Accum.value = +m_Accum.value;
-			break;
-		case TokenType::MINUS:
-			m_Accum.value = -m_Accum.value;
-			break;
-		default:
-			throw std::runtime_error("unbelivable");			
+		CASE(FILE_READ)
+		{
+			TextFile* file = textFile(sp[-2]);
+			if (file == nullptr || file->getInput() == nullptr)
+				RUNTIME_ERROR(FILE_NOT_OPEN_FOR_READING);
+			if (PASCAL_UNLIKELY(!read(*file->getInput(), *sp[-1].as.ref)))
+			{
+				if (file->getInput()->atEnd())
+					RUNTIME_ERROR(READ_PAST_END);
+				RUNTIME_ERROR(INVALID_INPUT);
+			}
+			sp -= 1 + ip->a;
+			ip++;
+			DISPATCH();
 		}
-	}
 
-	void Interpreter::visitProcDeclNode(const AST::ProcDeclNode &node)
-	{ }
+		CASE(FILE_READLN)
+		{
+			TextFile* file = textFile(sp[-1]);
+			if (file == nullptr || file->getInput() == nullptr)
+				RUNTIME_ERROR(FILE_NOT_OPEN_FOR_READING);
+			file->getInput()->skipLine();
+			sp -= ip->a;
+			ip++;
+			DISPATCH();
+		}
 
-	void Interpreter::visitParamNode(const AST::ParamNode &node)
-	{ }
+		CASE(FILE_WRITE)
+		{
+			TextFile* file = textFile(sp[-2]);
+			if (file == nullptr || file->getOutput() == nullptr)
+				RUNTIME_ERROR(FILE_NOT_OPEN_FOR_WRITING);
+			if (!file->getOutput()->putValue(sp[-1]))
+				OPERANDS_ERROR();
+			sp -= 1 + ip->a;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(FILE_WRITELN)
+		{
+			TextFile* file = textFile(sp[-1]);
+			if (file == nullptr || file->getOutput() == nullptr)
+				RUNTIME_ERROR(FILE_NOT_OPEN_FOR_WRITING);
+			file->getOutput()->put('\n');
+			sp -= ip->a;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(NOT)
+		{
+			if (!sp[-1].isBoolean())
+				OPERANDS_ERROR();
+			sp[-1].as.boolean = !sp[-1].as.boolean;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(EQ) { RELATION(EQ); ip++; DISPATCH(); }
+		CASE(NE) { RELATION(NE); ip++; DISPATCH(); }
+		CASE(LT) { RELATION(LT); ip++; DISPATCH(); }
+		CASE(LE) { RELATION(LE); ip++; DISPATCH(); }
+		CASE(GT) { RELATION(GT); ip++; DISPATCH(); }
+		CASE(GE) { RELATION(GE); ip++; DISPATCH(); }
+
+		CASE(CHAR_AT)
+		{
+			sp--;
+			if (!sp[-1].isString())
+				OPERANDS_ERROR();
+			CHECK_INDEX(sp[0], 1, static_cast<long>(sp[-1].stringLength()));
+			sp[-1] = Value::ShortString(sp[-1].stringChars() + sp[0].as.integer - 1, 1);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LENGTH)
+		{
+			if (!sp[-1].isString())
+				OPERANDS_ERROR();
+			sp[-1] = Value::Integer(static_cast<long>(sp[-1].stringLength()));
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(SET_BUILD)
+		{
+			SetBits bits = *constants[ip->b].as.set;
+			sp -= ip->a;
+			for (int32_t k = 0; k < ip->a; k++)
+			{
+				// A single element is a range of its own.
+				bool single = (k >= ip->a - ip->c);
+				long low = 0;
+				long high = 0;
+				if (!ordinal(sp[k], low) || !ordinal(sp[single ? k : k + 1], high))
+					OPERANDS_ERROR();
+				bits.chars = bits.chars || sp[k].isString();
+				if (!single)
+					k++;
+				if (low > high)
+					continue;
+				if (low < 0 || high > SetBits::MAX_ELEMENT)
+					RUNTIME_ERROR(ILLEGAL_SET_ELEMENT);
+				bits.insert(low, high);
+			}
+			*sp++ = m_Sets.make(bits);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(IN)
+		{
+			sp--;
+			long element = 0;
+			if (!sp[0].isSet() || !ordinal(sp[-1], element))
+				OPERANDS_ERROR();
+			sp[-1] = Value::Boolean(sp[0].as.set->contains(element));
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(TO_REAL)
+		{
+			if (sp[-1].isInteger())
+				sp[-1] = Value::Real(static_cast<double>(sp[-1].as.integer));
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(TO_BIG)
+		{
+			if (sp[-1].isInteger())
+				sp[-1].type = ValueType::BIGINT;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(JUMP)
+		{
+			const Instruction* target = code + ip->a;
+			bool backward = target <= ip;
+			ip = target;
+			if (backward)
+				BACK_EDGE();
+			DISPATCH();
+		}
+
+		CASE(JUMP_FALSE) { sp--; CONDITIONAL_JUMP(sp[0], false); DISPATCH(); }
+		CASE(JUMP_TRUE)  { sp--; CONDITIONAL_JUMP(sp[0], true);  DISPATCH(); }
+
+		CASE(JUMP_EQ) { sp -= 2; COMPARE_JUMP(EQ, sp[0], sp[1]); DISPATCH(); }
+		CASE(JUMP_NE) { sp -= 2; COMPARE_JUMP(NE, sp[0], sp[1]); DISPATCH(); }
+		CASE(JUMP_LT) { sp -= 2; COMPARE_JUMP(LT, sp[0], sp[1]); DISPATCH(); }
+		CASE(JUMP_LE) { sp -= 2; COMPARE_JUMP(LE, sp[0], sp[1]); DISPATCH(); }
+		CASE(JUMP_GT) { sp -= 2; COMPARE_JUMP(GT, sp[0], sp[1]); DISPATCH(); }
+		CASE(JUMP_GE) { sp -= 2; COMPARE_JUMP(GE, sp[0], sp[1]); DISPATCH(); }
+
+		CASE(CASE_LIST)  { sp--; CASE_DISPATCH(caseList,  sp[0]); DISPATCH(); }
+		CASE(CASE_FIND)  { sp--; CASE_DISPATCH(caseFind,  sp[0]); DISPATCH(); }
+		CASE(CASE_TABLE) { sp--; CASE_DISPATCH(caseTable, sp[0]); DISPATCH(); }
+
+		CASE(FOR_INIT)
+		{
+			Value const& var = base[ip->b];
+			Value const& limit = base[ip->c];
+			if (!bothIntegers(var, limit))
+				OPERANDS_ERROR();
+			ip = (var.as.integer > limit.as.integer) ? code + ip->a : ip + 1;
+			DISPATCH();
+		}
+
+		CASE(FOR_INIT_DN)
+		{
+			Value const& var = base[ip->b];
+			Value const& limit = base[ip->c];
+			if (!bothIntegers(var, limit))
+				OPERANDS_ERROR();
+			ip = (var.as.integer < limit.as.integer) ? code + ip->a : ip + 1;
+			DISPATCH();
+		}
+
+		// The body may have changed the variable through an outer reference.
+		CASE(FOR_NEXT)
+		{
+			Value& var = base[ip->b];
+			if (!var.isInteger())
+				OPERANDS_ERROR();
+			if (var.as.integer < base[ip->c].as.integer)
+			{
+				var.as.integer++;
+				ip = code + ip->a;
+				BACK_EDGE();
+			}
+			else
+			{
+				ip++;
+			}
+			DISPATCH();
+		}
+
+		CASE(FOR_NEXT_DN)
+		{
+			Value& var = base[ip->b];
+			if (!var.isInteger())
+				OPERANDS_ERROR();
+			if (var.as.integer > base[ip->c].as.integer)
+			{
+				var.as.integer--;
+				ip = code + ip->a;
+				BACK_EDGE();
+			}
+			else
+			{
+				ip++;
+			}
+			DISPATCH();
+		}
+
+		CASE(VECTOR)
+		{
+			ip = VectorKernels::run(vectorLoops[ip->b], base, display, constants) ? code + ip->a : ip + 1;
+			DISPATCH();
+		}
+
+		CASE(CALL)
+		{
+			ProcedureCode const& proc = procedures[ip->a];
+			if (jit != nullptr)
+				jit->countInvocation(ip->a);
+			ENTER(proc, sp - proc.paramsCount);
+			ENTER_NATIVE();
+			DISPATCH();
+		}
+
+		CASE(TAIL_CALL)
+		{
+			ProcedureCode const& proc = procedures[ip->a];
+			if (jit != nullptr)
+				jit->countInvocation(ip->a);
+			TAIL_ENTER(proc, sp - proc.paramsCount);
+			ENTER_NATIVE();
+			DISPATCH();
+		}
+
+		CASE(RET)
+		{
+			ActivationRecord& record = m_CallStack.peek();
+			display[record.getNestingLevel()] = record.getSavedDisplay();
+			ip = record.getReturnAddress();
+			sp = record.getSlots();
+			m_CallStack.pop();
+
+			base = m_CallStack.peek().getSlots();
+			ENTER_NATIVE();
+			DISPATCH();
+		}
+
+		// A function's result takes the place of its first argument on the
+		// caller's stack, nothing is kept in the activation record.
+		CASE(RET_VALUE)
+		{
+			Value result = base[ip->a];
+			ActivationRecord& record = m_CallStack.peek();
+			display[record.getNestingLevel()] = record.getSavedDisplay();
+			ip = record.getReturnAddress();
+			sp = record.getSlots();
+			*sp++ = result;
+			m_CallStack.pop();
+
+			base = m_CallStack.peek().getSlots();
+			ENTER_NATIVE();
+			DISPATCH();
+		}
+
+		CASE(ADD_CONST) { ARITHMETIC(plus, constants[ip->a]); ip++; DISPATCH(); }
+		CASE(SUB_CONST) { ARITHMETIC(minus, constants[ip->a]); ip++; DISPATCH(); }
+		CASE(MUL_CONST) { ARITHMETIC(times, constants[ip->a]); ip++; DISPATCH(); }
+		CASE(DIV_CONST) { DIVISION(divide, constants[ip->a]);   ip++; DISPATCH(); }
+		CASE(MOD_CONST) { DIVISION(modulo, constants[ip->a]);   ip++; DISPATCH(); }
+
+		CASE(ADD_LOCAL) { ARITHMETIC(plus, base[ip->a]); ip++; DISPATCH(); }
+		CASE(SUB_LOCAL) { ARITHMETIC(minus, base[ip->a]); ip++; DISPATCH(); }
+		CASE(MUL_LOCAL) { ARITHMETIC(times, base[ip->a]); ip++; DISPATCH(); }
+		CASE(DIV_LOCAL) { DIVISION(divide, base[ip->a]);   ip++; DISPATCH(); }
+		CASE(MOD_LOCAL) { DIVISION(modulo, base[ip->a]);   ip++; DISPATCH(); }
+
+		CASE(ADD_GLOBAL) { ARITHMETIC(plus, globals[ip->a]); ip++; DISPATCH(); }
+		CASE(SUB_GLOBAL) { ARITHMETIC(minus, globals[ip->a]); ip++; DISPATCH(); }
+		CASE(MUL_GLOBAL) { ARITHMETIC(times, globals[ip->a]); ip++; DISPATCH(); }
+		CASE(DIV_GLOBAL) { DIVISION(divide, globals[ip->a]);   ip++; DISPATCH(); }
+		CASE(MOD_GLOBAL) { DIVISION(modulo, globals[ip->a]);   ip++; DISPATCH(); }
+
+		CASE(LOAD_LOCAL2)
+		{
+			sp[0] = base[ip->a];
+			sp[1] = base[ip->b];
+			sp += 2;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(LOAD_GLOBAL2)
+		{
+			sp[0] = globals[ip->a];
+			sp[1] = globals[ip->b];
+			sp += 2;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(INC_LOCAL)
+		{
+			Value& var = base[ip->a];
+			Value res;
+			if (!plus(var, constants[ip->b], res))
+				OPERANDS_ERROR();
+			assign(var, res);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(INC_GLOBAL)
+		{
+			Value& var = globals[ip->a];
+			Value res;
+			if (!plus(var, constants[ip->b], res))
+				OPERANDS_ERROR();
+			assign(var, res);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(R_MOVE)      { base[ip->a] = base[ip->b];                ip++; DISPATCH(); }
+		CASE(R_LOADK)     { base[ip->a] = constants[ip->b];           ip++; DISPATCH(); }
+		CASE(R_SET)       { assign(base[ip->a], base[ip->b]);         ip++; DISPATCH(); }
+		CASE(R_SETK)      { assign(base[ip->a], constants[ip->b]);    ip++; DISPATCH(); }
+		CASE(R_GETGLOBAL) { base[ip->a] = globals[ip->b];             ip++; DISPATCH(); }
+		CASE(R_SETGLOBAL) { assign(globals[ip->a], base[ip->b]);      ip++; DISPATCH(); }
+		CASE(R_GETOUTER)  { base[ip->a] = display[ip->b][ip->c];      ip++; DISPATCH(); }
+		CASE(R_SETOUTER)  { assign(display[ip->a][ip->b], base[ip->c]); ip++; DISPATCH(); }
+
+		CASE(R_BOUNDS)     { CHECK_INDEX(base[ip->a], ip->b, ip->c);                  ip++; DISPATCH(); }
+		CASE(R_GETELEM)    { base[ip->a] = ELEMENT(base, ip->b, base[ip->c]);         ip++; DISPATCH(); }
+		CASE(R_SETELEM)    { assign(ELEMENT(base, ip->a, base[ip->b]), base[ip->c]);  ip++; DISPATCH(); }
+		CASE(R_GETGELEM)   { base[ip->a] = ELEMENT(globals, ip->b, base[ip->c]);      ip++; DISPATCH(); }
+		CASE(R_SETGELEM)   { assign(ELEMENT(globals, ip->a, base[ip->b]), base[ip->c]); ip++; DISPATCH(); }
+
+		CASE(R_ADD) { REGISTER_ARITHMETIC(plus, base[ip->c]); ip++; DISPATCH(); }
+		CASE(R_SUB) { REGISTER_ARITHMETIC(minus, base[ip->c]); ip++; DISPATCH(); }
+		CASE(R_MUL) { REGISTER_ARITHMETIC(times, base[ip->c]); ip++; DISPATCH(); }
+		CASE(R_DIV) { REGISTER_DIVISION(divide, base[ip->c]);   ip++; DISPATCH(); }
+		CASE(R_MOD) { REGISTER_DIVISION(modulo, base[ip->c]);   ip++; DISPATCH(); }
+
+		CASE(R_ADDK) { REGISTER_ARITHMETIC(plus, constants[ip->c]); ip++; DISPATCH(); }
+		CASE(R_SUBK) { REGISTER_ARITHMETIC(minus, constants[ip->c]); ip++; DISPATCH(); }
+		CASE(R_MULK) { REGISTER_ARITHMETIC(times, constants[ip->c]); ip++; DISPATCH(); }
+		CASE(R_DIVK) { REGISTER_DIVISION(divide, constants[ip->c]);   ip++; DISPATCH(); }
+		CASE(R_MODK) { REGISTER_DIVISION(modulo, constants[ip->c]);   ip++; DISPATCH(); }
+
+		CASE(R_NEG)
+		{
+			if (!negate(base[ip->b], base[ip->a]))
+				OPERANDS_ERROR();
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(R_TO_REAL)
+		{
+			Value const& value = base[ip->b];
+			base[ip->a] = value.isInteger() ? Value::Real(static_cast<double>(value.as.integer)) : value;
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(R_NOT)
+		{
+			Value const& value = base[ip->b];
+			if (!value.isBoolean())
+				OPERANDS_ERROR();
+			base[ip->a] = Value::Boolean(!value.as.boolean);
+			ip++;
+			DISPATCH();
+		}
+
+		CASE(R_EQ) { REGISTER_RELATION(EQ); ip++; DISPATCH(); }
+		CASE(R_NE) { REGISTER_RELATION(NE); ip++; DISPATCH(); }
+		CASE(R_LT) { REGISTER_RELATION(LT); ip++; DISPATCH(); }
+		CASE(R_LE) { REGISTER_RELATION(LE); ip++; DISPATCH(); }
+		CASE(R_GT) { REGISTER_RELATION(GT); ip++; DISPATCH(); }
+		CASE(R_GE) { REGISTER_RELATION(GE); ip++; DISPATCH(); }
+
+		CASE(R_CALL)
+		{
+			ProcedureCode const& proc = procedures[ip->a];
+			if (jit != nullptr)
+				jit->countInvocation(ip->a);
+			ENTER(proc, base + ip->b);
+			ENTER_NATIVE();
+			DISPATCH();
+		}
+
+		CASE(R_TAIL_CALL)
+		{
+			ProcedureCode const& proc = procedures[ip->a];
+			if (jit != nullptr)
+				jit->countInvocation(ip->a);
+			TAIL_ENTER(proc, base + ip->b);
+			ENTER_NATIVE();
+			DISPATCH();
+		}
+
+		CASE(R_JUMP_FALSE) { CONDITIONAL_JUMP(base[ip->b], false); DISPATCH(); }
+		CASE(R_JUMP_TRUE)  { CONDITIONAL_JUMP(base[ip->b], true);  DISPATCH(); }
+
+		CASE(R_JUMP_EQ) { COMPARE_JUMP(EQ, base[ip->b], base[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_NE) { COMPARE_JUMP(NE, base[ip->b], base[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_LT) { COMPARE_JUMP(LT, base[ip->b], base[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_LE) { COMPARE_JUMP(LE, base[ip->b], base[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_GT) { COMPARE_JUMP(GT, base[ip->b], base[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_GE) { COMPARE_JUMP(GE, base[ip->b], base[ip->c]); DISPATCH(); }
+
+		CASE(R_JUMP_EQK) { COMPARE_JUMP(EQ, base[ip->b], constants[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_NEK) { COMPARE_JUMP(NE, base[ip->b], constants[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_LTK) { COMPARE_JUMP(LT, base[ip->b], constants[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_LEK) { COMPARE_JUMP(LE, base[ip->b], constants[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_GTK) { COMPARE_JUMP(GT, base[ip->b], constants[ip->c]); DISPATCH(); }
+		CASE(R_JUMP_GEK) { COMPARE_JUMP(GE, base[ip->b], constants[ip->c]); DISPATCH(); }
+
+		CASE(R_CASE_LIST)  { CASE_DISPATCH(caseList,  base[ip->b]); DISPATCH(); }
+		CASE(R_CASE_FIND)  { CASE_DISPATCH(caseFind,  base[ip->b]); DISPATCH(); }
+		CASE(R_CASE_TABLE) { CASE_DISPATCH(caseTable, base[ip->b]); DISPATCH(); }
+
+		CASE(HALT)
+		{
+			m_Executed += executed;
+			return;
+		}
+
+		LOOP_END
+	}
 
-	void Interpreter::visitProcCallNode(const AST::ProcCallNode& node)
-	{ }
-}    
+#undef POSITION
+#undef OPERANDS_ERROR
+#undef ARITHMETIC
+#undef DIVISION
+#undef ENTER
+#undef TAIL_ENTER
+#undef ENTER_NATIVE
+#undef BACK_EDGE
+#undef JUMP_IF
+#undef CONDITIONAL_JUMP
+#undef COMPARE
+#undef RELATION
+#undef COMPARE_JUMP
+#undef CASE_DISPATCH
+#undef CHECK_INDEX
+#undef ELEMENT
+#undef REGISTER_ARITHMETIC
+#undef REGISTER_DIVISION
+#undef REGISTER_RELATION
+#undef COUNT
+#undef CASE
+#undef DISPATCH
+#undef LOOP_BEGIN
+#undef LOOP_END
+}
@@ -0,0 +1,1048 @@
+#include <pscpch.hpp>
+#include <Jit.hpp>
+#include <VectorKernels.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+#ifdef PASCAL_JIT_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Pascal
+{
+#ifdef PASCAL_JIT_X86_64
+	namespace
+	{
+		enum Reg : uint8_t
+		{
+			RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+			R12 = 12, R13 = 13, R14 = 14, R15 = 15
+		};
+
+		// Native code keeps the interpreter state in callee-saved registers.
+		const Reg BASE = RBX;
+		const Reg SP = R12;
+		const Reg GLOBALS = R13;
+		const Reg DISPLAY = R14;
+		const Reg CONTEXT = R15;
+
+		const int32_t TAG = offsetof(Value, type);
+		const int32_t PAYLOAD = offsetof(Value, as);
+		const int32_t SLOT = sizeof(Value);
+		const int32_t TOP = -SLOT;
+		const uint8_t INTEGER = static_cast<uint8_t>(ValueType::INTEGER);
+		const uint8_t REAL = static_cast<uint8_t>(ValueType::REAL);
+		const uint8_t BOOLEAN = static_cast<uint8_t>(ValueType::BOOLEAN);
+		const uint8_t BIGINT = static_cast<uint8_t>(ValueType::BIGINT);
+
+		enum Cond : uint8_t
+		{
+			COND_O = 0x0,
+			COND_AE = 0x3,
+			COND_E = 0x4,
+			COND_NE = 0x5,
+			COND_L = 0xC,
+			COND_GE = 0xD,
+			COND_LE = 0xE,
+			COND_G = 0xF
+		};
+
+		// Just the x86-64 encodings the templates need. Memory operands are
+		// always [base + disp32].
+		class Assembler
+		{
+		public:
+			std::vector<uint8_t> code;
+
+			size_t size() const { return code.size(); }
+
+			void byte(uint8_t b) { code.push_back(b); }
+			void dword(uint32_t d) { for (int i = 0; i < 4; i++) byte(d >> (8 * i)); }
+			void qword(uint64_t q) { for (int i = 0; i < 8; i++) byte(q >> (8 * i)); }
+
+			void rex(bool w, unsigned reg, unsigned base)
+			{
+				uint8_t res = 0x40 | (w << 3) | (((reg >> 3) & 1) << 2) | ((base >> 3) & 1);
+				if (res != 0x40)
+					byte(res);
+			}
+
+			void mem(unsigned reg, unsigned base, int32_t disp)
+			{
+				byte(0x80 | ((reg & 7) << 3) | (base & 7));
+				if ((base & 7) == RSP)
+					byte(0x24);
+				dword(disp);
+			}
+
+			void direct(unsigned reg, unsigned rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+
+			void movLoad(Reg r, Reg base, int32_t disp)  { rex(true, r, base); byte(0x8B); mem(r, base, disp); }
+			void movStore(Reg base, int32_t disp, Reg r) { rex(true, r, base); byte(0x89); mem(r, base, disp); }
+			void movReg(Reg dst, Reg src)                { rex(true, src, dst); byte(0x89); direct(src, dst); }
+			void movImm(Reg r, uint64_t imm)             { rex(true, 0, r); byte(0xB8 + (r & 7)); qword(imm); }
+
+			void movzxByte(Reg r, Reg base, int32_t disp)
+			{ rex(false, r, base); byte(0x0F); byte(0xB6); mem(r, base, disp); }
+			void movStoreByte(Reg base, int32_t disp, Reg r)
+			{ rex(false, r, base); byte(0x88); mem(r, base, disp); }
+			void movByte(Reg base, int32_t disp, uint8_t imm)
+			{ rex(false, 0, base); byte(0xC6); mem(0, base, disp); byte(imm); }
+			void cmpByte(Reg base, int32_t disp, uint8_t imm)
+			{ rex(false, 0, base); byte(0x80); mem(7, base, disp); byte(imm); }
+			void movStoreImm(Reg base, int32_t disp, int32_t imm)
+			{ rex(true, 0, base); byte(0xC7); mem(0, base, disp); dword(imm); }
+			void cmpLoad(Reg r, Reg base, int32_t disp)
+			{ rex(true, r, base); byte(0x3B); mem(r, base, disp); }
+			// movsxd r, dword [base + index * 4], registers below R8 only.
+			void movsxdIndexed(Reg r, Reg base, Reg index)
+			{ byte(0x48); byte(0x63); byte(0x04 | ((r & 7) << 3)); byte(0x80 | ((index & 7) << 3) | (base & 7)); }
+			void xorByte(Reg base, int32_t disp, uint8_t imm)
+			{ rex(false, 0, base); byte(0x80); mem(6, base, disp); byte(imm); }
+			void incMem(Reg base, int32_t disp)
+			{ rex(true, 0, base); byte(0x83); mem(0, base, disp); byte(1); }
+
+			void add(Reg dst, Reg src)  { rex(true, src, dst); byte(0x01); direct(src, dst); }
+			void sub(Reg dst, Reg src)  { rex(true, src, dst); byte(0x29); direct(src, dst); }
+			void imul(Reg dst, Reg src) { rex(true, dst, src); byte(0x0F); byte(0xAF); direct(dst, src); }
+			void test(Reg a, Reg b)     { rex(true, b, a); byte(0x85); direct(b, a); }
+			void cmp(Reg a, Reg b)      { rex(true, b, a); byte(0x39); direct(b, a); }
+			void neg(Reg r)             { rex(true, 0, r); byte(0xF7); direct(3, r); }
+			void idiv(Reg r)            { rex(true, 0, r); byte(0xF7); direct(7, r); }
+			void cqo()                  { byte(0x48); byte(0x99); }
+			void addImm(Reg r, int32_t imm) { rex(true, 0, r); byte(0x81); direct(0, r); dword(imm); }
+			void subImm(Reg r, int32_t imm) { rex(true, 0, r); byte(0x81); direct(5, r); dword(imm); }
+			void cmpImm(Reg r, int32_t imm) { rex(true, 0, r); byte(0x81); direct(7, r); dword(imm); }
+			void shlImm(Reg r, uint8_t imm) { rex(true, 0, r); byte(0xC1); direct(4, r); byte(imm); }
+
+			void push(Reg r)    { rex(false, 0, r); byte(0x50 + (r & 7)); }
+			void pop(Reg r)     { rex(false, 0, r); byte(0x58 + (r & 7)); }
+			void ret()          { byte(0xC3); }
+			void jmpReg(Reg r)  { rex(false, 0, r); byte(0xFF); direct(4, r); }
+			void callReg(Reg r) { rex(false, 0, r); byte(0xFF); direct(2, r); }
+			// test al, al
+			void testAl()       { byte(0x84); byte(0xC0); }
+			// Without a REX prefix: AL, CL, DL or BL only.
+			void setcc(Cond c, Reg r) { byte(0x0F); byte(0x90 | c); direct(0, r); }
+
+			// Both return the end of the jump, see bind().
+			size_t jcc(Cond c) { byte(0x0F); byte(0x80 | c); dword(0); return size(); }
+			size_t jmp()       { byte(0xE9); dword(0); return size(); }
+			// lea r, [rip + disp32], the displacement is bound like a jump.
+			size_t leaRip(Reg r) { rex(true, r, 0); byte(0x8D); byte(0x05 | ((r & 7) << 3)); dword(0); return size(); }
+
+			void bind(size_t jump, size_t target)
+			{
+				int32_t rel = static_cast<int32_t>(target) - static_cast<int32_t>(jump);
+				std::memcpy(&code[jump - 4], &rel, 4);
+			}
+
+			// SSE2, xmm0-xmm7
+			void movsdLoad(unsigned x, Reg base, int32_t disp)
+			{ byte(0xF2); rex(false, x, base); byte(0x0F); byte(0x10); mem(x, base, disp); }
+			void movsdStore(Reg base, int32_t disp, unsigned x)
+			{ byte(0xF2); rex(false, x, base); byte(0x0F); byte(0x11); mem(x, base, disp); }
+			void cvtsi2sd(unsigned x, Reg base, int32_t disp)
+			{ byte(0xF2); rex(true, x, base); byte(0x0F); byte(0x2A); mem(x, base, disp); }
+			void movq(unsigned x, Reg r)
+			{ byte(0x66); rex(true, x, r); byte(0x0F); byte(0x6E); direct(x, r); }
+			// addsd 0x58, mulsd 0x59, subsd 0x5C, divsd 0x5E
+			void sse(uint8_t op, unsigned dst, unsigned src)
+			{ byte(0xF2); byte(0x0F); byte(op); direct(dst, src); }
+			void xorpd(unsigned dst, unsigned src)   { byte(0x66); byte(0x0F); byte(0x57); direct(dst, src); }
+			void ucomisd(unsigned a, unsigned b)     { byte(0x66); byte(0x0F); byte(0x2E); direct(a, b); }
+		};
+
+		// Right operand of an arithmetic template.
+		struct Source
+		{
+			bool constant;
+			Reg base;
+			int32_t disp;
+			Value value;
+
+			static Source Memory(Reg base, int32_t disp) { return { false, base, disp, Value::None() }; }
+			static Source Constant(Value const& value)   { return { true, RAX, 0, value }; }
+		};
+
+		class TemplateCompiler
+		{
+		public:
+			TemplateCompiler(Bytecode const& code, OutputBuffer& output, size_t begin, size_t end)
+				: m_Code(code), m_Output(output), m_Begin(begin), m_End(end) {}
+
+			static bool supports(OpCode op);
+
+			Assembler const& compile();
+			size_t getOffset(size_t ip) const { return m_Offsets[ip - m_Begin]; }
+
+		private:
+			Bytecode const& m_Code;
+			OutputBuffer& m_Output;
+			size_t m_Begin, m_End;
+			Assembler m;
+
+			std::vector<size_t> m_Offsets;
+			// Jumps to the bailout stub of an instruction.
+			std::vector<std::pair<size_t, size_t>> m_Bailouts;
+			std::vector<size_t> m_Exits;
+			// Jumps to an instruction of the procedure, bound once all are placed.
+			std::vector<std::pair<size_t, size_t>> m_Jumps;
+			// Slow paths, placed after the code of the procedure.
+			std::vector<std::function<void()>> m_Deferred;
+			size_t m_Ip = 0;
+
+			void emit(Instruction const& e);
+
+			void bailIf(Cond c) { m_Bailouts.push_back({ m.jcc(c), m_Ip }); }
+			void bail()         { m_Bailouts.push_back({ m.jmp(), m_Ip }); }
+			void exit();
+
+			void copy(Reg dstBase, int32_t dstDisp, Reg srcBase, int32_t srcDisp);
+			void load(Reg base, int32_t disp);
+			void store(Reg base, int32_t disp);
+			void arithmetic(OpCode op, Reg base, int32_t disp, Source right, bool pop, bool checked = false);
+			void increment(Reg base, int32_t disp, Value const& step);
+			void conditionalJump(size_t target, bool expected);
+			void compare(Cond c);
+			void compareJump(size_t target, Cond c);
+			void caseDispatch(Instruction const& e);
+			void caseSearch(std::vector<std::pair<long, size_t>> const& labels, size_t first, size_t last,
+							size_t otherwise);
+			void compareLabel(long label);
+			void forInit(Instruction const& e, Cond exit);
+			void forNext(Instruction const& e, Cond exit, bool up);
+			void toReal(unsigned x, Source const& source);
+			bool element(Reg frame, int32_t offset, int32_t indexDisp);
+		};
+
+		bool TemplateCompiler::supports(OpCode op)
+		{
+			switch (op)
+			{
+			case OpCode::NOP:
+			case OpCode::CONST:
+			case OpCode::LOAD_LOCAL:
+			case OpCode::STORE_LOCAL:
+			case OpCode::LOAD_GLOBAL:
+			case OpCode::STORE_GLOBAL:
+			case OpCode::LOAD_OUTER:
+			case OpCode::STORE_OUTER:
+			case OpCode::ADD:
+			case OpCode::SUB:
+			case OpCode::MUL:
+			case OpCode::DIV:
+			case OpCode::MOD:
+			case OpCode::NEG:
+			case OpCode::ADD_CHECKED:
+			case OpCode::SUB_CHECKED:
+			case OpCode::MUL_CHECKED:
+			case OpCode::DIV_CHECKED:
+			case OpCode::NEG_CHECKED:
+			case OpCode::TO_REAL:
+			case OpCode::WRITE:
+			case OpCode::WRITELN:
+			case OpCode::CALL:
+			case OpCode::TAIL_CALL:
+			case OpCode::RET:
+			case OpCode::RET_VALUE:
+			case OpCode::HALT:
+			case OpCode::ADD_CONST:
+			case OpCode::SUB_CONST:
+			case OpCode::MUL_CONST:
+			case OpCode::DIV_CONST:
+			case OpCode::MOD_CONST:
+			case OpCode::ADD_LOCAL:
+			case OpCode::SUB_LOCAL:
+			case OpCode::MUL_LOCAL:
+			case OpCode::DIV_LOCAL:
+			case OpCode::MOD_LOCAL:
+			case OpCode::ADD_GLOBAL:
+			case OpCode::SUB_GLOBAL:
+			case OpCode::MUL_GLOBAL:
+			case OpCode::DIV_GLOBAL:
+			case OpCode::MOD_GLOBAL:
+			case OpCode::LOAD_LOCAL2:
+			case OpCode::LOAD_GLOBAL2:
+			case OpCode::INC_LOCAL:
+			case OpCode::INC_GLOBAL:
+			case OpCode::JUMP:
+			case OpCode::JUMP_FALSE:
+			case OpCode::JUMP_TRUE:
+			case OpCode::NOT:
+			case OpCode::EQ:
+			case OpCode::NE:
+			case OpCode::LT:
+			case OpCode::LE:
+			case OpCode::GT:
+			case OpCode::GE:
+			case OpCode::JUMP_EQ:
+			case OpCode::JUMP_NE:
+			case OpCode::JUMP_LT:
+			case OpCode::JUMP_LE:
+			case OpCode::JUMP_GT:
+			case OpCode::JUMP_GE:
+			case OpCode::FOR_INIT:
+			case OpCode::FOR_INIT_DN:
+			case OpCode::FOR_NEXT:
+			case OpCode::FOR_NEXT_DN:
+			case OpCode::VECTOR:
+			case OpCode::CASE_LIST:
+			case OpCode::CASE_FIND:
+			case OpCode::CASE_TABLE:
+			case OpCode::BOUNDS:
+			case OpCode::LOAD_ELEM:
+			case OpCode::STORE_ELEM:
+			case OpCode::LOAD_GELEM:
+			case OpCode::STORE_GELEM:
+			case OpCode::LOAD_OELEM:
+			case OpCode::STORE_OELEM:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		Assembler const& TemplateCompiler::compile()
+		{
+			std::vector<Instruction> const& code = m_Code.getCode();
+
+			for (m_Ip = m_Begin; m_Ip < m_End; m_Ip++)
+			{
+				m_Offsets.push_back(m.size());
+				emit(code[m_Ip]);
+			}
+
+			for (auto const& e : m_Jumps)
+				m.bind(e.first, m_Offsets[e.second - m_Begin]);
+
+			for (auto const& e : m_Deferred)
+				e();
+
+			// Bailout stubs: resume in the interpreter at the instruction.
+			std::map<size_t, size_t> stubs;
+			for (auto const& e : m_Bailouts)
+			{
+				auto it = stubs.find(e.second);
+				if (it == stubs.end())
+				{
+					it = stubs.insert({ e.second, m.size() }).first;
+					m.movStoreImm(CONTEXT, offsetof(JitContext, exitIp), e.second);
+					m.incMem(CONTEXT, offsetof(JitContext, bailouts));
+					m_Exits.push_back(m.jmp());
+				}
+				m.bind(e.first, it->second);
+			}
+
+			size_t epilogue = m.size();
+			m.movStore(CONTEXT, offsetof(JitContext, sp), SP);
+			m.pop(R15);
+			m.pop(R14);
+			m.pop(R13);
+			m.pop(R12);
+			m.pop(RBX);
+			m.ret();
+
+			for (size_t e : m_Exits)
+				m.bind(e, epilogue);
+
+			return m;
+		}
+
+		// Hands the instruction over to the interpreter.
+		void TemplateCompiler::exit()
+		{
+			m.movStoreImm(CONTEXT, offsetof(JitContext, exitIp), m_Ip);
+			m_Exits.push_back(m.jmp());
+		}
+
+		void TemplateCompiler::emit(Instruction const& e)
+		{
+			std::vector<Value> const& constants = m_Code.getConstants();
+
+			switch (e.op)
+			{
+			case OpCode::NOP:
+				break;
+			case OpCode::CONST:
+			{
+				Value const& value = constants[e.a];
+				uint64_t payload;
+				std::memcpy(&payload, &value.as, sizeof(payload));
+				m.movImm(RAX, payload);
+				m.movStore(SP, PAYLOAD, RAX);
+				m.movByte(SP, TAG, static_cast<uint8_t>(value.type));
+				m.addImm(SP, SLOT);
+				break;
+			}
+			case OpCode::LOAD_LOCAL:   load(BASE, e.a * SLOT); break;
+			case OpCode::LOAD_GLOBAL:  load(GLOBALS, e.a * SLOT); break;
+			case OpCode::STORE_LOCAL:  store(BASE, e.a * SLOT); break;
+			case OpCode::STORE_GLOBAL: store(GLOBALS, e.a * SLOT); break;
+			case OpCode::LOAD_OUTER:
+				m.movLoad(RAX, DISPLAY, e.a * sizeof(Value*));
+				load(RAX, e.b * SLOT);
+				break;
+			case OpCode::STORE_OUTER:
+				m.movLoad(RAX, DISPLAY, e.a * sizeof(Value*));
+				store(RAX, e.b * SLOT);
+				break;
+			case OpCode::BOUNDS:
+				m.cmpByte(SP, TOP + TAG, INTEGER);
+				bailIf(COND_NE);
+				m.movLoad(RAX, SP, TOP + PAYLOAD);
+				m.cmpImm(RAX, e.a);
+				bailIf(COND_L);
+				m.cmpImm(RAX, e.b);
+				bailIf(COND_G);
+				break;
+			case OpCode::LOAD_ELEM:
+			case OpCode::LOAD_GELEM:
+			case OpCode::LOAD_OELEM:
+			{
+				Reg frame = (e.op == OpCode::LOAD_ELEM) ? BASE : (e.op == OpCode::LOAD_GELEM) ? GLOBALS : RSI;
+				int32_t offset = (e.op == OpCode::LOAD_OELEM) ? e.b : e.a;
+				if (e.op == OpCode::LOAD_OELEM)
+					m.movLoad(RSI, DISPLAY, e.a * sizeof(Value*));
+				if (element(frame, offset, TOP))
+					copy(SP, TOP, RAX, offset * SLOT);
+				break;
+			}
+			case OpCode::STORE_ELEM:
+			case OpCode::STORE_GELEM:
+			case OpCode::STORE_OELEM:
+			{
+				Reg frame = (e.op == OpCode::STORE_ELEM) ? BASE : (e.op == OpCode::STORE_GELEM) ? GLOBALS : RSI;
+				int32_t offset = (e.op == OpCode::STORE_OELEM) ? e.b : e.a;
+				if (e.op == OpCode::STORE_OELEM)
+					m.movLoad(RSI, DISPLAY, e.a * sizeof(Value*));
+				if (element(frame, offset, 2 * TOP))
+				{
+					store(RAX, offset * SLOT);
+					m.subImm(SP, SLOT);
+				}
+				break;
+			}
+			case OpCode::LOAD_LOCAL2:
+				load(BASE, e.a * SLOT);
+				load(BASE, e.b * SLOT);
+				break;
+			case OpCode::LOAD_GLOBAL2:
+				load(GLOBALS, e.a * SLOT);
+				load(GLOBALS, e.b * SLOT);
+				break;
+
+			case OpCode::ADD:
+			case OpCode::SUB:
+			case OpCode::MUL:
+			case OpCode::DIV:
+			case OpCode::MOD:
+				arithmetic(e.op, SP, 2 * TOP, Source::Memory(SP, TOP), true);
+				break;
+
+			case OpCode::ADD_CHECKED: arithmetic(OpCode::ADD, SP, 2 * TOP, Source::Memory(SP, TOP), true, true); break;
+			case OpCode::SUB_CHECKED: arithmetic(OpCode::SUB, SP, 2 * TOP, Source::Memory(SP, TOP), true, true); break;
+			case OpCode::MUL_CHECKED: arithmetic(OpCode::MUL, SP, 2 * TOP, Source::Memory(SP, TOP), true, true); break;
+			case OpCode::DIV_CHECKED: arithmetic(OpCode::DIV, SP, 2 * TOP, Source::Memory(SP, TOP), true, true); break;
+
+			case OpCode::ADD_CONST: arithmetic(OpCode::ADD, SP, TOP, Source::Constant(constants[e.a]), false); break;
+			case OpCode::SUB_CONST: arithmetic(OpCode::SUB, SP, TOP, Source::Constant(constants[e.a]), false); break;
+			case OpCode::MUL_CONST: arithmetic(OpCode::MUL, SP, TOP, Source::Constant(constants[e.a]), false); break;
+			case OpCode::DIV_CONST: arithmetic(OpCode::DIV, SP, TOP, Source::Constant(constants[e.a]), false); break;
+			case OpCode::MOD_CONST: arithmetic(OpCode::MOD, SP, TOP, Source::Constant(constants[e.a]), false); break;
+
+			case OpCode::ADD_LOCAL: arithmetic(OpCode::ADD, SP, TOP, Source::Memory(BASE, e.a * SLOT), false); break;
+			case OpCode::SUB_LOCAL: arithmetic(OpCode::SUB, SP, TOP, Source::Memory(BASE, e.a * SLOT), false); break;
+			case OpCode::MUL_LOCAL: arithmetic(OpCode::MUL, SP, TOP, Source::Memory(BASE, e.a * SLOT), false); break;
+			case OpCode::DIV_LOCAL: arithmetic(OpCode::DIV, SP, TOP, Source::Memory(BASE, e.a * SLOT), false); break;
+			case OpCode::MOD_LOCAL: arithmetic(OpCode::MOD, SP, TOP, Source::Memory(BASE, e.a * SLOT), false); break;
+
+			case OpCode::ADD_GLOBAL: arithmetic(OpCode::ADD, SP, TOP, Source::Memory(GLOBALS, e.a * SLOT), false); break;
+			case OpCode::SUB_GLOBAL: arithmetic(OpCode::SUB, SP, TOP, Source::Memory(GLOBALS, e.a * SLOT), false); break;
+			case OpCode::MUL_GLOBAL: arithmetic(OpCode::MUL, SP, TOP, Source::Memory(GLOBALS, e.a * SLOT), false); break;
+			case OpCode::DIV_GLOBAL: arithmetic(OpCode::DIV, SP, TOP, Source::Memory(GLOBALS, e.a * SLOT), false); break;
+			case OpCode::MOD_GLOBAL: arithmetic(OpCode::MOD, SP, TOP, Source::Memory(GLOBALS, e.a * SLOT), false); break;
+
+			case OpCode::INC_LOCAL:  increment(BASE, e.a * SLOT, constants[e.b]); break;
+			case OpCode::INC_GLOBAL: increment(GLOBALS, e.a * SLOT, constants[e.b]); break;
+
+			case OpCode::NEG:
+			case OpCode::NEG_CHECKED:
+				m.cmpByte(SP, TOP + TAG, INTEGER);
+				bailIf(COND_NE);
+				m.movLoad(RAX, SP, TOP + PAYLOAD);
+				m.neg(RAX);
+				if (e.op == OpCode::NEG_CHECKED)
+					bailIf(COND_O);
+				m.movStore(SP, TOP + PAYLOAD, RAX);
+				break;
+
+			case OpCode::TO_REAL:
+			{
+				m.cmpByte(SP, TOP + TAG, INTEGER);
+				size_t done = m.jcc(COND_NE);
+				m.cvtsi2sd(0, SP, TOP + PAYLOAD);
+				m.movsdStore(SP, TOP + PAYLOAD, 0);
+				m.movByte(SP, TOP + TAG, REAL);
+				m.bind(done, m.size());
+				break;
+			}
+
+			case OpCode::NOT:
+				m.cmpByte(SP, TOP + TAG, BOOLEAN);
+				bailIf(COND_NE);
+				m.xorByte(SP, TOP + PAYLOAD, 1);
+				break;
+
+			case OpCode::EQ: compare(COND_E); break;
+			case OpCode::NE: compare(COND_NE); break;
+			case OpCode::LT: compare(COND_L); break;
+			case OpCode::LE: compare(COND_LE); break;
+			case OpCode::GT: compare(COND_G); break;
+			case OpCode::GE: compare(COND_GE); break;
+
+			case OpCode::JUMP:
+				m_Jumps.push_back({ m.jmp(), e.a });
+				break;
+			case OpCode::JUMP_FALSE: conditionalJump(e.a, false); break;
+			case OpCode::JUMP_TRUE:  conditionalJump(e.a, true); break;
+
+			case OpCode::JUMP_EQ: compareJump(e.a, COND_E); break;
+			case OpCode::JUMP_NE: compareJump(e.a, COND_NE); break;
+			case OpCode::JUMP_LT: compareJump(e.a, COND_L); break;
+			case OpCode::JUMP_LE: compareJump(e.a, COND_LE); break;
+			case OpCode::JUMP_GT: compareJump(e.a, COND_G); break;
+			case OpCode::JUMP_GE: compareJump(e.a, COND_GE); break;
+
+			case OpCode::CASE_LIST:
+			case OpCode::CASE_FIND:
+			case OpCode::CASE_TABLE:
+				caseDispatch(e);
+				break;
+
+			case OpCode::FOR_INIT:    forInit(e, COND_G); break;
+			case OpCode::FOR_INIT_DN: forInit(e, COND_L); break;
+			case OpCode::FOR_NEXT:    forNext(e, COND_GE, true); break;
+			case OpCode::FOR_NEXT_DN: forNext(e, COND_LE, false); break;
+
+			// Native code runs with the stack aligned for calls, and the
+			// interpreter state is in callee-saved registers.
+			case OpCode::VECTOR:
+				m.movImm(RDI, reinterpret_cast<uint64_t>(&m_Code.getVectorLoops()[e.b]));
+				m.movReg(RSI, BASE);
+				m.movReg(RDX, DISPLAY);
+				m.movImm(RCX, reinterpret_cast<uint64_t>(constants.data()));
+				m.movImm(RAX, reinterpret_cast<uint64_t>(&VectorKernels::run));
+				m.callReg(RAX);
+				m.testAl();
+				m_Jumps.push_back({ m.jcc(COND_NE), e.a });
+				break;
+
+			// Values write has no text for are reported by the interpreter.
+			case OpCode::WRITE:
+				m.movImm(RDI, reinterpret_cast<uint64_t>(&m_Output));
+				m.movReg(RSI, SP);
+				m.subImm(RSI, SLOT);
+				m.movImm(RAX, reinterpret_cast<uint64_t>(&OutputBuffer::write));
+				m.callReg(RAX);
+				m.testAl();
+				bailIf(COND_E);
+				m.subImm(SP, SLOT);
+				break;
+			case OpCode::WRITELN:
+				m.movImm(RDI, reinterpret_cast<uint64_t>(&m_Output));
+				m.movImm(RAX, reinterpret_cast<uint64_t>(&OutputBuffer::writeLine));
+				m.callReg(RAX);
+				break;
+
+			default:
+				exit();
+				break;
+			}
+		}
+
+		// Tags and payloads are always moved separately: a wide load of a
+		// value written in two parts would stall on store forwarding.
+		void TemplateCompiler::copy(Reg dstBase, int32_t dstDisp, Reg srcBase, int32_t srcDisp)
+		{
+			m.movzxByte(RDX, srcBase, srcDisp + TAG);
+			m.movLoad(RCX, srcBase, srcDisp + PAYLOAD);
+			m.movStoreByte(dstBase, dstDisp + TAG, RDX);
+			m.movStore(dstBase, dstDisp + PAYLOAD, RCX);
+		}
+
+		// RAX := frame + index * SLOT for the integer index at [SP + indexDisp],
+		// element 'index' being at [RAX + offset * SLOT]. Offsets too far
+		// for a displacement are left to the interpreter.
+		bool TemplateCompiler::element(Reg frame, int32_t offset, int32_t indexDisp)
+		{
+			int64_t disp = static_cast<int64_t>(offset) * SLOT;
+			if (disp < INT32_MIN || disp > INT32_MAX)
+			{
+				exit();
+				return false;
+			}
+
+			m.cmpByte(SP, indexDisp + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.movLoad(RAX, SP, indexDisp + PAYLOAD);
+			m.shlImm(RAX, 4);
+			m.add(RAX, frame);
+			return true;
+		}
+
+		void TemplateCompiler::load(Reg base, int32_t disp)
+		{
+			copy(SP, 0, base, disp);
+			m.addImm(SP, SLOT);
+		}
+
+		// assign(slot, pop): real slots widen integers, bigint and bignum
+		// slots, the last tags, keep them bigints.
+		void TemplateCompiler::store(Reg base, int32_t disp)
+		{
+			m.cmpByte(base, disp + TAG, REAL);
+			size_t slow = m.jcc(COND_E);
+			m.cmpByte(base, disp + TAG, BIGINT);
+			size_t big = m.jcc(COND_AE);
+			copy(base, disp, SP, TOP);
+			size_t done = m.size();
+			m.subImm(SP, SLOT);
+
+			m_Deferred.push_back([=]()
+			{
+				m.bind(slow, m.size());
+				m.cmpByte(SP, TOP + TAG, INTEGER);
+				size_t widen = m.jcc(COND_E);
+				m.cmpByte(SP, TOP + TAG, BIGINT);
+				size_t plain = m.jcc(COND_NE);
+				m.bind(widen, m.size());
+				m.cvtsi2sd(0, SP, TOP + PAYLOAD);
+				m.movsdStore(base, disp + PAYLOAD, 0);
+				m.bind(m.jmp(), done);
+				m.bind(plain, m.size());
+				copy(base, disp, SP, TOP);
+				m.bind(m.jmp(), done);
+
+				m.bind(big, m.size());
+				copy(base, disp, SP, TOP);
+				m.cmpByte(base, disp + TAG, INTEGER);
+				m.bind(m.jcc(COND_NE), done);
+				m.movByte(base, disp + TAG, BIGINT);
+				m.bind(m.jmp(), done);
+			});
+		}
+
+		// [base + disp] := [base + disp] <op> right, integers inline, reals
+		// in a slow path, anything else in the interpreter. Checked integer
+		// overflow is left to the interpreter to report.
+		void TemplateCompiler::arithmetic(OpCode op, Reg base, int32_t disp, Source right, bool pop, bool checked)
+		{
+			std::vector<size_t> slow;
+
+			m.cmpByte(base, disp + TAG, INTEGER);
+			slow.push_back(m.jcc(COND_NE));
+			if (right.constant && !right.value.isInteger())
+			{
+				slow.push_back(m.jmp());
+			}
+			else if (!right.constant)
+			{
+				m.cmpByte(right.base, right.disp + TAG, INTEGER);
+				slow.push_back(m.jcc(COND_NE));
+			}
+
+			m.movLoad(RAX, base, disp + PAYLOAD);
+			if (right.constant)
+				m.movImm(RCX, right.value.as.integer);
+			else
+				m.movLoad(RCX, right.base, right.disp + PAYLOAD);
+
+			Reg result = RAX;
+			switch (op)
+			{
+			case OpCode::ADD: m.add(RAX, RCX); break;
+			case OpCode::SUB: m.sub(RAX, RCX); break;
+			case OpCode::MUL: m.imul(RAX, RCX); break;
+			default:
+				// The interpreter reports division by zero, and takes -1
+				// divisors, whose LONG_MIN quotient idiv traps on.
+				m.test(RCX, RCX);
+				bailIf(COND_E);
+				m.cmpImm(RCX, -1);
+				bailIf(COND_E);
+				m.cqo();
+				m.idiv(RCX);
+				if (op == OpCode::MOD)
+					result = RDX;
+				break;
+			}
+			if (checked && op != OpCode::DIV)
+				bailIf(COND_O);
+			m.movStore(base, disp + PAYLOAD, result);
+
+			size_t done = m.size();
+			if (pop)
+				m.subImm(SP, SLOT);
+
+			if (op == OpCode::MOD)
+			{
+				for (size_t e : slow)
+					m_Bailouts.push_back({ e, m_Ip });
+				return;
+			}
+
+			uint8_t sse = (op == OpCode::ADD) ? 0x58 : (op == OpCode::SUB) ? 0x5C :
+				(op == OpCode::MUL) ? 0x59 : 0x5E;
+			size_t ip = m_Ip;
+			m_Deferred.push_back([=]()
+			{
+				m_Ip = ip;
+				for (size_t e : slow)
+					m.bind(e, m.size());
+
+				toReal(0, Source::Memory(base, disp));
+				toReal(1, right);
+				if (op == OpCode::DIV)
+				{
+					m.xorpd(2, 2);
+					m.ucomisd(1, 2);
+					bailIf(COND_E);
+				}
+				m.sse(sse, 0, 1);
+				m.movsdStore(base, disp + PAYLOAD, 0);
+				m.movByte(base, disp + TAG, REAL);
+				m.bind(m.jmp(), done);
+			});
+		}
+
+		// Loads an integer or real operand into xmm<x> as a real.
+		void TemplateCompiler::toReal(unsigned x, Source const& source)
+		{
+			if (source.constant)
+			{
+				if (!source.value.isNumber())
+				{
+					bail();
+					return;
+				}
+				double value = source.value.toReal();
+				uint64_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				m.movImm(RAX, bits);
+				m.movq(x, RAX);
+				return;
+			}
+
+			m.cmpByte(source.base, source.disp + TAG, INTEGER);
+			size_t notInteger = m.jcc(COND_NE);
+			m.cvtsi2sd(x, source.base, source.disp + PAYLOAD);
+			size_t done = m.jmp();
+			m.bind(notInteger, m.size());
+			m.cmpByte(source.base, source.disp + TAG, REAL);
+			bailIf(COND_NE);
+			m.movsdLoad(x, source.base, source.disp + PAYLOAD);
+			m.bind(done, m.size());
+		}
+
+		void TemplateCompiler::increment(Reg base, int32_t disp, Value const& step)
+		{
+			if (!step.isInteger())
+			{
+				bail();
+				return;
+			}
+
+			m.cmpByte(base, disp + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.movLoad(RAX, base, disp + PAYLOAD);
+			m.movImm(RCX, step.as.integer);
+			m.add(RAX, RCX);
+			m.movStore(base, disp + PAYLOAD, RAX);
+		}
+
+		// Pops a boolean, anything else is reported by the interpreter.
+		void TemplateCompiler::conditionalJump(size_t target, bool expected)
+		{
+			m.cmpByte(SP, TOP + TAG, BOOLEAN);
+			bailIf(COND_NE);
+			m.subImm(SP, SLOT);
+			m.cmpByte(SP, PAYLOAD, 0);
+			m_Jumps.push_back({ m.jcc(expected ? COND_NE : COND_E), target });
+		}
+
+		// Relations of two integers, the interpreter compares the rest.
+		void TemplateCompiler::compare(Cond c)
+		{
+			m.cmpByte(SP, 2 * TOP + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.cmpByte(SP, TOP + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.movLoad(RAX, SP, 2 * TOP + PAYLOAD);
+			m.movImm(RCX, 0);
+			m.cmpLoad(RAX, SP, TOP + PAYLOAD);
+			m.setcc(c, RCX);
+			m.movStore(SP, 2 * TOP + PAYLOAD, RCX);
+			m.movByte(SP, 2 * TOP + TAG, BOOLEAN);
+			m.subImm(SP, SLOT);
+		}
+
+		// The operands are popped before the compare, subtracting would
+		// change the flags.
+		void TemplateCompiler::compareJump(size_t target, Cond c)
+		{
+			m.cmpByte(SP, 2 * TOP + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.cmpByte(SP, TOP + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.subImm(SP, 2 * SLOT);
+			m.movLoad(RAX, SP, PAYLOAD);
+			m.cmpLoad(RAX, SP, SLOT + PAYLOAD);
+			m_Jumps.push_back({ m.jcc(c), target });
+		}
+
+		// Pops the integer selector into RAX. Tables become an indirect jump
+		// through offsets placed after the procedure, lists and searches a
+		// tree of compares with short compare chains as leaves.
+		void TemplateCompiler::caseDispatch(Instruction const& e)
+		{
+			std::vector<Instruction> const& code = m_Code.getCode();
+			std::vector<Value> const& constants = m_Code.getConstants();
+			Instruction const& otherwise = code[m_Ip + 1];
+
+			m.cmpByte(SP, TOP + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.subImm(SP, SLOT);
+			m.movLoad(RAX, SP, PAYLOAD);
+
+			if (e.op != OpCode::CASE_TABLE)
+			{
+				std::vector<std::pair<long, size_t>> labels;
+				for (int32_t i = 0; i < e.a; i++)
+				{
+					Instruction const& entry = code[m_Ip + 2 + i];
+					labels.push_back({ constants[entry.b].as.integer, entry.a });
+				}
+				caseSearch(labels, 0, labels.size(), otherwise.a);
+				return;
+			}
+
+			m.movImm(RCX, constants[otherwise.b].as.integer);
+			m.sub(RAX, RCX);
+			m.cmpImm(RAX, e.a);
+			m_Jumps.push_back({ m.jcc(COND_AE), otherwise.a });
+			size_t table = m.leaRip(RCX);
+			m.movsxdIndexed(RAX, RCX, RAX);
+			m.add(RAX, RCX);
+			m.jmpReg(RAX);
+
+			std::vector<size_t> targets;
+			for (int32_t i = 0; i < e.a; i++)
+				targets.push_back(code[m_Ip + 2 + i].a);
+			m_Deferred.push_back([=]()
+			{
+				size_t start = m.size();
+				m.bind(table, start);
+				for (size_t target : targets)
+					m.dword(static_cast<uint32_t>(m_Offsets[target - m_Begin] - start));
+			});
+		}
+
+		void TemplateCompiler::caseSearch(std::vector<std::pair<long, size_t>> const& labels, size_t first,
+										  size_t last, size_t otherwise)
+		{
+			if (last - first <= 4)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					compareLabel(labels[i].first);
+					m_Jumps.push_back({ m.jcc(COND_E), labels[i].second });
+				}
+				m_Jumps.push_back({ m.jmp(), otherwise });
+				return;
+			}
+
+			size_t middle = first + (last - first) / 2;
+			compareLabel(labels[middle].first);
+			m_Jumps.push_back({ m.jcc(COND_E), labels[middle].second });
+			size_t above = m.jcc(COND_G);
+			caseSearch(labels, first, middle, otherwise);
+			m.bind(above, m.size());
+			caseSearch(labels, middle + 1, last, otherwise);
+		}
+
+		void TemplateCompiler::compareLabel(long label)
+		{
+			if (label >= INT32_MIN && label <= INT32_MAX)
+			{
+				m.cmpImm(RAX, static_cast<int32_t>(label));
+			}
+			else
+			{
+				m.movImm(RCX, label);
+				m.cmp(RAX, RCX);
+			}
+		}
+
+		void TemplateCompiler::forInit(Instruction const& e, Cond exit)
+		{
+			m.cmpByte(BASE, e.b * SLOT + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.cmpByte(BASE, e.c * SLOT + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.movLoad(RAX, BASE, e.b * SLOT + PAYLOAD);
+			m.cmpLoad(RAX, BASE, e.c * SLOT + PAYLOAD);
+			m_Jumps.push_back({ m.jcc(exit), e.a });
+		}
+
+		// FOR_INIT checked the limit, only the variable's tag may change.
+		void TemplateCompiler::forNext(Instruction const& e, Cond exit, bool up)
+		{
+			m.cmpByte(BASE, e.b * SLOT + TAG, INTEGER);
+			bailIf(COND_NE);
+			m.movLoad(RAX, BASE, e.b * SLOT + PAYLOAD);
+			m.cmpLoad(RAX, BASE, e.c * SLOT + PAYLOAD);
+			size_t done = m.jcc(exit);
+			if (up)
+				m.addImm(RAX, 1);
+			else
+				m.subImm(RAX, 1);
+			m.movStore(BASE, e.b * SLOT + PAYLOAD, RAX);
+			m_Jumps.push_back({ m.jmp(), e.a });
+			m.bind(done, m.size());
+		}
+	}
+#endif
+
+	// Native runs of a procedure in a row that may end in a bailout before
+	// the procedure goes back to the interpreter for good.
+	static const unsigned BAILOUT_LIMIT = 64;
+
+	Jit::Jit(Bytecode& code, unsigned threshold, OutputBuffer& output)
+		: m_Code(code), m_Output(output), m_Threshold(threshold),
+		  m_Invocations(code.getProcedures().size(), 0),
+		  m_BailedRuns(code.getProcedures().size(), 0),
+		  m_Entries(code.getCode().size() + 1, nullptr)
+	{
+#ifdef PASCAL_JIT_X86_64
+		Assembler m;
+		m.push(RBX);
+		m.push(R12);
+		m.push(R13);
+		m.push(R14);
+		m.push(R15);
+		m.movReg(CONTEXT, RDI);
+		m.movLoad(BASE, CONTEXT, offsetof(JitContext, base));
+		m.movLoad(SP, CONTEXT, offsetof(JitContext, sp));
+		m.movLoad(GLOBALS, CONTEXT, offsetof(JitContext, globals));
+		m.movLoad(DISPLAY, CONTEXT, offsetof(JitContext, display));
+		m.jmpReg(RSI);
+
+		m_Trampoline = reinterpret_cast<Trampoline>(const_cast<uint8_t*>(install(m.code)));
+#endif
+	}
+
+	Jit::~Jit()
+	{
+#ifdef PASCAL_JIT_X86_64
+		for (auto const& e : m_Chunks)
+			munmap(e.first, e.second);
+#endif
+	}
+
+	bool Jit::isSupported()
+	{
+#ifdef PASCAL_JIT_X86_64
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void Jit::run(JitContext& ctx, unsigned proc, const void* entry)
+	{
+		m_Trampoline(&ctx, entry);
+		m_NativeRuns++;
+		m_Bailouts += ctx.bailouts;
+
+		if (ctx.bailouts == 0)
+			m_BailedRuns[proc] = 0;
+		else if (++m_BailedRuns[proc] == BAILOUT_LIMIT)
+			drop(proc);
+	}
+
+	// A procedure whose guards keep failing spends its runs getting in and
+	// out of native code, so none of its instructions are entered anymore.
+	// The code stays installed, the procedure isn't compiled again.
+	void Jit::drop(unsigned proc)
+	{
+		std::fill(m_Entries.begin() + m_Code.getProcedures()[proc].entry,
+				  m_Entries.begin() + m_Code.getProcedureEnd(proc), nullptr);
+		m_Dropped++;
+	}
+
+	bool Jit::compile(unsigned procIndex)
+	{
+#ifdef PASCAL_JIT_X86_64
+		ProcedureCode const& proc = m_Code.getProcedures()[procIndex];
+		std::vector<Instruction> const& code = m_Code.getCode();
+		size_t begin = proc.entry;
+		size_t end = m_Code.getProcedureEnd(procIndex);
+
+		if (m_Trampoline == nullptr)
+			return false;
+		for (size_t i = begin; i < end; i++)
+		{
+			if (!TemplateCompiler::supports(code[i].op))
+				return false;
+		}
+
+		TemplateCompiler compiler(m_Code, m_Output, begin, end);
+		const uint8_t* native = install(compiler.compile().code);
+		if (native == nullptr)
+			return false;
+
+		m_Entries[begin] = native + compiler.getOffset(begin);
+		for (size_t i = begin; i < end; i++)
+		{
+			if ((code[i].op == OpCode::CALL || code[i].op == OpCode::R_CALL) && i + 1 < end)
+				m_Entries[i + 1] = native + compiler.getOffset(i + 1);
+			if (opCodeIsJump(code[i].op))
+				m_Entries[code[i].a] = native + compiler.getOffset(code[i].a);
+		}
+
+		m_Compiled++;
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Copies the code into executable memory, W^X: the pages are made
+	// executable only once written.
+	const uint8_t* Jit::install(std::vector<uint8_t> const& code)
+	{
+#ifdef PASCAL_JIT_X86_64
+		size_t page = sysconf(_SC_PAGESIZE);
+		size_t size = (code.size() + page - 1) / page * page;
+
+		void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mem == MAP_FAILED)
+			return nullptr;
+
+		std::memcpy(mem, code.data(), code.size());
+		if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0)
+		{
+			munmap(mem, size);
+			return nullptr;
+		}
+
+		m_Chunks.push_back({ mem, size });
+		return static_cast<const uint8_t*>(mem);
+#else
+		return nullptr;
+#endif
+	}
+}
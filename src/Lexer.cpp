@@ -4,13 +4,13 @@
 
 namespace Pascal
 {
-	const Token_t nullToken = { TokenType::NONE, "", 0 };
+	const Token_t nullToken = { TokenType::NONE, "", 0, OverflowChecks::DEFAULT };
 	
 	TokenList Tokenize(std::shared_ptr<std::string> const& source)
 	{
 	    std::stringstream ss;
 	    TokenList res = std::make_shared<std::vector<Token_t>>();
-		Token_t curTok;
+		Token_t curTok = nullToken;
 		TokenType& ttype = curTok.type;
 		std::string const& file = *source;
 		
@@ -22,7 +22,14 @@ namespace Pascal
 			}
 			else
 			{
-				if (file[pos] == '.' && pos != 0 && isdigit(file[pos - 1])) // Float literals
+				if (file[pos] == '.' && pos != 0 && isdigit(file[pos - 1]) && file[pos + 1] != '.' &&
+					isdigit(ss.str()[0])) // Float literals, not r1.x
+				{
+					ss << file[pos];
+					continue;
+				}
+				if ((file[pos] == '+' || file[pos] == '-') && isdigit(file[pos + 1]) && ss.tellp() > 1 &&
+					isdigit(ss.str()[0]) && tolower(ss.str().back()) == 'e') // The sign of an exponent, 1.0e-300
 				{
 					ss << file[pos];
 					continue;
@@ -30,6 +37,14 @@ namespace Pascal
 
 				if (file[pos] == '{')
 				{
+					// Directives apply to the tokens that follow them.
+					if (file.compare(pos, 3, "{$q") == 0 || file.compare(pos, 3, "{$Q") == 0)
+					{
+						if (file[pos + 3] == '+')
+							curTok.checks = OverflowChecks::ON;
+						else if (file[pos + 3] == '-')
+							curTok.checks = OverflowChecks::OFF;
+					}
 					for (; pos <= file.size(); pos++)
 					{
 						if (file[pos] == '}')
@@ -74,6 +89,54 @@ namespace Pascal
 						ttype = TokenType::PROGRAM;
 					else if (work == "procedure")
 						ttype = TokenType::PROCEDURE;
+					else if (work == "function")
+						ttype = TokenType::FUNCTION;
+					else if (work == "while")
+						ttype = TokenType::WHILE;
+					else if (work == "do")
+						ttype = TokenType::DO;
+					else if (work == "repeat")
+						ttype = TokenType::REPEAT;
+					else if (work == "until")
+						ttype = TokenType::UNTIL;
+					else if (work == "for")
+						ttype = TokenType::FOR;
+					else if (work == "to")
+						ttype = TokenType::TO;
+					else if (work == "downto")
+						ttype = TokenType::DOWNTO;
+					else if (work == "if")
+						ttype = TokenType::IF;
+					else if (work == "then")
+						ttype = TokenType::THEN;
+					else if (work == "else")
+						ttype = TokenType::ELSE;
+					else if (work == "case")
+						ttype = TokenType::CASE;
+					else if (work == "of")
+						ttype = TokenType::OF;
+					else if (work == "array")
+						ttype = TokenType::ARRAY;
+					else if (work == "set")
+						ttype = TokenType::SET;
+					else if (work == "in")
+						ttype = TokenType::IN;
+					else if (work == "const")
+						ttype = TokenType::CONST;
+					else if (work == "nil")
+						ttype = TokenType::NIL;
+					else if (work == "type")
+						ttype = TokenType::TYPE;
+					else if (work == "record")
+						ttype = TokenType::RECORD;
+					else if (work == "packed")
+						ttype = TokenType::PACKED;
+					else if (work == "and")
+						ttype = TokenType::AND;
+					else if (work == "or")
+						ttype = TokenType::OR;
+					else if (work == "not")
+						ttype = TokenType::NOT;
 					else
 						ttype = TokenType::IDENTIFIER;
 
@@ -95,7 +158,16 @@ namespace Pascal
 						ttype = TokenType::SEMICOLON;
 						break;
 					case '.':
-						ttype = TokenType::DOT;
+						if (file[pos+1] == '.')
+						{
+							pos++;
+							curTok.str = "..";
+							ttype = TokenType::RANGE;
+						}
+						else
+						{
+							ttype = TokenType::DOT;
+						}
 						break;
 					case ',':
 						ttype = TokenType::COMMA;
@@ -115,6 +187,36 @@ namespace Pascal
 					case '=':
 						ttype = TokenType::EQUAL;
 						break;
+					case '<':
+						if (file[pos+1] == '=')
+						{
+							pos++;
+							curTok.str = "<=";
+							ttype = TokenType::LESS_EQUAL;
+						}
+						else if (file[pos+1] == '>')
+						{
+							pos++;
+							curTok.str = "<>";
+							ttype = TokenType::NOT_EQUAL;
+						}
+						else
+						{
+							ttype = TokenType::LESS;
+						}
+						break;
+					case '>':
+						if (file[pos+1] == '=')
+						{
+							pos++;
+							curTok.str = ">=";
+							ttype = TokenType::GREATER_EQUAL;
+						}
+						else
+						{
+							ttype = TokenType::GREATER;
+						}
+						break;
 					case '+':
 						ttype = TokenType::PLUS;
 						break;
@@ -127,6 +229,9 @@ namespace Pascal
 					case '%':
 						ttype = TokenType::MOD;
 						break;
+					case '^':
+						ttype = TokenType::CARET;
+						break;
 					case '*':
 						ttype = TokenType::PRODUCT;
 						break;
@@ -136,8 +241,30 @@ namespace Pascal
 					case ')':
 						ttype = TokenType::CLOSE_PAREN;
 						break;
+					case '[':
+						ttype = TokenType::OPEN_BRACKET;
+						break;
+					case ']':
+						ttype = TokenType::CLOSE_BRACKET;
+						break;
+					case '\'':
+						// '' stands for a quote inside the literal.
+						curTok.str.clear();
+						for (pos++; pos < file.size() && file[pos] != '\n'; pos++)
+						{
+							if (file[pos] == '\'')
+							{
+								if (file[pos + 1] != '\'')
+									break;
+								pos++;
+							}
+							curTok.str += file[pos];
+						}
+						if (pos >= file.size() || file[pos] != '\'')
+							ReportsManager::ReportError(curTok.pos, ErrorType::UNTERMINATED_STRING);
+						ttype = TokenType::STRING_LITERAL;
+						break;
 					default:
-						// TODO: Implement logical operators
 						ReportsManager::ReportError(pos, ErrorType::ILLEGAL_LETTER);
 					}
 
@@ -167,12 +294,58 @@ namespace Pascal
 			return "VAR";
 		case TokenType::PROCEDURE:
 			return "PROCEDURE";
+		case TokenType::FUNCTION:
+			return "FUNCTION";
+		case TokenType::WHILE:
+			return "WHILE";
+		case TokenType::DO:
+			return "DO";
+		case TokenType::REPEAT:
+			return "REPEAT";
+		case TokenType::UNTIL:
+			return "UNTIL";
+		case TokenType::FOR:
+			return "FOR";
+		case TokenType::TO:
+			return "TO";
+		case TokenType::DOWNTO:
+			return "DOWNTO";
+		case TokenType::IF:
+			return "IF";
+		case TokenType::THEN:
+			return "THEN";
+		case TokenType::ELSE:
+			return "ELSE";
+		case TokenType::CASE:
+			return "CASE";
+		case TokenType::OF:
+			return "OF";
+		case TokenType::ARRAY:
+			return "ARRAY";
+		case TokenType::SET:
+			return "SET";
+		case TokenType::IN:
+			return "IN";
+		case TokenType::TYPE:
+			return "TYPE";
+		case TokenType::RECORD:
+			return "RECORD";
+		case TokenType::PACKED:
+			return "PACKED";
+		case TokenType::CONST:
+			return "CONST";
+		case TokenType::NIL:
+			return "NIL";
 		case TokenType::IDENTIFIER:
 			return "IDENTIFIER";
 		case TokenType::DOT:
 			return "DOT";
+		case TokenType::CARET:
+			return "CARET";
 		case TokenType::COMMA:
 			return "COMMA";
+		case TokenType::RANGE:
+			return "RANGE";
 		case TokenType::COLON:
 			return "COLON";
 		case TokenType::SEMICOLON:
@@ -181,6 +354,8 @@ namespace Pascal
 			return "ASSIGNMENT";
 		case TokenType::EQUAL:
 			return "EQUAL";
+		case TokenType::NOT_EQUAL:
+			return "NOT_EQUAL";
 		case TokenType::GREATER:
 			return "GREATER";
 		case TokenType::LESS:
@@ -189,6 +364,12 @@ namespace Pascal
 			return "GREATER_EQUAL";
 		case TokenType::LESS_EQUAL:
 			return "LESS_EQUAL";
+		case TokenType::AND:
+			return "AND";
+		case TokenType::OR:
+			return "OR";
+		case TokenType::NOT:
+			return "NOT";
 		case TokenType::PLUS:
 			return "PLUS";
 		case TokenType::MINUS:
@@ -0,0 +1,96 @@
+#include <pscpch.hpp>
+#include <ObjectHeap.hpp>
+
+#include <algorithm>
+
+namespace Pascal
+{
+	ObjectHeap::LargePool& ObjectHeap::largePool(unsigned slots)
+	{
+		for (auto& e : m_LargePools)
+		{
+			if (e.slots == slots)
+				return e;
+		}
+		m_LargePools.push_back({ slots, nullptr });
+		return m_LargePools.back();
+	}
+
+	Value* ObjectHeap::allocate(std::vector<Value> const& layout)
+	{
+		// An empty record still needs a slot to link it when it is free.
+		unsigned slots = std::max<unsigned>(layout.size(), 1);
+		Value* object;
+		if (slots > MAX_POOLED)
+		{
+			LargePool& pool = largePool(slots);
+			if (pool.free != nullptr)
+			{
+				object = pool.free;
+				pool.free = object->as.ref;
+			}
+			else
+			{
+				m_Large.emplace_back(new Value[slots]);
+				object = m_Large.back().get();
+			}
+		}
+		else
+		{
+			Pool& pool = m_Pools[slots];
+			if (pool.free != nullptr)
+			{
+				object = pool.free;
+				pool.free = object->as.ref;
+			}
+			else
+			{
+				if (pool.next + slots > pool.end)
+				{
+					unsigned count = CHUNK_SLOTS / slots * slots;
+					m_Chunks.emplace_back(new Value[count]);
+					pool.next = m_Chunks.back().get();
+					pool.end = pool.next + count;
+				}
+				object = pool.next;
+				pool.next += slots;
+			}
+		}
+
+		std::copy(layout.begin(), layout.end(), object);
+		if (layout.empty())
+			*object = Value::Integer(0);
+
+		m_Allocations++;
+		m_LiveObjects++;
+		m_LiveBytes += slots * sizeof(Value);
+		m_PeakBytes = std::max(m_PeakBytes, m_LiveBytes);
+		return object;
+	}
+
+	bool ObjectHeap::free(Value* object, unsigned slots)
+	{
+		slots = std::max<unsigned>(slots, 1);
+		if (object->type == ValueType::NONE)
+			return false;
+		Value*& head = (slots > MAX_POOLED) ? largePool(slots).free : m_Pools[slots].free;
+		object->type = ValueType::NONE;
+		object->as.ref = head;
+		head = object;
+
+		m_LiveObjects--;
+		m_LiveBytes -= slots * sizeof(Value);
+		return true;
+	}
+
+	void ObjectHeap::reset()
+	{
+		for (auto& e : m_Pools)
+			e = Pool();
+		m_Chunks.clear();
+		m_Large.clear();
+		m_LargePools.clear();
+		m_LiveObjects = 0;
+		m_LiveBytes = 0;
+	}
+}
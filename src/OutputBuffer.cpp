@@ -0,0 +1,358 @@
+#include <pscpch.hpp>
+#include <OutputBuffer.hpp>
+#include <BigNum.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+namespace Pascal
+{
+	// "00" to "99", integers are printed two digits at a time.
+	static const char DIGIT_PAIRS[] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+	static const unsigned long DECIMAL_UNITS[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+		100000000, 1000000000 };
+
+	// Writes the digits right before 'end', returns the first one.
+	static char* toDigits(unsigned long magnitude, char* end)
+	{
+		while (magnitude >= 100)
+		{
+			end -= 2;
+			std::memcpy(end, DIGIT_PAIRS + (magnitude % 100) * 2, 2);
+			magnitude /= 100;
+		}
+		if (magnitude >= 10)
+		{
+			end -= 2;
+			std::memcpy(end, DIGIT_PAIRS + magnitude * 2, 2);
+		}
+		else
+		{
+			*--end = static_cast<char>('0' + magnitude);
+		}
+		return end;
+	}
+
+	// Output that can't be written is dropped, like a closed stdout
+	// drops it.
+	static void writeAll(int fd, const char* chars, size_t count)
+	{
+		while (count > 0)
+		{
+			ssize_t written = ::write(fd, chars, count);
+			if (written < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return;
+			}
+			chars += written;
+			count -= written;
+		}
+	}
+
+	// A ring of buffers the interpreter fills and the writer thread writes,
+	// in the order they were handed over. Each index is only advanced by
+	// its own side, so passing a buffer takes no lock; the mutex is only
+	// taken to sleep, when the ring is full or empty, and to wake.
+	class OutputBuffer::Writer
+	{
+	public:
+		static constexpr size_t SLOTS = 8;
+
+		explicit Writer(int fd)
+			: m_Fd(fd)
+		{
+			for (Slot& slot : m_Slots)
+				slot.data.reset(new char[SIZE]);
+			m_Thread = std::thread(&Writer::run, this);
+		}
+
+		// What was handed over is written first.
+		~Writer()
+		{
+			m_Stopping.store(true);
+			wake(m_WriterSleeping, m_Handed);
+			m_Thread.join();
+		}
+
+		char* getFirst() const { return m_Slots[0].data.get(); }
+
+		// Hands the buffer being filled over and returns the next one,
+		// once the writer is done with it.
+		char* handOff(size_t used)
+		{
+			size_t head = m_Head.load(std::memory_order_relaxed);
+			m_Slots[head % SLOTS].used = used;
+			m_Head.store(++head);
+			wake(m_WriterSleeping, m_Handed);
+			await(m_ProducerSleeping, m_Written, [&]() { return head - m_Tail.load() < SLOTS; });
+			return m_Slots[head % SLOTS].data.get();
+		}
+
+		void drain()
+		{
+			size_t head = m_Head.load(std::memory_order_relaxed);
+			await(m_ProducerSleeping, m_Written, [&]() { return m_Tail.load() == head; });
+		}
+
+	private:
+		struct Slot
+		{
+			std::unique_ptr<char[]> data;
+			size_t used = 0;
+		};
+
+		void run()
+		{
+			for (size_t tail = 0;; tail++)
+			{
+				await(m_WriterSleeping, m_Handed, [&]() { return m_Head.load() != tail || m_Stopping.load(); });
+				if (m_Head.load() == tail)
+					return;
+				Slot const& slot = m_Slots[tail % SLOTS];
+				writeAll(m_Fd, slot.data.get(), slot.used);
+				m_Tail.store(tail + 1);
+				wake(m_ProducerSleeping, m_Written);
+			}
+		}
+
+		// The flag is set before 'ready' is checked again and the other
+		// side changes the indices before it reads the flag, so one of
+		// them sees the other.
+		template <typename Ready>
+		void await(std::atomic<bool>& sleeping, std::condition_variable& wakeUp, Ready ready)
+		{
+			if (ready())
+				return;
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			sleeping.store(true);
+			wakeUp.wait(lock, ready);
+			sleeping.store(false);
+		}
+
+		void wake(std::atomic<bool>& sleeping, std::condition_variable& wakeUp)
+		{
+			if (sleeping.load())
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				wakeUp.notify_one();
+			}
+		}
+
+		int m_Fd;
+		Slot m_Slots[SLOTS];
+		// Buffers handed over and written so far, apart so the two threads
+		// don't share a cache line.
+		alignas(64) std::atomic<size_t> m_Head{ 0 };
+		alignas(64) std::atomic<size_t> m_Tail{ 0 };
+		std::atomic<bool> m_Stopping{ false };
+
+		std::mutex m_Mutex;
+		std::atomic<bool> m_WriterSleeping{ false };
+		std::condition_variable m_Handed;
+		std::atomic<bool> m_ProducerSleeping{ false };
+		std::condition_variable m_Written;
+		std::thread m_Thread;
+	};
+
+	OutputBuffer::OutputBuffer(int fd)
+		: m_Fd(fd), m_Owned(new char[SIZE]), m_Data(m_Owned.get())
+	{
+	}
+
+	OutputBuffer::~OutputBuffer()
+	{
+		flush();
+	}
+
+	void OutputBuffer::put(const char* chars, size_t count)
+	{
+		if (count > SIZE - m_Used)
+		{
+			if (m_Writer != nullptr)
+			{
+				// A buffer at a time, to stay in order with the rest.
+				while (count > SIZE - m_Used)
+				{
+					size_t part = SIZE - m_Used;
+					std::memcpy(m_Data + m_Used, chars, part);
+					m_Used = SIZE;
+					chars += part;
+					count -= part;
+					spill();
+				}
+			}
+			else
+			{
+				flush();
+				if (count >= SIZE)
+				{
+					writeAll(m_Fd, chars, count);
+					return;
+				}
+			}
+		}
+		std::memcpy(m_Data + m_Used, chars, count);
+		m_Used += count;
+	}
+
+	void OutputBuffer::putInteger(long value)
+	{
+		char digits[20];
+		char* end = digits + sizeof(digits);
+		unsigned long magnitude = (value < 0) ? 0ul - static_cast<unsigned long>(value) :
+			static_cast<unsigned long>(value);
+		char* first = toDigits(magnitude, end);
+		if (value < 0)
+			*--first = '-';
+		put(first, end - first);
+	}
+
+	// Printed like printf's %g. Reals from 0.0001 to 999999 are rounded
+	// to six digits here, the scaling being off by less than an ulp. The
+	// others, and those too close to halfway between two roundings for
+	// that, are left to std::to_chars.
+	void OutputBuffer::putReal(double value)
+	{
+		char chars[32];
+		char* end = chars + sizeof(chars);
+
+		double magnitude = std::fabs(value);
+		if (magnitude >= 1e-4 && magnitude < 999999.5)
+		{
+			int exponent = static_cast<int>(std::floor(std::log10(magnitude)));
+			auto scale = [&]()
+			{
+				return (exponent <= 5) ? magnitude * POWERS_OF_TEN[5 - exponent] :
+					magnitude / POWERS_OF_TEN[exponent - 5];
+			};
+			// log10 may be one off either way.
+			double scaled = scale();
+			if (scaled >= 1e6 || scaled < 1e5)
+			{
+				exponent += (scaled >= 1e6) ? 1 : -1;
+				scaled = scale();
+			}
+
+			double whole = std::floor(scaled);
+			double fraction = scaled - whole;
+			if (scaled >= 1e5 && scaled < 1e6 && std::fabs(fraction - 0.5) > 1e-9)
+			{
+				unsigned long digits = static_cast<unsigned long>(whole) + (fraction > 0.5);
+				if (digits == 1000000)
+				{
+					digits = 100000;
+					exponent++;
+				}
+				if (exponent >= -4 && exponent <= 5)
+				{
+					int decimals = 5 - exponent;
+					unsigned long decimal = digits % DECIMAL_UNITS[decimals];
+					char* first = end;
+					if (decimal != 0)
+					{
+						for (; decimal % 10 == 0; decimal /= 10)
+							decimals--;
+						first = toDigits(decimal, end);
+						while (end - first < decimals)
+							*--first = '0';
+						*--first = '.';
+					}
+					first = toDigits(digits / DECIMAL_UNITS[5 - exponent], first);
+					if (value < 0)
+						*--first = '-';
+					put(first, end - first);
+					return;
+				}
+			}
+		}
+
+		std::to_chars_result res = std::to_chars(chars, end, value, std::chars_format::general, 6);
+		put(chars, res.ptr - chars);
+	}
+
+	bool OutputBuffer::putValue(Value const& value)
+	{
+		switch (value.type)
+		{
+		case ValueType::INTEGER:
+		case ValueType::BIGINT:
+			putInteger(value.as.integer);
+			return true;
+		case ValueType::BIGNUM:
+		{
+			std::string digits = value.as.big->toString();
+			put(digits.data(), digits.size());
+			return true;
+		}
+		case ValueType::REAL:
+			putReal(value.as.real);
+			return true;
+		case ValueType::BOOLEAN:
+			if (value.as.boolean)
+				put("true", 4);
+			else
+				put("false", 5);
+			return true;
+		case ValueType::STRING:
+			put(value.stringChars(), value.stringLength());
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	void OutputBuffer::flush()
+	{
+		spill();
+		if (m_Writer != nullptr)
+			m_Writer->drain();
+	}
+
+	// On a single CPU there is nothing to write in parallel with, the
+	// thread would only add switches between the two.
+	void OutputBuffer::startWriter()
+	{
+		if (m_Writer != nullptr || std::thread::hardware_concurrency() == 1)
+			return;
+		flush();
+		m_Writer.reset(new Writer(m_Fd));
+		m_Data = m_Writer->getFirst();
+	}
+
+	void OutputBuffer::spill()
+	{
+		if (m_Used == 0)
+			return;
+		if (m_Writer != nullptr)
+			m_Data = m_Writer->handOff(m_Used);
+		else
+			writeAll(m_Fd, m_Data, m_Used);
+		m_Used = 0;
+	}
+
+	bool OutputBuffer::write(OutputBuffer* output, Value const* value)
+	{
+		return output->putValue(*value);
+	}
+
+	void OutputBuffer::writeLine(OutputBuffer* output)
+	{
+		output->put('\n');
+	}
+}
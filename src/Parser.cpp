@@ -22,12 +22,22 @@ namespace Pascal
 
 	std::unique_ptr<AST::BlockNode> Parser::parseBlock()
 	{
+		std::vector<std::unique_ptr<AST::TypeDeclNode>> typeDecls;
 	    std::vector<std::unique_ptr<AST::VarDeclNode>> varDecls;
 		std::vector<std::unique_ptr<AST::ProcDeclNode>> procDecls;
 	
 		while (true)
 		{
-			if (matching(TokenType::VAR))
+			if (matching(TokenType::TYPE))
+			{
+				do
+				{
+					typeDecls.push_back(parseTypeDecl());
+					require(TokenType::SEMICOLON);
+				}
+				while (currentToken().type == TokenType::IDENTIFIER);
+			}
+			else if (matching(TokenType::VAR))
 			{
 				do
 				{
@@ -36,9 +46,9 @@ namespace Pascal
 				}
 				while (currentToken().type == TokenType::IDENTIFIER);
 			}
-			else if (matching(TokenType::PROCEDURE))
+			else if (matching(TokenType::PROCEDURE) || matching(TokenType::FUNCTION))
 			{
-				procDecls.push_back(parseProcDecl());
+				procDecls.push_back(parseProcDecl(previousToken().type == TokenType::FUNCTION));
 				require(TokenType::SEMICOLON);
 			}
 			else
@@ -47,10 +57,11 @@ namespace Pascal
 			}
 		}
 	    
-		return std::make_unique<AST::BlockNode>(move(varDecls), move(procDecls), parseCompound());
+		return std::make_unique<AST::BlockNode>(move(typeDecls), move(varDecls), move(procDecls),
+												parseCompound());
 	}
 
-	inline std::unique_ptr<AST::ProcDeclNode> Parser::parseProcDecl()
+	inline std::unique_ptr<AST::ProcDeclNode> Parser::parseProcDecl(bool function)
 	{
 		Token id = require(TokenType::IDENTIFIER);
 
@@ -64,13 +75,23 @@ namespace Pascal
 			} while (matching(TokenType::SEMICOLON));
 			require(TokenType::CLOSE_PAREN);
 		}
+
+		std::unique_ptr<AST::TypeNode> result;
+		if (function)
+		{
+			require(TokenType::COLON);
+			result = std::make_unique<AST::TypeNode>(require(TokenType::IDENTIFIER));
+		}
 	    
 		require(TokenType::SEMICOLON);
-		return std::make_unique<AST::ProcDeclNode>(id, move(paramDecls), parseBlock());
+		std::unique_ptr<AST::BlockNode> block = parseBlock();
+		return std::make_unique<AST::ProcDeclNode>(id, move(paramDecls), move(block), move(result));
 	}
 	
 	inline void Parser::parseParam(std::vector<std::unique_ptr<AST::ParamNode>>& res)
 	{
+		Token mode = match({ TokenType::VAR, TokenType::CONST });
+
 		std::vector<Token_t> ids;
 		ids.push_back(require(TokenType::IDENTIFIER));
 		while (matching(TokenType::COMMA))
@@ -86,11 +107,19 @@ namespace Pascal
 		{
 			res.push_back(std::make_unique<AST::ParamNode>(
 								   std::make_unique<AST::VariableNode>(element),
-								   std::make_unique<AST::TypeNode>(type)
+								   std::make_unique<AST::TypeNode>(type),
+								   mode
 								   ));
 		}
 	}
 	
+	inline std::unique_ptr<AST::TypeDeclNode> Parser::parseTypeDecl()
+	{
+		Token name = require(TokenType::IDENTIFIER);
+		require(TokenType::EQUAL);
+		return std::make_unique<AST::TypeDeclNode>(name, std::make_unique<AST::TypeNode>(parseType()));
+	}
+
 	inline void Parser::parseVarDecls(std::vector<std::unique_ptr<AST::VarDeclNode>>& res)
 	{
 		std::vector<Token_t> ids;
@@ -102,7 +131,7 @@ namespace Pascal
 
 		require(TokenType::COLON);
 
-		AST::TypeNode type(require(TokenType::IDENTIFIER));
+		AST::TypeNode type = parseType();
 		
 		for (auto const& element : ids)
 		{
@@ -113,6 +142,152 @@ namespace Pascal
 		}
 	}
 
+	inline AST::TypeNode Parser::parseType()
+	{
+		if (matching(TokenType::SET))
+		{
+			Token keyword = previousToken();
+			require(TokenType::OF);
+			if (matching(TokenType::IDENTIFIER))
+				return AST::TypeNode(keyword, previousToken(), { nullToken, false }, { nullToken, false });
+
+			AST::IntegerLiteral low = parseIntegerLiteral();
+			require(TokenType::RANGE);
+			return AST::TypeNode(keyword, nullToken, low, parseIntegerLiteral());
+		}
+
+		if (matching(TokenType::RECORD) || matching(TokenType::PACKED))
+		{
+			Token keyword = previousToken();
+			if (keyword.type == TokenType::PACKED)
+				require(TokenType::RECORD);
+			return AST::TypeNode(keyword, keyword.type == TokenType::PACKED, parseFieldDecls());
+		}
+
+		if (matching(TokenType::CARET))
+		{
+			Token caret = previousToken();
+			return AST::TypeNode(caret, require(TokenType::IDENTIFIER));
+		}
+
+		if (!matching(TokenType::ARRAY))
+			return AST::TypeNode(require(TokenType::IDENTIFIER));
+
+		Token keyword = previousToken();
+		require(TokenType::OPEN_BRACKET);
+		AST::IntegerLiteral low = parseIntegerLiteral();
+		require(TokenType::RANGE);
+		AST::IntegerLiteral high = parseIntegerLiteral();
+		require(TokenType::CLOSE_BRACKET);
+		require(TokenType::OF);
+
+		return AST::TypeNode(keyword, low, high, require(TokenType::IDENTIFIER));
+	}
+
+	inline std::unique_ptr<AST::IndexNode> Parser::parseIndex(Token id)
+	{
+		Token bracket = previousToken();
+		std::unique_ptr<AST::Node> index = parseExpr();
+		require(TokenType::CLOSE_BRACKET);
+
+		return std::make_unique<AST::IndexNode>(std::make_unique<AST::VariableNode>(id), bracket, move(index));
+	}
+
+	// The first dot is already matched.
+	inline std::vector<Token_t> Parser::parseFieldNames()
+	{
+		std::vector<Token_t> res;
+		do
+		{
+			res.push_back(require(TokenType::IDENTIFIER));
+		} while (matching(TokenType::DOT));
+		return res;
+	}
+
+	// The caret is already matched, the fields of <pointer>^.<field>...
+	// or none.
+	inline std::vector<Token_t> Parser::parseDereferenceFields()
+	{
+		if (matching(TokenType::DOT))
+			return parseFieldNames();
+		return {};
+	}
+
+	// The 'record' keyword is already matched. The semicolon after the
+	// last field is optional.
+	inline std::shared_ptr<const std::vector<AST::FieldDecl>> Parser::parseFieldDecls()
+	{
+		std::shared_ptr<std::vector<AST::FieldDecl>> res = std::make_shared<std::vector<AST::FieldDecl>>();
+		while (currentToken().type == TokenType::IDENTIFIER)
+		{
+			AST::FieldDecl field;
+			do
+			{
+				field.names.push_back(require(TokenType::IDENTIFIER));
+			} while (matching(TokenType::COMMA));
+
+			require(TokenType::COLON);
+			field.type = std::make_shared<AST::TypeNode>(parseType());
+			res->push_back(std::move(field));
+
+			if (!matching(TokenType::SEMICOLON))
+				break;
+		}
+		require(TokenType::END);
+		return res;
+	}
+
+	// The opening parenthesis is already matched.
+	inline std::vector<std::unique_ptr<AST::Node>> Parser::parseArguments()
+	{
+		std::vector<std::unique_ptr<AST::Node>> res;
+		if (!matching(TokenType::CLOSE_PAREN))
+		{
+			do
+			{
+				res.push_back(parseExpr());
+			} while (matching(TokenType::COMMA));
+
+			require(TokenType::CLOSE_PAREN);
+		}
+		return res;
+	}
+
+	// The opening bracket is already matched.
+	inline std::unique_ptr<AST::SetNode> Parser::parseSet()
+	{
+		Token bracket = previousToken();
+		std::vector<AST::SetNode::Element> elements;
+		if (!matching(TokenType::CLOSE_BRACKET))
+		{
+			do
+			{
+				AST::SetNode::Element element;
+				element.low = parseSetBound(element.lowLiteral);
+				element.highLiteral = nullToken;
+				if (matching(TokenType::RANGE))
+					element.high = parseSetBound(element.highLiteral);
+				elements.push_back(std::move(element));
+			} while (matching(TokenType::COMMA));
+
+			require(TokenType::CLOSE_BRACKET);
+		}
+		return std::make_unique<AST::SetNode>(bracket, move(elements));
+	}
+
+	// 'literal' is the bound's token if that is all of it, nullToken otherwise.
+	inline std::unique_ptr<AST::Node> Parser::parseSetBound(Token_t& literal)
+	{
+		size_t start = m_ParserPos;
+		Token_t first = currentToken();
+		std::unique_ptr<AST::Node> res = parseExpr();
+
+		bool lone = (m_ParserPos == start + 1 &&
+					 (first.type == TokenType::NUMBER_LITERAL || first.type == TokenType::STRING_LITERAL));
+		literal = lone ? first : nullToken;
+		return res;
+	}
+
 	std::unique_ptr<AST::CompoundNode> Parser::parseCompound()
 	{
 		require(TokenType::BEGIN);
@@ -136,10 +311,37 @@ namespace Pascal
 		{
 			return parseCompound();
 		}
+		else if (currentToken().type == TokenType::WHILE)
+		{
+			return parseWhile();
+		}
+		else if (currentToken().type == TokenType::REPEAT)
+		{
+			return parseRepeat();
+		}
+		else if (currentToken().type == TokenType::FOR)
+		{
+			return parseFor();
+		}
+		else if (currentToken().type == TokenType::IF)
+		{
+			return parseIf();
+		}
+		else if (currentToken().type == TokenType::CASE)
+		{
+			return parseCase();
+		}
 		else if (currentToken().type == TokenType::IDENTIFIER)
 		{
 			Token id = match(TokenType::IDENTIFIER);
-			Token temp = match({ TokenType::ASSIGNMENT, TokenType::OPEN_PAREN });
+			// A call without arguments may leave out the parentheses: writeln;
+			if (currentToken().type == TokenType::SEMICOLON ||
+				currentToken().type == TokenType::END ||
+				currentToken().type == TokenType::UNTIL ||
+				currentToken().type == TokenType::ELSE)
+				return std::make_unique<AST::ProcCallNode>(id, std::vector<std::unique_ptr<AST::Node>>());
+			Token temp = match({ TokenType::ASSIGNMENT, TokenType::OPEN_PAREN, TokenType::OPEN_BRACKET,
+					TokenType::DOT, TokenType::CARET });
 			switch (temp.type)
 			{
 			case TokenType::ASSIGNMENT:
@@ -150,27 +352,52 @@ namespace Pascal
 					);
 				break;
 			}
-			case TokenType::OPEN_PAREN:
+			case TokenType::OPEN_BRACKET:
 			{
-				std::vector<std::unique_ptr<AST::Node>> params;
-				if (!matching(TokenType::CLOSE_PAREN))
+				std::unique_ptr<AST::IndexNode> element = parseIndex(id);
+				if (matching(TokenType::DOT))
 				{
-					do
-					{
-					    params.push_back(parseExpr());
-					} while (matching(TokenType::COMMA));
-
-					require(TokenType::CLOSE_PAREN);
+					std::unique_ptr<AST::FieldNode> field = std::make_unique<AST::FieldNode>(
+						move(element), parseFieldNames());
+					require(TokenType::ASSIGNMENT);
+					return std::make_unique<AST::AssignmentNode>(move(field), parseExpr());
 				}
-				return std::make_unique<AST::ProcCallNode>(id, std::move(params));
-				break;
+				if (matching(TokenType::CARET))
+				{
+					Token caret = previousToken();
+					std::unique_ptr<AST::FieldNode> field = std::make_unique<AST::FieldNode>(
+						move(element), caret, parseDereferenceFields());
+					require(TokenType::ASSIGNMENT);
+					return std::make_unique<AST::AssignmentNode>(move(field), parseExpr());
+				}
+				require(TokenType::ASSIGNMENT);
+				return std::make_unique<AST::AssignmentNode>(move(element), parseExpr());
 			}
+			case TokenType::DOT:
+			{
+				std::unique_ptr<AST::FieldNode> field = std::make_unique<AST::FieldNode>(
+					std::make_unique<AST::VariableNode>(id), parseFieldNames());
+				require(TokenType::ASSIGNMENT);
+				return std::make_unique<AST::AssignmentNode>(move(field), parseExpr());
+			}
+			case TokenType::CARET:
+			{
+				std::unique_ptr<AST::FieldNode> field = std::make_unique<AST::FieldNode>(
+					std::make_unique<AST::VariableNode>(id), temp, parseDereferenceFields());
+				require(TokenType::ASSIGNMENT);
+				return std::make_unique<AST::AssignmentNode>(move(field), parseExpr());
+			}
+			case TokenType::OPEN_PAREN:
+				return std::make_unique<AST::ProcCallNode>(id, parseArguments());
 			default:
 				ReportsManager::ReportError(id.pos, ErrorType::ILLEGAL_STATEMENT);
 				return std::make_unique<AST::NullStatementNode>();
 			}
 		}
-		else if (currentToken().type != TokenType::SEMICOLON)
+		else if (currentToken().type != TokenType::SEMICOLON &&
+				 currentToken().type != TokenType::END &&
+				 currentToken().type != TokenType::UNTIL &&
+				 currentToken().type != TokenType::ELSE)
 		{
 			ReportsManager::ReportError(currentToken().pos, ErrorType::ILLEGAL_STATEMENT);
 			return std::make_unique<AST::NullStatementNode>();
@@ -190,13 +417,134 @@ namespace Pascal
 		return std::make_unique<AST::AssignmentNode>(move(var), move(expr));
 	}
 
+	std::unique_ptr<AST::WhileNode> Parser::parseWhile()
+	{
+		Token keyword = require(TokenType::WHILE);
+		std::unique_ptr<AST::Node> condition = parseExpr();
+		require(TokenType::DO);
+
+		return std::make_unique<AST::WhileNode>(keyword, move(condition), parseStatement());
+	}
+
+	std::unique_ptr<AST::RepeatNode> Parser::parseRepeat()
+	{
+		Token keyword = require(TokenType::REPEAT);
+
+		std::vector<std::unique_ptr<AST::StatementNode>> statements;
+		do
+		{
+			statements.push_back(parseStatement());
+		}
+		while (matching(TokenType::SEMICOLON));
+
+		require(TokenType::UNTIL);
+
+		return std::make_unique<AST::RepeatNode>(keyword, move(statements), parseExpr());
+	}
+
+	std::unique_ptr<AST::ForNode> Parser::parseFor()
+	{
+		Token keyword = require(TokenType::FOR);
+		std::unique_ptr<AST::VariableNode> var = std::make_unique<AST::VariableNode>(require(TokenType::IDENTIFIER));
+		require(TokenType::ASSIGNMENT);
+		std::unique_ptr<AST::Node> from = parseExpr();
+		Token direction = require({ TokenType::TO, TokenType::DOWNTO });
+		std::unique_ptr<AST::Node> to = parseExpr();
+		require(TokenType::DO);
+
+		return std::make_unique<AST::ForNode>(keyword, move(var), move(from), move(to),
+											  direction.type == TokenType::DOWNTO, parseStatement());
+	}
+
+	// The else belongs to the nearest if.
+	std::unique_ptr<AST::IfNode> Parser::parseIf()
+	{
+		Token keyword = require(TokenType::IF);
+		std::unique_ptr<AST::Node> condition = parseExpr();
+		require(TokenType::THEN);
+		std::unique_ptr<AST::StatementNode> thenBranch = parseStatement();
+
+		std::unique_ptr<AST::StatementNode> elseBranch;
+		if (matching(TokenType::ELSE))
+			elseBranch = parseStatement();
+
+		return std::make_unique<AST::IfNode>(keyword, move(condition), move(thenBranch), move(elseBranch));
+	}
+
+	// The semicolon after the last branch is optional.
+	std::unique_ptr<AST::CaseNode> Parser::parseCase()
+	{
+		Token keyword = require(TokenType::CASE);
+		std::unique_ptr<AST::Node> selector = parseExpr();
+		require(TokenType::OF);
+
+		std::vector<AST::CaseNode::Branch> branches;
+		while (currentToken().type != TokenType::END && currentToken().type != TokenType::ELSE)
+		{
+			AST::CaseNode::Branch branch;
+			do
+			{
+				// Other literals are kept for the SemanticAnalyzer to reject at their position.
+				Token other = match({ TokenType::STRING_LITERAL, TokenType::BOOL_LITERAL });
+				if (other.type != TokenType::NONE)
+					branch.labels.push_back({ other, false });
+				else
+					branch.labels.push_back(parseIntegerLiteral());
+			} while (matching(TokenType::COMMA));
+
+			require(TokenType::COLON);
+			branch.statement = parseStatement();
+			branches.push_back(std::move(branch));
+
+			if (!matching(TokenType::SEMICOLON))
+				break;
+		}
+
+		std::unique_ptr<AST::StatementNode> elseBranch;
+		if (matching(TokenType::ELSE))
+		{
+			elseBranch = parseStatement();
+			matching(TokenType::SEMICOLON);
+		}
+		require(TokenType::END);
+
+		return std::make_unique<AST::CaseNode>(keyword, move(selector), move(branches), move(elseBranch));
+	}
+
+	AST::IntegerLiteral Parser::parseIntegerLiteral()
+	{
+		bool negative = false;
+		if (matching(TokenType::MINUS))
+			negative = true;
+		else
+			matching(TokenType::PLUS);
+
+		return { require(TokenType::NUMBER_LITERAL), negative };
+	}
+
+	// Relations bind loosest and don't chain, as in Pascal.
 	std::unique_ptr<AST::Node> Parser::parseExpr()
+	{
+		std::unique_ptr<AST::Node> left = parseSum();
+
+		Token_t operation = match({
+				TokenType::EQUAL, TokenType::NOT_EQUAL, TokenType::LESS,
+				TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL,
+				TokenType::IN
+			});
+		if (operation.type != TokenType::NONE)
+			left = std::make_unique<AST::BinOpNode>(move(left), parseSum(), operation);
+
+		return left;
+	}
+
+	std::unique_ptr<AST::Node> Parser::parseSum()
 	{
 		std::unique_ptr<AST::Node> left = parseMultDiv();
 
 		while (true)
 		{
-		    Token_t operation = match({ TokenType::PLUS, TokenType::MINUS });
+		    Token_t operation = match({ TokenType::PLUS, TokenType::MINUS, TokenType::OR });
 			if (operation.type == TokenType::NONE)
 				break;
 
@@ -214,7 +562,7 @@ namespace Pascal
 		while (true)
 		{
 			Token_t operation = match({
-					TokenType::PRODUCT, TokenType::DIVISION, TokenType::MOD
+					TokenType::PRODUCT, TokenType::DIVISION, TokenType::MOD, TokenType::AND
 				});
 			if (operation.type == TokenType::NONE)
 				break;
@@ -228,7 +576,7 @@ namespace Pascal
 
 	std::unique_ptr<AST::Node> Parser::parseUnary()
 	{
-		if (matching(TokenType::MINUS) || matching(TokenType::PLUS))
+		if (matching(TokenType::MINUS) || matching(TokenType::PLUS) || matching(TokenType::NOT))
 		{
 			Token t = previousToken();
 			return std::make_unique<AST::UnaryOpNode>(parseUnary(), t);
@@ -237,9 +585,48 @@ namespace Pascal
 		{
 			return std::make_unique<AST::NumberNode>(previousToken());
 		}
+		else if (matching(TokenType::BOOL_LITERAL))
+		{
+			return std::make_unique<AST::BooleanNode>(previousToken());
+		}
+		else if (matching(TokenType::STRING_LITERAL))
+		{
+			return std::make_unique<AST::StringNode>(previousToken());
+		}
+		else if (matching(TokenType::NIL))
+		{
+			return std::make_unique<AST::NilNode>(previousToken());
+		}
 		else if (matching(TokenType::IDENTIFIER))
 		{
-			return std::make_unique<AST::VariableNode>(previousToken());
+			Token id = previousToken();
+			if (matching(TokenType::OPEN_BRACKET))
+			{
+				std::unique_ptr<AST::IndexNode> element = parseIndex(id);
+				if (matching(TokenType::DOT))
+					return std::make_unique<AST::FieldNode>(move(element), parseFieldNames());
+				if (matching(TokenType::CARET))
+				{
+					Token caret = previousToken();
+					return std::make_unique<AST::FieldNode>(move(element), caret, parseDereferenceFields());
+				}
+				return element;
+			}
+			if (matching(TokenType::DOT))
+				return std::make_unique<AST::FieldNode>(std::make_unique<AST::VariableNode>(id), parseFieldNames());
+			if (matching(TokenType::CARET))
+			{
+				Token caret = previousToken();
+				return std::make_unique<AST::FieldNode>(std::make_unique<AST::VariableNode>(id), caret,
+														parseDereferenceFields());
+			}
+			if (matching(TokenType::OPEN_PAREN))
+				return std::make_unique<AST::ProcCallNode>(id, parseArguments(), true);
+			return std::make_unique<AST::VariableNode>(id);
+		}
+		else if (matching(TokenType::OPEN_BRACKET))
+		{
+			return parseSet();
 		}
 		else if (matching(TokenType::OPEN_PAREN))
 		{
@@ -0,0 +1,188 @@
+#include <pscpch.hpp>
+#include <Peephole.hpp>
+
+#include <climits>
+
+namespace Pascal
+{
+	void PeepholeOptimizer::run()
+	{
+		std::vector<Instruction> const& code = m_Code.getCode();
+		std::vector<size_t> const& positions = m_Code.getPositions();
+
+		m_Targets.assign(code.size() + 1, false);
+		for (auto const& e : code)
+		{
+			if (opCodeIsJump(e.op))
+				m_Targets[e.a] = true;
+		}
+		for (auto const& e : m_Code.getProcedures())
+			m_Targets[e.entry] = true;
+
+		std::vector<Instruction> res;
+		std::vector<size_t> resPositions;
+		std::vector<size_t> newIndex(code.size() + 1);
+
+		size_t i = 0;
+		while (i < code.size())
+		{
+			Instruction fused = code[i];
+			size_t length = 1;
+			// Errors of a superinstruction are reported where its operation is.
+			size_t pos = positions[i];
+
+			if (fuseIncrement(i, OpCode::LOAD_LOCAL, OpCode::STORE_LOCAL, OpCode::INC_LOCAL, fused) ||
+				fuseIncrement(i, OpCode::LOAD_GLOBAL, OpCode::STORE_GLOBAL, OpCode::INC_GLOBAL, fused))
+			{
+				length = 4;
+				pos = positions[i + 2];
+			}
+			else if (i + 1 < code.size() && !m_Targets[i + 1] &&
+					 withConst(code[i + 1].op) != OpCode::NOP &&
+					 (code[i].op == OpCode::CONST || code[i].op == OpCode::LOAD_LOCAL ||
+					  code[i].op == OpCode::LOAD_GLOBAL))
+			{
+				OpCode op = code[i + 1].op;
+				if (code[i].op == OpCode::CONST)
+					fused.op = withConst(op);
+				else if (code[i].op == OpCode::LOAD_LOCAL)
+					fused.op = withLocal(op);
+				else
+					fused.op = withGlobal(op);
+				length = 2;
+				pos = positions[i + 1];
+			}
+			else if (matches(i, { OpCode::CONST, OpCode::TO_REAL }))
+			{
+				Value value = m_Code.getConstants()[code[i].a];
+				if (value.isInteger())
+					value = Value::Real(static_cast<double>(value.as.integer));
+				fused.a = m_Code.addConstant(value);
+				length = 2;
+			}
+			else if (matches(i, { OpCode::CONST, OpCode::TO_BIG }))
+			{
+				Value value = m_Code.getConstants()[code[i].a];
+				if (value.isInteger())
+					value = Value::BigInt(value.as.integer);
+				fused.a = m_Code.addConstant(value);
+				length = 2;
+			}
+			else if (matches(i, { OpCode::LOAD_LOCAL, OpCode::LOAD_LOCAL }))
+			{
+				fused.op = OpCode::LOAD_LOCAL2;
+				fused.b = code[i + 1].a;
+				length = 2;
+			}
+			else if (matches(i, { OpCode::LOAD_GLOBAL, OpCode::LOAD_GLOBAL }))
+			{
+				fused.op = OpCode::LOAD_GLOBAL2;
+				fused.b = code[i + 1].a;
+				length = 2;
+			}
+
+			if (length > 1)
+				m_Fused++;
+
+			for (size_t j = 0; j < length; j++)
+				newIndex[i + j] = res.size();
+
+			res.push_back(fused);
+			resPositions.push_back(pos);
+			i += length;
+		}
+		newIndex[code.size()] = res.size();
+
+		for (auto& e : res)
+		{
+			if (opCodeIsJump(e.op))
+				e.a = newIndex[e.a];
+		}
+		for (auto& e : m_Code.getProcedures())
+			e.entry = newIndex[e.entry];
+
+		m_Code.getCode() = std::move(res);
+		m_Code.getPositions() = std::move(resPositions);
+	}
+
+	bool PeepholeOptimizer::matches(size_t pos, std::initializer_list<OpCode> ops) const
+	{
+		std::vector<Instruction> const& code = m_Code.getCode();
+		if (pos + ops.size() > code.size())
+			return false;
+
+		size_t i = pos;
+		for (OpCode op : ops)
+		{
+			if (code[i].op != op || (i != pos && m_Targets[i]))
+				return false;
+			i++;
+		}
+		return true;
+	}
+
+	// load x; const k; add/sub; store x  ->  inc x, (+/-)k
+	bool PeepholeOptimizer::fuseIncrement(size_t pos, OpCode load, OpCode store, OpCode inc,
+										  Instruction& res)
+	{
+		std::vector<Instruction> const& code = m_Code.getCode();
+
+		bool isAdd = matches(pos, { load, OpCode::CONST, OpCode::ADD, store });
+		bool isSub = !isAdd && matches(pos, { load, OpCode::CONST, OpCode::SUB, store });
+		if ((!isAdd && !isSub) || code[pos].a != code[pos + 3].a)
+			return false;
+
+		Value step = m_Code.getConstants()[code[pos + 1].a];
+		if (isSub)
+		{
+			if (step.isInteger() && step.as.integer != LONG_MIN)
+				step = Value::Integer(-step.as.integer);
+			else if (step.isReal())
+				step = Value::Real(-step.as.real);
+			else
+				return false;
+		}
+
+		res = { nullptr, inc, code[pos].a, static_cast<int32_t>(m_Code.addConstant(step)), 0 };
+		return true;
+	}
+
+	OpCode PeepholeOptimizer::withConst(OpCode op)
+	{
+		switch (op)
+		{
+		case OpCode::ADD: return OpCode::ADD_CONST;
+		case OpCode::SUB: return OpCode::SUB_CONST;
+		case OpCode::MUL: return OpCode::MUL_CONST;
+		case OpCode::DIV: return OpCode::DIV_CONST;
+		case OpCode::MOD: return OpCode::MOD_CONST;
+		default:          return OpCode::NOP;
+		}
+	}
+
+	OpCode PeepholeOptimizer::withLocal(OpCode op)
+	{
+		switch (op)
+		{
+		case OpCode::ADD: return OpCode::ADD_LOCAL;
+		case OpCode::SUB: return OpCode::SUB_LOCAL;
+		case OpCode::MUL: return OpCode::MUL_LOCAL;
+		case OpCode::DIV: return OpCode::DIV_LOCAL;
+		case OpCode::MOD: return OpCode::MOD_LOCAL;
+		default:          return OpCode::NOP;
+		}
+	}
+
+	OpCode PeepholeOptimizer::withGlobal(OpCode op)
+	{
+		switch (op)
+		{
+		case OpCode::ADD: return OpCode::ADD_GLOBAL;
+		case OpCode::SUB: return OpCode::SUB_GLOBAL;
+		case OpCode::MUL: return OpCode::MUL_GLOBAL;
+		case OpCode::DIV: return OpCode::DIV_GLOBAL;
+		case OpCode::MOD: return OpCode::MOD_GLOBAL;
+		default:          return OpCode::NOP;
+		}
+	}
+}
@@ -0,0 +1,601 @@
+#include <pscpch.hpp>
+#include <RegisterTranslator.hpp>
+
+#include <climits>
+
+namespace Pascal
+{
+	void RegisterTranslator::run()
+	{
+		std::vector<Instruction> const& code = m_Code.getCode();
+		std::vector<size_t> const& positions = m_Code.getPositions();
+		std::vector<ProcedureCode>& procedures = m_Code.getProcedures();
+
+		// The code of a procedure runs from its entry up to the next one.
+		std::vector<unsigned> order(procedures.size());
+		for (unsigned i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&](unsigned a, unsigned b)
+		{
+			return procedures[a].entry < procedures[b].entry;
+		});
+
+		m_Result.clear();
+		m_ResultPositions.clear();
+
+		for (size_t k = 0; k < order.size(); k++)
+		{
+			ProcedureCode& proc = procedures[order[k]];
+			size_t begin = proc.entry;
+			size_t end = (k + 1 < order.size()) ? procedures[order[k + 1]].entry : code.size();
+			size_t start = m_Result.size();
+
+			if (translate(proc, begin, end))
+			{
+				proc.registerCode = true;
+				m_Translated++;
+			}
+			else
+			{
+				m_Result.resize(start);
+				m_ResultPositions.resize(start);
+				for (size_t i = begin; i < end; i++)
+				{
+					Instruction e = code[i];
+					if (opCodeIsJump(e.op))
+						e.a = start + (e.a - begin);
+					m_Result.push_back(e);
+					m_ResultPositions.push_back(positions[i]);
+				}
+			}
+			proc.entry = start;
+		}
+
+		m_Code.getCode() = std::move(m_Result);
+		m_Code.getPositions() = std::move(m_ResultPositions);
+	}
+
+	bool RegisterTranslator::translate(ProcedureCode& proc, size_t begin, size_t end)
+	{
+		std::vector<Instruction> const& code = m_Code.getCode();
+		std::vector<size_t> const& positions = m_Code.getPositions();
+
+		m_Stack.clear();
+		m_FreeTemps.clear();
+		m_FirstTemp = m_NextTemp = proc.getFrameSize();
+		m_MaxRegister = m_FirstTemp - 1;
+		m_LastDefinition = SIZE_MAX;
+
+		size_t start = m_Result.size();
+		std::vector<bool> targets(end - begin, false);
+		for (size_t i = begin; i < end; i++)
+		{
+			if (!opCodeIsJump(code[i].op))
+				continue;
+			if (code[i].a < static_cast<int32_t>(begin) || code[i].a >= static_cast<int32_t>(end))
+				return false;
+			targets[code[i].a - begin] = true;
+		}
+
+		// Control flow only meets where the operand stack is empty, so no
+		// temporary is live across a jump.
+		std::vector<size_t> newIndex(end - begin);
+		for (size_t i = begin; i < end; i++)
+		{
+			Instruction const& e = code[i];
+			size_t pos = positions[i];
+
+			newIndex[i - begin] = m_Result.size();
+			if (targets[i - begin])
+			{
+				if (!m_Stack.empty())
+					return false;
+				m_LastDefinition = SIZE_MAX;
+			}
+
+			switch (e.op)
+			{
+			case OpCode::NOP:
+				break;
+			case OpCode::CONST:
+				m_Stack.push_back({ true, false, e.a });
+				break;
+			case OpCode::LOAD_LOCAL:
+				m_Stack.push_back({ false, false, e.a });
+				break;
+			case OpCode::LOAD_GLOBAL:
+			{
+				int32_t reg = allocateTemp();
+				emitDefinition(OpCode::R_GETGLOBAL, reg, e.a, 0, pos);
+				pushTemp(reg);
+				break;
+			}
+			case OpCode::LOAD_OUTER:
+			{
+				int32_t reg = allocateTemp();
+				emitDefinition(OpCode::R_GETOUTER, reg, e.a, e.b, pos);
+				pushTemp(reg);
+				break;
+			}
+			case OpCode::STORE_LOCAL:
+				emitStoreLocal(proc, e.a, pos);
+				break;
+			case OpCode::STORE_GLOBAL:
+			{
+				Operand value = toRegister(pop(), pos);
+				emit(OpCode::R_SETGLOBAL, e.a, value.index, 0, pos);
+				release(value);
+				break;
+			}
+			case OpCode::STORE_OUTER:
+			{
+				Operand value = toRegister(pop(), pos);
+				emit(OpCode::R_SETOUTER, e.a, e.b, value.index, pos);
+				release(value);
+				break;
+			}
+			case OpCode::BOUNDS:
+			{
+				Operand index = m_Stack.back();
+				if (index.constant)
+				{
+					Value const& value = m_Code.getConstants()[index.index];
+					if (value.isInteger() && value.as.integer >= e.a && value.as.integer <= e.b)
+						break;
+				}
+				index = toRegister(index, pos);
+				m_Stack.back() = index;
+				emit(OpCode::R_BOUNDS, index.index, e.a, e.b, pos);
+				break;
+			}
+			case OpCode::LOAD_ELEM:
+			case OpCode::LOAD_GELEM:
+			{
+				bool global = (e.op == OpCode::LOAD_GELEM);
+				Operand index = pop();
+				int32_t slot;
+				if (constantSlot(index, e.a, global ? m_Code.getProcedures()[0].getFrameSize() : m_FirstTemp, slot))
+				{
+					if (!global)
+					{
+						m_Stack.push_back({ false, false, slot });
+						break;
+					}
+					int32_t reg = allocateTemp();
+					emitDefinition(OpCode::R_GETGLOBAL, reg, slot, 0, pos);
+					pushTemp(reg);
+					break;
+				}
+
+				index = toRegister(index, pos);
+				release(index);
+				int32_t reg = allocateTemp();
+				emitDefinition(global ? OpCode::R_GETGELEM : OpCode::R_GETELEM, reg, e.a, index.index, pos);
+				pushTemp(reg);
+				break;
+			}
+			case OpCode::STORE_ELEM:
+			case OpCode::STORE_GELEM:
+			{
+				bool global = (e.op == OpCode::STORE_GELEM);
+				Operand value = pop();
+				Operand index = pop();
+				int32_t slot;
+				if (constantSlot(index, e.a, global ? m_Code.getProcedures()[0].getFrameSize() : m_FirstTemp, slot))
+				{
+					if (!global)
+					{
+						m_Stack.push_back(value);
+						emitStoreLocal(proc, slot, pos);
+						break;
+					}
+					value = toRegister(value, pos);
+					emit(OpCode::R_SETGLOBAL, slot, value.index, 0, pos);
+					release(value);
+					break;
+				}
+
+				// Any element may be a pending operand's variable.
+				if (!global && !m_Stack.empty())
+					return false;
+				index = toRegister(index, pos);
+				value = toRegister(value, pos);
+				emit(global ? OpCode::R_SETGELEM : OpCode::R_SETELEM, e.a, index.index, value.index, pos);
+				release(index);
+				release(value);
+				break;
+			}
+			case OpCode::ADD:
+			case OpCode::SUB:
+			case OpCode::MUL:
+			case OpCode::DIV:
+			case OpCode::MOD:
+				emitArithmetic(e.op, pos);
+				break;
+			case OpCode::NEG:
+			{
+				Operand value = pop();
+				if (value.constant)
+				{
+					Value folded = m_Code.getConstants()[value.index];
+					if (folded.isInteger() && folded.as.integer != LONG_MIN)
+					{
+						folded = Value::Integer(-folded.as.integer);
+						m_Stack.push_back({ true, false, static_cast<int32_t>(m_Code.addConstant(folded)) });
+						break;
+					}
+					else if (folded.isReal())
+					{
+						folded = Value::Real(-folded.as.real);
+						m_Stack.push_back({ true, false, static_cast<int32_t>(m_Code.addConstant(folded)) });
+						break;
+					}
+					value = toRegister(value, pos);
+				}
+				release(value);
+				int32_t reg = allocateTemp();
+				emitDefinition(OpCode::R_NEG, reg, value.index, 0, pos);
+				pushTemp(reg);
+				break;
+			}
+			case OpCode::NOT:
+			{
+				Operand value = pop();
+				if (value.constant && m_Code.getConstants()[value.index].isBoolean())
+				{
+					Value folded = Value::Boolean(!m_Code.getConstants()[value.index].as.boolean);
+					m_Stack.push_back({ true, false, static_cast<int32_t>(m_Code.addConstant(folded)) });
+					break;
+				}
+				value = toRegister(value, pos);
+				release(value);
+				int32_t reg = allocateTemp();
+				emitDefinition(OpCode::R_NOT, reg, value.index, 0, pos);
+				pushTemp(reg);
+				break;
+			}
+			case OpCode::EQ: emitComparison(OpCode::R_EQ, pos); break;
+			case OpCode::NE: emitComparison(OpCode::R_NE, pos); break;
+			case OpCode::LT: emitComparison(OpCode::R_LT, pos); break;
+			case OpCode::LE: emitComparison(OpCode::R_LE, pos); break;
+			case OpCode::GT: emitComparison(OpCode::R_GT, pos); break;
+			case OpCode::GE: emitComparison(OpCode::R_GE, pos); break;
+			case OpCode::TO_REAL:
+			{
+				Operand value = pop();
+				if (value.constant)
+				{
+					Value folded = m_Code.getConstants()[value.index];
+					if (folded.isInteger())
+						folded = Value::Real(static_cast<double>(folded.as.integer));
+					m_Stack.push_back({ true, false, static_cast<int32_t>(m_Code.addConstant(folded)) });
+					break;
+				}
+				release(value);
+				int32_t reg = allocateTemp();
+				emitDefinition(OpCode::R_TO_REAL, reg, value.index, 0, pos);
+				pushTemp(reg);
+				break;
+			}
+			case OpCode::CALL:
+				if (!emitCall(OpCode::R_CALL, m_Code.getProcedures()[e.a], e.a, pos))
+					return false;
+				break;
+			case OpCode::TAIL_CALL:
+				if (!emitCall(OpCode::R_TAIL_CALL, m_Code.getProcedures()[e.a], e.a, pos))
+					return false;
+				break;
+			case OpCode::RET:
+			case OpCode::RET_VALUE:
+			case OpCode::HALT:
+				if (!m_Stack.empty())
+					return false;
+				emit(e.op, e.a, 0, 0, pos);
+				break;
+			case OpCode::JUMP:
+			case OpCode::FOR_INIT:
+			case OpCode::FOR_INIT_DN:
+			case OpCode::FOR_NEXT:
+			case OpCode::FOR_NEXT_DN:
+			case OpCode::VECTOR:
+				if (!m_Stack.empty())
+					return false;
+				emit(e.op, e.a, e.b, e.c, pos);
+				break;
+			case OpCode::JUMP_FALSE:
+			case OpCode::JUMP_TRUE:
+			{
+				Operand condition = pop();
+				if (!m_Stack.empty())
+					return false;
+
+				bool expected = (e.op == OpCode::JUMP_TRUE);
+				if (condition.constant && m_Code.getConstants()[condition.index].isBoolean())
+				{
+					if (m_Code.getConstants()[condition.index].as.boolean == expected)
+						emit(OpCode::JUMP, e.a, 0, 0, pos);
+					break;
+				}
+
+				condition = toRegister(condition, pos);
+				emit(expected ? OpCode::R_JUMP_TRUE : OpCode::R_JUMP_FALSE, e.a, condition.index, 0, pos);
+				release(condition);
+				break;
+			}
+			case OpCode::JUMP_EQ:
+			case OpCode::JUMP_NE:
+			case OpCode::JUMP_LT:
+			case OpCode::JUMP_LE:
+			case OpCode::JUMP_GT:
+			case OpCode::JUMP_GE:
+			{
+				if (!emitCompareJump(e.op, e.a, pos))
+					return false;
+				break;
+			}
+			case OpCode::CASE_LIST:
+			case OpCode::CASE_FIND:
+			case OpCode::CASE_TABLE:
+			{
+				Operand selector = toRegister(pop(), pos);
+				if (!m_Stack.empty())
+					return false;
+
+				OpCode res = (e.op == OpCode::CASE_LIST) ? OpCode::R_CASE_LIST :
+					(e.op == OpCode::CASE_FIND) ? OpCode::R_CASE_FIND : OpCode::R_CASE_TABLE;
+				emit(res, e.a, selector.index, 0, pos);
+				release(selector);
+				break;
+			}
+			default:
+				return false;
+			}
+		}
+
+		for (size_t i = start; i < m_Result.size(); i++)
+		{
+			if (opCodeIsJump(m_Result[i].op))
+				m_Result[i].a = newIndex[m_Result[i].a - begin];
+		}
+
+		proc.maxStack = std::max(0, m_MaxRegister + 1 - m_FirstTemp);
+		return true;
+	}
+
+	int32_t RegisterTranslator::allocateTemp()
+	{
+		int32_t reg;
+		if (!m_FreeTemps.empty())
+		{
+			reg = *m_FreeTemps.begin();
+			m_FreeTemps.erase(m_FreeTemps.begin());
+		}
+		else
+		{
+			reg = m_NextTemp++;
+		}
+		useRegister(reg);
+		return reg;
+	}
+
+	void RegisterTranslator::release(Operand const& operand)
+	{
+		if (operand.temporary)
+			m_FreeTemps.insert(operand.index);
+	}
+
+	void RegisterTranslator::useRegister(int32_t reg)
+	{
+		m_MaxRegister = std::max(m_MaxRegister, reg);
+	}
+
+	RegisterTranslator::Operand RegisterTranslator::pop()
+	{
+		Operand res = m_Stack.back();
+		m_Stack.pop_back();
+		return res;
+	}
+
+	void RegisterTranslator::pushTemp(int32_t reg)
+	{
+		m_Stack.push_back({ false, true, reg });
+	}
+
+	RegisterTranslator::Operand RegisterTranslator::toRegister(Operand const& operand, size_t pos)
+	{
+		if (!operand.constant)
+			return operand;
+
+		int32_t reg = allocateTemp();
+		emitDefinition(OpCode::R_LOADK, reg, operand.index, 0, pos);
+		return { false, true, reg };
+	}
+
+	void RegisterTranslator::emit(OpCode op, int32_t a, int32_t b, int32_t c, size_t pos)
+	{
+		m_Result.push_back({ nullptr, op, a, b, c });
+		m_ResultPositions.push_back(pos);
+	}
+
+	void RegisterTranslator::emitDefinition(OpCode op, int32_t a, int32_t b, int32_t c, size_t pos)
+	{
+		emit(op, a, b, c, pos);
+		m_LastDefinition = m_Result.size() - 1;
+	}
+
+	void RegisterTranslator::emitArithmetic(OpCode op, size_t pos)
+	{
+		Operand right = pop();
+		Operand left = pop();
+
+		// Concatenation doesn't commute.
+		if (left.constant && !right.constant && (op == OpCode::ADD || op == OpCode::MUL) &&
+			!m_Code.getConstants()[left.index].isString())
+			std::swap(left, right);
+		left = toRegister(left, pos);
+
+		OpCode res;
+		switch (op)
+		{
+		case OpCode::ADD: res = right.constant ? OpCode::R_ADDK : OpCode::R_ADD; break;
+		case OpCode::SUB: res = right.constant ? OpCode::R_SUBK : OpCode::R_SUB; break;
+		case OpCode::MUL: res = right.constant ? OpCode::R_MULK : OpCode::R_MUL; break;
+		case OpCode::DIV: res = right.constant ? OpCode::R_DIVK : OpCode::R_DIV; break;
+		default:          res = right.constant ? OpCode::R_MODK : OpCode::R_MOD; break;
+		}
+
+		release(left);
+		release(right);
+		int32_t reg = allocateTemp();
+		emitDefinition(res, reg, left.index, right.index, pos);
+		pushTemp(reg);
+	}
+
+	void RegisterTranslator::emitComparison(OpCode op, size_t pos)
+	{
+		Operand right = toRegister(pop(), pos);
+		Operand left = toRegister(pop(), pos);
+
+		release(left);
+		release(right);
+		int32_t reg = allocateTemp();
+		emitDefinition(op, reg, left.index, right.index, pos);
+		pushTemp(reg);
+	}
+
+	// A constant operand goes last, so 'k < x' is tested as 'x > k'.
+	bool RegisterTranslator::emitCompareJump(OpCode op, int32_t target, size_t pos)
+	{
+		Operand right = pop();
+		Operand left = pop();
+		if (!m_Stack.empty())
+			return false;
+
+		if (left.constant && !right.constant)
+		{
+			std::swap(left, right);
+			switch (op)
+			{
+			case OpCode::JUMP_LT: op = OpCode::JUMP_GT; break;
+			case OpCode::JUMP_LE: op = OpCode::JUMP_GE; break;
+			case OpCode::JUMP_GT: op = OpCode::JUMP_LT; break;
+			case OpCode::JUMP_GE: op = OpCode::JUMP_LE; break;
+			default: break;
+			}
+		}
+		left = toRegister(left, pos);
+
+		OpCode res;
+		switch (op)
+		{
+		case OpCode::JUMP_EQ: res = right.constant ? OpCode::R_JUMP_EQK : OpCode::R_JUMP_EQ; break;
+		case OpCode::JUMP_NE: res = right.constant ? OpCode::R_JUMP_NEK : OpCode::R_JUMP_NE; break;
+		case OpCode::JUMP_LT: res = right.constant ? OpCode::R_JUMP_LTK : OpCode::R_JUMP_LT; break;
+		case OpCode::JUMP_LE: res = right.constant ? OpCode::R_JUMP_LEK : OpCode::R_JUMP_LE; break;
+		case OpCode::JUMP_GT: res = right.constant ? OpCode::R_JUMP_GTK : OpCode::R_JUMP_GT; break;
+		default:              res = right.constant ? OpCode::R_JUMP_GEK : OpCode::R_JUMP_GE; break;
+		}
+
+		emit(res, target, left.index, right.index, pos);
+		release(left);
+		release(right);
+		return true;
+	}
+
+	bool RegisterTranslator::constantSlot(Operand const& index, int32_t offset, int32_t frameSize, int32_t& slot) const
+	{
+		if (!index.constant)
+			return false;
+
+		Value const& value = m_Code.getConstants()[index.index];
+		if (!value.isInteger() || value.as.integer < -offset || value.as.integer >= frameSize - offset)
+			return false;
+		slot = static_cast<int32_t>(offset + value.as.integer);
+		return true;
+	}
+
+	void RegisterTranslator::emitStoreLocal(ProcedureCode const& proc, int32_t slot, size_t pos)
+	{
+		Operand value = pop();
+
+		// Values read from the variable earlier must not see the new one.
+		for (auto& e : m_Stack)
+		{
+			if (!e.constant && !e.temporary && e.index == slot)
+			{
+				int32_t reg = allocateTemp();
+				emit(OpCode::R_MOVE, reg, slot, 0, pos);
+				e = { false, true, reg };
+			}
+		}
+
+		// A real variable has to widen integers, so only the others can
+		// take the result of the last instruction directly.
+		bool lastDefined = value.temporary && m_LastDefinition == m_Result.size() - 1 &&
+			m_Result.back().a == value.index;
+		if (lastDefined && !proc.slotsInit[slot].isReal())
+			m_Result.back().a = slot;
+		else if (value.constant)
+			emit(OpCode::R_SETK, slot, value.index, 0, pos);
+		else
+			emit(OpCode::R_SET, slot, value.index, 0, pos);
+
+		release(value);
+	}
+
+	bool RegisterTranslator::emitCall(OpCode op, ProcedureCode const& callee, int32_t index, size_t pos)
+	{
+		size_t first = m_Stack.size() - callee.paramsCount;
+
+		// The values below the arguments outlive the call, which may change
+		// the variables they were read from.
+		for (size_t i = 0; i < first; i++)
+		{
+			if (!m_Stack[i].constant && !m_Stack[i].temporary)
+			{
+				int32_t reg = allocateTemp();
+				emit(OpCode::R_MOVE, reg, m_Stack[i].index, 0, pos);
+				m_Stack[i] = { false, true, reg };
+			}
+		}
+
+		// The callee's frame starts above every value that outlives the call.
+		int32_t window = m_FirstTemp;
+		for (size_t i = 0; i < first; i++)
+		{
+			if (m_Stack[i].temporary)
+				window = std::max(window, m_Stack[i].index + 1);
+		}
+
+		// The temporaries of the arguments are allocated in order, so filling
+		// the window from the last one never overwrites a pending argument.
+		for (size_t i = callee.paramsCount; i-- > 0;)
+		{
+			Operand const& arg = m_Stack[first + i];
+			int32_t target = window + i;
+			if (arg.temporary && arg.index > target)
+				return false;
+
+			if (arg.constant)
+				emit(OpCode::R_LOADK, target, arg.index, 0, pos);
+			else if (arg.index != target)
+				emit(OpCode::R_MOVE, target, arg.index, 0, pos);
+			useRegister(target);
+		}
+
+		while (m_Stack.size() > first)
+			release(pop());
+
+		emit(op, index, window, 0, pos);
+
+		// A function leaves its result at the start of its frame.
+		if (callee.type == ARType::FUNCTION)
+		{
+			int32_t reg = allocateTemp();
+			if (reg != window)
+				emit(OpCode::R_MOVE, reg, window, 0, pos);
+			pushTemp(reg);
+		}
+		return true;
+	}
+}
@@ -179,6 +179,13 @@ namespace Pascal
 		ReportWarning(where, typeToString(type) + additionalMsg);
 	}
 
+	std::string ReportsManager::PosToString(size_t where)
+	{
+		ErrorPos pos = getErrorPos(where);
+		return currentFile.fileName + ":" + std::to_string(pos.lineNumber) + ":" +
+			std::to_string(pos.column);
+	}
+
 	ReportsManager::ErrorPos ReportsManager::getErrorPos(size_t where)
 	{
 		ErrorPos res;
@@ -253,8 +260,94 @@ namespace Pascal
 			return "wrong arguments count";
 		case ErrorType::CANT_PARSE_LITERAL:
 			return "can't parse literal";
+		case ErrorType::LITERAL_OUT_OF_RANGE:
+			return "literal out of range";
 		case ErrorType::DIVISION_BY_ZERO:
 			return "division by zero";
+		case ErrorType::INTEGER_OVERFLOW:
+			return "integer overflow";
+		case ErrorType::ILLEGAL_OPERANDS:
+			return "illegal operand types";
+		case ErrorType::STACK_OVERFLOW:
+			return "stack overflow";
+		case ErrorType::ILLEGAL_CONTROL_VARIABLE:
+			return "control variable must be a local integer variable";
+		case ErrorType::CONTROL_VARIABLE_ASSIGNMENT:
+			return "assignment to the control variable of a for loop";
+		case ErrorType::ILLEGAL_CASE_LABEL:
+			return "case label must be an integer constant";
+		case ErrorType::DUPLICATE_CASE_LABEL:
+			return "duplicate case label";
+		case ErrorType::ILLEGAL_ARRAY_BOUNDS:
+			return "array bounds must be integer constants, the lower one not above the upper one";
+		case ErrorType::INDEXING_NON_ARRAY:
+			return "indexing something that is not an array";
+		case ErrorType::ARRAY_WITHOUT_INDEX:
+			return "arrays may only be used element by element";
+		case ErrorType::INDEX_OUT_OF_RANGE:
+			return "index out of range";
+		case ErrorType::UNTERMINATED_STRING:
+			return "string literal is missing its closing quote";
+		case ErrorType::STRING_ELEMENT_ASSIGNMENT:
+			return "characters of a string can't be assigned one by one";
+		case ErrorType::ILLEGAL_SET_BOUNDS:
+			return "set bounds must be integer constants within 0..255, the lower one not above the upper one";
+		case ErrorType::ILLEGAL_SET_ELEMENT:
+			return "set elements must be integers within 0..255 or characters";
+		case ErrorType::ILLEGAL_TYPE_DECLARATION:
+			return "only record, array and pointer types can be declared";
+		case ErrorType::ILLEGAL_FIELD_TYPE:
+			return "record fields can't be arrays";
+		case ErrorType::ILLEGAL_PARAMETER_TYPE:
+			return "records and arrays can only be passed as var or const parameters";
+		case ErrorType::FIELD_OF_NON_RECORD:
+			return "selecting a field of something that is not a record";
+		case ErrorType::UNKNOWN_FIELD:
+			return "the record has no such field";
+		case ErrorType::RECORD_WITHOUT_FIELD:
+			return "records may only be used field by field or assigned whole";
+		case ErrorType::INCOMPATIBLE_RECORDS:
+			return "only records of the same type can be assigned to each other";
+		case ErrorType::ILLEGAL_ELEMENT_TYPE:
+			return "array elements can't be arrays";
+		case ErrorType::NOT_A_VARIABLE_ARGUMENT:
+			return "the argument of a var parameter must be a variable, an element or a field";
+		case ErrorType::INCOMPATIBLE_ARGUMENT:
+			return "the argument must be of the very type of the var or const parameter";
+		case ErrorType::INCOMPATIBLE_ASSIGNMENT:
+			return "the value can't be assigned to a variable of this type";
+		case ErrorType::INCOMPATIBLE_VALUE_ARGUMENT:
+			return "the argument can't be passed to a value parameter of this type";
+		case ErrorType::CONST_PARAMETER_ASSIGNMENT:
+			return "const parameters can't be assigned";
+		case ErrorType::ILLEGAL_RESULT_TYPE:
+			return "functions can't return records or arrays";
+		case ErrorType::ILLEGAL_POINTER_TYPE:
+			return "pointers can't point to arrays";
+		case ErrorType::DEREFERENCING_NON_POINTER:
+			return "dereferencing something that is not a pointer";
+		case ErrorType::NOT_A_POINTER_ARGUMENT:
+			return "new and dispose take a pointer variable, element or field";
+		case ErrorType::NIL_DEREFERENCE:
+			return "dereferencing nil";
+		case ErrorType::DISPOSED_TWICE:
+			return "the object was already disposed of";
+		case ErrorType::NOT_A_READABLE_ARGUMENT:
+			return "read and readln take integer, real, bigint or string variables, elements or fields";
+		case ErrorType::READ_PAST_END:
+			return "reading past the end of the input";
+		case ErrorType::INVALID_INPUT:
+			return "the input is not a value of the variable's type";
+		case ErrorType::NOT_A_TEXT_ARGUMENT:
+			return "assign, reset, rewrite, close and eof take a text variable, element or field";
+		case ErrorType::UNASSIGNED_FILE:
+			return "the file was not assigned a name";
+		case ErrorType::CANT_OPEN_FILE:
+			return "can't open the file";
+		case ErrorType::FILE_NOT_OPEN_FOR_READING:
+			return "the file is not open for reading";
+		case ErrorType::FILE_NOT_OPEN_FOR_WRITING:
+			return "the file is not open for writing";
 		case ErrorType::NONE:
 			return "NONE ERROR";
 		}
@@ -3,22 +3,125 @@
 #include <pscpch.hpp>
 #include <SemanticAnalyzer.hpp>
 #include <ReportsManager.hpp>
+#include <Value.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <set>
 
 namespace Pascal
 {
-	SemanticAnalyzer::SemanticAnalyzer()
+	// Array bounds and the constants index expressions are followed
+	// through stay this small, so no sum of them overflows.
+	static const long INDEX_LIMIT = 1L << 30;
+	static const long ARRAY_MAX_LENGTH = 1L << 24;
+
+	// False for literals with other than digits or out of range for 'long'.
+	static bool integerValue(AST::IntegerLiteral const& literal, long& value)
+	{
+		if (literal.literal.type != TokenType::NUMBER_LITERAL ||
+			literal.literal.str.find_first_not_of("0123456789") != std::string::npos)
+			return false;
+
+		try
+		{
+			value = literal.getValue();
+		}
+		catch (std::exception const&)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	// array[<low>..<high>] whose elements take 'stride' slots each. Element
+	// offsets stay within INDEX_LIMIT, see Compiler::emitElement.
+	static bool arrayBounds(AST::TypeNode const& type, unsigned stride, long& low, long& high)
+	{
+		return integerValue(type.getLow(), low) && integerValue(type.getHigh(), high) &&
+			low >= -INDEX_LIMIT && high <= INDEX_LIMIT && low <= high &&
+			(high - low + 1) * stride <= ARRAY_MAX_LENGTH && std::abs(low) * stride <= INDEX_LIMIT;
+	}
+
+	// set of <low>..<high> within 0..255, or set of char.
+	static bool setBounds(AST::TypeNode const& type, long& low, long& high)
+	{
+		if (type.getToken().type != TokenType::NONE)
+		{
+			low = 0;
+			high = SetBits::MAX_ELEMENT;
+			return type.getToken().str == "char";
+		}
+		return integerValue(type.getLow(), low) && integerValue(type.getHigh(), high) &&
+			low >= 0 && high <= SetBits::MAX_ELEMENT && low <= high;
+	}
+
+	// The type of the values variables of 'type' hold, NONE for arrays,
+	// records and undefined types.
+	static ValueType valueType(std::shared_ptr<const Symbol> const& type)
+	{
+		if (type == nullptr)
+			return ValueType::NONE;
+		if (type->getType() == SymbolType::SET_TYPE)
+			return ValueType::SET;
+		if (type->getType() == SymbolType::POINTER_TYPE)
+			return ValueType::POINTER;
+		if (type->getType() != SymbolType::BUILTIN_TYPE)
+			return ValueType::NONE;
+
+		std::string const& name = type->getName();
+		if (name == "real")
+			return ValueType::REAL;
+		if (name == "boolean")
+			return ValueType::BOOLEAN;
+		if (name == "string")
+			return ValueType::STRING;
+		if (name == "bigint")
+			return ValueType::BIGINT;
+		if (name == "text")
+			return ValueType::TEXT;
+		return ValueType::INTEGER;
+	}
+
+	static bool isNumeric(ValueType type)
+	{
+		return type == ValueType::INTEGER || type == ValueType::REAL || type == ValueType::BIGINT;
+	}
+
+	// Integers and bigints are widened into reals and integers into bigints
+	// the way assign() widens them, other values only go into variables of
+	// their own type. Arguments are widened by TO_REAL, which leaves
+	// bigints alone.
+	static bool assignable(ValueType target, ValueType source, bool argument)
+	{
+		if (target == ValueType::NONE || source == ValueType::NONE || target == source)
+			return true;
+		if (target == ValueType::REAL)
+			return source == ValueType::INTEGER || (source == ValueType::BIGINT && !argument);
+		return target == ValueType::BIGINT && source == ValueType::INTEGER;
+	}
+
+	SemanticAnalyzer::SemanticAnalyzer(bool dumpScopes)
+		: m_DumpScopes(dumpScopes)
 	{
 		m_CurrentScopeLevel = 1;
 		m_Symtab = std::make_shared<SymbolTable>("global", m_CurrentScopeLevel, nullptr);
 		m_Symtab->initBuiltins();
 	}
+
+	SemanticAnalyzer::~SemanticAnalyzer()
+	{
+		for (auto const& e : m_AllPointers)
+			e->setTarget(nullptr);
+	}
 	
 	void SemanticAnalyzer::visitProgramNode(AST::ProgramNode const& node)
 	{
 		node.getBlock().accept(this);
+		node.getBlock().setFrameSize(m_Symtab->getSlotCount());
 
 		for (auto const& sym_p : m_Symtab->getSymbols())
 		{
@@ -30,20 +133,40 @@ namespace Pascal
 		}
 	}
 	
+	// Every element of an array and every field of a record gets a slot of
+	// its own.
 	void SemanticAnalyzer::visitVarDeclNode(AST::VarDeclNode const& node)
 	{
-		node.getType().accept(this);
-		m_Symtab->define(std::make_shared<VariableSymbol>(
-							node.getVar().getToken().str,
-							m_Symtab->lookup(node.getType().getToken().str),
-							node.getVar().getToken().pos
-							));
+		AST::TypeNode const& type = node.getType();
+		type.accept(this);
+
+		std::shared_ptr<const Symbol> typeSym = resolveType(type);
+		unsigned slots = RecordTypeSymbol::slotsOf(typeSym);
+		if (typeSym != nullptr && typeSym->getType() == SymbolType::ARRAY_TYPE)
+		{
+			const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(typeSym.get());
+			slots = array->getLength() * array->getStride();
+		}
+
+		std::shared_ptr<VariableSymbol> varSym = std::make_shared<VariableSymbol>(
+			node.getVar().getToken().str,
+			typeSym,
+			node.getVar().getToken().pos
+			);
+		varSym->setLocation(m_CurrentScopeLevel, m_Symtab->allocateSlots(slots));
+		m_Symtab->define(varSym);
+		node.getVar().setSymbol(varSym);
 	}
 	
 	void SemanticAnalyzer::visitBlockNode(AST::BlockNode const& node)
 	{
+		for (auto const& e : node.getTypeDecls())
+			e->accept(this);
+		resolvePointers();
+
 		for (auto const& e : node.getVarDecls())
 			e->accept(this);
+		resolvePointers();
 
 		for (auto const& e : node.getProcDecls())
 			e->accept(this);
@@ -51,10 +174,82 @@ namespace Pascal
 		node.getCompound().accept(this);
 	}
 	
+	// The type a pointer points to is checked by resolvePointers.
 	void SemanticAnalyzer::visitTypeNode(AST::TypeNode const& node)
 	{
-		if (m_Symtab->lookup(node.getToken().str) == nullptr)
+		if (node.isPointer())
+			return;
+
+		if (node.isSet())
+		{
+			long low = 0;
+			long high = 0;
+			if (!setBounds(node, low, high))
+			{
+				if (node.getToken().type != TokenType::NONE)
+					ReportsManager::ReportError(node.getToken().pos, ErrorType::NAME_UNDEFINED, true);
+				else
+					ReportsManager::ReportError(node.getKeyword().pos, ErrorType::ILLEGAL_SET_BOUNDS);
+			}
+			return;
+		}
+
+		// The copies of a record type are checked once.
+		if (node.isRecord())
+		{
+			if (m_Records.count(node.getFields().get()) != 0)
+				return;
+
+			std::set<std::string> names;
+			for (auto const& field : *node.getFields())
+			{
+				field.type->accept(this);
+				if (field.type->isArray())
+					ReportsManager::ReportError(field.type->getKeyword().pos, ErrorType::ILLEGAL_FIELD_TYPE);
+				else if (namesArray(*field.type))
+					ReportsManager::ReportError(field.type->getToken().pos, ErrorType::ILLEGAL_FIELD_TYPE);
+				for (auto const& name : field.names)
+				{
+					if (!names.insert(name.str).second)
+						ReportsManager::ReportError(name.pos, ErrorType::NAME_REDEFINITION);
+				}
+			}
+			return;
+		}
+
+		std::shared_ptr<const Symbol> element = m_Symtab->lookup(node.getToken().str);
+		if (element == nullptr)
 		    ReportsManager::ReportError(node.getToken().pos, ErrorType::NAME_UNDEFINED, true);
+
+		if (node.isArray())
+		{
+			long low = 0;
+			long high = 0;
+			if (!arrayBounds(node, RecordTypeSymbol::slotsOf(element), low, high))
+				ReportsManager::ReportError(node.getKeyword().pos, ErrorType::ILLEGAL_ARRAY_BOUNDS);
+			if (element != nullptr && element->getType() == SymbolType::ARRAY_TYPE)
+				ReportsManager::ReportError(node.getToken().pos, ErrorType::ILLEGAL_ELEMENT_TYPE);
+		}
+	}
+
+	// Records, arrays and pointers can be declared, the type is named
+	// after the declaration.
+	void SemanticAnalyzer::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{
+		AST::TypeNode const& type = node.getType();
+		if (!type.isRecord() && !type.isArray() && !type.isPointer())
+		{
+			ReportsManager::ReportError(node.getName().pos, ErrorType::ILLEGAL_TYPE_DECLARATION);
+			return;
+		}
+
+		type.accept(this);
+		if (type.isRecord())
+			m_Symtab->define(recordType(type, node.getName().str, node.getName().pos));
+		else if (type.isPointer())
+			m_Symtab->define(pointerType(type, node.getName().str));
+		else
+			m_Symtab->define(arrayType(type, node.getName().str));
 	}
 	
 	void SemanticAnalyzer::visitStatementNode(AST::StatementNode const& node)
@@ -67,34 +262,86 @@ namespace Pascal
 		for (auto const& e : node.getStatements())
 			e->accept(this);
 	}
+	// Records are assigned whole only from records of the same type, other
+	// values only to variables they are assignable to. Assigning the name
+	// of a function being run sets its result. Assigning through a pointer
+	// reads the pointer.
 	void SemanticAnalyzer::visitAssignmentNode(AST::AssignmentNode const& node)
 	{
-		node.getExpr().accept(this);
+		m_BigContext = assignsBigint(node);
+		std::shared_ptr<const Symbol> source = designate(node.getExpr());
+		m_BigContext = false;
+		ValueType sourceType = m_ExprType;
+		std::shared_ptr<const Symbol> found = m_Symtab->lookup(node.getVar().getToken().str);
 
-		if (m_Symtab->lookup(node.getVar().getToken().str) == nullptr)
+		if (found == nullptr)
 		{
 			ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::NAME_UNDEFINED);
 		}
+		else if (found->getType() == SymbolType::PROCEDURE && node.getField() == nullptr &&
+				 node.getElement() == nullptr &&
+				 std::find(m_Procedures.begin(), m_Procedures.end(), found.get()) != m_Procedures.end() &&
+				 reinterpret_cast<const ProcedureSymbol*>(found.get())->isFunction())
+		{
+			node.getVar().setSymbol(reinterpret_cast<const ProcedureSymbol*>(found.get())->getResult());
+			if (source != nullptr)
+				ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::RECORD_WITHOUT_FIELD);
+			else if (!assignable(valueType(node.getVar().getSymbol()->getParent()), sourceType, false))
+				ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::INCOMPATIBLE_ASSIGNMENT);
+		}
 		else
 		{
 			std::shared_ptr<Symbol> sym = m_Symtab->change(node.getVar().getToken().str);
 			
+			bool dereference = node.getField() != nullptr && node.getField()->isDereference();
 			if (sym->getType() != SymbolType::VARIABLE)
 			{
 				ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::ILLEGAL_ASSIGNMENT);
 				ReportsManager::ReportNote(sym->getPos(), "the declaration is here");
 			}
-			else
+			else if (!dereference)
 			{
+				if (reinterpret_cast<VariableSymbol*>(sym.get())->getMode() == ParamMode::CONST)
+					ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::CONST_PARAMETER_ASSIGNMENT);
 				reinterpret_cast<VariableSymbol*>(sym.get())->undirty();
+				if (!m_Symtab->isBelongThisScope(sym))
+					reinterpret_cast<VariableSymbol*>(sym.get())->beAssignedByNested();
 			}
+
+			if (!dereference && findLoop(sym.get()) != nullptr)
+				ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::CONTROL_VARIABLE_ASSIGNMENT);
 		
-			node.getVar().accept(this);
+			std::shared_ptr<const Symbol> target;
+			if (node.getField() != nullptr)
+			{
+				target = designate(*node.getField());
+			}
+			else if (node.getElement() != nullptr)
+			{
+				target = designate(*node.getElement());
+				if (isString(node.getVar().getSymbol().get()))
+					ReportsManager::ReportError(node.getElement()->getBracket().pos, ErrorType::STRING_ELEMENT_ASSIGNMENT);
+			}
+			else
+			{
+				target = designate(node.getVar());
+			}
+
+			if (target != source)
+				ReportsManager::ReportError(node.getVar().getToken().pos, (target == nullptr) ?
+											ErrorType::RECORD_WITHOUT_FIELD : ErrorType::INCOMPATIBLE_RECORDS);
+			else if (target != nullptr)
+				node.setRecord(target);
+			else if (!assignable(m_ExprType, sourceType, false))
+				ReportsManager::ReportError(node.getVar().getToken().pos, ErrorType::INCOMPATIBLE_ASSIGNMENT);
 		}
 	}
 	
 	void SemanticAnalyzer::visitVariableNode(AST::VariableNode const& node)
 	{
+		m_Affine.known = false;
+		m_ExprType = ValueType::NONE;
+
 		if (m_Symtab->lookup(node.getToken().str) == nullptr)
 		{
 			ReportsManager::ReportError(node.getToken().pos, ErrorType::NAME_UNDEFINED, true);
@@ -105,12 +352,47 @@ namespace Pascal
 			#define VAR_SYM reinterpret_cast<VariableSymbol*>(sym.get())
 			
 			std::shared_ptr<Symbol> sym = m_Symtab->change(node.getToken().str);
+
+			// A function's name alone calls it without arguments.
+			bool function = (sym->getType() == SymbolType::PROCEDURE &&
+							 reinterpret_cast<const ProcedureSymbol*>(sym.get())->isFunction()) ||
+				(sym->getType() == SymbolType::BUILTIN_ROUTINE &&
+				 reinterpret_cast<const BuiltinRoutineSymbol*>(sym.get())->isFunction());
+			if (function)
+			{
+				node.setCall(std::make_shared<AST::ProcCallNode>(
+					node.getToken(), std::vector<std::unique_ptr<AST::Node>>(), true));
+				node.getCall()->accept(this);
+				return;
+			}
+			if (sym->getType() != SymbolType::VARIABLE)
+			{
+				ReportsManager::ReportError(node.getToken().pos,
+											(sym->getType() == SymbolType::PROCEDURE) ?
+											ErrorType::PROCEDURE_AS_FUNCTION : ErrorType::NAME_UNDEFINED);
+				return;
+			}
 			
-			if (m_Symtab->isBelongThisScope(sym) && VAR_SYM->getDirty())
+			// Array elements and record fields start as zeros.
+			bool record = VAR_SYM->getParent() != nullptr &&
+				VAR_SYM->getParent()->getType() == SymbolType::RECORD_TYPE;
+			if (m_Symtab->isBelongThisScope(sym) && VAR_SYM->getDirty() && &node != m_IndexedVar && !record &&
+				&node != m_ReferenceArgument)
 				ReportsManager::ReportWarning(node.getToken().pos, WarningType::UNINTIALIZED_VAR);	
 			
 			VAR_SYM->beUsed();
 
+			node.setSymbol(std::static_pointer_cast<const VariableSymbol>(sym));
+			m_Affine = { true, VAR_SYM, 0 };
+			m_Designator = { &node, sym, VAR_SYM->getParent() };
+			m_ExprType = valueType(VAR_SYM->getParent());
+
+			if (&node != m_IndexedVar && &node != m_ReferenceArgument && VAR_SYM->getParent() != nullptr &&
+				VAR_SYM->getParent()->getType() == SymbolType::ARRAY_TYPE)
+				ReportsManager::ReportError(node.getToken().pos, ErrorType::ARRAY_WITHOUT_INDEX);
+			if (record)
+				wholeRecord(node, VAR_SYM->getParent(), node.getToken().pos);
+
 			#undef VAR_SYM
 		}
 	}
@@ -122,65 +404,153 @@ namespace Pascal
 	
 	void SemanticAnalyzer::visitNumberNode(AST::NumberNode const& node)
 	{
-		try
-		{
-		    std::stoi(node.getToken().str);
-		}
-		catch (...)
+		long value = 0;
+		bool integer = integerValue({ node.getToken(), false }, value);
+		m_Affine.known = integer && value <= INDEX_LIMIT;
+		m_Affine.var = nullptr;
+		m_Affine.offset = value;
+
+		std::string const& str = node.getToken().str;
+		if (str.find_first_not_of("0123456789") == std::string::npos)
 		{
-			try
+			m_ExprType = ValueType::INTEGER;
+			if (integer)
+				return;
+			if (m_BigContext)
 			{
-			    std::stof(node.getToken().str);
+				node.setBig();
+				m_ExprType = ValueType::BIGINT;
 			}
-			catch (...)
+			else
 			{
-				ReportsManager::ReportError(node.getToken().pos, ErrorType::CANT_PARSE_LITERAL);
+				ReportsManager::ReportError(node.getToken().pos, ErrorType::LITERAL_OUT_OF_RANGE);
+				m_ExprType = ValueType::NONE;
 			}
+			return;
+		}
+		m_ExprType = ValueType::REAL;
+
+		// Digits, an optional fraction and an optional signed exponent.
+		// Reals too small for a double are rounded to zero.
+		char* end = nullptr;
+		errno = 0;
+		double real = std::strtod(str.c_str(), &end);
+		if (!isdigit(str.back()) || str.find_first_not_of("0123456789.e+-") != std::string::npos ||
+			end != str.c_str() + str.size())
+		{
+			ReportsManager::ReportError(node.getToken().pos, ErrorType::CANT_PARSE_LITERAL);
+			m_ExprType = ValueType::NONE;
+		}
+		else if (errno == ERANGE && std::isinf(real))
+		{
+			ReportsManager::ReportError(node.getToken().pos, ErrorType::LITERAL_OUT_OF_RANGE);
+			m_ExprType = ValueType::NONE;
 		}
 	}
 	
+	// Sums and differences of a variable and constants are followed, see
+	// visitIndexNode. Operands of mismatched types are left to the
+	// interpreter, they make the result NONE.
 	void SemanticAnalyzer::visitBinOpNode(AST::BinOpNode const& node)
 	{
 		node.getLeft().accept(this);
+		Affine left = m_Affine;
+		ValueType leftType = m_ExprType;
 		node.getRight().accept(this);
+		Affine right = m_Affine;
+		ValueType rightType = m_ExprType;
+
+		TokenType type = node.getOperation().type;
+		if (type == TokenType::EQUAL || type == TokenType::NOT_EQUAL || type == TokenType::LESS ||
+			type == TokenType::LESS_EQUAL || type == TokenType::GREATER || type == TokenType::GREATER_EQUAL ||
+			type == TokenType::IN || type == TokenType::AND || type == TokenType::OR)
+			m_ExprType = ValueType::BOOLEAN;
+		else if (leftType == rightType)
+			m_ExprType = leftType;
+		else if (isNumeric(leftType) && isNumeric(rightType))
+			m_ExprType = (leftType == ValueType::REAL || rightType == ValueType::REAL) ?
+				ValueType::REAL : ValueType::BIGINT;
+		else
+			m_ExprType = ValueType::NONE;
+
+		m_Affine.known = false;
+		if (!left.known || !right.known || (left.var != nullptr && right.var != nullptr))
+			return;
+
+		if (type == TokenType::PLUS)
+			m_Affine = { true, (left.var != nullptr) ? left.var : right.var, left.offset + right.offset };
+		else if (type == TokenType::MINUS && right.var == nullptr)
+			m_Affine = { true, left.var, left.offset - right.offset };
+
+		if (m_Affine.offset < -INDEX_LIMIT || m_Affine.offset > INDEX_LIMIT)
+			m_Affine.known = false;
 	}
 	
 	void SemanticAnalyzer::visitUnaryOpNode(AST::UnaryOpNode const& node)
 	{
 		node.getExpr().accept(this);
+		if (node.getOperation().type == TokenType::NOT)
+			m_ExprType = ValueType::BOOLEAN;
+
+		if (node.getOperation().type == TokenType::NOT ||
+			(node.getOperation().type == TokenType::MINUS && m_Affine.var != nullptr))
+			m_Affine.known = false;
+		else if (node.getOperation().type == TokenType::MINUS)
+			m_Affine.offset = -m_Affine.offset;
 	}
 
+	// The parameters are defined in the procedure's scope first, the
+	// procedure is defined with their symbols.
 	void SemanticAnalyzer::visitProcDeclNode(const AST::ProcDeclNode &node)
 	{
-	    std::vector<VariableSymbol> procSymParams;
-		
-		for (auto const& e : node.getParams())
-		{
-			procSymParams.push_back(VariableSymbol(
-										e->getVar().getToken().str,
-										m_Symtab->lookup(e->getType().getToken().str), // ???
-										e->getVar().getToken().pos
-										));
-		}
-		
-		m_Symtab->define(std::make_shared<ProcedureSymbol>(
-							 node.getProcName().str,
-							 node.getProcName().pos,
-							 procSymParams
-							 ));
-
 		std::shared_ptr<SymbolTable> oldScope = m_Symtab;
 		m_CurrentScopeLevel++;
 		m_Symtab = std::make_shared<SymbolTable>(node.getProcName().str, m_CurrentScopeLevel, oldScope);
 
+	    std::vector<std::shared_ptr<const VariableSymbol>> procSymParams;
 		for (auto const& e : node.getParams())
 		{
 			e->accept(this);
+			procSymParams.push_back(e->getVar().getSymbol());
+		}
+
+		// The result takes the slot after the parameters.
+		std::shared_ptr<VariableSymbol> result;
+		if (node.getResultType() != nullptr)
+		{
+			Token const& typeName = node.getResultType()->getToken();
+			std::shared_ptr<const Symbol> type = m_Symtab->lookup(typeName.str);
+			if (type == nullptr)
+			{
+				ReportsManager::ReportError(typeName.pos, ErrorType::NAME_UNDEFINED);
+			}
+			else if (type->getType() == SymbolType::RECORD_TYPE || type->getType() == SymbolType::ARRAY_TYPE)
+			{
+				ReportsManager::ReportError(typeName.pos, ErrorType::ILLEGAL_RESULT_TYPE);
+				type = nullptr;
+			}
+
+			result = std::make_shared<VariableSymbol>(node.getProcName().str, type, node.getProcName().pos);
+			result->setLocation(m_CurrentScopeLevel, m_Symtab->allocateSlot());
 		}
+		
+		std::shared_ptr<ProcedureSymbol> procSym = std::make_shared<ProcedureSymbol>(
+			node.getProcName().str,
+			node.getProcName().pos,
+			procSymParams,
+			m_CurrentScopeLevel,
+			result
+			);
+		oldScope->define(procSym);
+		node.setSymbol(procSym);
 							 
+		m_Procedures.push_back(procSym.get());
 		node.getBlock().accept(this);
+		m_Procedures.pop_back();
+		node.getBlock().setFrameSize(m_Symtab->getSlotCount());
 
-		std::cout << m_Symtab->toString() << std::endl;
+		if (m_DumpScopes)
+			std::cout << m_Symtab->toString() << std::endl;
 
 		for (auto const& sym_p : m_Symtab->getSymbols())
 		{
@@ -196,38 +566,646 @@ namespace Pascal
 		m_CurrentScopeLevel--;
 	}
 
+	// Records and arrays are only passed by reference, see
+	// VariableSymbol::isReference.
 	void SemanticAnalyzer::visitParamNode(const AST::ParamNode &node)
 	{
-		std::unique_ptr<VariableSymbol> varSym = std::make_unique<VariableSymbol>(
+		ParamMode mode = ParamMode::VALUE;
+		if (node.getMode().type == TokenType::VAR)
+			mode = ParamMode::VAR;
+		else if (node.getMode().type == TokenType::CONST)
+			mode = ParamMode::CONST;
+
+		std::shared_ptr<const Symbol> type = m_Symtab->lookup(node.getType().getToken().str);
+		if (type != nullptr && mode == ParamMode::VALUE &&
+			(type->getType() == SymbolType::RECORD_TYPE || type->getType() == SymbolType::ARRAY_TYPE))
+		{
+			ReportsManager::ReportError(node.getType().getToken().pos, ErrorType::ILLEGAL_PARAMETER_TYPE);
+			type = nullptr;
+		}
+
+		std::shared_ptr<VariableSymbol> varSym = std::make_shared<VariableSymbol>(
 			node.getVar().getToken().str,
-			m_Symtab->lookup(node.getType().getToken().str),
+			type,
 			node.getVar().getToken().pos
 			);
+		varSym->setMode(mode);
 		varSym->undirty();
+		varSym->setLocation(m_CurrentScopeLevel, m_Symtab->allocateSlot());
+		node.getVar().setSymbol(varSym);
 		m_Symtab->define(std::move(varSym));
 	}
 
 	void SemanticAnalyzer::visitProcCallNode(const AST::ProcCallNode& node)
 	{
 		std::shared_ptr<const Symbol> sym = m_Symtab->lookup(node.getProcName().str);
+		const ProcedureSymbol* proc = nullptr;
+		if (sym != nullptr && sym->getType() == SymbolType::PROCEDURE &&
+			reinterpret_cast<const ProcedureSymbol*>(sym.get())->getArgs().size() == node.getArguments().size())
+			proc = reinterpret_cast<const ProcedureSymbol*>(sym.get());
+
+		Builtin routine = Builtin::LENGTH;
+		if (sym != nullptr && sym->getType() == SymbolType::BUILTIN_ROUTINE)
+			routine = reinterpret_cast<const BuiltinRoutineSymbol*>(sym.get())->getRoutine();
+
+		bool bigContext = m_BigContext;
+		for (unsigned i = 0; i < node.getArguments().size(); i++)
+		{
+			m_BigContext = proc != nullptr && !proc->getArgs()[i]->isReference() &&
+				proc->getArgs()[i]->getParent() != nullptr && proc->getArgs()[i]->getParent()->getName() == "bigint";
+			if (proc != nullptr && proc->getArgs()[i]->isReference())
+				referenceArgument(*node.getArguments()[i], *proc->getArgs()[i], node.getProcName().pos);
+			else if ((routine == Builtin::NEW || routine == Builtin::DISPOSE) && node.getArguments().size() == 1)
+				pointerArgument(node, routine == Builtin::NEW);
+			else if (routine == Builtin::READ || routine == Builtin::READLN)
+				readArgument(node, i);
+			else if ((routine == Builtin::WRITE || routine == Builtin::WRITELN) && i == 0)
+				writeArgument(node);
+			else if ((routine == Builtin::ASSIGN || routine == Builtin::RESET || routine == Builtin::REWRITE ||
+					  routine == Builtin::CLOSE || routine == Builtin::END_OF_FILE) && i == 0)
+				textArgument(node, routine == Builtin::ASSIGN);
+			else
+				node.getArguments()[i]->accept(this);
+
+			if (proc != nullptr && !proc->getArgs()[i]->isReference() &&
+				!assignable(valueType(proc->getArgs()[i]->getParent()), m_ExprType, true))
+				ReportsManager::ReportError(node.getProcName().pos, ErrorType::INCOMPATIBLE_VALUE_ARGUMENT);
+		}
+		m_BigContext = bigContext;
+		
+		m_Affine.known = false;
+		m_ExprType = ValueType::NONE;
+		if (proc != nullptr && proc->isFunction())
+			m_ExprType = valueType(proc->getResult()->getParent());
+		else if (routine == Builtin::LENGTH && sym != nullptr && sym->getType() == SymbolType::BUILTIN_ROUTINE)
+			m_ExprType = ValueType::INTEGER;
+		else if (routine == Builtin::END_OF_FILE)
+			m_ExprType = ValueType::BOOLEAN;
+
 		if (sym == nullptr)
 		{
 			ReportsManager::ReportError(node.getProcName().pos, ErrorType::CALLING_NON_PROCEDURE);
 		}
+		else if (sym->getType() == SymbolType::BUILTIN_ROUTINE)
+		{
+			const BuiltinRoutineSymbol* routine = reinterpret_cast<const BuiltinRoutineSymbol*>(sym.get());
+			if (routine->isFunction() != node.isFunctionCall())
+				ReportsManager::ReportError(node.getProcName().pos, routine->isFunction() ?
+											ErrorType::ILLEGAL_STATEMENT : ErrorType::PROCEDURE_AS_FUNCTION);
+			else if ((routine->getArgsCount() != BuiltinRoutineSymbol::ANY_ARGS &&
+					  routine->getArgsCount() != node.getArguments().size()) ||
+					 (routine->getRoutine() == Builtin::END_OF_FILE && node.getArguments().size() > 1))
+				ReportsManager::ReportError(node.getProcName().pos, ErrorType::WRONG_ARGUMENTS_COUNT);
+			else
+				node.setBuiltin(std::static_pointer_cast<const BuiltinRoutineSymbol>(sym));
+		}
+		else if (sym->getType() != SymbolType::PROCEDURE)
+		{
+			ReportsManager::ReportError(node.getProcName().pos, node.isFunctionCall() ?
+										ErrorType::CALLING_NON_FUNCTION : ErrorType::CALLING_NON_PROCEDURE);
+		}
 		else
 		{
-			if (sym->getType() != SymbolType::PROCEDURE)
+			const ProcedureSymbol* varSym = reinterpret_cast<const ProcedureSymbol*>(sym.get());
+			if (varSym->isFunction() != node.isFunctionCall())
 			{
-				ReportsManager::ReportError(node.getProcName().pos, ErrorType::CALLING_NON_PROCEDURE);
+				ReportsManager::ReportError(node.getProcName().pos, varSym->isFunction() ?
+											ErrorType::ILLEGAL_STATEMENT : ErrorType::PROCEDURE_AS_FUNCTION);
+			}
+			else if (varSym->getArgs().size() != node.getArguments().size())
+			{
+				ReportsManager::ReportError(node.getProcName().pos, ErrorType::WRONG_ARGUMENTS_COUNT);
 			}
 			else
 			{
-				const ProcedureSymbol* varSym = reinterpret_cast<const ProcedureSymbol*>(sym.get());
-				if (varSym->getArgs().size() != node.getArguments().size())
-				{
-					ReportsManager::ReportError(node.getProcName().pos, ErrorType::WRONG_ARGUMENTS_COUNT);
-				}
+				node.setSymbol(std::static_pointer_cast<const ProcedureSymbol>(sym));
+			}
+		}
+	}
+
+	void SemanticAnalyzer::visitWhileNode(AST::WhileNode const& node)
+	{
+		node.getCondition().accept(this);
+		node.getBody().accept(this);
+	}
+
+	void SemanticAnalyzer::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		for (auto const& e : node.getStatements())
+			e->accept(this);
+		node.getCondition().accept(this);
+	}
+
+	// The Compiler keeps the control variable in a frame slot of the running
+	// procedure and counts it as an integer, so nothing else may change it.
+	// Only a nested procedure still could, see visitIndexNode.
+	void SemanticAnalyzer::visitForNode(AST::ForNode const& node)
+	{
+		node.getFrom().accept(this);
+		Affine from = m_Affine;
+		node.getTo().accept(this);
+		Affine to = m_Affine;
+
+		Token const& id = node.getVar().getToken();
+		if (m_Symtab->lookup(id.str) == nullptr)
+		{
+			ReportsManager::ReportError(id.pos, ErrorType::NAME_UNDEFINED);
+			return;
+		}
+
+		std::shared_ptr<Symbol> sym = m_Symtab->change(id.str);
+		if (sym->getType() != SymbolType::VARIABLE || !m_Symtab->isBelongThisScope(sym) ||
+			reinterpret_cast<VariableSymbol*>(sym.get())->getMode() != ParamMode::VALUE ||
+			reinterpret_cast<VariableSymbol*>(sym.get())->getParent() == nullptr ||
+			reinterpret_cast<VariableSymbol*>(sym.get())->getParent()->getName() != "integer")
+		{
+			ReportsManager::ReportError(id.pos, ErrorType::ILLEGAL_CONTROL_VARIABLE);
+			return;
+		}
+		if (findLoop(sym.get()) != nullptr)
+			ReportsManager::ReportError(id.pos, ErrorType::CONTROL_VARIABLE_ASSIGNMENT);
+
+		reinterpret_cast<VariableSymbol*>(sym.get())->undirty();
+		node.getVar().accept(this);
+
+		bool constant = from.known && from.var == nullptr && to.known && to.var == nullptr;
+		m_Loops.push_back({ &node, sym.get(), constant,
+				node.isDownto() ? to.offset : from.offset,
+				node.isDownto() ? from.offset : to.offset, false, 0, 0 });
+		node.getBody().accept(this);
+		Loop loop = m_Loops.back();
+		m_Loops.pop_back();
+
+		// With constant limits the range is checked here, an empty one
+		// keeps every index in bounds.
+		if (!loop.indexed || loop.low > loop.high)
+			return;
+		if (!loop.constant)
+			node.setIndexing(AST::ForNode::Indexing::GUARDED, loop.low, loop.high);
+		else if (loop.first > loop.last || (loop.first >= loop.low && loop.last <= loop.high))
+			node.setIndexing(AST::ForNode::Indexing::PROVEN, loop.low, loop.high);
+	}
+
+	void SemanticAnalyzer::visitIfNode(AST::IfNode const& node)
+	{
+		node.getCondition().accept(this);
+		node.getThen().accept(this);
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+	}
+
+	void SemanticAnalyzer::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		m_Affine.known = false;
+		m_ExprType = ValueType::BOOLEAN;
+	}
+
+	void SemanticAnalyzer::visitStringNode(AST::StringNode const& node)
+	{
+		m_Affine.known = false;
+		m_ExprType = ValueType::STRING;
+	}
+
+	void SemanticAnalyzer::visitNilNode(AST::NilNode const& node)
+	{
+		m_Affine.known = false;
+		m_ExprType = ValueType::POINTER;
+	}
+
+	// Literal elements are checked here, the others when the set is built.
+	void SemanticAnalyzer::visitSetNode(AST::SetNode const& node)
+	{
+		for (auto const& e : node.getElements())
+		{
+			Token_t const* literals[] = { &e.lowLiteral, &e.highLiteral };
+			for (Token_t const* literal : literals)
+			{
+				long value = 0;
+				if (literal->type != TokenType::NONE &&
+					(!AST::SetNode::literalValue(*literal, value) || value > SetBits::MAX_ELEMENT))
+					ReportsManager::ReportError(literal->pos, ErrorType::ILLEGAL_SET_ELEMENT);
+			}
+
+			e.low->accept(this);
+			if (e.high != nullptr)
+				e.high->accept(this);
+		}
+		m_Affine.known = false;
+		m_ExprType = ValueType::SET;
+	}
+
+	// Labels are integer literals, each used once. One the parser couldn't
+	// read was reported there, it has no position to report it again at.
+	void SemanticAnalyzer::visitCaseNode(AST::CaseNode const& node)
+	{
+		node.getSelector().accept(this);
+
+		std::set<long> seen;
+		for (auto const& branch : node.getBranches())
+		{
+			for (auto const& label : branch.labels)
+			{
+				long value = 0;
+				if (label.literal.type == TokenType::NONE)
+					continue;
+				if (!integerValue(label, value))
+					ReportsManager::ReportError(label.literal.pos, ErrorType::ILLEGAL_CASE_LABEL);
+				else if (!seen.insert(value).second)
+					ReportsManager::ReportError(label.literal.pos, ErrorType::DUPLICATE_CASE_LABEL);
+			}
+			branch.statement->accept(this);
+		}
+
+		if (node.getElse() != nullptr)
+			node.getElse()->accept(this);
+	}
+
+	// Constant indices are checked here. The index of a[i + k], where i is
+	// the control variable of an enclosing for loop, stays in bounds as long
+	// as the loop's range does. No nested
+	// procedure may assign i, one could be called from the body. Characters
+	// of a string are checked when they are read.
+	void SemanticAnalyzer::visitIndexNode(AST::IndexNode const& node)
+	{
+		bool bigContext = m_BigContext;
+		m_BigContext = false;
+		node.getIndex().accept(this);
+		m_BigContext = bigContext;
+		Affine index = m_Affine;
+
+		m_IndexedVar = &node.getVar();
+		node.getVar().accept(this);
+		m_IndexedVar = nullptr;
+		m_Affine.known = false;
+
+		std::shared_ptr<const VariableSymbol> const& sym = node.getVar().getSymbol();
+		m_ExprType = isString(sym.get()) ? ValueType::STRING : ValueType::NONE;
+		if (sym == nullptr || isString(sym.get()))
+			return;
+		if (sym->getParent() == nullptr || sym->getParent()->getType() != SymbolType::ARRAY_TYPE)
+		{
+			ReportsManager::ReportError(node.getBracket().pos, ErrorType::INDEXING_NON_ARRAY);
+			return;
+		}
+
+		const ArrayTypeSymbol* array = reinterpret_cast<const ArrayTypeSymbol*>(sym->getParent().get());
+		m_Designator.node = &node;
+		m_Designator.type = array->getElement();
+		m_ExprType = valueType(array->getElement());
+		if (array->getElement() != nullptr && array->getElement()->getType() == SymbolType::RECORD_TYPE)
+			wholeRecord(node, array->getElement(), node.getBracket().pos);
+
+		if (index.known && index.var == nullptr)
+		{
+			if (index.offset < array->getLow() || index.offset > array->getHigh())
+				ReportsManager::ReportError(node.getBracket().pos, ErrorType::INDEX_OUT_OF_RANGE);
+			else
+				node.setInBounds(true);
+			return;
+		}
+
+		if (!index.known || index.var == nullptr || index.var->getAssignedByNested())
+			return;
+		Loop* loop = findLoop(index.var);
+		if (loop == nullptr)
+			return;
+
+		long low = array->getLow() - index.offset;
+		long high = array->getHigh() - index.offset;
+		loop->low = loop->indexed ? std::max(loop->low, low) : low;
+		loop->high = loop->indexed ? std::min(loop->high, high) : high;
+		loop->indexed = true;
+		node.setLoop(loop->node);
+	}
+
+	// The offsets of the fields selected add up to the slot of the last one,
+	// in the object pointed to after a caret.
+	void SemanticAnalyzer::visitFieldNode(AST::FieldNode const& node)
+	{
+		AST::Node const* selected = node.getElement();
+		if (selected == nullptr)
+			selected = &node.getVar();
+		m_Designator.node = nullptr;
+		std::shared_ptr<const Symbol> type = designate(*selected);
+		m_Affine.known = false;
+		m_ExprType = ValueType::NONE;
+
+		if (node.getVar().getSymbol() == nullptr)
+			return;
+
+		if (node.isDereference())
+		{
+			if (m_Designator.node != selected || m_Designator.type == nullptr ||
+				m_Designator.type->getType() != SymbolType::POINTER_TYPE)
+			{
+				ReportsManager::ReportError(node.getCaret().pos, ErrorType::DEREFERENCING_NON_POINTER);
+				return;
+			}
+			type = reinterpret_cast<const PointerTypeSymbol*>(m_Designator.type.get())->getTarget();
+		}
+
+		unsigned offset = 0;
+		for (auto const& field : node.getFields())
+		{
+			if (type == nullptr || type->getType() != SymbolType::RECORD_TYPE)
+			{
+				ReportsManager::ReportError(field.pos, ErrorType::FIELD_OF_NON_RECORD);
+				return;
+			}
+
+			const RecordTypeSymbol::Field* found = reinterpret_cast<const RecordTypeSymbol*>(type.get())->find(field.str);
+			if (found == nullptr)
+			{
+				ReportsManager::ReportError(field.pos, ErrorType::UNKNOWN_FIELD);
+				return;
+			}
+			offset += found->offset;
+			type = found->type;
+		}
+		node.setField(type, offset);
+		m_Designator.node = &node;
+		m_Designator.type = type;
+		m_Designator.dereferenced = node.isDereference();
+		m_ExprType = valueType(type);
+
+		if (type != nullptr && type->getType() == SymbolType::RECORD_TYPE)
+			wholeRecord(node, type, node.getPos());
+	}
+
+	std::shared_ptr<const Symbol> SemanticAnalyzer::resolveType(AST::TypeNode const& type)
+	{
+		if (type.isRecord())
+			return recordType(type, "record", type.getKeyword().pos);
+
+		if (type.isSet())
+		{
+			long low = 0;
+			long high = 0;
+			if (!setBounds(type, low, high))
+				low = high = 0;
+			return std::make_shared<SetTypeSymbol>(type.getToken().type != TokenType::NONE, low, high,
+												   type.getKeyword().pos);
+		}
+
+		if (type.isArray())
+			return arrayType(type, "");
+		if (type.isPointer())
+			return pointerType(type, "");
+		return m_Symtab->lookup(type.getToken().str);
+	}
+
+	std::shared_ptr<PointerTypeSymbol> SemanticAnalyzer::pointerType(AST::TypeNode const& type, std::string const& name)
+	{
+		std::shared_ptr<PointerTypeSymbol> res = std::make_shared<PointerTypeSymbol>(
+			type.getToken().str, type.getToken().pos, name);
+		m_Pointers.push_back(res);
+		m_AllPointers.push_back(res);
+		return res;
+	}
+
+	// Pointers may point to records declared after them, to themselves
+	// through their fields, but not to arrays.
+	void SemanticAnalyzer::resolvePointers()
+	{
+		for (auto const& e : m_Pointers)
+		{
+			std::shared_ptr<const Symbol> target = m_Symtab->lookup(e->getTargetName());
+			if (target == nullptr)
+			{
+				ReportsManager::ReportError(e->getPos(), ErrorType::NAME_UNDEFINED, true);
+			}
+			else if (target->getType() == SymbolType::ARRAY_TYPE)
+			{
+				ReportsManager::ReportError(e->getPos(), ErrorType::ILLEGAL_POINTER_TYPE);
+				target = nullptr;
 			}
+			e->setTarget(target);
+		}
+		m_Pointers.clear();
+	}
+
+	// Array elements, reported by visitTypeNode, are left untyped.
+	std::shared_ptr<ArrayTypeSymbol> SemanticAnalyzer::arrayType(AST::TypeNode const& type, std::string const& name)
+	{
+		std::shared_ptr<const Symbol> element = m_Symtab->lookup(type.getToken().str);
+		if (element != nullptr && element->getType() == SymbolType::ARRAY_TYPE)
+			element = nullptr;
+
+		long low = 0;
+		long high = 0;
+		if (!arrayBounds(type, RecordTypeSymbol::slotsOf(element), low, high))
+			low = high = 0;
+		return std::make_shared<ArrayTypeSymbol>(element, low, high, type.getKeyword().pos, name);
+	}
+
+	bool SemanticAnalyzer::namesArray(AST::TypeNode const& type) const
+	{
+		if (type.isArray() || type.isRecord() || type.isSet() || type.isPointer())
+			return false;
+		std::shared_ptr<const Symbol> sym = m_Symtab->lookup(type.getToken().str);
+		return sym != nullptr && sym->getType() == SymbolType::ARRAY_TYPE;
+	}
+
+	// The copies of a TypeNode share their fields, they all get one type.
+	// Array fields, reported by visitTypeNode, are left untyped.
+	std::shared_ptr<RecordTypeSymbol> SemanticAnalyzer::recordType(AST::TypeNode const& type,
+																   std::string const& name, size_t pos)
+	{
+		auto found = m_Records.find(type.getFields().get());
+		if (found != m_Records.end())
+			return found->second;
+
+		std::vector<std::pair<std::string, std::shared_ptr<const Symbol>>> fields;
+		for (auto const& field : *type.getFields())
+		{
+			std::shared_ptr<const Symbol> fieldType = (field.type->isArray() || namesArray(*field.type)) ?
+				nullptr : resolveType(*field.type);
+			for (auto const& e : field.names)
+				fields.push_back({ e.str, fieldType });
+		}
+
+		std::shared_ptr<RecordTypeSymbol> res = std::make_shared<RecordTypeSymbol>(name, type.isPacked(), fields, pos);
+		m_Records[type.getFields().get()] = res;
+		return res;
+	}
+
+	// Visits a node that may name a whole record, returns the record's type
+	// if it does.
+	std::shared_ptr<const Symbol> SemanticAnalyzer::designate(AST::Node const& node)
+	{
+		AST::Node const* oldNode = m_WholeNode;
+		std::shared_ptr<const Symbol> oldRecord = m_WholeRecord;
+		m_WholeNode = &node;
+		m_WholeRecord = nullptr;
+
+		node.accept(this);
+		std::shared_ptr<const Symbol> res = m_WholeRecord;
+
+		m_WholeNode = oldNode;
+		m_WholeRecord = oldRecord;
+		return res;
+	}
+
+	// The argument of a var parameter, or of a const one passed by
+	// reference, names a variable, an element or a field of the very type
+	// of the parameter. Passing it to a var parameter assigns it.
+	void SemanticAnalyzer::referenceArgument(AST::Node const& arg, VariableSymbol const& param, size_t pos)
+	{
+		m_Designator.node = nullptr;
+		m_ReferenceArgument = &arg;
+		designate(arg);
+		m_ReferenceArgument = nullptr;
+		m_Affine.known = false;
+
+		if (m_Designator.node != &arg)
+		{
+			ReportsManager::ReportError(pos, ErrorType::NOT_A_VARIABLE_ARGUMENT);
+			return;
+		}
+		if (m_Designator.type != param.getParent())
+			ReportsManager::ReportError(pos, ErrorType::INCOMPATIBLE_ARGUMENT);
+		if (param.getMode() == ParamMode::VAR)
+			assignDesignated(pos);
+	}
+
+	// new assigns its argument, dispose only reads it.
+	void SemanticAnalyzer::pointerArgument(AST::ProcCallNode const& node, bool allocates)
+	{
+		AST::Node const& arg = *node.getArguments()[0];
+		m_Designator.node = nullptr;
+		if (allocates)
+			m_ReferenceArgument = &arg;
+		designate(arg);
+		m_ReferenceArgument = nullptr;
+		m_Affine.known = false;
+
+		if (m_Designator.node != &arg || m_Designator.type == nullptr ||
+			m_Designator.type->getType() != SymbolType::POINTER_TYPE)
+		{
+			ReportsManager::ReportError(node.getProcName().pos, ErrorType::NOT_A_POINTER_ARGUMENT);
+			return;
+		}
+		node.setPointerType(m_Designator.type);
+		if (allocates)
+			assignDesignated(node.getProcName().pos);
+	}
+
+	// read assigns its arguments, numbers and strings only. The first one
+	// may be the text file they are read from instead.
+	void SemanticAnalyzer::readArgument(AST::ProcCallNode const& node, unsigned i)
+	{
+		AST::Node const& arg = *node.getArguments()[i];
+		size_t pos = node.getProcName().pos;
+		m_Designator.node = nullptr;
+		m_ReferenceArgument = &arg;
+		designate(arg);
+		m_ReferenceArgument = nullptr;
+		m_Affine.known = false;
+
+		if (i == 0 && designatesText(arg))
+		{
+			node.setTextFile();
+			return;
+		}
+		std::shared_ptr<const Symbol> const& type = m_Designator.type;
+		if (m_Designator.node != &arg || type == nullptr || type->getType() != SymbolType::BUILTIN_TYPE ||
+			type->getName() == "boolean" || type->getName() == "text")
+		{
+			ReportsManager::ReportError(pos, ErrorType::NOT_A_READABLE_ARGUMENT);
+			return;
+		}
+		assignDesignated(pos);
+	}
+
+	// The first argument of write may be the text file it writes to.
+	void SemanticAnalyzer::writeArgument(AST::ProcCallNode const& node)
+	{
+		AST::Node const& arg = *node.getArguments()[0];
+		m_Designator.node = nullptr;
+		arg.accept(this);
+		if (designatesText(arg))
+			node.setTextFile();
+	}
+
+	// assign names its text file, reset, rewrite, close and eof only use it.
+	void SemanticAnalyzer::textArgument(AST::ProcCallNode const& node, bool assigns)
+	{
+		AST::Node const& arg = *node.getArguments()[0];
+		m_Designator.node = nullptr;
+		if (assigns)
+			m_ReferenceArgument = &arg;
+		designate(arg);
+		m_ReferenceArgument = nullptr;
+		m_Affine.known = false;
+
+		if (!designatesText(arg))
+		{
+			ReportsManager::ReportError(node.getProcName().pos, ErrorType::NOT_A_TEXT_ARGUMENT);
+			return;
+		}
+		if (assigns)
+			assignDesignated(node.getProcName().pos);
+	}
+
+	bool SemanticAnalyzer::designatesText(AST::Node const& arg) const
+	{
+		return m_Designator.node == &arg && m_Designator.type != nullptr &&
+			m_Designator.type->getType() == SymbolType::BUILTIN_TYPE && m_Designator.type->getName() == "text";
+	}
+
+	// A bigint variable, element or function result. Fields are left
+	// out.
+	bool SemanticAnalyzer::assignsBigint(AST::AssignmentNode const& node) const
+	{
+		std::shared_ptr<const Symbol> sym = m_Symtab->lookup(node.getVar().getToken().str);
+		if (sym != nullptr && sym->getType() == SymbolType::PROCEDURE &&
+			reinterpret_cast<const ProcedureSymbol*>(sym.get())->isFunction())
+			sym = reinterpret_cast<const ProcedureSymbol*>(sym.get())->getResult();
+		if (sym == nullptr || sym->getType() != SymbolType::VARIABLE || node.getField() != nullptr)
+			return false;
+
+		std::shared_ptr<const Symbol> type = reinterpret_cast<const VariableSymbol*>(sym.get())->getParent();
+		if (node.getElement() != nullptr && type != nullptr && type->getType() == SymbolType::ARRAY_TYPE)
+			type = reinterpret_cast<const ArrayTypeSymbol*>(type.get())->getElement();
+		return type != nullptr && type->getName() == "bigint";
+	}
+
+	// The designator visited last is assigned.
+	void SemanticAnalyzer::assignDesignated(size_t pos)
+	{
+		if (m_Designator.dereferenced)
+			return;
+
+		VariableSymbol* var = reinterpret_cast<VariableSymbol*>(m_Designator.var.get());
+		if (var->getMode() == ParamMode::CONST)
+			ReportsManager::ReportError(pos, ErrorType::CONST_PARAMETER_ASSIGNMENT);
+		var->undirty();
+		if (!m_Symtab->isBelongThisScope(m_Designator.var))
+			var->beAssignedByNested();
+		if (findLoop(var) != nullptr)
+			ReportsManager::ReportError(pos, ErrorType::CONTROL_VARIABLE_ASSIGNMENT);
+	}
+
+	void SemanticAnalyzer::wholeRecord(AST::Node const& node, std::shared_ptr<const Symbol> const& type, size_t pos)
+	{
+		if (&node == m_WholeNode)
+			m_WholeRecord = type;
+		else
+			ReportsManager::ReportError(pos, ErrorType::RECORD_WITHOUT_FIELD);
+	}
+
+	bool SemanticAnalyzer::isString(const VariableSymbol* var)
+	{
+		return var != nullptr && var->getParent() != nullptr && var->getParent()->getName() == "string";
+	}
+
+	SemanticAnalyzer::Loop* SemanticAnalyzer::findLoop(const Symbol* var)
+	{
+		for (auto& e : m_Loops)
+		{
+			if (e.var == var)
+				return &e;
 		}
+		return nullptr;
 	}
 }
@@ -0,0 +1,44 @@
+#include <pscpch.hpp>
+#include <SetHeap.hpp>
+#include <VectorKernels.hpp>
+
+namespace Pascal
+{
+	Value SetHeap::make(SetBits const& bits)
+	{
+		m_Sets.push_back(bits);
+		return Value::Set(&m_Sets.back());
+	}
+
+	Value SetHeap::unite(Value const& a, Value const& b)
+	{
+		SetBits bits;
+		VectorKernels::setUnion(bits, *a.as.set, *b.as.set);
+		return result(bits, a, b);
+	}
+
+	Value SetHeap::intersect(Value const& a, Value const& b)
+	{
+		SetBits bits;
+		VectorKernels::setIntersection(bits, *a.as.set, *b.as.set);
+		return result(bits, a, b);
+	}
+
+	Value SetHeap::subtract(Value const& a, Value const& b)
+	{
+		SetBits bits;
+		VectorKernels::setDifference(bits, *a.as.set, *b.as.set);
+		return result(bits, a, b);
+	}
+
+	// Characters stay characters when combined with numbers.
+	Value SetHeap::result(SetBits& bits, Value const& a, Value const& b)
+	{
+		bits.chars = a.as.set->chars || b.as.set->chars;
+		if (bits == *a.as.set)
+			return a;
+		if (bits == *b.as.set)
+			return b;
+		return make(bits);
+	}
+}
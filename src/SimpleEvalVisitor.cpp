@@ -53,8 +53,21 @@ namespace Pascal
 
 	void SimpleEvalVisitor::visitAssignmentNode(AST::AssignmentNode const& node)
 	{
+		std::string name = node.getVar().getToken().str;
+		AST::IndexNode const* element = (node.getField() != nullptr) ?
+			node.getField()->getElement() : node.getElement();
+		if (element != nullptr)
+		{
+			element->getIndex().accept(this);
+			name += "[" + std::to_string(static_cast<long>(acc)) + "]";
+		}
+		if (node.getField() != nullptr)
+		{
+			for (auto const& e : node.getField()->getFields())
+				name += "." + e.str;
+		}
 		node.getExpr().accept(this);
-		vars[node.getVar().getToken().str] = acc;
+		vars[name] = acc;
 	}
 
 	void SimpleEvalVisitor::visitVariableNode(AST::VariableNode const& node)
@@ -96,6 +109,30 @@ namespace Pascal
 		case TokenType::MOD:
 			acc = left / right;
 			break;
+		case TokenType::EQUAL:
+			acc = left == right;
+			break;
+		case TokenType::NOT_EQUAL:
+			acc = left != right;
+			break;
+		case TokenType::LESS:
+			acc = left < right;
+			break;
+		case TokenType::LESS_EQUAL:
+			acc = left <= right;
+			break;
+		case TokenType::GREATER:
+			acc = left > right;
+			break;
+		case TokenType::GREATER_EQUAL:
+			acc = left >= right;
+			break;
+		case TokenType::AND:
+			acc = left != 0 && right != 0;
+			break;
+		case TokenType::OR:
+			acc = left != 0 || right != 0;
+			break;
 		default:
 			throw std::runtime_error("binary unbelivable");
 		}
@@ -113,6 +150,9 @@ namespace Pascal
 		case TokenType::MINUS:
 			acc = -acc;
 			break;
+		case TokenType::NOT:
+			acc = acc == 0;
+			break;
 		default:
 			throw std::runtime_error("unary unbelivable");
 		}
@@ -132,4 +172,121 @@ namespace Pascal
 	{
 		
 	}
+
+	void SimpleEvalVisitor::visitWhileNode(AST::WhileNode const& node)
+	{
+		for (node.getCondition().accept(this); acc != 0; node.getCondition().accept(this))
+		{
+			node.getBody().accept(this);
+		}
+	}
+
+	void SimpleEvalVisitor::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		do
+		{
+			for (auto const& e : node.getStatements())
+			{
+				e->accept(this);
+			}
+			node.getCondition().accept(this);
+		}
+		while (acc == 0);
+	}
+
+	void SimpleEvalVisitor::visitForNode(AST::ForNode const& node)
+	{
+		node.getFrom().accept(this);
+		float from = acc;
+		node.getTo().accept(this);
+		float to = acc;
+
+		float step = (node.isDownto()) ? (-1) : (1);
+		std::string const& name = node.getVar().getToken().str;
+		for (vars[name] = from; (to - vars[name]) * step >= 0; vars[name] += step)
+		{
+			node.getBody().accept(this);
+		}
+	}
+
+	void SimpleEvalVisitor::visitIfNode(AST::IfNode const& node)
+	{
+		node.getCondition().accept(this);
+		if (acc != 0)
+		{
+			node.getThen().accept(this);
+		}
+		else if (node.getElse() != nullptr)
+		{
+			node.getElse()->accept(this);
+		}
+	}
+
+	void SimpleEvalVisitor::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		acc = node.getValue() ? 1 : 0;
+	}
+
+	void SimpleEvalVisitor::visitCaseNode(AST::CaseNode const& node)
+	{
+		node.getSelector().accept(this);
+		for (auto const& branch : node.getBranches())
+		{
+			for (auto const& label : branch.labels)
+			{
+				if (acc == label.getValue())
+				{
+					branch.statement->accept(this);
+					return;
+				}
+			}
+		}
+
+		if (node.getElse() != nullptr)
+		{
+			node.getElse()->accept(this);
+		}
+	}
+
+	// Elements are variables named 'a[i]'.
+	void SimpleEvalVisitor::visitIndexNode(AST::IndexNode const& node)
+	{
+		node.getIndex().accept(this);
+		acc = vars[node.getVar().getToken().str + "[" + std::to_string(static_cast<long>(acc)) + "]"];
+	}
+
+	void SimpleEvalVisitor::visitStringNode(AST::StringNode const& node)
+	{
+		
+	}
+
+	void SimpleEvalVisitor::visitSetNode(AST::SetNode const& node)
+	{
+
+	}
+
+	void SimpleEvalVisitor::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{
+
+	}
+
+	void SimpleEvalVisitor::visitFieldNode(AST::FieldNode const& node)
+	{
+		std::string name = node.getVar().getToken().str;
+		if (node.getElement() != nullptr)
+		{
+			node.getElement()->getIndex().accept(this);
+			name += "[" + std::to_string(static_cast<long>(acc)) + "]";
+		}
+		if (node.isDereference())
+			name += "^";
+		for (auto const& e : node.getFields())
+			name += "." + e.str;
+		acc = vars[name];
+	}
+
+	void SimpleEvalVisitor::visitNilNode(AST::NilNode const& node)
+	{
+		acc = 0;
+	}
 }
@@ -0,0 +1,86 @@
+#include <pscpch.hpp>
+#include <StringHeap.hpp>
+
+#include <cstring>
+
+namespace Pascal
+{
+	Value StringHeap::make(const char* chars, size_t length)
+	{
+		if (length <= Value::SHORT_STRING)
+			return Value::ShortString(chars, length);
+
+		StringBuffer* buffer = allocate(length);
+		memcpy(buffer->chars, chars, length);
+		buffer->used = length;
+		return makeLong(buffer, length);
+	}
+
+	Value StringHeap::concat(Value const& a, Value const& b)
+	{
+		size_t left = a.stringLength();
+		size_t right = b.stringLength();
+		if (right == 0)
+			return a;
+		if (left == 0)
+			return b;
+
+		size_t length = left + right;
+		if (length <= Value::SHORT_STRING)
+		{
+			char chars[Value::SHORT_STRING];
+			memcpy(chars, a.stringChars(), left);
+			memcpy(chars + left, b.stringChars(), right);
+			return Value::ShortString(chars, length);
+		}
+
+		// 'b' is at most as long as the buffer's text here, so it can't
+		// overlap the appended part even when it shares the buffer.
+		if (!a.isShortString())
+		{
+			StringBuffer* buffer = a.as.string->buffer;
+			if (buffer->used == left && buffer->capacity >= length)
+			{
+				memcpy(buffer->chars + left, b.stringChars(), right);
+				buffer->used = length;
+				return makeLong(buffer, length);
+			}
+		}
+
+		// A long string that outgrew its buffer is likely to grow again.
+		StringBuffer* buffer = allocate(a.isShortString() ? length : 2 * length);
+		memcpy(buffer->chars, a.stringChars(), left);
+		memcpy(buffer->chars + left, b.stringChars(), right);
+		buffer->used = length;
+		return makeLong(buffer, length);
+	}
+
+	Value StringHeap::makeLong(StringBuffer* buffer, size_t length)
+	{
+		m_Strings.push_back({ length, buffer });
+		return Value::String(&m_Strings.back());
+	}
+
+	// Buffers of more than a sixteenth of a chunk get one of their own.
+	StringBuffer* StringHeap::allocate(size_t capacity)
+	{
+		char* chars;
+		if (capacity > CHUNK / 16)
+		{
+			m_Large.emplace_back(new char[capacity]);
+			chars = m_Large.back().get();
+		}
+		else
+		{
+			if (m_Chunks.empty() || m_Used + capacity > CHUNK)
+			{
+				m_Chunks.emplace_back(new char[CHUNK]);
+				m_Used = 0;
+			}
+			chars = m_Chunks.back().get() + m_Used;
+			m_Used += capacity;
+		}
+		m_Buffers.push_back({ 0, capacity, chars });
+		return &m_Buffers.back();
+	}
+}
@@ -17,11 +17,35 @@ namespace Pascal
 	{
 		m_Symbols["integer"] = std::make_shared<BuiltInTypeSymbol>("integer");
 		m_Symbols["real"] = std::make_shared<BuiltInTypeSymbol>("real");
+		m_Symbols["boolean"] = std::make_shared<BuiltInTypeSymbol>("boolean");
+		m_Symbols["string"] = std::make_shared<BuiltInTypeSymbol>("string");
+		m_Symbols["bigint"] = std::make_shared<BuiltInTypeSymbol>("bigint");
+		m_Symbols["text"] = std::make_shared<BuiltInTypeSymbol>("text");
+		m_Symbols["length"] = std::make_shared<BuiltinRoutineSymbol>("length", Builtin::LENGTH, 1, true);
+		m_Symbols["new"] = std::make_shared<BuiltinRoutineSymbol>("new", Builtin::NEW, 1, false);
+		m_Symbols["dispose"] = std::make_shared<BuiltinRoutineSymbol>("dispose", Builtin::DISPOSE, 1, false);
+		m_Symbols["write"] = std::make_shared<BuiltinRoutineSymbol>("write", Builtin::WRITE,
+			BuiltinRoutineSymbol::ANY_ARGS, false);
+		m_Symbols["writeln"] = std::make_shared<BuiltinRoutineSymbol>("writeln", Builtin::WRITELN,
+			BuiltinRoutineSymbol::ANY_ARGS, false);
+		m_Symbols["read"] = std::make_shared<BuiltinRoutineSymbol>("read", Builtin::READ,
+			BuiltinRoutineSymbol::ANY_ARGS, false);
+		m_Symbols["readln"] = std::make_shared<BuiltinRoutineSymbol>("readln", Builtin::READLN,
+			BuiltinRoutineSymbol::ANY_ARGS, false);
+		m_Symbols["assign"] = std::make_shared<BuiltinRoutineSymbol>("assign", Builtin::ASSIGN, 2, false);
+		m_Symbols["reset"] = std::make_shared<BuiltinRoutineSymbol>("reset", Builtin::RESET, 1, false);
+		m_Symbols["rewrite"] = std::make_shared<BuiltinRoutineSymbol>("rewrite", Builtin::REWRITE, 1, false);
+		m_Symbols["close"] = std::make_shared<BuiltinRoutineSymbol>("close", Builtin::CLOSE, 1, false);
+		m_Symbols["eof"] = std::make_shared<BuiltinRoutineSymbol>("eof", Builtin::END_OF_FILE,
+			BuiltinRoutineSymbol::ANY_ARGS, true);
 	}
 	
+	// Declarations hide the builtin types and routines.
 	void SymbolTable::define(std::shared_ptr<Symbol> sym)
 	{
-		if (m_Symbols.count(sym->getName()))
+		auto found = m_Symbols.find(sym->getName());
+		if (found != m_Symbols.end() && found->second->getType() != SymbolType::BUILTIN_TYPE &&
+			found->second->getType() != SymbolType::BUILTIN_ROUTINE)
 			ReportsManager::ReportError(sym->getPos(), ErrorType::NAME_REDEFINITION);
 		else
 			m_Symbols[sym->getName()] = sym;
@@ -0,0 +1,49 @@
+#include <pscpch.hpp>
+#include <TextFile.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Pascal
+{
+	TextFile::~TextFile()
+	{
+		close();
+	}
+
+	void TextFile::assign(std::string name)
+	{
+		close();
+		m_Name = std::move(name);
+	}
+
+	bool TextFile::reset()
+	{
+		close();
+		m_Fd = ::open(m_Name.c_str(), O_RDONLY | O_CLOEXEC);
+		if (m_Fd < 0)
+			return false;
+		m_Input.reset(new InputBuffer(m_Fd));
+		return true;
+	}
+
+	bool TextFile::rewrite()
+	{
+		close();
+		m_Fd = ::open(m_Name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+		if (m_Fd < 0)
+			return false;
+		m_Output.reset(new OutputBuffer(m_Fd));
+		return true;
+	}
+
+	// The buffers go first, the output is flushed and the input unmapped.
+	void TextFile::close()
+	{
+		m_Input.reset();
+		m_Output.reset();
+		if (m_Fd >= 0)
+			::close(m_Fd);
+		m_Fd = -1;
+	}
+}
@@ -0,0 +1,317 @@
+#include <pscpch.hpp>
+#include <Value.hpp>
+#include <BigNum.hpp>
+#include <VectorKernels.hpp>
+
+#include <climits>
+#include <cstring>
+
+namespace Pascal
+{
+	std::string typeToString(ValueType type)
+	{
+		switch (type)
+		{
+		case ValueType::NONE:
+			return "NONE";
+		case ValueType::INTEGER:
+			return "INTEGER";
+		case ValueType::REAL:
+			return "REAL";
+		case ValueType::BOOLEAN:
+			return "BOOLEAN";
+		case ValueType::STRING:
+			return "STRING";
+		case ValueType::SET:
+			return "SET";
+		case ValueType::REFERENCE:
+			return "REFERENCE";
+		case ValueType::POINTER:
+			return "POINTER";
+		case ValueType::TEXT:
+			return "TEXT";
+		case ValueType::BIGINT:
+			return "BIGINT";
+		case ValueType::BIGNUM:
+			return "BIGNUM";
+		}
+		return "UNKNOWN";
+	}
+
+	static std::string setElementToString(long element, bool chars)
+	{
+		if (!chars)
+			return std::to_string(element);
+		char c = static_cast<char>(element);
+		return Value::ShortString(&c, 1).toString();
+	}
+
+	std::string Value::toString() const
+	{
+		switch (type)
+		{
+		case ValueType::NONE:
+			return "<none>";
+		case ValueType::INTEGER:
+			return std::to_string(as.integer);
+		case ValueType::REAL:
+		{
+			std::stringstream ss;
+			ss << as.real;
+			return ss.str();
+		}
+		case ValueType::BOOLEAN:
+			return as.boolean ? "true" : "false";
+		case ValueType::STRING:
+		{
+			std::string res = "'";
+			for (const char* c = stringChars(); c != stringChars() + stringLength(); c++)
+				res += (*c == '\'') ? "''" : std::string(1, *c);
+			return res + "'";
+		}
+		case ValueType::SET:
+		{
+			// Runs of elements as ranges: [1, 3..5].
+			std::string res = "[";
+			for (long e = 0; e <= SetBits::MAX_ELEMENT; e++)
+			{
+				if (!as.set->contains(e))
+					continue;
+				long last = e;
+				while (as.set->contains(last + 1))
+					last++;
+
+				if (res.size() > 1)
+					res += ", ";
+				res += setElementToString(e, as.set->chars);
+				if (last > e)
+					res += ".." + setElementToString(last, as.set->chars);
+				e = last;
+			}
+			return res + "]";
+		}
+		case ValueType::REFERENCE:
+			return as.ref->toString();
+		// Objects may point back at each other, they aren't followed.
+		case ValueType::POINTER:
+			return (as.ref == nullptr) ? "nil" : "^";
+		case ValueType::TEXT:
+			return "text";
+		case ValueType::BIGINT:
+			return std::to_string(as.integer);
+		case ValueType::BIGNUM:
+			return as.big->toString();
+		}
+		return "<unknown>";
+	}
+
+	const SetBits SetBits::EMPTY = { { 0, 0, 0, 0 }, false };
+	const SetBits SetBits::EMPTY_CHARS = { { 0, 0, 0, 0 }, true };
+
+	// Byte by byte, then the shorter one first.
+	static int compareStrings(Value const& a, Value const& b)
+	{
+		size_t left = a.stringLength();
+		size_t right = b.stringLength();
+		int res = memcmp(a.stringChars(), b.stringChars(), std::min(left, right));
+		if (res != 0)
+			return res;
+		return (left < right) ? -1 : (left > right);
+	}
+
+	// = and <> test equality, <= and >= inclusion. < and > are their
+	// complements, so that a branch may still test either relation.
+	bool compareSets(Relation rel, Value const& a, Value const& b, bool& res)
+	{
+		if (!b.isSet())
+			return false;
+
+		SetBits const& left = *a.as.set;
+		SetBits const& right = *b.as.set;
+		switch (rel)
+		{
+		case Relation::EQ: res = VectorKernels::setsEqual(left, right); break;
+		case Relation::NE: res = !VectorKernels::setsEqual(left, right); break;
+		case Relation::LE: res = VectorKernels::setIncluded(left, right); break;
+		case Relation::GT: res = !VectorKernels::setIncluded(left, right); break;
+		case Relation::GE: res = VectorKernels::setIncluded(right, left); break;
+		case Relation::LT: res = !VectorKernels::setIncluded(right, left); break;
+		}
+		return true;
+	}
+
+	// A number of any kind as a real.
+	static bool asReal(Value const& value, double& res)
+	{
+		switch (value.type)
+		{
+		case ValueType::INTEGER:
+		case ValueType::BIGINT:
+			res = static_cast<double>(value.as.integer);
+			return true;
+		case ValueType::REAL:
+			res = value.as.real;
+			return true;
+		case ValueType::BIGNUM:
+			res = value.as.big->toReal();
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Numbers combine as reals when either of them is one.
+	static bool asReals(Value const& a, Value const& b, double& left, double& right)
+	{
+		return (a.isReal() || b.isReal()) && asReal(a, left) && asReal(b, right);
+	}
+
+	static bool isWhole(Value const& value)
+	{
+		return value.isMachineInteger() || value.isBigNum();
+	}
+
+	// Of integers of any size.
+	static int compareWhole(Value const& a, Value const& b)
+	{
+		if (a.isMachineInteger() && b.isMachineInteger())
+			return (a.as.integer < b.as.integer) ? -1 : (a.as.integer > b.as.integer);
+		return BigNum::compare(a.isBigNum() ? *a.as.big : BigNum::fromLong(a.as.integer),
+							   b.isBigNum() ? *b.as.big : BigNum::fromLong(b.as.integer));
+	}
+
+	// Bigints stay inline until the result overflows a long. Then these
+	// fail and the interpreter's BigHeap computes it, as it does when an
+	// operand is a BigNum already.
+	bool addSlow(Value const& a, Value const& b, Value& res)
+	{
+		long sum;
+		if (a.isMachineInteger() && b.isMachineInteger())
+		{
+			if (__builtin_add_overflow(a.as.integer, b.as.integer, &sum))
+				return false;
+			res = Value::BigInt(sum);
+			return true;
+		}
+		double left, right;
+		if (!asReals(a, b, left, right))
+			return false;
+		res = Value::Real(left + right);
+		return true;
+	}
+
+	bool subSlow(Value const& a, Value const& b, Value& res)
+	{
+		long difference;
+		if (a.isMachineInteger() && b.isMachineInteger())
+		{
+			if (__builtin_sub_overflow(a.as.integer, b.as.integer, &difference))
+				return false;
+			res = Value::BigInt(difference);
+			return true;
+		}
+		double left, right;
+		if (!asReals(a, b, left, right))
+			return false;
+		res = Value::Real(left - right);
+		return true;
+	}
+
+	bool mulSlow(Value const& a, Value const& b, Value& res)
+	{
+		long product;
+		if (a.isMachineInteger() && b.isMachineInteger())
+		{
+			if (__builtin_mul_overflow(a.as.integer, b.as.integer, &product))
+				return false;
+			res = Value::BigInt(product);
+			return true;
+		}
+		double left, right;
+		if (!asReals(a, b, left, right))
+			return false;
+		res = Value::Real(left * right);
+		return true;
+	}
+
+	bool divSlow(Value const& a, Value const& b, Value& res)
+	{
+		if (a.isMachineInteger() && b.isMachineInteger())
+		{
+			if (a.as.integer == LONG_MIN && b.as.integer == -1)
+				return false;
+			res = Value::BigInt(a.as.integer / b.as.integer);
+			return true;
+		}
+		double left, right;
+		if (!asReals(a, b, left, right))
+			return false;
+		res = Value::Real(left / right);
+		return true;
+	}
+
+	bool modSlow(Value const& a, Value const& b, Value& res)
+	{
+		if (!a.isMachineInteger() || !b.isMachineInteger())
+			return false;
+		// LONG_MIN % -1 traps.
+		res = Value::BigInt((b.as.integer == -1) ? 0 : a.as.integer % b.as.integer);
+		return true;
+	}
+
+	bool negSlow(Value const& a, Value& res)
+	{
+		if (a.isBigInt() && a.as.integer != LONG_MIN)
+			res = Value::BigInt(-a.as.integer);
+		else if (a.isReal())
+			res = Value::Real(-a.as.real);
+		else
+			return false;
+		return true;
+	}
+
+	bool lessSlow(Value const& a, Value const& b, bool& res)
+	{
+		double left, right;
+		if (isWhole(a) && isWhole(b))
+			res = compareWhole(a, b) < 0;
+		else if (asReal(a, left) && asReal(b, right))
+			res = left < right;
+		else if (a.isBoolean() && b.isBoolean())
+			res = a.as.boolean < b.as.boolean;
+		else if (a.isString() && b.isString())
+			res = compareStrings(a, b) < 0;
+		else
+			return false;
+		return true;
+	}
+
+	bool equalSlow(Value const& a, Value const& b, bool& res)
+	{
+		double left, right;
+		if (isWhole(a) && isWhole(b))
+			res = compareWhole(a, b) == 0;
+		else if (asReal(a, left) && asReal(b, right))
+			res = left == right;
+		else if (a.isBoolean() && b.isBoolean())
+			res = a.as.boolean == b.as.boolean;
+		else if (a.isString() && b.isString())
+			res = a.stringLength() == b.stringLength() && compareStrings(a, b) == 0;
+		else if (a.isPointer() && b.isPointer())
+			res = a.as.ref == b.as.ref;
+		else
+			return false;
+		return true;
+	}
+
+	void assignSlow(Value& slot, Value const& value)
+	{
+		double real;
+		if (slot.isReal() && asReal(value, real))
+			slot = Value::Real(real);
+		else if ((slot.isBigInt() || slot.isBigNum()) && value.isInteger())
+			slot = Value::BigInt(value.as.integer);
+		else
+			slot = value;
+	}
+}
@@ -0,0 +1,645 @@
+#include <pscpch.hpp>
+#include <VectorKernels.hpp>
+
+#include <cstring>
+
+#ifdef PASCAL_VECTOR_X86_64
+#include <immintrin.h>
+#endif
+
+namespace Pascal
+{
+	namespace
+	{
+		typedef void (*IntegerKernel)(Value* a, Value const* b, Value const* c, long s, long n);
+		typedef void (*RealKernel)(Value* a, Value const* b, Value const* c, double s, long n);
+		typedef void (*SetKernel)(SetBits& res, SetBits const& a, SetBits const& b);
+
+		enum class SetOperation
+		{
+			UNION,
+			INTERSECTION,
+			DIFFERENCE
+		};
+
+		// The kernels of one instruction set, 'c' is 'b' for those without
+		// a right operand.
+		struct KernelSet
+		{
+			const char* name;
+			void (*fill)(Value* a, Value s, long n);
+			IntegerKernel addIntegers;
+			IntegerKernel subIntegers;
+			unsigned long (*sumIntegers)(Value const* b, long n);
+			RealKernel addReals;
+			RealKernel subReals;
+			RealKernel mulReals;
+			RealKernel scaleReals;
+			RealKernel axpyReals;
+			SetKernel setUnion;
+			SetKernel setIntersection;
+			SetKernel setDifference;
+			bool (*setsEqual)(SetBits const& a, SetBits const& b);
+			bool (*setIncluded)(SetBits const& a, SetBits const& b);
+		};
+
+		// Unsigned, so that overflow wraps around like in the interpreter.
+		template <VectorKernel K>
+		inline unsigned long integerOp(unsigned long b, unsigned long c, unsigned long s)
+		{
+			switch (K)
+			{
+			case VectorKernel::ADD:   return b + c;
+			case VectorKernel::SUB:   return b - c;
+			case VectorKernel::MUL:   return b * c;
+			case VectorKernel::SCALE: return b * s;
+			default:                  return b * s + c;
+			}
+		}
+
+		template <VectorKernel K>
+		inline double realOp(double b, double c, double s)
+		{
+			switch (K)
+			{
+			case VectorKernel::ADD:   return b + c;
+			case VectorKernel::SUB:   return b - c;
+			case VectorKernel::MUL:   return b * c;
+			case VectorKernel::SCALE: return b * s;
+			default:                  return b * s + c;
+			}
+		}
+
+		void scalarFill(Value* a, Value s, long n)
+		{
+			std::fill_n(a, n, s);
+		}
+
+		template <VectorKernel K>
+		void scalarIntegers(Value* a, Value const* b, Value const* c, long s, long n)
+		{
+			for (long k = 0; k < n; k++)
+				a[k] = Value::Integer(integerOp<K>(b[k].as.integer, c[k].as.integer, s));
+		}
+
+		unsigned long scalarSumIntegers(Value const* b, long n)
+		{
+			unsigned long res = 0;
+			for (long k = 0; k < n; k++)
+				res += b[k].as.integer;
+			return res;
+		}
+
+		template <VectorKernel K>
+		void scalarReals(Value* a, Value const* b, Value const* c, double s, long n)
+		{
+			for (long k = 0; k < n; k++)
+				a[k] = Value::Real(realOp<K>(b[k].as.real, c[k].as.real, s));
+		}
+
+		template <SetOperation S>
+		void scalarSets(SetBits& res, SetBits const& a, SetBits const& b)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				switch (S)
+				{
+				case SetOperation::UNION:        res.words[k] = a.words[k] | b.words[k]; break;
+				case SetOperation::INTERSECTION: res.words[k] = a.words[k] & b.words[k]; break;
+				default:                         res.words[k] = a.words[k] & ~b.words[k]; break;
+				}
+			}
+		}
+
+		bool scalarSetsEqual(SetBits const& a, SetBits const& b)
+		{
+			return ((a.words[0] ^ b.words[0]) | (a.words[1] ^ b.words[1]) |
+					(a.words[2] ^ b.words[2]) | (a.words[3] ^ b.words[3])) == 0;
+		}
+
+		bool scalarSetIncluded(SetBits const& a, SetBits const& b)
+		{
+			return ((a.words[0] & ~b.words[0]) | (a.words[1] & ~b.words[1]) |
+					(a.words[2] & ~b.words[2]) | (a.words[3] & ~b.words[3])) == 0;
+		}
+
+		const KernelSet SCALAR = {
+			"scalar",
+			scalarFill,
+			scalarIntegers<VectorKernel::ADD>,
+			scalarIntegers<VectorKernel::SUB>,
+			scalarSumIntegers,
+			scalarReals<VectorKernel::ADD>,
+			scalarReals<VectorKernel::SUB>,
+			scalarReals<VectorKernel::MUL>,
+			scalarReals<VectorKernel::SCALE>,
+			scalarReals<VectorKernel::AXPY>,
+			scalarSets<SetOperation::UNION>,
+			scalarSets<SetOperation::INTERSECTION>,
+			scalarSets<SetOperation::DIFFERENCE>,
+			scalarSetsEqual,
+			scalarSetIncluded
+		};
+
+#ifdef PASCAL_VECTOR_X86_64
+		// SSE2: one value per register. Reals are computed two at a time
+		// on their payloads alone, a tag read as a double would be a
+		// denormal.
+
+		inline __m128i load128(Value const* v) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(v)); }
+		inline void store128(Value* v, __m128i x) { _mm_storeu_si128(reinterpret_cast<__m128i*>(v), x); }
+		inline __m128d load128d(Value const* v) { return _mm_loadu_pd(reinterpret_cast<const double*>(v)); }
+		inline void store128d(Value* v, __m128d x) { _mm_storeu_pd(reinterpret_cast<double*>(v), x); }
+
+		void sse2Fill(Value* a, Value s, long n)
+		{
+			__m128i x = load128(&s);
+			for (long k = 0; k < n; k++)
+				store128(a + k, x);
+		}
+
+		template <VectorKernel K>
+		void sse2Integers(Value* a, Value const* b, Value const* c, long s, long n)
+		{
+			for (long k = 0; k < n; k++)
+			{
+				__m128i x = load128(b + k);
+				__m128i y = load128(c + k);
+				__m128i res = (K == VectorKernel::ADD) ? _mm_add_epi64(x, y) : _mm_sub_epi64(x, y);
+				// The tag of b, the payload of the result.
+				res = _mm_castpd_si128(_mm_move_sd(_mm_castsi128_pd(res), _mm_castsi128_pd(x)));
+				store128(a + k, res);
+			}
+		}
+
+		unsigned long sse2SumIntegers(Value const* b, long n)
+		{
+			__m128i sum = _mm_setzero_si128();
+			for (long k = 0; k < n; k++)
+				sum = _mm_add_epi64(sum, load128(b + k));
+			return _mm_cvtsi128_si64(_mm_unpackhi_epi64(sum, sum));
+		}
+
+		template <VectorKernel K>
+		inline __m128d sse2RealOp(__m128d b, __m128d c, __m128d s)
+		{
+			switch (K)
+			{
+			case VectorKernel::ADD:   return _mm_add_pd(b, c);
+			case VectorKernel::SUB:   return _mm_sub_pd(b, c);
+			case VectorKernel::MUL:   return _mm_mul_pd(b, c);
+			case VectorKernel::SCALE: return _mm_mul_pd(b, s);
+			default:                  return _mm_add_pd(_mm_mul_pd(b, s), c);
+			}
+		}
+
+		template <VectorKernel K>
+		void sse2Reals(Value* a, Value const* b, Value const* c, double s, long n)
+		{
+			__m128d scalar = _mm_set1_pd(s);
+			long k = 0;
+			for (; k + 2 <= n; k += 2)
+			{
+				__m128d b0 = load128d(b + k);
+				__m128d b1 = load128d(b + k + 1);
+				__m128d x = _mm_unpackhi_pd(b0, b1);
+				__m128d y = _mm_unpackhi_pd(load128d(c + k), load128d(c + k + 1));
+				__m128d res = sse2RealOp<K>(x, y, scalar);
+				store128d(a + k, _mm_shuffle_pd(b0, res, 0));
+				store128d(a + k + 1, _mm_shuffle_pd(b1, res, 2));
+			}
+			for (; k < n; k++)
+				a[k] = Value::Real(realOp<K>(b[k].as.real, c[k].as.real, s));
+		}
+
+		// Sets take two registers.
+
+		inline __m128i loadSet128(SetBits const& set, int half)
+		{ return _mm_load_si128(reinterpret_cast<const __m128i*>(set.words) + half); }
+
+		template <SetOperation S>
+		inline __m128i sse2SetOp(__m128i a, __m128i b)
+		{
+			switch (S)
+			{
+			case SetOperation::UNION:        return _mm_or_si128(a, b);
+			case SetOperation::INTERSECTION: return _mm_and_si128(a, b);
+			default:                         return _mm_andnot_si128(b, a);
+			}
+		}
+
+		template <SetOperation S>
+		void sse2Sets(SetBits& res, SetBits const& a, SetBits const& b)
+		{
+			__m128i* words = reinterpret_cast<__m128i*>(res.words);
+			_mm_store_si128(words, sse2SetOp<S>(loadSet128(a, 0), loadSet128(b, 0)));
+			_mm_store_si128(words + 1, sse2SetOp<S>(loadSet128(a, 1), loadSet128(b, 1)));
+		}
+
+		inline bool sse2IsZero(__m128i x)
+		{
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) == 0xFFFF;
+		}
+
+		bool sse2SetsEqual(SetBits const& a, SetBits const& b)
+		{
+			return sse2IsZero(_mm_or_si128(_mm_xor_si128(loadSet128(a, 0), loadSet128(b, 0)),
+										   _mm_xor_si128(loadSet128(a, 1), loadSet128(b, 1))));
+		}
+
+		bool sse2SetIncluded(SetBits const& a, SetBits const& b)
+		{
+			return sse2IsZero(_mm_or_si128(_mm_andnot_si128(loadSet128(b, 0), loadSet128(a, 0)),
+										   _mm_andnot_si128(loadSet128(b, 1), loadSet128(a, 1))));
+		}
+
+		const KernelSet SSE2 = {
+			"sse2",
+			sse2Fill,
+			sse2Integers<VectorKernel::ADD>,
+			sse2Integers<VectorKernel::SUB>,
+			sse2SumIntegers,
+			sse2Reals<VectorKernel::ADD>,
+			sse2Reals<VectorKernel::SUB>,
+			sse2Reals<VectorKernel::MUL>,
+			sse2Reals<VectorKernel::SCALE>,
+			sse2Reals<VectorKernel::AXPY>,
+			sse2Sets<SetOperation::UNION>,
+			sse2Sets<SetOperation::INTERSECTION>,
+			sse2Sets<SetOperation::DIFFERENCE>,
+			sse2SetsEqual,
+			sse2SetIncluded
+		};
+
+		// AVX2: two values per register, reals four at a time.
+
+#define PASCAL_AVX2 __attribute__((target("avx2")))
+
+		PASCAL_AVX2 inline __m256i load256(Value const* v) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v)); }
+		PASCAL_AVX2 inline void store256(Value* v, __m256i x) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(v), x); }
+		PASCAL_AVX2 inline __m256d load256d(Value const* v) { return _mm256_loadu_pd(reinterpret_cast<const double*>(v)); }
+		PASCAL_AVX2 inline void store256d(Value* v, __m256d x) { _mm256_storeu_pd(reinterpret_cast<double*>(v), x); }
+
+		PASCAL_AVX2 void avx2Fill(Value* a, Value s, long n)
+		{
+			__m256i x = _mm256_broadcastsi128_si256(load128(&s));
+			long k = 0;
+			for (; k + 2 <= n; k += 2)
+				store256(a + k, x);
+			if (k < n)
+				a[k] = s;
+		}
+
+		template <VectorKernel K>
+		PASCAL_AVX2 void avx2Integers(Value* a, Value const* b, Value const* c, long s, long n)
+		{
+			long k = 0;
+			for (; k + 2 <= n; k += 2)
+			{
+				__m256i x = load256(b + k);
+				__m256i y = load256(c + k);
+				__m256i res = (K == VectorKernel::ADD) ? _mm256_add_epi64(x, y) : _mm256_sub_epi64(x, y);
+				// Tags (dwords 0, 1, 4 and 5) of b.
+				store256(a + k, _mm256_blend_epi32(res, x, 0x33));
+			}
+			if (k < n)
+				a[k] = Value::Integer(integerOp<K>(b[k].as.integer, c[k].as.integer, s));
+		}
+
+		PASCAL_AVX2 unsigned long avx2SumIntegers(Value const* b, long n)
+		{
+			__m256i sum = _mm256_setzero_si256();
+			long k = 0;
+			for (; k + 2 <= n; k += 2)
+				sum = _mm256_add_epi64(sum, load256(b + k));
+			unsigned long res = _mm256_extract_epi64(sum, 1) + _mm256_extract_epi64(sum, 3);
+			if (k < n)
+				res += b[k].as.integer;
+			return res;
+		}
+
+		template <VectorKernel K>
+		PASCAL_AVX2 inline __m256d avx2RealOp(__m256d b, __m256d c, __m256d s)
+		{
+			switch (K)
+			{
+			case VectorKernel::ADD:   return _mm256_add_pd(b, c);
+			case VectorKernel::SUB:   return _mm256_sub_pd(b, c);
+			case VectorKernel::MUL:   return _mm256_mul_pd(b, c);
+			case VectorKernel::SCALE: return _mm256_mul_pd(b, s);
+			default:                  return _mm256_add_pd(_mm256_mul_pd(b, s), c);
+			}
+		}
+
+		// Payloads of b[k..k+3] come out as k, k+2, k+1, k+3.
+		template <VectorKernel K>
+		PASCAL_AVX2 void avx2Reals(Value* a, Value const* b, Value const* c, double s, long n)
+		{
+			__m256d scalar = _mm256_set1_pd(s);
+			long k = 0;
+			for (; k + 4 <= n; k += 4)
+			{
+				__m256d b0 = load256d(b + k);
+				__m256d b1 = load256d(b + k + 2);
+				__m256d x = _mm256_unpackhi_pd(b0, b1);
+				__m256d y = _mm256_unpackhi_pd(load256d(c + k), load256d(c + k + 2));
+				__m256d res = avx2RealOp<K>(x, y, scalar);
+				store256d(a + k, _mm256_shuffle_pd(b0, res, 0x0));
+				store256d(a + k + 2, _mm256_shuffle_pd(b1, res, 0xA));
+			}
+			for (; k < n; k++)
+				a[k] = Value::Real(realOp<K>(b[k].as.real, c[k].as.real, s));
+		}
+
+		// A set is one register, tests are a single vptest.
+
+		PASCAL_AVX2 inline __m256i loadSet256(SetBits const& set)
+		{ return _mm256_load_si256(reinterpret_cast<const __m256i*>(set.words)); }
+
+		template <SetOperation S>
+		PASCAL_AVX2 void avx2Sets(SetBits& res, SetBits const& a, SetBits const& b)
+		{
+			__m256i x = loadSet256(a);
+			__m256i y = loadSet256(b);
+			__m256i z;
+			switch (S)
+			{
+			case SetOperation::UNION:        z = _mm256_or_si256(x, y); break;
+			case SetOperation::INTERSECTION: z = _mm256_and_si256(x, y); break;
+			default:                         z = _mm256_andnot_si256(y, x); break;
+			}
+			_mm256_store_si256(reinterpret_cast<__m256i*>(res.words), z);
+		}
+
+		PASCAL_AVX2 bool avx2SetsEqual(SetBits const& a, SetBits const& b)
+		{
+			__m256i x = _mm256_xor_si256(loadSet256(a), loadSet256(b));
+			return _mm256_testz_si256(x, x);
+		}
+
+		// testc: no bit of 'a' outside of 'b'.
+		PASCAL_AVX2 bool avx2SetIncluded(SetBits const& a, SetBits const& b)
+		{
+			return _mm256_testc_si256(loadSet256(b), loadSet256(a));
+		}
+
+#undef PASCAL_AVX2
+
+		const KernelSet AVX2 = {
+			"avx2",
+			avx2Fill,
+			avx2Integers<VectorKernel::ADD>,
+			avx2Integers<VectorKernel::SUB>,
+			avx2SumIntegers,
+			avx2Reals<VectorKernel::ADD>,
+			avx2Reals<VectorKernel::SUB>,
+			avx2Reals<VectorKernel::MUL>,
+			avx2Reals<VectorKernel::SCALE>,
+			avx2Reals<VectorKernel::AXPY>,
+			avx2Sets<SetOperation::UNION>,
+			avx2Sets<SetOperation::INTERSECTION>,
+			avx2Sets<SetOperation::DIFFERENCE>,
+			avx2SetsEqual,
+			avx2SetIncluded
+		};
+#endif
+
+		bool isAvailable(KernelSet const& set)
+		{
+#ifdef PASCAL_VECTOR_X86_64
+			if (&set == &AVX2)
+			{
+				__builtin_cpu_init();
+				return __builtin_cpu_supports("avx2");
+			}
+#endif
+			return true;
+		}
+
+		KernelSet const* widest()
+		{
+#ifdef PASCAL_VECTOR_X86_64
+			return isAvailable(AVX2) ? &AVX2 : &SSE2;
+#else
+			return &SCALAR;
+#endif
+		}
+
+		KernelSet const* s_Kernels = widest();
+
+		// Kernels no instruction set speeds up: vector 64 bit multiplies
+		// only come with AVX-512, and floating point addition isn't
+		// associative, so real sums have to run in order.
+
+		unsigned long dotIntegers(Value const* b, Value const* c, long n)
+		{
+			unsigned long res = 0;
+			for (long k = 0; k < n; k++)
+				res += static_cast<unsigned long>(b[k].as.integer) * c[k].as.integer;
+			return res;
+		}
+
+		double sumReals(double sum, Value const* b, long n)
+		{
+			for (long k = 0; k < n; k++)
+				sum = sum + b[k].as.real;
+			return sum;
+		}
+
+		double dotReals(double sum, Value const* b, Value const* c, long n)
+		{
+			for (long k = 0; k < n; k++)
+				sum = sum + b[k].as.real * c[k].as.real;
+			return sum;
+		}
+
+		Value* address(VectorOperand const& operand, Value* base, Value* const* display, Value const* constants)
+		{
+			if (operand.constant)
+				return const_cast<Value*>(constants + operand.slot);
+			return ((operand.level == 0) ? base : display[operand.level]) + operand.slot;
+		}
+	}
+
+	bool VectorKernels::run(VectorLoop const& loop, Value* base, Value* const* display, Value const* constants)
+	{
+		Value& var = base[loop.var];
+		Value const& limit = base[loop.limit];
+		if (!bothIntegers(var, limit) || var.as.integer > limit.as.integer)
+			return false;
+
+		long first = var.as.integer;
+		long last = limit.as.integer;
+		VectorKernel kernel = loop.kernel;
+		bool reduction = (kernel == VectorKernel::SUM || kernel == VectorKernel::DOT);
+		bool right = (kernel == VectorKernel::ADD || kernel == VectorKernel::SUB || kernel == VectorKernel::MUL ||
+					  kernel == VectorKernel::AXPY || kernel == VectorKernel::DOT);
+		bool scalar = (kernel == VectorKernel::FILL || kernel == VectorKernel::SCALE || kernel == VectorKernel::AXPY);
+
+		const VectorOperand* arrays[] = {
+			reduction ? nullptr : &loop.target,
+			(kernel == VectorKernel::FILL) ? nullptr : &loop.left,
+			right ? &loop.right : nullptr
+		};
+
+		// The iterations up to the first element out of bounds or of
+		// another type, the loop's own code deals with it.
+		long end = last;
+		for (auto array : arrays)
+		{
+			if (array == nullptr)
+				continue;
+			if (first < array->low)
+				return false;
+			end = std::min(end, array->high);
+		}
+		for (auto array : arrays)
+		{
+			if (array == nullptr)
+				continue;
+			Value const* elements = address(*array, base, display, constants);
+			for (long k = first; k <= end; k++)
+			{
+				if (elements[k].type != loop.element)
+				{
+					end = k - 1;
+					break;
+				}
+			}
+		}
+		if (end < first)
+			return false;
+
+		Value s = Value::None();
+		if (scalar)
+		{
+			s = *address(loop.scalar, base, display, constants);
+			if (loop.element == ValueType::REAL && s.isInteger())
+				s = Value::Real(static_cast<double>(s.as.integer));
+			if (s.type != loop.element)
+				return false;
+		}
+
+		Value* a = address(loop.target, base, display, constants);
+		if (reduction && a->type != loop.element)
+			return false;
+
+		long n = end - first + 1;
+		if (!reduction)
+			a += first;
+		Value const* b = address(loop.left, base, display, constants) + first;
+		Value const* c = right ? address(loop.right, base, display, constants) + first : b;
+		bool integer = (loop.element == ValueType::INTEGER);
+
+		switch (kernel)
+		{
+		case VectorKernel::COPY:
+			std::memmove(a, b, n * sizeof(Value));
+			break;
+		case VectorKernel::FILL:
+			s_Kernels->fill(a, s, n);
+			break;
+		case VectorKernel::ADD:
+			if (integer)
+				s_Kernels->addIntegers(a, b, c, 0, n);
+			else
+				s_Kernels->addReals(a, b, c, 0.0, n);
+			break;
+		case VectorKernel::SUB:
+			if (integer)
+				s_Kernels->subIntegers(a, b, c, 0, n);
+			else
+				s_Kernels->subReals(a, b, c, 0.0, n);
+			break;
+		case VectorKernel::MUL:
+			if (integer)
+				scalarIntegers<VectorKernel::MUL>(a, b, c, 0, n);
+			else
+				s_Kernels->mulReals(a, b, c, 0.0, n);
+			break;
+		case VectorKernel::SCALE:
+			if (integer)
+				scalarIntegers<VectorKernel::SCALE>(a, b, c, s.as.integer, n);
+			else
+				s_Kernels->scaleReals(a, b, c, s.as.real, n);
+			break;
+		case VectorKernel::AXPY:
+			if (integer)
+				scalarIntegers<VectorKernel::AXPY>(a, b, c, s.as.integer, n);
+			else
+				s_Kernels->axpyReals(a, b, c, s.as.real, n);
+			break;
+		case VectorKernel::SUM:
+			if (integer)
+				a->as.integer = static_cast<unsigned long>(a->as.integer) + s_Kernels->sumIntegers(b, n);
+			else
+				a->as.real = sumReals(a->as.real, b, n);
+			break;
+		case VectorKernel::DOT:
+			if (integer)
+				a->as.integer = static_cast<unsigned long>(a->as.integer) + dotIntegers(b, c, n);
+			else
+				a->as.real = dotReals(a->as.real, b, c, n);
+			break;
+		}
+
+		if (end == last)
+		{
+			var.as.integer = last;
+			return true;
+		}
+		var.as.integer = end + 1;
+		return false;
+	}
+
+	void VectorKernels::setUnion(SetBits& res, SetBits const& a, SetBits const& b)
+	{
+		s_Kernels->setUnion(res, a, b);
+	}
+
+	void VectorKernels::setIntersection(SetBits& res, SetBits const& a, SetBits const& b)
+	{
+		s_Kernels->setIntersection(res, a, b);
+	}
+
+	void VectorKernels::setDifference(SetBits& res, SetBits const& a, SetBits const& b)
+	{
+		s_Kernels->setDifference(res, a, b);
+	}
+
+	bool VectorKernels::setsEqual(SetBits const& a, SetBits const& b)
+	{
+		return s_Kernels->setsEqual(a, b);
+	}
+
+	bool VectorKernels::setIncluded(SetBits const& a, SetBits const& b)
+	{
+		return s_Kernels->setIncluded(a, b);
+	}
+
+	bool VectorKernels::select(std::string const& isa)
+	{
+		static const KernelSet* const SETS[] = {
+			&SCALAR,
+#ifdef PASCAL_VECTOR_X86_64
+			&SSE2,
+			&AVX2,
+#endif
+		};
+
+		for (auto set : SETS)
+		{
+			if (isa == set->name && isAvailable(*set))
+			{
+				s_Kernels = set;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	const char* VectorKernels::getIsaName()
+	{
+		return s_Kernels->name;
+	}
+}
@@ -0,0 +1,310 @@
+#include <pscpch.hpp>
+#include <Vectorizer.hpp>
+#include <AST.hpp>
+
+namespace Pascal
+{
+	bool Vectorizer::match(AST::ForNode const& node, Match& res)
+	{
+		if (node.isDownto() || node.getVar().getSymbol() == nullptr)
+			return false;
+
+		m_Var = node.getVar().getSymbol().get();
+		m_Sum = nullptr;
+		m_Assigned = false;
+		m_Shape.clear();
+		m_Arrays.clear();
+		m_Scalar = nullptr;
+		m_Number = nullptr;
+		m_Operations.clear();
+
+		node.getBody().accept(this);
+		if (!m_Assigned || m_Shape.find_first_of("IX") != std::string::npos)
+			return false;
+
+		// a[i] := ..., the target is the first array.
+		static const struct
+		{
+			const char* shape;
+			VectorKernel kernel;
+			// Positions in m_Arrays of b and c.
+			int left;
+			int right;
+		} FORMS[] = {
+			{ "E",     VectorKernel::COPY,  1, -1 },
+			{ "S",     VectorKernel::FILL,  -1, -1 },
+			{ "EE+",   VectorKernel::ADD,   1, 2 },
+			{ "EE-",   VectorKernel::SUB,   1, 2 },
+			{ "EE*",   VectorKernel::MUL,   1, 2 },
+			{ "ES*",   VectorKernel::SCALE, 1, -1 },
+			{ "SE*",   VectorKernel::SCALE, 1, -1 },
+			{ "ES*E+", VectorKernel::AXPY,  1, 2 },
+			{ "SE*E+", VectorKernel::AXPY,  1, 2 },
+			{ "EES*+", VectorKernel::AXPY,  2, 1 },
+			{ "ESE*+", VectorKernel::AXPY,  2, 1 },
+		};
+		// r := ..., no target array.
+		static const struct
+		{
+			const char* shape;
+			VectorKernel kernel;
+		} SUMS[] = {
+			{ "RE+",   VectorKernel::SUM },
+			{ "ER+",   VectorKernel::SUM },
+			{ "REE*+", VectorKernel::DOT },
+			{ "EE*R+", VectorKernel::DOT },
+		};
+
+		bool found = false;
+		if (m_Sum == nullptr)
+		{
+			for (auto const& e : FORMS)
+			{
+				if (m_Shape != e.shape)
+					continue;
+				res.kernel = e.kernel;
+				res.target = m_Arrays[0];
+				res.left = (e.left < 0) ? nullptr : m_Arrays[e.left];
+				res.right = (e.right < 0) ? nullptr : m_Arrays[e.right];
+				found = true;
+			}
+		}
+		else
+		{
+			for (auto const& e : SUMS)
+			{
+				if (m_Shape != e.shape)
+					continue;
+				res.kernel = e.kernel;
+				res.target = m_Sum;
+				res.left = m_Arrays[0];
+				res.right = (m_Arrays.size() > 1) ? m_Arrays[1] : nullptr;
+				found = true;
+			}
+		}
+		if (!found)
+			return false;
+
+		res.scalar = m_Scalar;
+		res.number = m_Number;
+		res.operations = m_Operations;
+
+		// Mixed element types would convert, which the kernels don't.
+		res.element = static_cast<const ArrayTypeSymbol*>(m_Arrays[0]->getParent().get())->getElement();
+		for (auto array : m_Arrays)
+		{
+			if (static_cast<const ArrayTypeSymbol*>(array->getParent().get())->getElement() != res.element)
+				return false;
+		}
+		return res.element != nullptr;
+	}
+
+	void Vectorizer::visitProgramNode(AST::ProgramNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitVarDeclNode(AST::VarDeclNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitBlockNode(AST::BlockNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitTypeNode(AST::TypeNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitStatementNode(AST::StatementNode const& node)
+	{
+		node.accept(this);
+	}
+
+	void Vectorizer::visitCompoundNode(AST::CompoundNode const& node)
+	{
+		if (node.getStatements().size() != 1)
+			m_Shape += 'X';
+		else
+			node.getStatements()[0]->accept(this);
+	}
+
+	// Kernels work on single slot elements, not on records.
+	void Vectorizer::visitAssignmentNode(AST::AssignmentNode const& node)
+	{
+		if (m_Assigned || node.getField() != nullptr || node.getRecord() != nullptr)
+		{
+			m_Shape += 'X';
+			return;
+		}
+		m_Assigned = true;
+
+		if (node.getElement() != nullptr)
+		{
+			node.getElement()->accept(this);
+			if (m_Shape == "E")
+				m_Shape.clear();
+		}
+		else
+		{
+			const VariableSymbol* sym = node.getVar().getSymbol().get();
+			if (sym == nullptr || sym == m_Var || isArray(*sym) || sym->isReference())
+				m_Shape += 'X';
+			m_Sum = sym;
+		}
+		if (m_Shape.empty())
+			node.getExpr().accept(this);
+	}
+
+	void Vectorizer::visitVariableNode(AST::VariableNode const& node)
+	{
+		if (node.getCall() != nullptr)
+		{
+			node.getCall()->accept(this);
+			return;
+		}
+		const VariableSymbol* sym = node.getSymbol().get();
+		if (sym == nullptr || isArray(*sym) || sym->isReference())
+			m_Shape += 'X';
+		else if (sym == m_Var)
+			m_Shape += 'I';
+		else if (sym == m_Sum)
+			m_Shape += 'R';
+		else if (m_Scalar != nullptr || m_Number != nullptr)
+			m_Shape += 'X';
+		else
+		{
+			m_Scalar = sym;
+			m_Shape += 'S';
+		}
+	}
+
+	void Vectorizer::visitNullStatementNode(AST::NullStatementNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitNumberNode(AST::NumberNode const& node)
+	{
+		if (m_Scalar != nullptr || m_Number != nullptr || node.isBig())
+			m_Shape += 'X';
+		else
+		{
+			m_Number = &node;
+			m_Shape += 'S';
+		}
+	}
+
+	void Vectorizer::visitBinOpNode(AST::BinOpNode const& node)
+	{
+		node.getLeft().accept(this);
+		node.getRight().accept(this);
+
+		switch (node.getOperation().type)
+		{
+		case TokenType::PLUS:    m_Shape += '+'; break;
+		case TokenType::MINUS:   m_Shape += '-'; break;
+		case TokenType::PRODUCT: m_Shape += '*'; break;
+		default:                 m_Shape += 'X'; return;
+		}
+		m_Operations.push_back(&node.getOperation());
+	}
+
+	void Vectorizer::visitUnaryOpNode(AST::UnaryOpNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitProcDeclNode(AST::ProcDeclNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitParamNode(const AST::ParamNode &node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitProcCallNode(const AST::ProcCallNode& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitWhileNode(AST::WhileNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitRepeatNode(AST::RepeatNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitForNode(AST::ForNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitIfNode(AST::IfNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitBooleanNode(AST::BooleanNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitCaseNode(AST::CaseNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	// Only a[i] itself: with i + k two iterations could meet. The kernels
+	// address arrays by their slot, not through var parameters.
+	void Vectorizer::visitIndexNode(AST::IndexNode const& node)
+	{
+		std::string shape = m_Shape;
+		m_Shape.clear();
+		node.getIndex().accept(this);
+		bool plain = (m_Shape == "I");
+
+		const VariableSymbol* sym = node.getVar().getSymbol().get();
+		m_Shape = shape + ((plain && sym != nullptr && isArray(*sym) && !sym->isReference()) ? 'E' : 'X');
+		if (m_Shape.back() == 'E')
+			m_Arrays.push_back(sym);
+	}
+
+	void Vectorizer::visitStringNode(AST::StringNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitSetNode(AST::SetNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitTypeDeclNode(AST::TypeDeclNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitFieldNode(AST::FieldNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	void Vectorizer::visitNilNode(AST::NilNode const& node)
+	{
+		m_Shape += 'X';
+	}
+
+	bool Vectorizer::isArray(VariableSymbol const& sym)
+	{
+		return sym.getParent() != nullptr && sym.getParent()->getType() == SymbolType::ARRAY_TYPE;
+	}
+}
@@ -10,7 +10,14 @@
 #include <SemanticAnalyzer.hpp>
 #include <GraphvizVisitor.hpp>
 #include <CodePrettifier.hpp>
+#include <CppTranspiler.hpp>
+#include <Compiler.hpp>
+#include <Inliner.hpp>
+#include <Peephole.hpp>
+#include <RegisterTranslator.hpp>
+#include <VectorKernels.hpp>
 
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <memory>
@@ -57,6 +64,62 @@ int main(int argc, char* argv[])
 	
 	Pascal::ReportsManager::Init(args);
 
+	// -q: skip the debugging dumps (AST graph, symbol tables, prettified source)
+	bool quiet = find(args.begin(), args.end(), "-q") != args.end() ||
+		find(args.begin(), args.end(), "--quiet") != args.end();
+	bool dumpBytecode = find(args.begin(), args.end(), "--dump-bytecode") != args.end();
+	bool peephole = find(args.begin(), args.end(), "--no-peephole") == args.end();
+	bool registerVM = find(args.begin(), args.end(), "--register-vm") != args.end();
+	bool emitCpp = find(args.begin(), args.end(), "--emit-cpp") != args.end();
+	bool jit = find(args.begin(), args.end(), "--jit") != args.end();
+
+	// --jit-threshold=N: calls or loop iterations before a procedure is compiled
+	unsigned jitThreshold = 100;
+	for (auto const& arg : args)
+	{
+		if (arg.rfind("--jit-threshold=", 0) == 0)
+		{
+			jit = true;
+			jitThreshold = std::max(1, stoi(arg.substr(arg.find('=') + 1)));
+		}
+	}
+
+	// --inline-size=N: biggest procedure body (in AST nodes) to inline
+	// --inline-growth=N: most nodes inlined into a single procedure
+	bool inlining = find(args.begin(), args.end(), "--no-inline") == args.end();
+	bool inlineReport = find(args.begin(), args.end(), "--inline-report") != args.end();
+	unsigned inlineSize = 40;
+	unsigned inlineGrowth = 400;
+	for (auto const& arg : args)
+	{
+		if (arg.rfind("--inline-size=", 0) == 0)
+			inlineSize = std::max(0, stoi(arg.substr(arg.find('=') + 1)));
+		else if (arg.rfind("--inline-growth=", 0) == 0)
+			inlineGrowth = std::max(0, stoi(arg.substr(arg.find('=') + 1)));
+	}
+	// --no-bounds-checks: index arrays without checking the bounds
+	bool boundsChecks = find(args.begin(), args.end(), "--no-bounds-checks") == args.end();
+	// --overflow-checks: report integer overflow outside {$Q-} code
+	bool overflowChecks = find(args.begin(), args.end(), "--overflow-checks") != args.end();
+	// --no-vectorize: run array loops as bytecode only
+	// --kernels=scalar|sse2|avx2: instruction set of the array loop kernels
+	bool vectorize = find(args.begin(), args.end(), "--no-vectorize") == args.end();
+	for (auto const& arg : args)
+	{
+		if (arg.rfind("--kernels=", 0) == 0 && !Pascal::VectorKernels::select(arg.substr(arg.find('=') + 1)))
+		{
+			cout << TermColor::BrightRed << "error" << TermColor::BrightWhite <<
+				": kernels \"" << arg.substr(arg.find('=') + 1) << "\" not available" << TermColor::Reset << endl;
+			return 1;
+		}
+	}
+	bool printStats = find(args.begin(), args.end(), "--stats") != args.end();
+	// --heap-reset: free the objects left by new at once when the program ends
+	bool heapReset = find(args.begin(), args.end(), "--heap-reset") != args.end();
+	bool profilePairs = find(args.begin(), args.end(), "--profile-pairs") != args.end();
+	// --async-output: write the output on a thread of its own
+	bool asyncOutput = find(args.begin(), args.end(), "--async-output") != args.end();
+
 	// TODO: Support multiple files
 	string inFileName;
 	for (auto const& arg : args)
@@ -99,26 +162,116 @@ int main(int argc, char* argv[])
 			}
 		}
 
-		Pascal::SemanticAnalyzer symTab;
+		Pascal::SemanticAnalyzer symTab(!quiet);
 		tree->accept(&symTab);
 
 		if (Pascal::ReportsManager::GetErrorsCount() == 0)
 		{
-			Pascal::GraphvizVisitor graph(args[0] + ".dot");
-			tree->accept(&graph);
-			graph.flush();
+			if (!quiet)
+			{
+				Pascal::GraphvizVisitor graph(inFileName + ".dot");
+				tree->accept(&graph);
+				graph.flush();
 			
-			string cmd = "dot -Tsvg " + args[0] + ".dot -o " + args[0] + ".svg";
-			exec(cmd.c_str());
+				string cmd = "dot -Tsvg " + inFileName + ".dot -o " + inFileName + ".svg";
+				exec(cmd.c_str());
+
+				cout << symTab.getSymbolTable()->toString();
 
-			cout << symTab.getSymbolTable()->toString();
+				Pascal::CodePrettifier pretty;
+				tree->accept(&pretty);
+				cout << endl << pretty.toString() << endl;
+			}
+
+			// --emit-cpp: translate to C++ instead of running
+			if (emitCpp)
+			{
+				Pascal::CppTranspiler transpiler;
+				transpiler.setOverflowChecks(overflowChecks);
+				tree->accept(&transpiler);
+
+				ofstream fout(inFileName + ".cpp");
+				fout << transpiler.toString();
+				return 0;
+			}
+
+			Pascal::Inliner inliner(inlineSize, inlineGrowth);
+			if (inlining)
+				tree->accept(&inliner);
+
+			Pascal::Bytecode code;
+			Pascal::Compiler compiler(code, inlining ? &inliner : nullptr);
+			compiler.setBoundsChecks(boundsChecks);
+			compiler.setOverflowChecks(overflowChecks);
+			compiler.setVectorize(vectorize);
+			tree->accept(&compiler);
+
+			if (inlineReport)
+				cerr << inliner.getReport();
+
+			if (dumpBytecode)
+				cout << "BYTECODE" << endl << code.disassemble() << endl;
 
-			Pascal::CodePrettifier pretty;
-			tree->accept(&pretty);
-			cout << endl << pretty.toString() << endl;
+			Pascal::RegisterTranslator translator(code);
+			if (registerVM)
+			{
+				translator.run();
+				if (dumpBytecode)
+					cout << "REGISTER BYTECODE" << endl << code.disassemble() << endl;
+			}
+
+			// Register procedures are left as they are, the rest is still
+			// stack code worth fusing.
+			Pascal::PeepholeOptimizer optimizer(code);
+			if (peephole)
+			{
+				optimizer.run();
+				if (dumpBytecode)
+					cout << "BYTECODE AFTER PEEPHOLE" << endl << code.disassemble() << endl;
+			}
+
+			Pascal::Interpreter interpreter(code);
+			interpreter.setProfiling(profilePairs);
+			interpreter.setHeapReset(heapReset);
+			if (jit)
+				interpreter.enableJit(jitThreshold);
+			if (asyncOutput)
+				interpreter.enableAsyncOutput();
+			auto start = chrono::steady_clock::now();
+			interpreter.run();
+			auto finish = chrono::steady_clock::now();
+
+			if (printStats)
+			{
+				cerr << "dispatch: " << Pascal::Interpreter::getDispatchName() << endl;
+				if (registerVM)
+					cerr << "vm: register (" << translator.getTranslatedCount() << " of " <<
+						code.getProcedures().size() << " procedures)" << endl;
+				else
+					cerr << "vm: stack" << endl;
+				cerr << "inlined calls: " << inliner.getInlinedCount() << endl;
+				cerr << "bounds checks: " << compiler.getBoundsChecks() << " of " <<
+					compiler.getElementAccesses() << " array accesses" << endl;
+				cerr << "vectorized loops: " << compiler.getVectorizedLoops() << " (" <<
+					Pascal::VectorKernels::getIsaName() << " kernels)" << endl;
+				cerr << "superinstructions: " << optimizer.getFusedCount() << endl;
+				if (Pascal::Jit const* compiled = interpreter.getJit())
+					cerr << "jit: " << compiled->getCompiledCount() << " procedures compiled, " <<
+						compiled->getNativeRuns() << " native runs, " << compiled->getBailouts() <<
+						" bailouts, " << compiled->getDroppedCount() << " procedures dropped" << endl;
+				Pascal::ObjectHeap const& heap = interpreter.getHeap();
+				cerr << "heap: " << heap.getAllocations() << " objects allocated, " << heap.getLiveObjects() <<
+					" live (" << heap.getLiveBytes() << " bytes), peak " << heap.getPeakBytes() << " bytes";
+				if (heapReset)
+					cerr << ", " << interpreter.getReclaimedCount() << " reclaimed by reset";
+				cerr << endl;
+				cerr << "instructions executed: " << interpreter.getExecutedCount() << endl;
+				cerr << "execution time: " <<
+					chrono::duration<double, milli>(finish - start).count() << " ms" << endl;
+			}
 
-			Pascal::Interpreter interpreter;
-		    tree->accept(&interpreter);
+			if (profilePairs)
+				cerr << interpreter.getPairProfile(25);
 		}
 	}
 	catch (Pascal::StopExecution const& e)
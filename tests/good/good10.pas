@@ -0,0 +1,52 @@
+program good10;
+var i, k, total, dot : integer;
+var sum, scale : real;
+var a, b, c : array [1..40] of integer;
+var x, y : array [0..15] of real;
+var marks, copies : array [1..8] of boolean;
+
+procedure axpy(n : integer; factor : real);
+var j : integer;
+var z : array [0..15] of real;
+begin
+   for j := 0 to 15 do
+      z[j] := factor;
+   for j := 0 to n do
+      z[j] := x[j] * factor + z[j];
+   for j := 0 to 15 do
+      sum := sum + z[j]
+end;
+
+begin
+   k := 3;
+   for i := 1 to 40 do
+      b[i] := i * i - 50;
+   for i := 1 to 40 do
+      c[i] := 7;
+   for i := 1 to 40 do
+      a[i] := b[i] + c[i];
+   for i := 1 to 40 do
+      a[i] := a[i] - b[i] * k;
+   for i := 10 to 30 do
+      a[i] := a[i] * c[i];
+
+   total := 0;
+   dot := 0;
+   for i := 1 to 40 do
+      total := total + a[i];
+   for i := 1 to 40 do
+      dot := dot + a[i] * b[i];
+
+   scale := 0.5;
+   for i := 0 to 15 do
+      x[i] := i * 1.25;
+   for i := 0 to 15 do
+      y[i] := x[i] * scale;
+   sum := 0;
+   axpy(11, 2);
+
+   for i := 1 to 8 do
+      marks[i] := i % 2 = 1;
+   for i := 1 to 8 do
+      copies[i] := marks[i]
+end.
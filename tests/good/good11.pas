@@ -0,0 +1,42 @@
+program good11;
+var i, n, vowels : integer;
+var s, t, line, greeting, quote, ends, c : string;
+var less, same, longer : boolean;
+var words : array [1..4] of string;
+
+procedure shout(word : string; times : integer);
+var k : integer;
+begin
+   for k := 1 to times do
+      line := line + word + '!'
+end;
+
+begin
+   greeting := 'Hello, ' + 'world';
+   quote := 'it''s';
+   s := '';
+   for i := 1 to 100 do
+      s := s + 'ab';
+   n := length(s);
+
+   t := 'mississippi';
+   vowels := 0;
+   for i := 1 to length(t) do
+   begin
+      c := t[i];
+      if (c = 'i') or (c = 'a') then
+         vowels := vowels + 1
+   end;
+
+   less := 'apple' < 'apples';
+   same := greeting = 'Hello, world';
+   longer := length(greeting + quote) > 15;
+
+   words[1] := 'short';
+   words[2] := 'a much longer word';
+   for i := 3 to 4 do
+      words[i] := words[i - 2] + words[i - 1];
+
+   shout('hey', 3);
+   ends := t[1] + t[length(t)] + ''
+end.
@@ -0,0 +1,39 @@
+program good12;
+var letters, vowels, digits, seen : set of char;
+var small, odd, even, both : set of 0..255;
+var text, c : string;
+var i, n, count : integer;
+var isVowel, inside, subset, equal, other : boolean;
+
+begin
+   letters := ['a'..'z', 'A'..'Z'];
+   vowels := ['a', 'e', 'i', 'o', 'u'];
+   digits := ['0'..'9'];
+   text := 'Hello, World 42 times';
+
+   count := 0;
+   seen := [];
+   for i := 1 to length(text) do
+   begin
+      c := text[i];
+      if c in letters - vowels then
+         count := count + 1;
+      seen := seen + [c]
+   end;
+   isVowel := 'e' in seen * vowels;
+
+   n := 3;
+   small := [1, n..n + 2, 10];
+   odd := [];
+   even := [];
+   for i := 0 to 20 do
+      if i % 2 = 1 then
+         odd := odd + [i]
+      else
+         even := even + [i];
+   both := odd * even;
+   inside := 4 in small;
+   subset := [3, 5] <= small;
+   equal := odd + even = [0..20];
+   other := (small <> [1, 3..5, 10]) or not (256 in small) or (digits >= ['4', '2'])
+end.
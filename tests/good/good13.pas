@@ -0,0 +1,42 @@
+program good13;
+type point = record x, y : integer end;
+type segment = record a, b : point; name : string end;
+type cell = packed record alive : boolean; weight : real; age : integer; tags : set of char; end;
+var p, q : point;
+var s, t : segment;
+var grid : array [1..4] of cell;
+var origin : record x, y : integer; label : string end;
+var i, sum : integer;
+var same : boolean;
+
+begin
+   p.x := 3;
+   p.y := 4;
+   q := p;
+   q.y := q.y * 2;
+
+   s.a := p;
+   s.b.x := -1;
+   s.b.y := q.x + q.y;
+   s.name := 'diagonal';
+   t := s;
+   t.a.x := 100;
+
+   for i := 1 to 4 do
+   begin
+      grid[i].alive := i % 2 = 0;
+      grid[i].weight := i * 0.25;
+      grid[i].age := i * i;
+      grid[i].tags := ['a'..'c']
+   end;
+   grid[1] := grid[4];
+   grid[2].tags := grid[2].tags + ['z'];
+
+   sum := 0;
+   for i := 1 to 4 do
+      if grid[i].alive then
+         sum := sum + grid[i].age;
+
+   origin.label := 'origin';
+   same := (s.a.x = p.x) and (t.b.y = s.b.y) and (t.a.x <> s.a.x)
+end.
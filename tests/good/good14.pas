@@ -0,0 +1,102 @@
+program good14;
+type point = record x, y : integer end;
+type vector = array [1..5] of integer;
+type path = array [0..2] of point;
+var a, b, total, depth : integer;
+var v : vector;
+var p : point;
+var route : path;
+var name : string;
+var ratio : real;
+
+procedure swap(var x : integer; var y : integer);
+var t : integer;
+begin
+   t := x;
+   x := y;
+   y := t
+end;
+
+procedure sum(const items : vector; var res : integer);
+var i : integer;
+begin
+   res := 0;
+   for i := 1 to 5 do
+      res := res + items[i]
+end;
+
+procedure shift(var q : point; d : integer);
+begin
+   q.x := q.x + d;
+   q.y := q.y - d
+end;
+
+procedure stretch(var r : path; k : integer);
+var i : integer;
+begin
+   for i := 0 to 2 do
+   begin
+      r[i].x := r[i].x * k;
+      shift(r[i], 1)
+   end;
+   swap(r[0].y, r[2].x)
+end;
+
+procedure count(var n : integer);
+   procedure bump(k : integer);
+   begin
+      n := n + k
+   end;
+begin
+   bump(2);
+   bump(3)
+end;
+
+procedure descend(var level : integer; n : integer);
+begin
+   if n > 0 then
+   begin
+      level := level + 1;
+      descend(level, n - 1)
+   end
+end;
+
+procedure widen(var w : real; const by : integer);
+begin
+   w := w + by
+end;
+
+procedure greet(var s : string; const who : string);
+begin
+   s := s + who
+end;
+
+begin
+   a := 1;
+   b := 2;
+   swap(a, b);
+
+   for a := 1 to 5 do
+      v[a] := a * a;
+   swap(v[1], v[5]);
+   sum(v, total);
+
+   p.x := 10;
+   p.y := 20;
+   shift(p, 5);
+
+   route[0].x := 1;
+   route[1].x := 2;
+   route[2].x := 3;
+   stretch(route, 10);
+
+   b := 0;
+   count(b);
+   depth := 0;
+   descend(depth, 7);
+
+   ratio := 0.5;
+   widen(ratio, 2);
+   name := 'hello, ';
+   greet(name, 'world')
+end.
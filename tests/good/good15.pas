@@ -0,0 +1,87 @@
+program good15;
+type point = record x, y : integer end;
+var a, b, c, big, total : integer;
+var half : real;
+var even, found : boolean;
+var greeting : string;
+var p : point;
+
+function fib(n : integer) : integer;
+begin
+   if n < 2 then
+      fib := n
+   else
+      fib := fib(n - 1) + fib(n - 2)
+end;
+
+function square(x : integer) : integer;
+begin
+   square := x * x
+end;
+
+function halve(x : real) : real;
+begin
+   halve := x / 2
+end;
+
+function isEven(x : integer) : boolean;
+begin
+   isEven := x % 2 = 0
+end;
+
+function greet(who : string) : string;
+begin
+   greet := 'hello, ' + who
+end;
+
+function largest(const q : point) : integer;
+begin
+   largest := q.x;
+   if q.y > q.x then
+      largest := q.y
+end;
+
+function sumTo(n : integer) : integer;
+var i, s : integer;
+   procedure add(k : integer);
+   begin
+      s := s + k;
+      sumTo := s
+   end;
+begin
+   s := 0;
+   for i := 1 to n do
+      add(i)
+end;
+
+function collatz(n : integer) : integer;
+var steps : integer;
+begin
+   steps := 0;
+   while n <> 1 do
+   begin
+      if isEven(n) then
+         n := n / 2
+      else
+         n := 3 * n + 1;
+      steps := steps + 1
+   end;
+   collatz := steps
+end;
+
+begin
+   a := fib(20);
+   b := square(square(3)) + square(a % 7);
+   half := halve(7);
+   even := isEven(b);
+   if isEven(a) then
+      c := 1
+   else
+      c := 2;
+   greeting := greet('world');
+   p.x := 3;
+   p.y := 11;
+   big := largest(p);
+   total := sumTo(10);
+   found := collatz(27) = 111
+end.
@@ -0,0 +1,115 @@
+program good16;
+type
+   list = ^node;
+   node = record value : integer; next : list end;
+   tree = ^leaf;
+   leaf = record key : integer; left, right : tree end;
+   point = record x, y : real end;
+var head, p : list;
+var root : tree;
+var counter : ^integer;
+var corner : ^point;
+var q : point;
+var slots : array[1..3] of list;
+var i, count, sum, depth, first, last : integer;
+var empty, same : boolean;
+
+procedure push(var l : list; v : integer);
+var n : list;
+begin
+   new(n);
+   n^.value := v;
+   n^.next := l;
+   l := n
+end;
+
+procedure insert(var t : tree; k : integer);
+begin
+   if t = nil then
+   begin
+      new(t);
+      t^.key := k
+   end
+   else if k < t^.key then
+      insert(t^.left, k)
+   else
+      insert(t^.right, k)
+end;
+
+function height(t : tree) : integer;
+var l, r : integer;
+begin
+   if t = nil then
+      height := 0
+   else
+   begin
+      l := height(t^.left);
+      r := height(t^.right);
+      if l > r then
+         height := l + 1
+      else
+         height := r + 1
+   end
+end;
+
+function smallest(t : tree) : integer;
+begin
+   while t^.left <> nil do
+      t := t^.left;
+   smallest := t^.key
+end;
+
+begin
+   head := nil;
+   empty := head = nil;
+   for i := 1 to 10 do
+      push(head, i * i);
+
+   count := 0;
+   sum := 0;
+   p := head;
+   while p <> nil do
+   begin
+      count := count + 1;
+      sum := sum + p^.value;
+      p := p^.next
+   end;
+
+   while head <> nil do
+   begin
+      p := head;
+      head := head^.next;
+      dispose(p)
+   end;
+
+   insert(root, 50);
+   insert(root, 30);
+   insert(root, 70);
+   insert(root, 20);
+   insert(root, 40);
+   insert(root, 35);
+   depth := height(root);
+   first := smallest(root);
+
+   new(counter);
+   counter^ := 41;
+   counter^ := counter^ + 1;
+   last := counter^;
+   dispose(counter);
+
+   new(corner);
+   corner^.x := 1;
+   corner^.y := 2.5;
+   q := corner^;
+   corner^ := q;
+   same := corner^.x = q.x;
+
+   for i := 1 to 3 do
+   begin
+      new(slots[i]);
+      slots[i]^.value := i
+   end;
+   slots[2]^.next := slots[3];
+   p := slots[2]^.next;
+   last := last + p^.value
+end.
@@ -0,0 +1,57 @@
+program good17;
+type account = record owner : integer; balance : bigint end;
+var f, p, q, r, back, wide, narrow, literal : bigint;
+var powers : array[0..4] of bigint;
+var acc : account;
+var i : integer;
+var ratio : real;
+var bigger, exact : boolean;
+
+function fact(n : bigint) : bigint;
+begin
+   if n <= 1 then
+      fact := 1
+   else
+      fact := n * fact(n - 1)
+end;
+
+function gcd(a, b : bigint) : bigint;
+var t : bigint;
+begin
+   while b <> 0 do
+   begin
+      t := a % b;
+      a := b;
+      b := t
+   end;
+   gcd := a
+end;
+
+begin
+   f := fact(25);
+   p := 1;
+   for i := 1 to 70 do
+      p := p * 2;
+   q := f / p;
+   r := f % p;
+   exact := q * p + r = f;
+
+   back := p * p / p / p;
+   wide := 9223372036854775807;
+   wide := wide + 1;
+   narrow := -wide + 1;
+
+   { Literals beyond a long are bigints where a bigint is assigned. }
+   literal := 15511210043330985984000000 - fact(25) + gcd(100000000000000000000, 10);
+
+   powers[0] := 1;
+   for i := 1 to 4 do
+      powers[i] := powers[i - 1] * 1000000000000;
+
+   acc.owner := 7;
+   acc.balance := powers[3] - powers[2];
+   acc.balance := gcd(acc.balance, fact(30));
+
+   bigger := powers[4] > powers[3] * 999;
+   ratio := powers[2] / 1.0e12
+end.
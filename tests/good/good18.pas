@@ -0,0 +1,34 @@
+program good18;
+{$Q+}
+var h, i, total, half, rest, back : integer;
+var big : bigint;
+
+{ The hash wraps on purpose, so it runs unchecked. }
+{$Q-}
+function mix(h, k : integer) : integer;
+begin
+   mix := h * 1099511628211 + k
+end;
+{$Q+}
+
+function triangle(n : integer) : integer;
+begin
+   triangle := n * (n + 1) / 2
+end;
+
+begin
+   h := 1469598103934665603;
+   for i := 1 to 100 do
+      h := mix(h, i);
+
+   total := 0;
+   for i := 1 to 1000 do
+      total := total + triangle(i);
+   half := total / 2;
+   rest := -(total % 7);
+   back := total - half * 2;
+
+   { Bigints grow instead of overflowing, checked or not. }
+   big := 4611686018427387904;
+   big := big * 4 + big
+end.
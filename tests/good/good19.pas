@@ -0,0 +1,29 @@
+program good19;
+var i, n : integer;
+var x : real;
+var b : bigint;
+var s : string;
+var ok : boolean;
+
+procedure line(k : integer);
+begin
+   writeln('k = ', k, ' half = ', k / 2, ' r = ', k * 0.5)
+end;
+
+begin
+   n := 0;
+   x := 3.14159265;
+   b := 4611686018427387904;
+   b := b * b;
+   s := 'it''s';
+   ok := x > 3;
+   write('start ');
+   writeln();
+   for i := 1 to 5 do
+      line(i);
+   writeln(x, ' ', -x, ' ', 1.0e20, ' ', 0.0001, ' ', 100000.0, ' ', 1000000.0);
+   writeln(b, ' ', -9223372036854775807 - 1, ' ', 0, ' ', -5);
+   writeln(s, ' ', ok, ' ', not ok);
+   write(1, 2, 3);
+   writeln()
+end.
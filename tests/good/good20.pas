@@ -0,0 +1,29 @@
+program good20;
+{ Run with good20.in as the input. }
+var n, i, k, sum : integer;
+var x, total : real;
+var b : bigint;
+var name : string;
+var a : array[1..3] of integer;
+
+procedure pair(var m : integer; var y : real);
+begin
+   read(m, y)
+end;
+
+begin
+   readln(name);
+   readln(n);
+   sum := 0;
+   total := 0.0;
+   for i := 1 to n do
+   begin
+      pair(k, x);
+      sum := sum + k;
+      total := total + x
+   end;
+   readln();
+   read(a[1], a[2], a[3]);
+   readln(b);
+   writeln(name, ': ', sum, ' ', total, ' ', a[1] + a[2] + a[3], ' ', b * 2)
+end.
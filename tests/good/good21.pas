@@ -0,0 +1,38 @@
+program good21;
+var f, g : text;
+var i, k, sum, lines : integer;
+var x : real;
+var s, last : string;
+
+begin
+   assign(f, '/tmp/good21.txt');
+   rewrite(f);
+   writeln(f, 'squares and halves');
+   for i := 1 to 10 do
+      writeln(f, i * i, ' ', i / 2.0);
+   write(f, 'no line break at the end');
+   close(f);
+
+   reset(f);
+   readln(f, s);
+   sum := 0;
+   for i := 1 to 10 do
+   begin
+      readln(f, k, x);
+      sum := sum + k
+   end;
+   readln(f, last);
+   writeln(s, ': ', sum, ' ', x, ' ', eof(f));
+
+   { A second variable reads the same file again, line by line. }
+   assign(g, '/tmp/good21.txt');
+   reset(g);
+   lines := 0;
+   while not eof(g) do
+   begin
+      readln(g, s);
+      lines := lines + 1
+   end;
+   close(g);
+   writeln(lines, ' lines, the last one: ', last)
+end.
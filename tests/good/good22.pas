@@ -0,0 +1,33 @@
+program good22;
+var f, g : text;
+var i : integer;
+var first, filler, last, again : string;
+
+begin
+   assign(f, '/tmp/good22.txt');
+   rewrite(f);
+   writeln(f, 'first');
+   for i := 1 to 1000 do
+      writeln(f, 'a line to fill a few pages ', i);
+   writeln(f, 'last');
+   close(f);
+
+   { Rewriting the name that is being read truncates the file under f,
+     which goes on with what it has read. }
+   reset(f);
+   readln(f, first);
+   assign(g, '/tmp/good22.txt');
+   rewrite(g);
+   writeln(g, 'again');
+   close(g);
+   for i := 1 to 1000 do
+      readln(f, filler);
+   readln(f, last);
+   writeln(first, ' ', filler, ' ', last, ' ', eof(f));
+   close(f);
+
+   reset(f);
+   readln(f, again);
+   close(f);
+   writeln(again)
+end.
@@ -0,0 +1,55 @@
+program good23;
+var a, x, y, z, n, i : integer;
+var s : string;
+var b : boolean;
+var arr : array [1..3] of integer;
+
+function f(k : integer) : integer;
+begin
+   a := 100;
+   f := k
+end;
+
+function g(var v : integer) : integer;
+begin
+   v := v + 5;
+   g := v - 5
+end;
+
+function tick(k : integer) : boolean;
+begin
+   n := n + 1;
+   tick := n < k
+end;
+
+function show(k : integer) : integer;
+begin
+   write('<', k, '>');
+   show := k
+end;
+
+begin
+   { Operands are evaluated before the calls to their right. }
+   a := 1;
+   i := 0;
+   x := a + f(2);
+   y := 1;
+   y := y + g(y);
+   z := f(1) + a;
+   { Calls on the right of and, or and in loop conditions are made
+     only when evaluated. }
+   n := 0;
+   b := false and tick(10);
+   b := true or tick(10);
+   while tick(5) do
+      i := i + 1;
+   repeat
+      i := i + 10
+   until not tick(8);
+   arr[1] := 1;
+   i := 1;
+   arr[i] := g(i) + arr[1];
+   writeln(show(1), show(2) + show(3));
+   s := 'ab';
+   s := s + 'c'
+end.
@@ -0,0 +1,12 @@
+program good24;
+var tiny, huge, scaled, sum : real;
+var ordered : boolean;
+
+begin
+   { Signed exponents belong to the literal: 1.0e-300 is not 1.0e - 300. }
+   tiny := 1.0e-300;
+   huge := 2.5E+300;
+   scaled := 15e-1 * 2e2;
+   sum := -1e-3 + 3.0e2 - 1e+1;
+   ordered := (tiny > 0) and (tiny < 1e-299) and (huge > 1e300)
+end.
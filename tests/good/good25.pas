@@ -0,0 +1,13 @@
+program good25;
+var big, next, negated, hashed, i : integer;
+
+begin
+   { Unchecked integer arithmetic wraps around instead of trapping. }
+   big := 9223372036854775807;
+   next := big + 1;
+   negated := -next;
+   hashed := 7;
+   for i := 1 to 10 do
+      hashed := hashed * 1000003 - big;
+   writeln(next, ' ', negated, ' ', hashed, ' ', next - 1)
+end.
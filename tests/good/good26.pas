@@ -0,0 +1,18 @@
+program good26;
+var i : integer;
+
+procedure greet;
+begin
+   write('hello');
+   writeln
+end;
+
+begin
+   { Calls without arguments may leave out their parentheses. }
+   write('a');
+   writeln;
+   greet;
+   for i := 1 to 2 do
+      if i = 1 then writeln else write;
+   repeat writeln until true
+end.
@@ -0,0 +1,17 @@
+program good27;
+var i : integer;
+var sum : real;
+
+{ The native negation only knows integers, so every native run of
+  flipped bails out until the Jit leaves it to the interpreter. }
+function flipped(x : real) : real;
+begin
+   flipped := -x * 2.0 + 1.0
+end;
+
+begin
+   sum := 0.0;
+   for i := 1 to 1000 do
+      sum := sum + flipped(i);
+   writeln(sum)
+end.
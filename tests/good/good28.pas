@@ -0,0 +1,17 @@
+program good28;
+var i, sum, low : integer;
+
+{ LONG_MIN / -1 wraps and LONG_MIN % -1 is 0 instead of trapping. }
+function both(a, b : integer) : integer;
+begin
+   both := a % b + a / b
+end;
+
+begin
+   low := -9223372036854775807 - 1;
+   writeln(low % -1, ' ', low / -1, ' ', both(low, -1));
+   sum := 0;
+   for i := 1 to 200 do
+      sum := sum + both(low, -1) + low % (i - i - 1) + both(low + i, i + 3);
+   writeln(sum)
+end.
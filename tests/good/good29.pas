@@ -0,0 +1,27 @@
+program good29;
+var x, n : integer;
+
+{ A function without parameters is called by its name alone. }
+function seven : integer;
+begin
+   n := n + 1;
+   seven := 7
+end;
+
+function countdown(k : integer) : integer;
+begin
+   if k = 0 then
+      countdown := seven
+   else
+      countdown := countdown(k - 1) + 1
+end;
+
+begin
+   n := 0;
+   x := seven;
+   x := x + seven * 2;
+   writeln(x, ' ', seven + seven, ' ', countdown(3), ' ', n);
+   while x > seven do
+      x := x - 1;
+   writeln(x)
+end.
@@ -0,0 +1,15 @@
+program good30;
+{ Run with good30.in as the input. eof alone is eof of the input. }
+var x, sum, lines : integer;
+
+begin
+   sum := 0;
+   lines := 0;
+   while not eof do
+   begin
+      readln(x);
+      sum := sum + x;
+      lines := lines + 1
+   end;
+   writeln(lines, ' ', sum)
+end.
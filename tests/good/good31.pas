@@ -0,0 +1,32 @@
+program good31;
+type
+   Wide = record
+      a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q, r : integer;
+   end;
+   Wider = record
+      a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q, r, s, t, u : real;
+   end;
+   PWide = ^Wide;
+   PWider = ^Wider;
+var x, y : PWide;
+var z : PWider;
+var i, sum : integer;
+begin
+   sum := 0;
+   for i := 1 to 100000 do
+   begin
+      new(x);
+      x^.r := i;
+      new(z);
+      z^.u := i;
+      sum := sum + x^.r + x^.a;
+      dispose(x);
+      dispose(z)
+   end;
+   new(x);
+   new(y);
+   y^.q := 5;
+   writeln(sum, ' ', x^.r, ' ', y^.q);
+   dispose(x);
+   dispose(y)
+end.
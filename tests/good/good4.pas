@@ -0,0 +1,24 @@
+program good4;
+var total, n : integer;
+    r : real;
+
+procedure addTo(k : integer; w : real);
+var t : integer;
+
+   procedure inner(m : integer);
+   begin
+      total := total + m;
+      t := t + 1
+   end;
+
+begin
+   inner(k);
+   inner(k * 2);
+   r := r + w + t
+end;
+
+begin
+   n := 5;
+   addTo(n, 1);
+   addTo(n + 1, 0.5)
+end.
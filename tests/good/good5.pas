@@ -0,0 +1,38 @@
+program good5;
+var total, depth : integer;
+    r : real;
+
+procedure finish(k : integer; w : real);
+var t : integer;
+begin
+   t := k * 2;
+   total := total + t;
+   r := r + w
+end;
+
+procedure middle(k : integer);
+var m : integer;
+
+   procedure note(q : integer);
+   begin
+      m := m + q;
+      depth := depth + m
+   end;
+
+begin
+   m := k;
+   note(k + 1);
+   finish(m, k)
+end;
+
+procedure outer(n : integer);
+begin
+   depth := depth + 1;
+   middle(n * 3)
+end;
+
+begin
+   outer(1);
+   outer(2);
+   middle(7)
+end.
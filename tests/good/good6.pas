@@ -0,0 +1,40 @@
+program good6;
+var i, j, sum, count, last : integer;
+    avg : real;
+
+procedure triangle(n : integer);
+var k : integer;
+begin
+   for k := 1 to n do
+      sum := sum + k;
+   last := k
+end;
+
+procedure countdown(n : integer);
+var k, steps : integer;
+begin
+   steps := 0;
+   for k := n downto 1 do
+   begin
+      steps := steps + 1;
+      count := count + steps * k
+   end
+end;
+
+begin
+   for i := 1 to 10 do
+      for j := i to i + 3 do
+         sum := sum + i * j;
+
+   for i := 5 to 4 do
+      sum := sum + 1000;
+
+   triangle(100);
+   countdown(7);
+
+   j := 3;
+   for j := j * 2 downto j - 1 do
+      count := count + j;
+
+   avg := sum / 10
+end.
@@ -0,0 +1,68 @@
+program good7;
+var i, n, d, evens, steps, below, hits : integer;
+    x : real;
+    found, small, both, either, flag : boolean;
+
+procedure collatz(start : integer);
+var k : integer;
+begin
+   k := start;
+   steps := 0;
+   while k <> 1 do
+   begin
+      if k % 2 = 0 then
+         k := k / 2
+      else
+         k := 3 * k + 1;
+      steps := steps + 1
+   end
+end;
+
+procedure classify(v : integer);
+begin
+   if v < 0 then
+      below := below + 1
+   else if (v >= 10) and (v <= 20) then
+      hits := hits + 1
+   else if not (v > 100) then
+      hits := hits + 100
+end;
+
+begin
+   for i := 1 to 20 do
+      if i % 2 = 0 then
+         evens := evens + 1;
+
+   collatz(27);
+
+   n := 0;
+   repeat
+      n := n + 1
+   until (n * n > 200) or (n >= 100);
+
+   d := 0;
+   x := 10;
+   found := (d <> 0) and (x / d > 1);
+   if (d = 0) or (x / d > 1) then
+      d := 5;
+   found := (d <> 0) and (x / d > 1);
+
+   small := x < 10.5;
+   both := found and small;
+   either := not found or small;
+   flag := (small = both) <> either;
+   if flag then
+      flag := false
+   else
+      flag := true;
+
+   classify(-3);
+   classify(15);
+   classify(50);
+   classify(500);
+
+   if true then
+      below := below + 10;
+   while false do
+      below := 0
+end.
@@ -0,0 +1,69 @@
+program good8;
+var i, few, dense, sparse, negative, other, nested, state, runs : integer;
+
+procedure classify(v : integer);
+begin
+   case v % 7 of
+      0: few := few + 1;
+      3, 5: few := few + 10
+   end;
+
+   case v of
+      1, 2, 3: dense := dense + 1;
+      4: dense := dense + 10;
+      6, 7: dense := dense + 100;
+      8: dense := dense + 1000;
+      10: dense := dense + 10000
+   else
+      other := other + 1
+   end;
+
+   case v * v of
+      1: sparse := sparse + 1;
+      100: sparse := sparse + 2;
+      400: sparse := sparse + 3;
+      10000: sparse := sparse + 4;
+      90000: sparse := sparse + 5;
+      1000000: sparse := sparse + 6
+   else
+      begin
+         other := other + 10;
+         sparse := sparse - 1
+      end
+   end
+end;
+
+begin
+   for i := -5 to 30 do
+      classify(i);
+
+   for i := -3 to 3 do
+      case i of
+         -3, -1: negative := negative + 1;
+         -2: negative := negative + 10;
+         +2: negative := negative + 100;
+      end;
+
+   state := 0;
+   runs := 0;
+   while state <> 4 do
+   begin
+      runs := runs + 1;
+      case state of
+         0: state := 2;
+         1: state := 3;
+         2:
+            case runs of
+               2: nested := nested + 1;
+               3, 4: nested := nested + 10
+            else
+               state := 1
+            end;
+         3: state := 4
+      end
+   end;
+
+   case 99 of
+      1: other := 0
+   end
+end.
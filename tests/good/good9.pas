@@ -0,0 +1,61 @@
+program good9;
+var i, n, sum : integer;
+var squares : array [1..20] of integer;
+var shifted : array [-3..3] of integer;
+var halves : array [0..4] of real;
+var flags : array [1..6] of boolean;
+
+procedure sieve(limit : integer);
+var k, m : integer;
+var composite : array [2..50] of boolean;
+begin
+   for k := 2 to limit do
+      if not composite[k] then
+      begin
+         n := n + 1;
+         m := k * k;
+         while m <= limit do
+         begin
+            composite[m] := true;
+            m := m + k
+         end
+      end
+end;
+
+procedure outer;
+var j : integer;
+var counts : array [0..9] of integer;
+
+   procedure bump(v : integer);
+   begin
+      counts[v % 10] := counts[v % 10] + 1
+   end;
+
+begin
+   for j := 1 to 25 do
+      bump(j * 3);
+   for j := 9 downto 0 do
+      sum := sum + counts[j] * j
+end;
+
+begin
+   for i := 1 to 20 do
+      squares[i] := i * i;
+
+   for i := -3 to 3 do
+      shifted[i] := squares[i + 4] - i;
+
+   for i := 0 to 4 do
+      halves[i] := i / 2;
+   halves[0] := 7;
+
+   for i := 1 to 6 do
+      flags[i] := squares[i] % 2 = 0;
+
+   n := 0;
+   sieve(50);
+
+   sum := 0;
+   outer();
+   sum := sum + squares[n] + shifted[-3]
+end.